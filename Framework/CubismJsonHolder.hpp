@@ -48,10 +48,11 @@ namespace Live2D { namespace Cubism { namespace Framework {
          *
          * @param buffer Buffer into which JSON is loaded
          * @param size Number of bytes in buffer
+         * @param borrowBuffer true to parse without copying buffer, which must then outlive the instance
          */
-        void CreateCubismJson(const csmByte* buffer, csmSizeInt size)
+        void CreateCubismJson(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer = false)
         {
-            _json = Utils::CubismJson::Create(buffer, size);
+            _json = Utils::CubismJson::Create(buffer, size, borrowBuffer);
 
             if (!IsValid())
             {
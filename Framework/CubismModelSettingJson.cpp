@@ -177,9 +177,9 @@ csmBool CubismModelSettingJson::IsExistLipSyncParameters() const
     return false;
 }
 
-CubismModelSettingJson::CubismModelSettingJson(const csmByte* buffer, csmSizeInt size)
+CubismModelSettingJson::CubismModelSettingJson(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer)
 {
-    CreateCubismJson(buffer, size);
+    CreateCubismJson(buffer, size, borrowBuffer);
 
     if (_json)
     {
@@ -413,7 +413,7 @@ csmInt32 CubismModelSettingJson::GetEyeBlinkParameterCount()
 
         if (strcmp(refI[Name].GetRawString(), EyeBlink) == 0)
         {
-            num = refI[Ids].GetVector()->GetSize();
+            num = refI[Ids].GetSize();
             break;
         }
     }
@@ -462,7 +462,7 @@ csmInt32 CubismModelSettingJson::GetLipSyncParameterCount()
 
         if (strcmp(refI[Name].GetRawString(), LipSync) == 0)
         {
-            num = refI[Ids].GetVector()->GetSize();
+            num = refI[Ids].GetSize();
             break;
         }
     }
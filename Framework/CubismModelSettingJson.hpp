@@ -27,8 +27,9 @@ public:
      *
      * @param buffer Buffer into which the Model Settings File is loaded
      * @param size Number of bytes in buffer
+     * @param borrowBuffer true to parse without copying buffer, which must then outlive the instance
      */
-    CubismModelSettingJson(const csmByte* buffer, csmSizeInt size);
+    CubismModelSettingJson(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer = false);
 
     /**
      * Destructor
@@ -23,6 +23,7 @@ void CubismBreath::Delete(CubismBreath* instance)
 
 CubismBreath::CubismBreath()
                             : _currentTime(0.0f)
+                            , _parameterIndicesModel(NULL)
 { }
 
 CubismBreath::~CubismBreath()
@@ -31,6 +32,7 @@ CubismBreath::~CubismBreath()
 void CubismBreath::SetParameters(const csmVector<BreathParameterData>& breathParameters)
 {
     _breathParameters = breathParameters;
+    _parameterIndicesModel = NULL;
 }
 
 const csmVector<CubismBreath::BreathParameterData>& CubismBreath::GetParameters() const
@@ -43,13 +45,28 @@ void CubismBreath::UpdateParameters(CubismModel* model, csmFloat32 deltaTimeSeco
     _currentTime += deltaTimeSeconds;
 
     const csmFloat32 t = _currentTime * 2.0f * CubismMath::Pi;
+    const csmInt32 parameterCount = static_cast<csmInt32>(_breathParameters.GetSize());
 
-    for (csmUint32 i = 0; i < _breathParameters.GetSize(); ++i)
+    // パラメータのインデックスはモデルごとに一度だけ求める
+    if (_parameterIndicesModel != model)
     {
-        BreathParameterData* data = &_breathParameters[i];
+        _parameterIndices.UpdateSize(parameterCount, -1, false);
+        _parameterValues.UpdateSize(parameterCount, 0.0f, false);
+        for (csmInt32 i = 0; i < parameterCount; ++i)
+        {
+            _parameterIndices[i] = model->GetParameterIndex(_breathParameters[i].ParameterId);
+        }
+        _parameterIndicesModel = model;
+    }
+
+    for (csmInt32 i = 0; i < parameterCount; ++i)
+    {
+        const BreathParameterData* data = &_breathParameters[i];
 
-        model->AddParameterValue(data->ParameterId, data->Offset + (data->Peak * sinf(t / data->Cycle)), data->Weight);
+        _parameterValues[i] = (data->Offset + (data->Peak * sinf(t / data->Cycle))) * data->Weight;
     }
+
+    model->AddParameterValues(_parameterIndices.GetPtr(), _parameterValues.GetPtr(), parameterCount);
 }
 
 }}}
@@ -110,6 +110,10 @@ private:
 
     csmVector<BreathParameterData> _breathParameters;
     csmFloat32 _currentTime;
+
+    csmVector<csmInt32> _parameterIndices;      ///< Indices of the parameters in _parameterIndicesModel
+    const CubismModel* _parameterIndicesModel;
+    csmVector<csmFloat32> _parameterValues;     ///< Values to be added to the parameters
 };
 
 }}}
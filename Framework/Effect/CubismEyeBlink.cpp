@@ -35,6 +35,7 @@ CubismEyeBlink::CubismEyeBlink(ICubismModelSetting* modelSetting)
     , _closedSeconds(0.05f)
     , _openingSeconds(0.15f)
     , _userTimeSeconds(0.0f)
+    , _parameterIndicesModel(NULL)
 {
     if (modelSetting == NULL)
     {
@@ -72,6 +73,7 @@ void CubismEyeBlink::SetBlinkingSettings(csmFloat32 closing, csmFloat32 closed,
 void CubismEyeBlink::SetParameterIds(const csmVector<CubismIdHandle>& parameterIds)
 {
     _parameterIds = parameterIds;
+    _parameterIndicesModel = NULL;
 }
 
 const csmVector<CubismIdHandle>& CubismEyeBlink::GetParameterIds() const
@@ -150,10 +152,26 @@ void CubismEyeBlink::UpdateParameters(CubismModel* model, csmFloat32 deltaTimeSe
         parameterValue = -parameterValue;
     }
 
-    for (csmUint32 i = 0; i < _parameterIds.GetSize(); ++i)
+    const csmInt32 parameterCount = static_cast<csmInt32>(_parameterIds.GetSize());
+
+    // パラメータのインデックスはモデルごとに一度だけ求める
+    if (_parameterIndicesModel != model)
     {
-        model->SetParameterValue(_parameterIds[i], parameterValue);
+        _parameterIndices.UpdateSize(parameterCount, -1, false);
+        _parameterValues.UpdateSize(parameterCount, 0.0f, false);
+        for (csmInt32 i = 0; i < parameterCount; ++i)
+        {
+            _parameterIndices[i] = model->GetParameterIndex(_parameterIds[i]);
+        }
+        _parameterIndicesModel = model;
     }
+
+    for (csmInt32 i = 0; i < parameterCount; ++i)
+    {
+        _parameterValues[i] = parameterValue;
+    }
+
+    model->SetParameterValues(_parameterIndices.GetPtr(), _parameterValues.GetPtr(), parameterCount);
 }
 
 }}}
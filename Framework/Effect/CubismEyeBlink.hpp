@@ -109,6 +109,10 @@ private:
     csmFloat32                  _openingSeconds;
     csmFloat32                  _userTimeSeconds;
 
+    csmVector<csmInt32>         _parameterIndices;          ///< Indices of the parameters in _parameterIndicesModel
+    const CubismModel*          _parameterIndicesModel;
+    csmVector<csmFloat32>       _parameterValues;           ///< Values set to the parameters
+
 };
 
 }}}
@@ -7,18 +7,64 @@
 
 #include "CubismIdManager.hpp"
 #include "CubismId.hpp"
+#include "CubismDefaultParameterId.hpp"
+#include <string.h>
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
+namespace {
+const csmUint32 IdBlockSize = 64;       ///< IDs per storage block
+const csmUint32 InitialSlotCount = 256; ///< Initial size of the hash index
+
+/**
+ * Default IDs, registered when the manager is created.
+ * The prefixes (HitAreaPrefix, PartsArm*Prefix) are not IDs by themselves.
+ */
+const csmChar** GetDefaultIds(csmInt32* count)
+{
+    using namespace DefaultParameterId;
+    static const csmChar* ids[] =
+    {
+        HitAreaHead, HitAreaBody, PartsIdCore,
+        ParamAngleX, ParamAngleY, ParamAngleZ,
+        ParamEyeLOpen, ParamEyeLSmile, ParamEyeROpen, ParamEyeRSmile,
+        ParamEyeBallX, ParamEyeBallY, ParamEyeBallForm,
+        ParamBrowLY, ParamBrowRY, ParamBrowLX, ParamBrowRX,
+        ParamBrowLAngle, ParamBrowRAngle, ParamBrowLForm, ParamBrowRForm,
+        ParamMouthForm, ParamMouthOpenY, ParamCheek,
+        ParamBodyAngleX, ParamBodyAngleY, ParamBodyAngleZ, ParamBreath,
+        ParamArmLA, ParamArmRA, ParamArmLB, ParamArmRB, ParamHandL, ParamHandR,
+        ParamHairFront, ParamHairSide, ParamHairBack, ParamHairFluffy,
+        ParamShoulderY, ParamBustX, ParamBustY, ParamBaseX, ParamBaseY, ParamNONE,
+    };
+    *count = static_cast<csmInt32>(sizeof(ids) / sizeof(ids[0]));
+    return ids;
+}
+}
+
 CubismIdManager::CubismIdManager()
-{ }
+    : _blockUsed(IdBlockSize)
+    , _slotCount(InitialSlotCount)
+{
+    _slots = static_cast<Slot*>(CSM_MALLOC(sizeof(Slot) * _slotCount));
+    memset(_slots, 0, sizeof(Slot) * _slotCount);
+
+    csmInt32 count = 0;
+    const csmChar** ids = GetDefaultIds(&count);
+    RegisterIds(ids, count);
+}
 
 CubismIdManager::~CubismIdManager()
 {
     for (csmUint32 i = 0; i < _ids.GetSize(); ++i)
     {
-        CSM_DELETE_SELF(CubismId, _ids[i]);
+        _ids[i]->~CubismId();
+    }
+    for (csmUint32 i = 0; i < _blocks.GetSize(); ++i)
+    {
+        CSM_FREE(_blocks[i]);
     }
+    CSM_FREE(_slots);
 }
 
 void CubismIdManager::RegisterIds(const csmChar** ids, csmInt32 count)
@@ -39,7 +85,7 @@ void CubismIdManager::RegisterIds(const csmVector<csmString>& ids)
 
 const CubismId* CubismIdManager::GetId(const csmString& id)
 {
-    return RegisterId(id.GetRawString());
+    return RegisterId(id);
 }
 
 const CubismId* CubismIdManager::GetId(const csmChar* id)
@@ -49,44 +95,163 @@ const CubismId* CubismIdManager::GetId(const csmChar* id)
 
 csmBool CubismIdManager::IsExist(const csmString& id) const
 {
-    return IsExist(id.GetRawString());
+    csmInt32 length = 0;
+    const csmUint32 hash = Hash(id.GetRawString(), id.GetLength(), &length);
+
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return (FindId(id.GetRawString(), length, hash) != NULL);
 }
+
 csmBool CubismIdManager::IsExist(const csmChar* id) const
 {
-    return (FindId(id) != NULL);
+    csmInt32 length = 0;
+    const csmUint32 hash = Hash(id, -1, &length);
+
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return (FindId(id, length, hash) != NULL);
 }
 
 const CubismId* CubismIdManager::RegisterId(const csmChar* id)
 {
-    CubismId* result = NULL;
+    csmInt32 length = 0;
+    const csmUint32 hash = Hash(id, -1, &length);
+    return RegisterId(id, length, hash);
+}
 
-    if ((result = FindId(id)) != NULL)
+const CubismId* CubismIdManager::RegisterId(const csmString& id)
+{
+    csmInt32 length = 0;
+    const csmUint32 hash = Hash(id.GetRawString(), id.GetLength(), &length);
+    return RegisterId(id.GetRawString(), length, hash);
+}
+
+const CubismId* CubismIdManager::RegisterId(const csmChar* id, csmInt32 length, csmUint32 hash)
+{
+    // IDs are registered while loading and looked up afterwards: most calls find the ID.
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        CubismId* result = FindId(id, length, hash);
+        if (result != NULL)
+        {
+            return result;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+
+    // Another thread may have registered it in the meantime.
+    CubismId* result = FindId(id, length, hash);
+    if (result != NULL)
     {
         return result;
     }
 
-    result = CSM_NEW CubismId(id);
+    if ((_ids.GetSize() + 1) * 2 > _slotCount)
+    {
+        GrowIndex();
+    }
+
+    result = CreateId(id);
     _ids.PushBack(result);
 
+    const csmUint32 mask = _slotCount - 1;
+    csmUint32 index = hash & mask;
+    while (_slots[index].Id != NULL)
+    {
+        index = (index + 1) & mask;
+    }
+    _slots[index].Hash = hash;
+    _slots[index].Id = result;
+
     return result;
 }
 
-const CubismId* CubismIdManager::RegisterId(const csmString& id)
+csmUint32 CubismIdManager::Hash(const csmChar* id, csmInt32 length, csmInt32* outLength)
 {
-    return RegisterId(id.GetRawString());
+    csmUint32 hash = 2166136261u;
+    csmInt32 i = 0;
+
+    if (length < 0)
+    {
+        for (; id[i] != '\0'; ++i)
+        {
+            hash = (hash ^ static_cast<csmUint8>(id[i])) * 16777619u;
+        }
+    }
+    else
+    {
+        for (; i < length; ++i)
+        {
+            hash = (hash ^ static_cast<csmUint8>(id[i])) * 16777619u;
+        }
+    }
+
+    *outLength = i;
+    // Mix the high bits in: the index is taken from the low bits.
+    return hash ^ (hash >> 16);
 }
 
-CubismId* CubismIdManager::FindId(const csmChar* id) const
+CubismId* CubismIdManager::FindId(const csmChar* id, csmInt32 length, csmUint32 hash) const
 {
-    for (csmUint32 i = 0; i < _ids.GetSize(); ++i)
+    const csmUint32 mask = _slotCount - 1;
+
+    for (csmUint32 index = hash & mask; _slots[index].Id != NULL; index = (index + 1) & mask)
     {
-        if (_ids[i]->GetString() == id)
+        const Slot& slot = _slots[index];
+        if (slot.Hash != hash)
+        {
+            continue;
+        }
+
+        const csmString& name = slot.Id->GetString();
+        if (name.GetLength() == length && memcmp(name.GetRawString(), id, length) == 0)
         {
-            return _ids[i];
+            return slot.Id;
         }
     }
 
     return NULL;
 }
 
+CubismId* CubismIdManager::CreateId(const csmChar* id)
+{
+    if (_blockUsed == IdBlockSize)
+    {
+        _blocks.PushBack(CSM_MALLOC(sizeof(CubismId) * IdBlockSize));
+        _blockUsed = 0;
+    }
+
+    void* memory = static_cast<CubismId*>(_blocks[_blocks.GetSize() - 1]) + _blockUsed;
+    ++_blockUsed;
+
+    return CSM_PLACEMENT_NEW(memory) CubismId(id);
+}
+
+void CubismIdManager::GrowIndex()
+{
+    const csmUint32 slotCount = _slotCount * 2;
+    const csmUint32 mask = slotCount - 1;
+    Slot* slots = static_cast<Slot*>(CSM_MALLOC(sizeof(Slot) * slotCount));
+    memset(slots, 0, sizeof(Slot) * slotCount);
+
+    for (csmUint32 i = 0; i < _slotCount; ++i)
+    {
+        if (_slots[i].Id == NULL)
+        {
+            continue;
+        }
+
+        csmUint32 index = _slots[i].Hash & mask;
+        while (slots[index].Id != NULL)
+        {
+            index = (index + 1) & mask;
+        }
+        slots[index] = _slots[i];
+    }
+
+    CSM_FREE(_slots);
+    _slots = slots;
+    _slotCount = slotCount;
+}
+
 }}}
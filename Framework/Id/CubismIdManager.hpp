@@ -10,6 +10,8 @@
 #include "Type/CubismBasicType.hpp"
 #include "Type/csmString.hpp"
 #include "Type/csmVector.hpp"
+#include <mutex>
+#include <shared_mutex>
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
@@ -17,6 +19,11 @@ struct CubismId;
 
 /**
  * Handles ID names.
+ *
+ * IDs are interned: each name is registered once and its handle stays valid
+ * until the manager is destroyed, so handles can be compared by address.
+ * Lookups go through an open addressing hash index (constant time), and the
+ * default parameter & part IDs (`DefaultParameterId`) are registered up front.
  */
 class CubismIdManager
 {
@@ -109,9 +116,50 @@ private:
     CubismIdManager(const CubismIdManager&);
     CubismIdManager& operator=(const CubismIdManager&);
 
-    CubismId* FindId(const csmChar* id) const;
+    /**
+     * Slot of the hash index; empty if Id is NULL.
+     */
+    struct Slot
+    {
+        csmUint32 Hash;
+        CubismId* Id;
+    };
+
+    /**
+     * Hashes an ID string (FNV-1a).
+     *
+     * @param id ID string
+     * @param length Length of the string, or -1 to compute it
+     * @param outLength Length of the string
+     */
+    static csmUint32 Hash(const csmChar* id, csmInt32 length, csmInt32* outLength);
 
-    csmVector<CubismId*> _ids;
+    /**
+     * Registers an ID of known length and hash.
+     */
+    const CubismId* RegisterId(const csmChar* id, csmInt32 length, csmUint32 hash);
+
+    /**
+     * Looks an ID up in the hash index. The caller holds the lock.
+     */
+    CubismId* FindId(const csmChar* id, csmInt32 length, csmUint32 hash) const;
+
+    /**
+     * Constructs an ID in the current block, allocating a new block when full.
+     */
+    CubismId* CreateId(const csmChar* id);
+
+    /**
+     * Doubles the hash index.
+     */
+    void GrowIndex();
+
+    csmVector<CubismId*> _ids;      ///< Registered IDs, in registration order
+    csmVector<void*> _blocks;       ///< Storage of the IDs; never moved, so handles stay valid
+    csmUint32 _blockUsed;           ///< IDs constructed in the last block
+    Slot* _slots;                   ///< Hash index (linear probing, at most half full)
+    csmUint32 _slotCount;           ///< Number of slots, a power of two
+    mutable std::shared_mutex _mutex;   ///< Lookups are shared, registrations exclusive, so that assets can be parsed on worker threads
 };
 
 }}}
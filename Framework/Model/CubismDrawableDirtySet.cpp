@@ -0,0 +1,247 @@
+﻿/**
+ * Copyright(c) Live2D Inc. All rights reserved.
+ *
+ * Use of this source code is governed by the Live2D Open Software license
+ * that can be found at https://www.live2d.com/eula/live2d-open-software-license-agreement_en.html.
+ */
+
+#include "CubismDrawableDirtySet.hpp"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CSM_DIRTY_SET_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CSM_DIRTY_SET_NEON
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//--------- LIVE2D NAMESPACE ------------
+namespace Live2D { namespace Cubism { namespace Framework {
+
+namespace {
+
+const csmInt32 WordBits = 32;
+
+// 種類ごとのダイナミックフラグ（頂点位置はフラグを使わない）
+const Core::csmFlags KindFlags[CubismDrawableDirtySet::Kind_Count] =
+{
+    0,
+    Core::csmOpacityDidChange,
+    Core::csmRenderOrderDidChange,
+    Core::csmBlendColorDidChange,
+    Core::csmVisibilityDidChange,
+};
+
+csmInt32 CountTrailingZeros(csmUint32 word)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, word);
+    return static_cast<csmInt32>(index);
+#else
+    return __builtin_ctz(word);
+#endif
+}
+
+#if defined(CSM_DIRTY_SET_NEON)
+// 各バイトの最上位ビットではなく、0xFFのバイトを16ビットのマスクにする
+csmUint32 MoveMask(uint8x16_t bytes)
+{
+    static const csmUint8 Weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vandq_u8(bytes, vld1q_u8(Weights)))));
+    return static_cast<csmUint32>(vgetq_lane_u64(sums, 0) | (vgetq_lane_u64(sums, 1) << 8));
+}
+#endif
+
+}
+
+CubismDrawableDirtySet::CubismDrawableDirtySet()
+    : _drawableCount(0)
+    , _wordCount(0)
+    , _updateSerial(0)
+{ }
+
+void CubismDrawableDirtySet::Resize(csmInt32 drawableCount)
+{
+    _drawableCount = drawableCount;
+    _wordCount = (drawableCount + WordBits - 1) / WordBits;
+    _bits.UpdateSize(Kind_Count * _wordCount, 0, false);
+}
+
+void CubismDrawableDirtySet::Update(const Core::csmModel* model)
+{
+    const csmInt32 drawableCount = Core::csmGetDrawableCount(model);
+    const csmInt32* vertexCounts = Core::csmGetDrawableVertexCounts(model);
+    const Core::csmVector2** positions = Core::csmGetDrawableVertexPositions(model);
+
+    // 最初の更新：比較する位置が無いので全て変化ありにする
+    const csmBool first = (_drawableCount != drawableCount || _vertexSerials.GetSize() != static_cast<csmUint32>(drawableCount));
+    if (first)
+    {
+        Resize(drawableCount);
+        _vertexOffsets.UpdateSize(drawableCount, 0, false);
+        csmInt32 vertexCount = 0;
+        for (csmInt32 i = 0; i < drawableCount; ++i)
+        {
+            _vertexOffsets[i] = vertexCount;
+            vertexCount += vertexCounts[i];
+        }
+        _previousPositions.UpdateSize(vertexCount, Core::csmVector2(), false);
+        _vertexSerials.UpdateSize(drawableCount, 0, false);
+    }
+    ++_updateSerial;
+
+    BuildFromFlags(Core::csmGetDrawableDynamicFlags(model));
+
+    // 頂点位置：前回の更新と比較する（変化したものだけコピー）
+    csmUint32* vertexWords = GetWords(Kind_VertexPositions);
+    memset(vertexWords, 0, sizeof(csmUint32) * _wordCount);
+    for (csmInt32 i = 0; i < drawableCount; ++i)
+    {
+        Core::csmVector2* previous = _previousPositions.GetPtr() + _vertexOffsets[i];
+        const csmSizeType bytes = sizeof(Core::csmVector2) * vertexCounts[i];
+        if (!first && memcmp(previous, positions[i], bytes) == 0)
+        {
+            continue;
+        }
+        memcpy(previous, positions[i], bytes);
+        vertexWords[i / WordBits] |= 1u << (i % WordBits);
+        _vertexSerials[i] = _updateSerial;
+    }
+}
+
+void CubismDrawableDirtySet::BuildFromFlags(const Core::csmFlags* flags)
+{
+    for (csmInt32 kind = Kind_VertexPositions + 1; kind < Kind_Count; ++kind)
+    {
+        memset(GetWords(static_cast<Kind>(kind)), 0, sizeof(csmUint32) * _wordCount);
+    }
+
+    // 16 Drawableずつ、種類ごとのビットをまとめて作る（16は32の約数なのでワードをまたがない）
+    csmInt32 i = 0;
+#if defined(CSM_DIRTY_SET_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= _drawableCount; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(flags + i));
+        for (csmInt32 kind = Kind_VertexPositions + 1; kind < Kind_Count; ++kind)
+        {
+            const __m128i masked = _mm_and_si128(bytes, _mm_set1_epi8(static_cast<char>(KindFlags[kind])));
+            const csmUint32 mask = ~static_cast<csmUint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(masked, zero))) & 0xFFFFu;
+            GetWords(static_cast<Kind>(kind))[i / WordBits] |= mask << (i % WordBits);
+        }
+    }
+#elif defined(CSM_DIRTY_SET_NEON)
+    for (; i + 16 <= _drawableCount; i += 16)
+    {
+        const uint8x16_t bytes = vld1q_u8(flags + i);
+        for (csmInt32 kind = Kind_VertexPositions + 1; kind < Kind_Count; ++kind)
+        {
+            const csmUint32 mask = MoveMask(vtstq_u8(bytes, vdupq_n_u8(KindFlags[kind])));
+            GetWords(static_cast<Kind>(kind))[i / WordBits] |= mask << (i % WordBits);
+        }
+    }
+#endif
+    for (; i < _drawableCount; ++i)
+    {
+        for (csmInt32 kind = Kind_VertexPositions + 1; kind < Kind_Count; ++kind)
+        {
+            if (flags[i] & KindFlags[kind])
+            {
+                GetWords(static_cast<Kind>(kind))[i / WordBits] |= 1u << (i % WordBits);
+            }
+        }
+    }
+}
+
+void CubismDrawableDirtySet::CopyBits(const CubismDrawableDirtySet& source)
+{
+    if (_drawableCount != source._drawableCount)
+    {
+        Resize(source._drawableCount);
+    }
+    if (_bits.GetSize() > 0)
+    {
+        memcpy(_bits.GetPtr(), source._bits.GetPtr(), sizeof(csmUint32) * _bits.GetSize());
+    }
+    ++_updateSerial;
+}
+
+void CubismDrawableDirtySet::Merge(const CubismDrawableDirtySet& source)
+{
+    // 作る前の集合は全て変化ありなので、和も全て変化ありになる
+    if (source._drawableCount != _drawableCount)
+    {
+        Resize(0);
+        return;
+    }
+
+    const csmUint32* sourceBits = source._bits.GetPtr();
+    csmUint32* bits = _bits.GetPtr();
+    const csmInt32 count = static_cast<csmInt32>(_bits.GetSize());
+    for (csmInt32 i = 0; i < count; ++i)
+    {
+        bits[i] |= sourceBits[i];
+    }
+}
+
+csmBool CubismDrawableDirtySet::IsDirty(Kind kind, csmInt32 drawableIndex) const
+{
+    if (drawableIndex < 0 || drawableIndex >= _drawableCount)
+    {
+        return true;
+    }
+
+    return (GetWords(kind)[drawableIndex / WordBits] >> (drawableIndex % WordBits)) & 1u;
+}
+
+csmBool CubismDrawableDirtySet::IsAnyDirty(Kind kind) const
+{
+    if (_drawableCount == 0)
+    {
+        return true;
+    }
+
+    const csmUint32* words = GetWords(kind);
+    csmUint32 any = 0;
+    for (csmInt32 i = 0; i < _wordCount; ++i)
+    {
+        any |= words[i];
+    }
+    return any != 0;
+}
+
+csmInt32 CubismDrawableDirtySet::CollectDirty(Kind kind, csmVector<csmInt32>& outIndices) const
+{
+    outIndices.ClearElements();
+
+    const csmUint32* words = GetWords(kind);
+    for (csmInt32 i = 0; i < _wordCount; ++i)
+    {
+        // 立っているビットだけを下位から取り出す
+        for (csmUint32 word = words[i]; word != 0; word &= word - 1)
+        {
+            outIndices.PushBack(i * WordBits + CountTrailingZeros(word));
+        }
+    }
+    return static_cast<csmInt32>(outIndices.GetSize());
+}
+
+csmUint32 CubismDrawableDirtySet::GetVertexPositionsSerial(csmInt32 drawableIndex) const
+{
+    if (drawableIndex < 0 || drawableIndex >= static_cast<csmInt32>(_vertexSerials.GetSize()))
+    {
+        return 0;
+    }
+
+    return _vertexSerials[drawableIndex];
+}
+
+}}}
+//--------- LIVE2D NAMESPACE ------------
@@ -0,0 +1,139 @@
+﻿/**
+ * Copyright(c) Live2D Inc. All rights reserved.
+ *
+ * Use of this source code is governed by the Live2D Open Software license
+ * that can be found at https://www.live2d.com/eula/live2d-open-software-license-agreement_en.html.
+ */
+
+#pragma once
+
+#include "CubismFramework.hpp"
+#include "Type/csmVector.hpp"
+
+//--------- LIVE2D NAMESPACE ------------
+namespace Live2D { namespace Cubism { namespace Framework {
+
+/**
+ * @brief   モデルの更新で変化したDrawableの集合。<br>
+ *          変化の種類ごとに1 Drawable 1ビットで、更新ごとに一度だけ作る。
+ *          レンダラ・クリッピングマスク・当たり判定は変化したDrawableだけを処理できる。<br>
+ *          集合を作る前（サイズ0）は全てのDrawableを変化ありとみなす。<br>
+ *          ビットは直前の更新での変化なので、処理した更新番号を覚えておき、
+ *          間の更新を処理していない場合（IsConsecutive()がfalse）は全て変化ありとして扱う。
+ */
+class CubismDrawableDirtySet
+{
+public:
+    /**
+     * @brief   変化の種類
+     */
+    enum Kind
+    {
+        Kind_VertexPositions = 0,   ///< 頂点位置（コアのフラグは常に立つため、前回の更新の位置と比較する）
+        Kind_Opacity,               ///< 不透明度
+        Kind_RenderOrder,           ///< 描画順
+        Kind_Color,                 ///< 乗算色・スクリーン色
+        Kind_Visibility,            ///< 表示状態
+        Kind_Count
+    };
+
+    /**
+     * @brief   コンストラクタ
+     */
+    CubismDrawableDirtySet();
+
+    /**
+     * @brief   更新したモデルから集合を作る。最初の更新では全てのDrawableが変化ありになる。
+     *
+     * @param[in]   model   ->  csmUpdateModel済みのモデル
+     */
+    void Update(const Core::csmModel* model);
+
+    /**
+     * @brief   ビットをコピーし、この集合の更新番号を1つ進める。頂点位置の比較用データと更新番号はコピーしない。
+     *
+     * @param[in]   source  ->  コピー元
+     */
+    void CopyBits(const CubismDrawableDirtySet& source);
+
+    /**
+     * @brief   ビットの和を取る（間の更新が描画されなかった時など）。
+     *
+     * @param[in]   source  ->  加える集合（同じモデルのもの）
+     */
+    void Merge(const CubismDrawableDirtySet& source);
+
+    /**
+     * @brief   Drawableが変化したか
+     *
+     * @param[in]   kind            ->  変化の種類
+     * @param[in]   drawableIndex   ->  Drawableのインデックス
+     * @return  変化していればtrue（集合を作る前は常にtrue）
+     */
+    csmBool IsDirty(Kind kind, csmInt32 drawableIndex) const;
+
+    /**
+     * @brief   いずれかのDrawableが変化したか
+     *
+     * @param[in]   kind    ->  変化の種類
+     */
+    csmBool IsAnyDirty(Kind kind) const;
+
+    /**
+     * @brief   変化したDrawableのインデックスを昇順に列挙する。
+     *
+     * @param[in]   kind        ->  変化の種類
+     * @param[out]  outIndices  ->  インデックスのリスト（容量は再利用される）
+     * @return  変化したDrawableの数
+     */
+    csmInt32 CollectDirty(Kind kind, csmVector<csmInt32>& outIndices) const;
+
+    /**
+     * @brief   Drawableの頂点位置が最後に変化した更新の番号。<br>
+     *          番号が変わらない間は頂点位置から計算した値（矩形など）をキャッシュできる。
+     *
+     * @param[in]   drawableIndex   ->  Drawableのインデックス
+     * @return  更新の番号（1から）。コピーした集合など、番号が無い場合は0
+     */
+    csmUint32 GetVertexPositionsSerial(csmInt32 drawableIndex) const;
+
+    /**
+     * @brief   更新番号。Update()・CopyBits()のたびに1つ進む（集合を作る前は0）。
+     */
+    csmUint32 GetUpdateSerial() const { return _updateSerial; }
+
+    /**
+     * @brief   ビットが前回処理した更新からの変化を表すか
+     *
+     * @param[in]   processedSerial ->  前回処理した時のGetUpdateSerial()の値（未処理は0）
+     * @return  直後の更新であればtrue。間の更新を処理していない場合や集合を作る前はfalse
+     */
+    csmBool IsConsecutive(csmUint32 processedSerial) const
+    {
+        return _drawableCount > 0 && processedSerial != 0 && processedSerial + 1 == _updateSerial;
+    }
+
+    /**
+     * @brief   Drawableの数（集合を作る前は0）
+     */
+    csmInt32 GetDrawableCount() const { return _drawableCount; }
+
+private:
+    void Resize(csmInt32 drawableCount);
+
+    void BuildFromFlags(const Core::csmFlags* flags);
+
+    const csmUint32* GetWords(Kind kind) const { return _bits.GetPtr() + kind * _wordCount; }
+    csmUint32* GetWords(Kind kind) { return _bits.GetPtr() + kind * _wordCount; }
+
+    csmInt32 _drawableCount;                        ///< Drawableの数
+    csmInt32 _wordCount;                            ///< 種類ごとのワード数
+    csmVector<csmUint32> _bits;                     ///< Kind_Count × _wordCount のビット列
+    csmVector<Core::csmVector2> _previousPositions; ///< 前回の更新の頂点位置（全Drawableを連結）
+    csmVector<csmInt32> _vertexOffsets;             ///< _previousPositions内の各Drawableの位置
+    csmVector<csmUint32> _vertexSerials;            ///< 各Drawableの頂点位置が最後に変化した更新の番号
+    csmUint32 _updateSerial;                        ///< 更新の番号
+};
+
+}}}
+//--------- LIVE2D NAMESPACE ------------
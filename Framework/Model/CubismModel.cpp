@@ -9,6 +9,7 @@
 #include "Rendering/CubismRenderer.hpp"
 #include "Id/CubismId.hpp"
 #include "Id/CubismIdManager.hpp"
+#include <string.h>
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
@@ -27,6 +28,7 @@ CubismModel::CubismModel(Core::csmModel* model)
     , _isOverwrittenModelScreenColors(false)
     , _isOverwrittenCullings(false)
     , _modelOpacity(1.0f)
+    , _drawableSnapshot(NULL)
 { }
 
 CubismModel::~CubismModel()
@@ -69,11 +71,122 @@ void CubismModel::MultiplyParameterValue(csmInt32 parameterIndex, csmFloat32 val
     SetParameterValue(parameterIndex, (GetParameterValue(parameterIndex) * (1.0f + (value - 1.0f) * weight)));
 }
 
+void CubismModel::SetParameterValues(const csmInt32* parameterIndices, const csmFloat32* values, csmInt32 count, csmFloat32 weight)
+{
+    const csmInt32 parameterCount = Core::csmGetParameterCount(_model);
+
+    for (csmInt32 i = 0; i < count; ++i)
+    {
+        const csmInt32 parameterIndex = parameterIndices[i];
+
+        // モデルに存在しないパラメータ
+        if (parameterIndex < 0 || parameterIndex >= parameterCount)
+        {
+            SetParameterValue(parameterIndex, values[i], weight);
+            continue;
+        }
+
+        csmFloat32 value = values[i];
+        if (_parameterMaximumValues[parameterIndex] < value)
+        {
+            value = _parameterMaximumValues[parameterIndex];
+        }
+        if (_parameterMinimumValues[parameterIndex] > value)
+        {
+            value = _parameterMinimumValues[parameterIndex];
+        }
+
+        _parameterValues[parameterIndex] = (weight == 1)
+                                          ? value
+                                          : (_parameterValues[parameterIndex] * (1 - weight)) + (value * weight);
+    }
+}
+
+void CubismModel::AddParameterValues(const csmInt32* parameterIndices, const csmFloat32* values, csmInt32 count, csmFloat32 weight)
+{
+    const csmInt32 parameterCount = Core::csmGetParameterCount(_model);
+
+    for (csmInt32 i = 0; i < count; ++i)
+    {
+        const csmInt32 parameterIndex = parameterIndices[i];
+
+        // モデルに存在しないパラメータ
+        if (parameterIndex < 0 || parameterIndex >= parameterCount)
+        {
+            AddParameterValue(parameterIndex, values[i], weight);
+            continue;
+        }
+
+        csmFloat32 value = _parameterValues[parameterIndex] + (values[i] * weight);
+        if (_parameterMaximumValues[parameterIndex] < value)
+        {
+            value = _parameterMaximumValues[parameterIndex];
+        }
+        if (_parameterMinimumValues[parameterIndex] > value)
+        {
+            value = _parameterMinimumValues[parameterIndex];
+        }
+
+        _parameterValues[parameterIndex] = value;
+    }
+}
+
+void CubismModel::AccumulateParameterValue(csmInt32 parameterIndex, csmFloat32 value, csmFloat32 weight)
+{
+    // モデルに存在しないパラメータは直ちに加算する
+    if (parameterIndex < 0 || parameterIndex >= Core::csmGetParameterCount(_model))
+    {
+        AddParameterValue(parameterIndex, value, weight);
+        return;
+    }
+
+    if (!_isAccumulatedParameter[parameterIndex])
+    {
+        _isAccumulatedParameter[parameterIndex] = true;
+        _accumulatedParameterIndices.PushBack(parameterIndex, false);
+    }
+    _accumulatedParameterValues[parameterIndex] += value * weight;
+}
+
+void CubismModel::ApplyAccumulatedParameterValues()
+{
+    const csmInt32 count = static_cast<csmInt32>(_accumulatedParameterIndices.GetSize());
+    if (count == 0)
+    {
+        return;
+    }
+
+    // パラメータごとの合計を一度だけクランプする
+    csmFloat32* accumulatedValues = _accumulatedParameterValues.GetPtr();
+    for (csmInt32 i = 0; i < count; ++i)
+    {
+        const csmInt32 parameterIndex = _accumulatedParameterIndices[i];
+
+        csmFloat32 value = _parameterValues[parameterIndex] + accumulatedValues[parameterIndex];
+        if (_parameterMaximumValues[parameterIndex] < value)
+        {
+            value = _parameterMaximumValues[parameterIndex];
+        }
+        if (_parameterMinimumValues[parameterIndex] > value)
+        {
+            value = _parameterMinimumValues[parameterIndex];
+        }
+
+        _parameterValues[parameterIndex] = value;
+        accumulatedValues[parameterIndex] = 0.0f;
+        _isAccumulatedParameter[parameterIndex] = false;
+    }
+    _accumulatedParameterIndices.ClearElements();
+}
+
 void CubismModel::Update() const
 {
     // Update model.
     Core::csmUpdateModel(_model);
 
+    // Collect changed drawables.
+    _drawableDirtySet.Update(_model);
+
     // Reset dynamic drawable flags.
     Core::csmResetDrawableDynamicFlags(_model);
 }
@@ -93,9 +206,10 @@ void CubismModel::SetPartOpacity(CubismIdHandle partId, csmFloat32 opacity)
 
 void CubismModel::SetPartOpacity(csmInt32 partIndex, csmFloat32 opacity)
 {
-    if (_notExistPartOpacities.IsExist(partIndex))
+    csmFloat32* notExistOpacity = _notExistPartOpacities.Find(partIndex);
+    if (notExistOpacity != NULL)
     {
-        _notExistPartOpacities[partIndex] = opacity;
+        *notExistOpacity = opacity;
         return;
     }
 
@@ -120,10 +234,11 @@ csmFloat32 CubismModel::GetPartOpacity(CubismIdHandle partId)
 
 csmFloat32 CubismModel::GetPartOpacity(csmInt32 partIndex)
 {
-    if (_notExistPartOpacities.IsExist(partIndex))
+    const csmFloat32* notExistOpacity = _notExistPartOpacities.Find(partIndex);
+    if (notExistOpacity != NULL)
     {
         // モデルに存在しないパーツIDの場合、非存在パーツリストから不透明度を返す
-        return _notExistPartOpacities[partIndex];
+        return *notExistOpacity;
     }
 
     //インデックスの範囲内検知
@@ -174,9 +289,10 @@ csmInt32 CubismModel::GetParameterIndex(CubismIdHandle parameterId)
     }
 
     // モデルに存在していない場合、非存在パラメータIDリスト内を検索し、そのインデックスを返す
-    if (_notExistParameterId.IsExist(parameterId))
+    const csmInt32* notExistIndex = _notExistParameterId.Find(parameterId);
+    if (notExistIndex != NULL)
     {
-        return _notExistParameterId[parameterId];
+        return *notExistIndex;
     }
 
     // 非存在パラメータIDリストにない場合、新しく要素を追加する
@@ -196,9 +312,10 @@ CubismIdHandle CubismModel::GetParameterId(csmUint32 parameterIndex)
 
 csmFloat32 CubismModel::GetParameterValue(csmInt32 parameterIndex)
 {
-    if (_notExistParameterValues.IsExist(parameterIndex))
+    const csmFloat32* notExistValue = _notExistParameterValues.Find(parameterIndex);
+    if (notExistValue != NULL)
     {
-        return _notExistParameterValues[parameterIndex];
+        return *notExistValue;
     }
 
     //インデックスの範囲内検知
@@ -209,12 +326,12 @@ csmFloat32 CubismModel::GetParameterValue(csmInt32 parameterIndex)
 
 void CubismModel::SetParameterValue(csmInt32 parameterIndex, csmFloat32 value, csmFloat32 weight)
 {
-    if (_notExistParameterValues.IsExist(parameterIndex))
+    csmFloat32* notExistValue = _notExistParameterValues.Find(parameterIndex);
+    if (notExistValue != NULL)
     {
-        _notExistParameterValues[parameterIndex] = (weight == 1)
-                                                         ? value
-                                                         : (_notExistParameterValues[parameterIndex] * (1 - weight)) +
-                                                         (value * weight);
+        *notExistValue = (weight == 1)
+                             ? value
+                             : (*notExistValue * (1 - weight)) + (value * weight);
         return;
     }
 
@@ -351,9 +468,10 @@ csmInt32 CubismModel::GetPartIndex(CubismIdHandle partId)
     const csmInt32 partCount = Core::csmGetPartCount(_model);
 
     // モデルに存在していない場合、非存在パーツIDリスト内にあるかを検索し、そのインデックスを返す
-    if (_notExistPartId.IsExist(partId))
+    const csmInt32* notExistIndex = _notExistPartId.Find(partId);
+    if (notExistIndex != NULL)
     {
-        return _notExistPartId[partId];
+        return *notExistIndex;
     }
 
     // 非存在パーツIDリストにない場合、新しく要素を追加する
@@ -383,6 +501,10 @@ void CubismModel::Initialize()
         {
             _parameterIds.PushBack(CubismFramework::GetIdManager()->GetId(parameterIds[i]));
         }
+
+        _accumulatedParameterValues.UpdateSize(parameterCount, 0.0f, false);
+        _isAccumulatedParameter.UpdateSize(parameterCount, false, false);
+        _accumulatedParameterIndices.PrepareCapacity(parameterCount);
     }
 
     const csmInt32  partCount = Core::csmGetPartCount(_model);
@@ -496,6 +618,11 @@ csmInt32 CubismModel::GetPartCount() const
 
 const csmInt32* CubismModel::GetDrawableRenderOrders() const
 {
+    if (_drawableSnapshot != NULL)
+    {
+        return _drawableSnapshot->RenderOrders;
+    }
+
     const csmInt32* renderOrders = Core::csmGetDrawableRenderOrders(_model);
     return renderOrders;
 }
@@ -537,6 +664,11 @@ const csmUint16* CubismModel::GetDrawableVertexIndices(csmInt32 drawableIndex) c
 
 const Core::csmVector2* CubismModel::GetDrawableVertexPositions(csmInt32 drawableIndex) const
 {
+    if (_drawableSnapshot != NULL)
+    {
+        return _drawableSnapshot->VertexPositions[drawableIndex];
+    }
+
     const Core::csmVector2** verticesArray = Core::csmGetDrawableVertexPositions(_model);
     return verticesArray[drawableIndex];
 }
@@ -549,19 +681,19 @@ const Core::csmVector2* CubismModel::GetDrawableVertexUvs(csmInt32 drawableIndex
 
 csmFloat32 CubismModel::GetDrawableOpacity(csmInt32 drawableIndex) const
 {
-    const csmFloat32* opacities = Core::csmGetDrawableOpacities(_model);
+    const csmFloat32* opacities = (_drawableSnapshot != NULL) ? _drawableSnapshot->Opacities : Core::csmGetDrawableOpacities(_model);
     return opacities[drawableIndex];
 }
 
 Core::csmVector4 CubismModel::GetDrawableMultiplyColor(csmInt32 drawableIndex) const
 {
-    const Core::csmVector4* multiplyColors = Core::csmGetDrawableMultiplyColors(_model);
+    const Core::csmVector4* multiplyColors = (_drawableSnapshot != NULL) ? _drawableSnapshot->MultiplyColors : Core::csmGetDrawableMultiplyColors(_model);
     return multiplyColors[drawableIndex];
 }
 
 Core::csmVector4 CubismModel::GetDrawableScreenColor(csmInt32 drawableIndex) const
 {
-    const Core::csmVector4* screenColors = Core::csmGetDrawableScreenColors(_model);
+    const Core::csmVector4* screenColors = (_drawableSnapshot != NULL) ? _drawableSnapshot->ScreenColors : Core::csmGetDrawableScreenColors(_model);
     return screenColors[drawableIndex];
 }
 
@@ -570,45 +702,55 @@ csmInt32 CubismModel::GetDrawableParentPartIndex(csmUint32 drawableIndex) const
     return Core::csmGetDrawableParentPartIndices(_model)[drawableIndex];
 }
 
+const Core::csmFlags* CubismModel::GetDrawableDynamicFlags() const
+{
+    if (_drawableSnapshot != NULL)
+    {
+        return _drawableSnapshot->DynamicFlags;
+    }
+
+    return Core::csmGetDrawableDynamicFlags(_model);
+}
+
 csmBool CubismModel::GetDrawableDynamicFlagIsVisible(csmInt32 drawableIndex) const
 {
-    const Core::csmFlags* dynamicFlags = Core::csmGetDrawableDynamicFlags(_model);
+    const Core::csmFlags* dynamicFlags = GetDrawableDynamicFlags();
     return IsBitSet(dynamicFlags[drawableIndex], Core::csmIsVisible)!=0 ? true : false;
 }
 
 csmBool CubismModel::GetDrawableDynamicFlagVisibilityDidChange(csmInt32 drawableIndex) const
 {
-    const Core::csmFlags* dynamicFlags = Core::csmGetDrawableDynamicFlags(_model);
+    const Core::csmFlags* dynamicFlags = GetDrawableDynamicFlags();
     return IsBitSet(dynamicFlags[drawableIndex], Core::csmVisibilityDidChange)!=0 ? true : false;
 }
 
 csmBool CubismModel::GetDrawableDynamicFlagOpacityDidChange(csmInt32 drawableIndex) const
 {
-    const Core::csmFlags* dynamicFlags = Core::csmGetDrawableDynamicFlags(_model);
+    const Core::csmFlags* dynamicFlags = GetDrawableDynamicFlags();
     return IsBitSet(dynamicFlags[drawableIndex], Core::csmOpacityDidChange) != 0 ? true : false;
 }
 
 csmBool CubismModel::GetDrawableDynamicFlagDrawOrderDidChange(csmInt32 drawableIndex) const
 {
-    const Core::csmFlags* dynamicFlags = Core::csmGetDrawableDynamicFlags(_model);
+    const Core::csmFlags* dynamicFlags = GetDrawableDynamicFlags();
     return IsBitSet(dynamicFlags[drawableIndex], Core::csmDrawOrderDidChange) != 0 ? true : false;
 }
 
 csmBool CubismModel::GetDrawableDynamicFlagRenderOrderDidChange(csmInt32 drawableIndex) const
 {
-    const Core::csmFlags* dynamicFlags = Core::csmGetDrawableDynamicFlags(_model);
+    const Core::csmFlags* dynamicFlags = GetDrawableDynamicFlags();
     return IsBitSet(dynamicFlags[drawableIndex], Core::csmRenderOrderDidChange) != 0 ? true : false;
 }
 
 csmBool CubismModel::GetDrawableDynamicFlagVertexPositionsDidChange(csmInt32 drawableIndex) const
 {
-    const Core::csmFlags* dynamicFlags = Core::csmGetDrawableDynamicFlags(_model);
+    const Core::csmFlags* dynamicFlags = GetDrawableDynamicFlags();
     return IsBitSet(dynamicFlags[drawableIndex], Core::csmVertexPositionsDidChange) != 0 ? true : false;
 }
 
 csmBool CubismModel::GetDrawableDynamicFlagBlendColorDidChange(csmInt32 drawableIndex) const
 {
-    const Core::csmFlags* dynamicFlags = Core::csmGetDrawableDynamicFlags(_model);
+    const Core::csmFlags* dynamicFlags = GetDrawableDynamicFlags();
     return IsBitSet(dynamicFlags[drawableIndex], Core::csmBlendColorDidChange) != 0 ? true : false;
 }
 
@@ -650,27 +792,23 @@ void CubismModel::LoadParameters()
         parameterCount = savedParameterCount;
     }
 
-    for (csmInt32 i = 0; i < parameterCount; ++i)
+    if (parameterCount > 0)
     {
-        _parameterValues[i] = _savedParameters[i];
+        memcpy(_parameterValues, _savedParameters.GetPtr(), sizeof(csmFloat32) * parameterCount);
     }
 }
 
 void CubismModel::SaveParameters()
 {
     const csmInt32 parameterCount = Core::csmGetParameterCount(_model);
-    const csmInt32 savedParameterCount = static_cast<csmInt32>(_savedParameters.GetSize());
 
-    for (csmInt32 i = 0; i < parameterCount; ++i)
+    if (static_cast<csmInt32>(_savedParameters.GetSize()) < parameterCount)
     {
-        if (i < savedParameterCount)
-        {
-            _savedParameters[i] = _parameterValues[i];
-        }
-        else
-        {
-            _savedParameters.PushBack(_parameterValues[i], false);
-        }
+        _savedParameters.UpdateSize(parameterCount, 0.0f, false);
+    }
+    if (parameterCount > 0)
+    {
+        memcpy(_savedParameters.GetPtr(), _parameterValues, sizeof(csmFloat32) * parameterCount);
     }
 }
 
@@ -907,6 +1045,31 @@ void CubismModel::SetModelOpacity(csmFloat32 value)
     _modelOpacity = value;
 }
 
+void CubismModel::SetDrawableSnapshot(const DrawableSnapshot* snapshot)
+{
+    _drawableSnapshot = snapshot;
+}
+
+const CubismModel::DrawableSnapshot* CubismModel::GetDrawableSnapshot() const
+{
+    return _drawableSnapshot;
+}
+
+const CubismDrawableDirtySet& CubismModel::GetDrawableDirtySet() const
+{
+    if (_drawableSnapshot != NULL && _drawableSnapshot->DirtySet != NULL)
+    {
+        return *_drawableSnapshot->DirtySet;
+    }
+
+    return _drawableDirtySet;
+}
+
+const CubismDrawableDirtySet& CubismModel::GetUpdatedDrawableDirtySet() const
+{
+    return _drawableDirtySet;
+}
+
 Core::csmModel* CubismModel::GetModel() const
 {
     return _model;
@@ -8,10 +8,11 @@
 #pragma once
 
 #include "CubismFramework.hpp"
-#include "Type/csmMap.hpp"
+#include "Type/csmHashMap.hpp"
 #include "Type/csmVector.hpp"
 #include "Rendering/CubismRenderer.hpp"
 #include "Id/CubismId.hpp"
+#include "Model/CubismDrawableDirtySet.hpp"
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
@@ -119,6 +120,21 @@ public:
         Rendering::CubismRenderer::CubismTextureColor Color;        ///< Color
     };
 
+    /**
+     * Dynamic state of the drawables, captured after an update.
+     * Lets a model be updated on one thread while another thread draws the captured state.
+     */
+    struct DrawableSnapshot
+    {
+        const Core::csmVector2* const* VertexPositions;     ///< Vertex positions, per drawable
+        const csmFloat32* Opacities;                        ///< Opacities
+        const csmInt32* RenderOrders;                       ///< Render orders
+        const Core::csmFlags* DynamicFlags;                 ///< Dynamic flags
+        const Core::csmVector4* MultiplyColors;             ///< Multiply colors (from the model, before the SDK overrides)
+        const Core::csmVector4* ScreenColors;               ///< Screen colors (from the model, before the SDK overrides)
+        const CubismDrawableDirtySet* DirtySet;             ///< Drawables changed since the previously drawn snapshot
+    };
+
     /**
      * Calculates and updates the model state based on the set parameters.
      */
@@ -351,6 +367,45 @@ public:
      */
     void        MultiplyParameterValue(csmInt32 parameterIndex, csmFloat32 value, csmFloat32 weight = 1.0f);
 
+    /**
+     * Sets the values of several parameters.
+     * Same as SetParameterValue() for each index, without looking up indices of parameters not in the model.
+     *
+     * @param parameterIndices Parameter indices
+     * @param values Parameter values, one per index
+     * @param count Number of parameters
+     * @param weight Weight
+     */
+    void        SetParameterValues(const csmInt32* parameterIndices, const csmFloat32* values, csmInt32 count, csmFloat32 weight = 1.0f);
+
+    /**
+     * Adds to the values of several parameters.
+     * Same as AddParameterValue() for each index, without looking up indices of parameters not in the model.
+     *
+     * @param parameterIndices Parameter indices
+     * @param values Values to be added, one per index
+     * @param count Number of parameters
+     * @param weight Weight
+     */
+    void        AddParameterValues(const csmInt32* parameterIndices, const csmFloat32* values, csmInt32 count, csmFloat32 weight = 1.0f);
+
+    /**
+     * Accumulates a value to be added to the parameter by ApplyAccumulatedParameterValues().
+     * The values accumulated for a parameter are summed and clamped once.
+     *
+     * @param parameterIndex Parameter index
+     * @param value Value to be added
+     * @param weight Weight
+     */
+    void        AccumulateParameterValue(csmInt32 parameterIndex, csmFloat32 value, csmFloat32 weight = 1.0f);
+
+    /**
+     * Adds the accumulated values to the parameters and clears them.
+     *
+     * @note Call before Update(), or before anything reading the parameters (e.g. physics).
+     */
+    void        ApplyAccumulatedParameterValues();
+
     /**
      * Returns the index of the drawable.
      *
@@ -837,6 +892,38 @@ public:
      */
     void SetModelOpacity(csmFloat32 value);
 
+    /**
+     * Sets the snapshot read by the drawable getters (vertex positions, opacities,
+     * render orders, dynamic flags, multiply & screen colors) instead of the live model state.
+     * The snapshot is not copied and must outlive its use.
+     *
+     * @param snapshot Snapshot, NULL to read the live model state
+     */
+    void SetDrawableSnapshot(const DrawableSnapshot* snapshot);
+
+    /**
+     * Returns the snapshot read by the drawable getters.
+     *
+     * @return Snapshot, NULL when the live model state is read
+     */
+    const DrawableSnapshot* GetDrawableSnapshot() const;
+
+    /**
+     * Returns the drawables changed by the last update, or those of the snapshot when one is set.
+     * Lets the renderer, the clipping masks and the hit tests skip the unchanged drawables.
+     *
+     * @return Dirty set
+     */
+    const CubismDrawableDirtySet& GetDrawableDirtySet() const;
+
+    /**
+     * Returns the drawables changed by the last update, ignoring the snapshot.
+     * For capturing the update on the thread updating the model.
+     *
+     * @return Dirty set
+     */
+    const CubismDrawableDirtySet& GetUpdatedDrawableDirtySet() const;
+
     Core::csmModel*     GetModel() const;
 
 private:
@@ -849,6 +936,8 @@ private:
 
     void Initialize();
 
+    const Core::csmFlags* GetDrawableDynamicFlags() const;
+
     void SetPartColor(
         csmUint32 partIndex,
         csmFloat32 r, csmFloat32 g, csmFloat32 b, csmFloat32 a,
@@ -861,14 +950,18 @@ private:
         csmVector<CubismModel::PartColorData>& partColors,
         csmVector <CubismModel::DrawableColorData>& drawableColors);
 
-    csmMap<csmInt32, csmFloat32>        _notExistPartOpacities;
-    csmMap<CubismIdHandle, csmInt32>   _notExistPartId;
+    csmHashMap<csmInt32, csmFloat32>        _notExistPartOpacities;
+    csmHashMap<CubismIdHandle, csmInt32>    _notExistPartId;
 
-    csmMap<csmInt32, csmFloat32>        _notExistParameterValues;
-    csmMap<CubismIdHandle, csmInt32>   _notExistParameterId;
+    csmHashMap<csmInt32, csmFloat32>        _notExistParameterValues;
+    csmHashMap<CubismIdHandle, csmInt32>    _notExistParameterId;
 
     csmVector<csmFloat32>   _savedParameters;
 
+    csmVector<csmFloat32>   _accumulatedParameterValues;    ///< Values to be added, per parameter
+    csmVector<csmInt32>     _accumulatedParameterIndices;   ///< Parameters with an accumulated value
+    csmVector<csmBool>      _isAccumulatedParameter;
+
     Core::csmModel*     _model;
 
     csmFloat32*         _parameterValues;
@@ -879,6 +972,10 @@ private:
 
     csmFloat32 _modelOpacity;
 
+    const DrawableSnapshot* _drawableSnapshot;
+
+    mutable CubismDrawableDirtySet _drawableDirtySet;
+
     csmVector<CubismIdHandle> _parameterIds;
     csmVector<CubismIdHandle> _partIds;
     csmVector<CubismIdHandle> _drawableIds;
@@ -88,6 +88,7 @@ void CubismUserModel::LoadModel(const csmByte* buffer, csmSizeInt size, csmBool
     }
 
     _model = _moc->CreateModel();
+    _hitBounds.Clear();
 
     if (_model == NULL)
     {
@@ -148,44 +149,60 @@ csmBool CubismUserModel::IsHit(CubismIdHandle drawableId, csmFloat32 pointX, csm
         return false; // 存在しない場合はfalse
     }
 
-    const csmInt32    count = _model->GetDrawableVertexCount(drawIndex);
-    const csmFloat32* vertices = _model->GetDrawableVertices(drawIndex);
-
-    csmFloat32 left = vertices[0];
-    csmFloat32 right = vertices[0];
-    csmFloat32 top = vertices[1];
-    csmFloat32 bottom = vertices[1];
-
-    for (csmInt32 j = 1; j < count; ++j)
+    // 頂点位置が変化していなければ前回の矩形を使う
+    const csmUint32 serial = _model->GetDrawableDirtySet().GetVertexPositionsSerial(drawIndex);
+    HitBounds* bounds = _hitBounds.Find(drawIndex);
+    if (bounds == NULL || serial == 0 || bounds->Serial != serial)
     {
-        csmFloat32 x = vertices[Constant::VertexOffset + j * Constant::VertexStep];
-        csmFloat32 y = vertices[Constant::VertexOffset + j * Constant::VertexStep + 1];
+        const csmInt32    count = _model->GetDrawableVertexCount(drawIndex);
+        const csmFloat32* vertices = _model->GetDrawableVertices(drawIndex);
 
-        if (x < left)
-        {
-            left = x; // Min x
-        }
-
-        if (x > right)
-        {
-            right = x; // Max x
-        }
+        csmFloat32 left = vertices[0];
+        csmFloat32 right = vertices[0];
+        csmFloat32 top = vertices[1];
+        csmFloat32 bottom = vertices[1];
 
-        if (y < top)
+        for (csmInt32 j = 1; j < count; ++j)
         {
-            top = y; // Min y
+            csmFloat32 x = vertices[Constant::VertexOffset + j * Constant::VertexStep];
+            csmFloat32 y = vertices[Constant::VertexOffset + j * Constant::VertexStep + 1];
+
+            if (x < left)
+            {
+                left = x; // Min x
+            }
+
+            if (x > right)
+            {
+                right = x; // Max x
+            }
+
+            if (y < top)
+            {
+                top = y; // Min y
+            }
+
+            if (y > bottom)
+            {
+                bottom = y; // Max y
+            }
         }
 
-        if (y > bottom)
+        if (bounds == NULL)
         {
-            bottom = y; // Max y
+            bounds = &_hitBounds[drawIndex];
         }
+        bounds->Serial = serial;
+        bounds->Left = left;
+        bounds->Right = right;
+        bounds->Top = top;
+        bounds->Bottom = bottom;
     }
 
     const csmFloat32 tx = _modelMatrix->InvertTransformX(pointX);
     const csmFloat32 ty = _modelMatrix->InvertTransformY(pointY);
 
-    return ((left <= tx) && (tx <= right) && (top <= ty) && (ty <= bottom));
+    return ((bounds->Left <= tx) && (tx <= bounds->Right) && (bounds->Top <= ty) && (ty <= bounds->Bottom));
 }
 
 ACubismMotion* CubismUserModel::LoadMotion(const csmByte* buffer, csmSizeInt size, const csmChar* name,
@@ -249,7 +249,20 @@ protected:
     csmBool     _debugMode;
 
 private:
+    /**
+     * Bounding rectangle of a drawable, computed by a hit test.
+     */
+    struct HitBounds
+    {
+        csmUint32 Serial;       ///< Update serial of the vertex positions it was computed from
+        csmFloat32 Left;
+        csmFloat32 Right;
+        csmFloat32 Top;
+        csmFloat32 Bottom;
+    };
+
     Rendering::CubismRenderer* _renderer;
+    csmHashMap<csmInt32, HitBounds> _hitBounds;     ///< Bounds reused while the vertex positions of the drawable are unchanged
 };
 
 }}}
@@ -310,7 +310,7 @@ protected:
     csmBool       _isLoopFadeIn;
     csmBool       _previousLoopState;
 
-    csmVector<const csmString*>    _firedEventValues;
+    csmInlineVector<const csmString*, 4>    _firedEventValues;
 
     BeganMotionCallback _onBeganMotion;
     void* _onBeganMotionCustomData;
@@ -31,6 +31,8 @@ const csmFloat32 DefaultFadeTime = 1.0f;
 
 
 CubismExpressionMotion::CubismExpressionMotion()
+    : _fadeWeight(0.0f)
+    , _parameterIndicesModel(NULL)
 { }
 
 CubismExpressionMotion::~CubismExpressionMotion()
@@ -100,7 +102,7 @@ void CubismExpressionMotion::CalculateExpressionParameters(CubismModel* model, c
         const csmFloat32 currentParameterValue = expressionParameterValue.OverwriteValue =
             model->GetParameterValue(expressionParameterValue.ParameterId);
 
-        csmVector<ExpressionParameter> expressionParameters = GetExpressionParameters();
+        const csmVector<ExpressionParameter>& expressionParameters = GetExpressionParameters();
         csmInt32 parameterIndex = -1;
         for (csmInt32 j = 0; j < expressionParameters.GetSize(); ++j)
         {
@@ -175,11 +177,46 @@ void CubismExpressionMotion::CalculateExpressionParameters(CubismModel* model, c
     }
 }
 
-csmVector<CubismExpressionMotion::ExpressionParameter> CubismExpressionMotion::GetExpressionParameters()
+const csmVector<CubismExpressionMotion::ExpressionParameter>& CubismExpressionMotion::GetExpressionParameters() const
 {
     return _parameters;
 }
 
+const csmVector<csmInt32>& CubismExpressionMotion::GetParameterIndices(CubismModel* model)
+{
+    if (_parameterIndicesModel == model && _parameterIndices.GetSize() == _parameters.GetSize())
+    {
+        return _parameterIndices;
+    }
+
+    _parameterIndices.Clear();
+    _parameterIndices.PrepareCapacity(_parameters.GetSize());
+    for (csmUint32 i = 0; i < _parameters.GetSize(); ++i)
+    {
+        csmInt32 parameterIndex = -1;
+
+        if (_parameters[i].ParameterId != NULL)
+        {
+            parameterIndex = model->GetParameterIndex(_parameters[i].ParameterId);
+
+            // 同じパラメータが複数あれば最初のものだけ使う（CalculateExpressionParametersと同じ）
+            for (csmUint32 j = 0; j < i; ++j)
+            {
+                if (_parameterIndices[j] == parameterIndex)
+                {
+                    parameterIndex = -1;
+                    break;
+                }
+            }
+        }
+
+        _parameterIndices.PushBack(parameterIndex, false);
+    }
+    _parameterIndicesModel = model;
+
+    return _parameterIndices;
+}
+
 csmFloat32 CubismExpressionMotion::GetFadeWeight()
 {
 #if _DEBUG
@@ -75,7 +75,17 @@ public:
     /**
      * Returns the parameters referenced by the facial expression.
      */
-    csmVector<ExpressionParameter> GetExpressionParameters();
+    const csmVector<ExpressionParameter>& GetExpressionParameters() const;
+
+    /**
+     * Returns the indices of the parameters referenced by the facial expression in the model,
+     * in the order of GetExpressionParameters(). Resolved once per model (compiled form of the expression).
+     *
+     * @param model model the expression is applied to
+     *
+     * @return parameter indices; -1 for a parameter without ID or already listed before
+     */
+    const csmVector<csmInt32>& GetParameterIndices(CubismModel* model);
 
     /**
      * Returns the current fade weight value of the facial expression.
@@ -107,6 +117,9 @@ private:
 
 
     csmFloat32 _fadeWeight;
+
+    csmVector<csmInt32> _parameterIndices;      ///< Indices of _parameters in _parameterIndicesModel
+    const CubismModel* _parameterIndicesModel;  ///< Model _parameterIndices were resolved for
 };
 
 }}}
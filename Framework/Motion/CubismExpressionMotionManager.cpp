@@ -13,22 +13,25 @@
 
 namespace Live2D { namespace Cubism { namespace Framework {
 
+namespace {
+
+// 計算に使うExpression（再生できない場合はNULL）
+ACubismMotion* GetAvailableMotion(CubismMotionQueueEntry* motionQueueEntry)
+{
+    return motionQueueEntry->IsAvailable() ? motionQueueEntry->GetCubismMotion() : NULL;
+}
+
+}
+
 CubismExpressionMotionManager::CubismExpressionMotionManager()
     : _currentPriority(0)
     , _reservePriority(0)
-    , _expressionParameterValues(CSM_NEW csmVector<ExpressionParameterValue>())
+    , _hasBlend(false)
     , _fadeWeights(CSM_NEW csmVector<csmFloat32>())
 { }
 
 CubismExpressionMotionManager::~CubismExpressionMotionManager()
 {
-    if(_expressionParameterValues)
-    {
-        CSM_DELETE(_expressionParameterValues);
-
-        _expressionParameterValues = NULL;
-    }
-
     if (_fadeWeights)
     {
         CSM_DELETE(_fadeWeights);
@@ -104,58 +107,31 @@ csmBool CubismExpressionMotionManager::UpdateMotion(CubismModel* model, csmFloat
 
         CubismExpressionMotion* expressionMotion = (CubismExpressionMotion*)motionQueueEntry->GetCubismMotion();
 
-        if (expressionMotion == NULL)
+        // 開始前に終了したもの（同じフレームで次のExpressionが開始された）は計算しない
+        if (expressionMotion == NULL || (motionQueueEntry->IsFinished() && !motionQueueEntry->IsStarted()))
         {
-            CSM_DELETE(motionQueueEntry);
+            ReleaseEntry(motionQueueEntry);
             ite = motions->Erase(ite);          // 削除
             continue;
         }
 
-        csmVector<CubismExpressionMotion::ExpressionParameter> expressionParameters = expressionMotion->GetExpressionParameters();
         if (motionQueueEntry->IsAvailable())
         {
-            // 再生中のExpressionが参照しているパラメータをすべてリストアップ
-            for (csmInt32 i = 0; i < expressionParameters.GetSize(); ++i)
+            // 再生中のExpressionが参照しているパラメータをすべてリストアップ（インデックスはExpressionごとに一度だけ求める）
+            const csmVector<csmInt32>& parameterIndices = expressionMotion->GetParameterIndices(model);
+            for (csmUint32 i = 0; i < parameterIndices.GetSize(); ++i)
             {
-                if (expressionParameters[i].ParameterId == NULL)
+                if (parameterIndices[i] >= 0)
                 {
-                    continue;
+                    AddBlendedParameter(parameterIndices[i]);
                 }
-
-                csmInt32 index = -1;
-                // リストにパラメータIDが存在するか検索
-                for (csmInt32 j = 0; j < _expressionParameterValues->GetSize(); ++j)
-                {
-                    if (_expressionParameterValues->At(j).ParameterId != expressionParameters[i].ParameterId)
-                    {
-                        continue;
-                    }
-
-                    index = j;
-                    break;
-                }
-
-                if (index >= 0)
-                {
-                    continue;
-                }
-
-                // パラメータがリストに存在しないなら新規追加
-                ExpressionParameterValue item;
-                item.ParameterId = expressionParameters[i].ParameterId;
-                item.AdditiveValue = CubismExpressionMotion::DefaultAdditiveValue;
-                item.MultiplyValue = CubismExpressionMotion::DefaultMultiplyValue;
-                item.OverwriteValue = model->GetParameterValue(item.ParameterId);
-                _expressionParameterValues->PushBack(item);
             }
         }
 
-        // ------ 値を計算する ------
+        // ------ フェードの重みを計算する ------
         expressionMotion->SetupMotionQueueEntry(motionQueueEntry, _userTimeSeconds);
 
         SetFadeWeight(expressionIndex, expressionMotion->UpdateFadeWeight(motionQueueEntry, _userTimeSeconds));
-        expressionMotion->CalculateExpressionParameters(model, _userTimeSeconds, motionQueueEntry,
-            _expressionParameterValues, expressionIndex, GetFadeWeight(expressionIndex));
 
         expressionWeight += expressionMotion->GetFadeInTime() == 0.0f
             ? 1.0f
@@ -173,6 +149,15 @@ csmBool CubismExpressionMotionManager::UpdateMotion(CubismModel* model, csmFloat
         ++expressionIndex;
     }
 
+    // 削除したExpressionの分を詰める
+    if (_fadeWeights->GetSize() > motions->GetSize())
+    {
+        _fadeWeights->UpdateSize(motions->GetSize(), 0.0f, false);
+    }
+
+    // ------ 値を計算する（Expressionとフェードの重みが変わった時だけ） ------
+    const csmBool hasBlend = UpdateBlend(model);
+
     // ----- 最新のExpressionのフェードが完了していればそれ以前を削除する ------
     if (motions->GetSize() > 1)
     {
@@ -180,36 +165,174 @@ csmBool CubismExpressionMotionManager::UpdateMotion(CubismModel* model, csmFloat
 
         if (latestFadeWeight >= 1.0f)
         {
-            // 配列の最後の要素は削除しない
-            for (csmInt32 i = motions->GetSize()-2; i >= 0; i--)
+            // 配列の最後の要素は削除せず、先頭に移す
+            const csmInt32 last = motions->GetSize() - 1;
+            for (csmInt32 i = 0; i < last; i++)
             {
-                CubismMotionQueueEntry* motionQueueEntry = motions->At(i);
-                CSM_DELETE(motionQueueEntry);
-                motions->Remove(i);
-                _fadeWeights->Remove(i);
+                ReleaseEntry(motions->At(i));
             }
+            motions->At(0) = motions->At(last);
+            motions->UpdateSize(1, NULL, false);
+            _fadeWeights->At(0) = _fadeWeights->At(last);
+            _fadeWeights->UpdateSize(1, 0.0f, false);
         }
     }
 
+    if (!hasBlend)
+    {
+        return updated;
+    }
+
     if (expressionWeight > 1.0f)
     {
         expressionWeight = 1.0f;
     }
 
     // モデルに各値を適用
-    for (csmInt32 i = 0; i < _expressionParameterValues->GetSize(); ++i)
+    const csmInt32 parameterCount = static_cast<csmInt32>(_blendedParameterIndices.GetSize());
+    const csmInt32* parameterIndices = _blendedParameterIndices.GetPtr();
+    csmFloat32* values = _blendValues.GetPtr();
+    for (csmInt32 i = 0; i < parameterCount; ++i)
     {
-        model->SetParameterValue(_expressionParameterValues->At(i).ParameterId,
-            (_expressionParameterValues->At(i).OverwriteValue + _expressionParameterValues->At(i).AdditiveValue) * _expressionParameterValues->At(i).MultiplyValue,
-            expressionWeight);
+        values[i] = model->GetParameterValue(parameterIndices[i]);
+    }
 
-        _expressionParameterValues->At(i).AdditiveValue = CubismExpressionMotion::DefaultAdditiveValue;
-        _expressionParameterValues->At(i).MultiplyValue = CubismExpressionMotion::DefaultMultiplyValue;
+    // 分岐の無い1つのループにする（ベクトル化される）
+    const csmFloat32* scales = _blendScales.GetPtr();
+    const csmFloat32* overwriteValues = _blendOverwriteValues.GetPtr();
+    const csmFloat32* additiveValues = _blendAdditiveValues.GetPtr();
+    const csmFloat32* multiplyValues = _blendMultiplyValues.GetPtr();
+    for (csmInt32 i = 0; i < parameterCount; ++i)
+    {
+        values[i] = (values[i] * scales[i] + overwriteValues[i] + additiveValues[i]) * multiplyValues[i];
     }
 
+    model->SetParameterValues(parameterIndices, values, parameterCount, expressionWeight);
+
     return updated;
 }
 
+csmBool CubismExpressionMotionManager::AddBlendedParameter(csmInt32 parameterIndex)
+{
+    if (parameterIndex >= static_cast<csmInt32>(_blendedParameterSlots.GetSize()))
+    {
+        _blendedParameterSlots.UpdateSize(parameterIndex + 1, -1, false);
+    }
+
+    if (_blendedParameterSlots[parameterIndex] >= 0)
+    {
+        return false;
+    }
+
+    _blendedParameterSlots[parameterIndex] = _blendedParameterIndices.GetSize();
+    _blendedParameterIndices.PushBack(parameterIndex, false);
+    return true;
+}
+
+csmBool CubismExpressionMotionManager::UpdateBlend(CubismModel* model)
+{
+    csmVector<CubismMotionQueueEntry*>* motions = GetCubismMotionQueueEntries();
+    const csmInt32 motionCount = static_cast<csmInt32>(motions->GetSize());
+    const csmInt32 parameterCount = static_cast<csmInt32>(_blendedParameterIndices.GetSize());
+
+    // 前回と同じExpression・フェードの重み・パラメータなら計算済みの値を使う
+    csmBool changed = (static_cast<csmInt32>(_blendMotions.GetSize()) != motionCount)
+        || (static_cast<csmInt32>(_blendScales.GetSize()) != parameterCount);
+    for (csmInt32 i = 0; !changed && i < motionCount; ++i)
+    {
+        changed = (_blendMotions[i] != GetAvailableMotion(motions->At(i))) || (_blendFadeWeights[i] != _fadeWeights->At(i));
+    }
+    if (!changed)
+    {
+        return _hasBlend;
+    }
+
+    _blendMotions.UpdateSize(motionCount, NULL, false);
+    _blendFadeWeights.UpdateSize(motionCount, 0.0f, false);
+    for (csmInt32 i = 0; i < motionCount; ++i)
+    {
+        _blendMotions[i] = GetAvailableMotion(motions->At(i));
+        _blendFadeWeights[i] = _fadeWeights->At(i);
+    }
+
+    _blendScales.UpdateSize(parameterCount, 1.0f, false);
+    _blendOverwriteValues.UpdateSize(parameterCount, 0.0f, false);
+    _blendAdditiveValues.UpdateSize(parameterCount, 0.0f, false);
+    _blendMultiplyValues.UpdateSize(parameterCount, 1.0f, false);
+    _blendValues.UpdateSize(parameterCount, 0.0f, false);
+
+    csmFloat32* scales = _blendScales.GetPtr();
+    csmFloat32* overwriteValues = _blendOverwriteValues.GetPtr();
+    csmFloat32* additiveValues = _blendAdditiveValues.GetPtr();
+    csmFloat32* multiplyValues = _blendMultiplyValues.GetPtr();
+
+    for (csmInt32 i = 0; i < parameterCount; ++i)
+    {
+        scales[i] = 1.0f;
+        overwriteValues[i] = 0.0f;
+        additiveValues[i] = CubismExpressionMotion::DefaultAdditiveValue;
+        multiplyValues[i] = CubismExpressionMotion::DefaultMultiplyValue;
+    }
+
+    // CalculateExpressionParametersと同じ計算を、現在値に依らない係数で行う
+    // 上書き値は最後のExpressionで決まる（現在値 * (1 - w) + 上書き値 * w）
+    _hasBlend = false;
+    for (csmInt32 expressionIndex = 0; expressionIndex < motionCount; ++expressionIndex)
+    {
+        CubismMotionQueueEntry* motionQueueEntry = motions->At(expressionIndex);
+        if (!motionQueueEntry->IsAvailable())
+        {
+            continue;
+        }
+
+        CubismExpressionMotion* expressionMotion = (CubismExpressionMotion*)motionQueueEntry->GetCubismMotion();
+
+        // 先頭のExpressionは重みを掛けずに設定する
+        const csmFloat32 weight = (expressionIndex == 0) ? 1.0f : _fadeWeights->At(expressionIndex);
+
+        // 参照していないパラメータは初期値に向けてフェードする
+        for (csmInt32 i = 0; i < parameterCount; ++i)
+        {
+            scales[i] = 1.0f;
+            overwriteValues[i] = 0.0f;
+            additiveValues[i] = additiveValues[i] * (1.0f - weight) + CubismExpressionMotion::DefaultAdditiveValue * weight;
+            multiplyValues[i] = multiplyValues[i] * (1.0f - weight) + CubismExpressionMotion::DefaultMultiplyValue * weight;
+        }
+
+        const csmVector<CubismExpressionMotion::ExpressionParameter>& expressionParameters = expressionMotion->GetExpressionParameters();
+        const csmVector<csmInt32>& parameterIndices = expressionMotion->GetParameterIndices(model);
+        for (csmUint32 j = 0; j < parameterIndices.GetSize(); ++j)
+        {
+            if (parameterIndices[j] < 0)
+            {
+                continue;
+            }
+
+            const csmInt32 slot = _blendedParameterSlots[parameterIndices[j]];
+            const csmFloat32 value = expressionParameters[j].Value;
+            switch (expressionParameters[j].BlendType)
+            {
+            case CubismExpressionMotion::Additive:
+                additiveValues[slot] += (value - CubismExpressionMotion::DefaultAdditiveValue) * weight;
+                break;
+            case CubismExpressionMotion::Multiply:
+                multiplyValues[slot] += (value - CubismExpressionMotion::DefaultMultiplyValue) * weight;
+                break;
+            case CubismExpressionMotion::Overwrite:
+                scales[slot] = 1.0f - weight;
+                overwriteValues[slot] = value * weight;
+                break;
+            default:
+                break;
+            }
+        }
+
+        _hasBlend = true;
+    }
+
+    return _hasBlend;
+}
+
 csmFloat32 CubismExpressionMotionManager::GetFadeWeight(csmInt32 index)
 {
     if (index < 0 || _fadeWeights->GetSize() < 1 || _fadeWeights->GetSize() <= index)
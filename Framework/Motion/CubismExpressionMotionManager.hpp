@@ -108,8 +108,42 @@ private:
      */
     void SetFadeWeight(csmInt32 index, csmFloat32 expressionFadeWeight);
 
-    // Values of each parameter to be applied to the model
-    csmVector<ExpressionParameterValue>* _expressionParameterValues;
+    /**
+     * Adds a parameter referenced by a playing expression to the blended parameters.
+     *
+     * @param[in]    parameterIndex  Index of the parameter in the model
+     * @return true if the parameter was added; false if it was already blended
+     */
+    csmBool AddBlendedParameter(csmInt32 parameterIndex);
+
+    /**
+     * Combines the playing expressions into one add / multiply / overwrite per blended parameter.
+     * Recomputed only when the expressions or their fade weights changed.
+     *
+     * @param[in]    model  Target model
+     * @return true if an expression is combined; false if there is nothing to apply
+     */
+    csmBool UpdateBlend(CubismModel* model);
+
+    // Blended parameters: indices in the model of the parameters referenced by the playing expressions
+    csmVector<csmInt32> _blendedParameterIndices;
+
+    // Position in _blendedParameterIndices of each parameter index of the model, -1 if not blended
+    csmVector<csmInt32> _blendedParameterSlots;
+
+    // Combined expressions, per blended parameter: (current * scale + overwrite + additive) * multiply
+    csmVector<csmFloat32> _blendScales;
+    csmVector<csmFloat32> _blendOverwriteValues;
+    csmVector<csmFloat32> _blendAdditiveValues;
+    csmVector<csmFloat32> _blendMultiplyValues;
+
+    // Work area: values of the blended parameters
+    csmVector<csmFloat32> _blendValues;
+
+    // Expressions (NULL if not available) and fade weights the combination was computed for
+    csmVector<ACubismMotion*> _blendMotions;
+    csmVector<csmFloat32> _blendFadeWeights;
+    csmBool _hasBlend;
 
     // Weights of the currently playing expression
     csmVector<csmFloat32>* _fadeWeights;
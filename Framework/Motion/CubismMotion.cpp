@@ -607,7 +607,8 @@ void CubismMotion::Parse(const csmByte* motionJson, const csmSizeInt size)
 {
     _motionData = CSM_NEW CubismMotionData;
 
-    CubismMotionJson* json = CSM_NEW CubismMotionJson(motionJson, size);
+    // jsonはこの関数内で破棄するため、バッファを複製せずに読む
+    CubismMotionJson* json = CSM_NEW CubismMotionJson(motionJson, size, true);
 
     if (!json->IsValid())
     {
@@ -902,7 +903,7 @@ void CubismMotion::SetEffectIds(const csmVector<CubismIdHandle>& eyeBlinkParamet
 
 const csmVector<const csmString*>& CubismMotion::GetFiredEvent(csmFloat32 beforeCheckTimeSeconds, csmFloat32 motionTimeSeconds)
 {
-    _firedEventValues.UpdateSize(0);
+    _firedEventValues.ClearElements();
     /// イベントの発火チェック
     for (csmInt32 u = 0; u < _motionData->EventCount; ++u)
     {
@@ -31,8 +31,9 @@ public:
      *
      * @param buffer buffer containing the loaded motion file
      * @param size size of the buffer in bytes
+     * @param borrowBuffer true to parse without copying buffer, which must then outlive the instance
      */
-    CubismMotionJson(const csmByte* buffer, csmSizeInt size);
+    CubismMotionJson(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer = false);
 
     /**
      * Destructor
@@ -70,4 +70,24 @@ csmBool CubismMotionManager::ReserveMotion(csmInt32 priority)
     return true;
 }
 
+csmBool CubismMotionManager::ReserveMotion(csmInt32 priority, csmBool force)
+{
+    if (force)
+    {
+        _reservePriority = priority;    // 再生中・予約中の優先度に関わらず予約する
+        return true;
+    }
+
+    return ReserveMotion(priority);
+}
+
+void CubismMotionManager::CancelReservation(csmInt32 priority)
+{
+    // 後から他の優先度で予約されていれば、そちらを残す
+    if (priority == _reservePriority)
+    {
+        _reservePriority = 0;
+    }
+}
+
 }}}
@@ -85,6 +85,26 @@ public:
      */
     csmBool ReserveMotion(csmInt32 priority);
 
+    /**
+     * Reserves the motion for playback.<br>
+     * A motion is reserved if its priority is higher than those of the playing and the reserved motions,
+     * or if it is forced: it then preempts them whatever their priority.
+     * Starting it with StartMotionPriority() fades out the playing motions.
+     *
+     * @param priority priority of the motion
+     * @param force true to preempt the playing and the reserved motions
+     *
+     * @return true if the motion was reserved for playback; otherwise false.
+     */
+    csmBool ReserveMotion(csmInt32 priority, csmBool force);
+
+    /**
+     * Cancels the reservation made by ReserveMotion(), e.g. when the reserved motion could not be loaded.
+     *
+     * @param priority priority of the reserved motion
+     */
+    void CancelReservation(csmInt32 priority);
+
 private:
     csmInt32 _currentPriority;
     csmInt32 _reservePriority;
@@ -16,6 +16,7 @@ const CubismMotionQueueEntryHandle InvalidMotionQueueEntryHandleValue = reinterp
 
 CubismMotionQueueManager::CubismMotionQueueManager()
     : _userTimeSeconds(0.0f)
+    , _handleCount(0)
     , _eventCallback(NULL)
     , _eventCustomData(NULL)
 {}
@@ -29,36 +30,45 @@ CubismMotionQueueManager::~CubismMotionQueueManager()
             CSM_DELETE(_motions[i]);
         }
     }
-}
 
-CubismMotionQueueEntryHandle CubismMotionQueueManager::StartMotion(ACubismMotion* motion, csmBool autoDelete)
-{
-    if (motion == NULL)
+    for (csmUint32 i = 0; i < _freeEntries.GetSize(); ++i)
     {
-        return InvalidMotionQueueEntryHandleValue;
+        CSM_DELETE(_freeEntries[i]);
     }
+}
 
-    CubismMotionQueueEntry* motionQueueEntry = NULL;
+CubismMotionQueueEntry* CubismMotionQueueManager::AcquireEntry()
+{
+    CubismMotionQueueEntry* motionQueueEntry;
 
-    // 既にモーションがあれば終了フラグを立てる
-    for (csmUint32 i = 0; i < _motions.GetSize(); ++i)
+    if (_freeEntries.GetSize() > 0)
     {
-        motionQueueEntry = _motions.At(i);
-        if (motionQueueEntry == NULL)
-        {
-            continue;
-        }
-
-        motionQueueEntry->SetFadeout(motionQueueEntry->_motion->GetFadeOutTime());
+        motionQueueEntry = _freeEntries[_freeEntries.GetSize() - 1];
+        _freeEntries.Remove(_freeEntries.GetSize() - 1);
+    }
+    else
+    {
+        motionQueueEntry = CSM_NEW CubismMotionQueueEntry(); // 終了時に破棄する
     }
 
-    motionQueueEntry = CSM_NEW CubismMotionQueueEntry(); // 終了時に破棄する
-    motionQueueEntry->_autoDelete = autoDelete;
-    motionQueueEntry->_motion = motion;
+    // NULL と InvalidMotionQueueEntryHandleValue 以外の値
+    motionQueueEntry->_motionQueueEntryHandle = reinterpret_cast<CubismMotionQueueEntryHandle>(++_handleCount);
 
-    _motions.PushBack(motionQueueEntry, false);
+    return motionQueueEntry;
+}
 
-    return motionQueueEntry->_motionQueueEntryHandle;
+void CubismMotionQueueManager::ReleaseEntry(CubismMotionQueueEntry* motionQueueEntry)
+{
+    // autoDelete のモーションを削除し、初期状態に戻す
+    motionQueueEntry->~CubismMotionQueueEntry();
+    CSM_PLACEMENT_NEW(motionQueueEntry) CubismMotionQueueEntry();
+
+    _freeEntries.PushBack(motionQueueEntry);
+}
+
+CubismMotionQueueEntryHandle CubismMotionQueueManager::StartMotion(ACubismMotion* motion, csmBool autoDelete)
+{
+    return StartEntry(motion, autoDelete);
 }
 
 CubismMotionQueueEntryHandle CubismMotionQueueManager::StartMotion(ACubismMotion* motion, csmBool autoDelete, csmFloat32 userTimeSeconds)
@@ -67,6 +77,11 @@ CubismMotionQueueEntryHandle CubismMotionQueueManager::StartMotion(ACubismMotion
     CubismLogWarning("StartMotion(ACubismMotion* motion, csmBool autoDelete, csmFloat32 userTimeSeconds) is a deprecated function. Please use StartMotion(ACubismMotion* motion, csmBool autoDelete).");
 #endif
 
+    return StartEntry(motion, autoDelete);
+}
+
+CubismMotionQueueEntryHandle CubismMotionQueueManager::StartEntry(ACubismMotion* motion, csmBool autoDelete)
+{
     if (motion == NULL)
     {
         return InvalidMotionQueueEntryHandleValue;
@@ -83,10 +98,18 @@ CubismMotionQueueEntryHandle CubismMotionQueueManager::StartMotion(ACubismMotion
             continue;
         }
 
+        if (!motionQueueEntry->IsStarted())
+        {
+            // 開始前（同じフレームで続けて開始された場合など）はパラメータに反映されていないので、フェードアウトせずに終了する
+            motionQueueEntry->IsFinished(true);
+            continue;
+        }
+
+        // フェードアウト中なら早い方の終了時刻が残る（StartFadeout）
         motionQueueEntry->SetFadeout(motionQueueEntry->_motion->GetFadeOutTime());
     }
 
-    motionQueueEntry = CSM_NEW CubismMotionQueueEntry(); // 終了時に破棄する
+    motionQueueEntry = AcquireEntry();
     motionQueueEntry->_autoDelete = autoDelete;
     motionQueueEntry->_motion = motion;
 
@@ -95,30 +118,46 @@ CubismMotionQueueEntryHandle CubismMotionQueueManager::StartMotion(ACubismMotion
     return motionQueueEntry->_motionQueueEntryHandle;
 }
 
+void CubismMotionQueueManager::CompactEntries()
+{
+    // 削除した（NULLにした）位置を詰める。並びはモーションを適用する順なので保つ
+    csmUint32 size = 0;
+    for (csmUint32 i = 0; i < _motions.GetSize(); ++i)
+    {
+        if (_motions[i] != NULL)
+        {
+            _motions[size++] = _motions[i];
+        }
+    }
+    _motions.UpdateSize(size, NULL, false);
+}
+
 csmBool CubismMotionQueueManager::DoUpdateMotion(CubismModel* model, csmFloat32 userTimeSeconds)
 {
     csmBool updated = false;
 
     // ------- 処理を行う --------
-    // 既にモーションがあれば終了フラグを立てる
-
-    for (csmVector<CubismMotionQueueEntry*>::iterator ite = _motions.Begin(); ite != _motions.End();)
+    // 削除するエントリはNULLにして、最後にまとめて詰める
+    // （イベントのコールバックからStartMotionされることがあるので、サイズは毎回取得する）
+    csmBool removed = false;
+    for (csmUint32 index = 0; index < _motions.GetSize(); ++index)
     {
-        CubismMotionQueueEntry* motionQueueEntry = *ite;
+        CubismMotionQueueEntry* motionQueueEntry = _motions[index];
 
         if (motionQueueEntry == NULL)
         {
-            ite = _motions.Erase(ite);          // 削除
+            removed = true;
             continue;
         }
 
         ACubismMotion* motion = motionQueueEntry->_motion;
 
-        if (motion == NULL)
+        // 開始前に終了したものは反映もイベントの検査もしない
+        if (motion == NULL || (motionQueueEntry->IsFinished() && !motionQueueEntry->IsStarted()))
         {
-            CSM_DELETE(motionQueueEntry);
-            ite = _motions.Erase(ite);          // 削除
-
+            _motions[index] = NULL;
+            ReleaseEntry(motionQueueEntry);
+            removed = true;
             continue;
         }
 
@@ -137,25 +176,32 @@ csmBool CubismMotionQueueManager::DoUpdateMotion(CubismModel* model, csmFloat32
             _eventCallback(this, *(firedList[i]), _eventCustomData);
         }
 
+        // コールバックでStopAllMotionsされた場合、エントリは解放済み
+        if (index >= _motions.GetSize() || _motions[index] != motionQueueEntry)
+        {
+            continue;
+        }
+
         motionQueueEntry->SetLastCheckEventTime(userTimeSeconds);
 
         // ----- 終了済みの処理があれば削除する ------
         if (motionQueueEntry->IsFinished())
         {
-            CSM_DELETE(motionQueueEntry);
-            ite = _motions.Erase(ite);          // 削除
+            _motions[index] = NULL;
+            ReleaseEntry(motionQueueEntry);
+            removed = true;
         }
-        else
+        else if (motionQueueEntry->IsTriggeredFadeOut())
         {
-            if (motionQueueEntry->IsTriggeredFadeOut())
-            {
-                motionQueueEntry->StartFadeout(motionQueueEntry->GetFadeOutSeconds(), userTimeSeconds);
-            }
-
-            ++ite;
+            motionQueueEntry->StartFadeout(motionQueueEntry->GetFadeOutSeconds(), userTimeSeconds);
         }
     }
 
+    if (removed)
+    {
+        CompactEntries();
+    }
+
     return updated;
 }
 
@@ -192,34 +238,20 @@ csmBool CubismMotionQueueManager::IsFinished()
     // ------- 処理を行う --------
     // 既にモーションがあれば終了フラグを立てる
 
-    for (csmVector<CubismMotionQueueEntry*>::iterator ite = _motions.Begin(); ite != _motions.End();)
+    for (csmUint32 i = 0; i < _motions.GetSize(); ++i)
     {
-        CubismMotionQueueEntry* motionQueueEntry = *ite;
+        const CubismMotionQueueEntry* motionQueueEntry = _motions[i];
 
-        if (motionQueueEntry == NULL)
-        {
-            ite = _motions.Erase(ite);          // 削除
-            continue;
-        }
-
-        ACubismMotion* motion = motionQueueEntry->_motion;
-
-        if (motion == NULL)
+        // 削除はDoUpdateMotionで行う
+        if (motionQueueEntry == NULL || motionQueueEntry->_motion == NULL)
         {
-            CSM_DELETE(motionQueueEntry);
-            ite = _motions.Erase(ite);          // 削除
             continue;
         }
 
-        // ----- 終了済みの処理があれば削除する ------
         if (!motionQueueEntry->IsFinished())
         {
             return false;
         }
-        else
-        {
-            ++ite;
-        }
     }
 
     return true;
@@ -250,23 +282,16 @@ csmBool CubismMotionQueueManager::IsFinished(CubismMotionQueueEntryHandle motion
 void CubismMotionQueueManager::StopAllMotions()
 {
     // ------- 処理を行う --------
-    // 既にモーションがあれば終了フラグを立てる
+    // 全て解放し、配列の容量は次のモーションのために残す
 
-    for (csmVector<CubismMotionQueueEntry*>::iterator ite = _motions.Begin(); ite != _motions.End();)
+    for (csmUint32 i = 0; i < _motions.GetSize(); ++i)
     {
-        CubismMotionQueueEntry* motionQueueEntry = *ite;
-
-        if (motionQueueEntry == NULL)
+        if (_motions[i] != NULL)
         {
-            ite = _motions.Erase(ite);
-
-            continue;
+            ReleaseEntry(_motions[i]);
         }
-
-        // ----- 終了済みの処理があれば削除する ------
-        CSM_DELETE(motionQueueEntry);
-        ite = _motions.Erase(ite); //削除
     }
+    _motions.ClearElements();
 }
 
 void CubismMotionQueueManager::SetEventCallback(CubismMotionEventFunction callback, void* customData)
@@ -47,6 +47,7 @@ public:
     /**
      * Plays the motion.<br>
      * If a motion of the same type is already playing, it ends the currently playing motion and starts fading it out.
+     * A motion started but not played yet (e.g. started twice in a frame) ends at once, without fading out.
      *
      * @param motion motion to play
      * @param autoDelete true to delete the instance of the motion when playback ends
@@ -125,11 +126,42 @@ public:
 protected:
     virtual csmBool     DoUpdateMotion(CubismModel* model, csmFloat32 userTimeSeconds);
 
+    /**
+     * Returns a finished entry to the free list, for reuse by the next StartMotion.<br>
+     * The motion of the entry is deleted if it was started with autoDelete.
+     *
+     * @param motionQueueEntry entry already removed from the queue
+     */
+    void                ReleaseEntry(CubismMotionQueueEntry* motionQueueEntry);
 
     csmFloat32 _userTimeSeconds;
 
 private:
+    /**
+     * Fades out the queued motions and queues the motion.<br>
+     * A queued motion not started yet has not changed any parameter: it is finished at once instead of faded out.
+     *
+     * @param motion motion to play
+     * @param autoDelete true to delete the instance of the motion when playback ends
+     *
+     * @return handle of the queued motion
+     */
+    CubismMotionQueueEntryHandle StartEntry(ACubismMotion* motion, csmBool autoDelete);
+
+    /**
+     * Removes the NULL entries from the queue, keeping the order of the others (the order the motions are applied in).
+     */
+    void CompactEntries();
+
+    /**
+     * Takes an entry from the free list, or allocates one if it is empty.<br>
+     * The entry gets a new handle, so that the handles of the finished motions stay finished.
+     */
+    CubismMotionQueueEntry* AcquireEntry();
+
     csmVector<CubismMotionQueueEntry*>      _motions;
+    csmVector<CubismMotionQueueEntry*>      _freeEntries;   ///< Finished entries; motions started in a row do not allocate
+    csmSizeType                             _handleCount;   ///< Last issued handle
 
     CubismMotionEventFunction         _eventCallback;
     void*                             _eventCustomData;
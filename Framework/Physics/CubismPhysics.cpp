@@ -539,7 +539,8 @@ void CubismPhysics::Parse(const csmByte* physicsJson, csmSizeInt size)
 {
     _physicsRig = CSM_NEW CubismPhysicsRig;
 
-    CubismPhysicsJson* json = CSM_NEW CubismPhysicsJson(physicsJson, size);
+    // jsonはこの関数内で破棄するため、バッファを複製せずに読む
+    CubismPhysicsJson* json = CSM_NEW CubismPhysicsJson(physicsJson, size, true);
 
     _isJsonValid = json->IsValid();
 
@@ -58,9 +58,9 @@ const csmChar* Radius = "Radius";
 const csmChar* Acceleration = "Acceleration";
 }
 
-CubismPhysicsJson::CubismPhysicsJson(const csmByte* buffer, csmSizeInt size)
+CubismPhysicsJson::CubismPhysicsJson(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer)
 {
-    CreateCubismJson(buffer, size);
+    CreateCubismJson(buffer, size, borrowBuffer);
 }
 
 CubismPhysicsJson::~CubismPhysicsJson()
@@ -143,7 +143,7 @@ csmFloat32 CubismPhysicsJson::GetNormalizationAngleDefaultValue(csmInt32 physics
 
 csmInt32 CubismPhysicsJson::GetInputCount(csmInt32 physicsSettingIndex) const
 {
-    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Input].GetVector()->GetSize());
+    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Input].GetSize());
 }
 
 csmFloat32 CubismPhysicsJson::GetInputWeight(csmInt32 physicsSettingIndex, csmInt32 inputIndex) const
@@ -169,7 +169,7 @@ CubismIdHandle CubismPhysicsJson::GetInputSourceId(csmInt32 physicsSettingIndex,
 // Output
 csmInt32 CubismPhysicsJson::GetOutputCount(csmInt32 physicsSettingIndex) const
 {
-    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Output].GetVector()->GetSize());
+    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Output].GetSize());
 }
 
 csmInt32 CubismPhysicsJson::GetOutputVertexIndex(csmInt32 physicsSettingIndex, csmInt32 outputIndex) const
@@ -205,7 +205,7 @@ csmBool CubismPhysicsJson::GetOutputReflect(csmInt32 physicsSettingIndex, csmInt
 // Particle
 csmInt32 CubismPhysicsJson::GetParticleCount(csmInt32 physicsSettingIndex) const
 {
-    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Vertices].GetVector()->GetSize());
+    return static_cast<csmInt32>(_json->GetRoot()[PhysicsSettings][physicsSettingIndex][Vertices].GetSize());
 }
 
 csmFloat32 CubismPhysicsJson::GetParticleMobility(csmInt32 physicsSettingIndex, csmInt32 vertexIndex) const
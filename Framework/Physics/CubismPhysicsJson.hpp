@@ -27,10 +27,11 @@ public:
      *
      * コンストラクタ。
      *
-     * @param[in]   buffer  physics3.jsonが読み込まれているバッファ
-     * @param[in]   size    バッファのサイズ
+     * @param[in]   buffer          physics3.jsonが読み込まれているバッファ
+     * @param[in]   size            バッファのサイズ
+     * @param[in]   borrowBuffer    bufferを複製せずに読むならtrue（インスタンスの破棄までbufferを保持すること）
      */
-    CubismPhysicsJson(const csmByte* buffer, csmSizeInt size);
+    CubismPhysicsJson(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer = false);
 
     /**
      * @brief デストラクタ
@@ -97,6 +97,14 @@ public:
      */
     void CalcClippedDrawTotalBounds(CubismModel& model, T_ClippingContext* clippingContext);
 
+    /**
+     * @brief   前回の計算から頂点位置が変化した描画オブジェクトを使うクリッピングコンテキストの矩形を無効にする。<br>
+     *           CalcClippedDrawTotalBounds()は有効な矩形を再計算しない。
+     *
+     * @param[in]   model            ->  モデルのインスタンス
+     */
+    void InvalidateClippedDrawTotalBounds(const CubismModel& model);
+
     /**
      * @brief   画面描画に使用するクリッピングマスクのリストを取得する
      *
@@ -147,6 +155,8 @@ protected:
     CubismMatrix44 _tmpMatrixForMask;       ///< マスク計算用の行列
     CubismMatrix44 _tmpMatrixForDraw;       ///< マスク計算用の行列
     csmRectF _tmpBoundsOnModel;       ///< マスク配置計算用の矩形
+    csmUint32 _clippedDrawTotalBoundsSerial;    ///< 矩形を計算した時のモデルの更新番号（未計算は0）
+    csmVector<csmInt32> _dirtyDrawableIndices;  ///< 頂点位置が変化した描画オブジェクトのリスト（作業用）
 };
 
 #include "CubismClippingManager.tpp"
@@ -11,6 +11,7 @@
 template <class T_ClippingContext, class T_OffscreenSurface>
 CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::CubismClippingManager() :
                                                                     _clippingMaskBufferSize(256, 256)
+                                                                  , _clippedDrawTotalBoundsSerial(0)
 {
     CubismRenderer::CubismTextureColor* tmp = NULL;
     tmp = CSM_NEW CubismRenderer::CubismTextureColor();
@@ -62,7 +63,7 @@ CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::~CubismClippingMan
 
     if (_clearedMaskBufferFlags.GetSize() != 0)
     {
-        _clearedMaskBufferFlags.Clear();
+        _clearedMaskBufferFlags.ClearElements();
         _clearedMaskBufferFlags = NULL;
     }
 }
@@ -141,6 +142,7 @@ void CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::SetupMatrixFo
 {
     // 全てのクリッピングを用意する
     // 同じクリップ（複数の場合はまとめて１つのクリップ）を使う場合は１度だけ設定する
+    InvalidateClippedDrawTotalBounds(model);
     csmInt32 usingClipCount = 0;
     for (csmUint32 clipIndex = 0; clipIndex < _clippingContextListForMask.GetSize(); clipIndex++)
     {
@@ -165,7 +167,7 @@ void CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::SetupMatrixFo
     // サイズがレンダーテクスチャの枚数と合わない場合は合わせる
     if (_clearedMaskBufferFlags.GetSize() != _renderTextureCount)
     {
-        _clearedMaskBufferFlags.Clear();
+        _clearedMaskBufferFlags.ClearElements();
 
         for (csmInt32 i = 0; i < _renderTextureCount; ++i)
         {
@@ -422,6 +424,12 @@ void CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::SetupLayoutBo
 template <class T_ClippingContext, class T_OffscreenSurface>
 void CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::CalcClippedDrawTotalBounds(CubismModel& model, T_ClippingContext* clippingContext)
 {
+    // 頂点位置が変化していなければ前回の矩形をそのまま使う
+    if (clippingContext->_isAllClippedDrawRectValid)
+    {
+        return;
+    }
+
     // 被クリッピングマスク（マスクされる描画オブジェクト）の全体の矩形
     csmFloat32 clippedDrawTotalMinX = FLT_MAX, clippedDrawTotalMinY = FLT_MAX;
     csmFloat32 clippedDrawTotalMaxX = -FLT_MAX, clippedDrawTotalMaxY = -FLT_MAX;
@@ -479,6 +487,40 @@ void CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::CalcClippedDr
         clippingContext->_allClippedDrawRect->Width = w;
         clippingContext->_allClippedDrawRect->Height = h;
     }
+    clippingContext->_isAllClippedDrawRectValid = true;
+}
+
+template <class T_ClippingContext, class T_OffscreenSurface>
+void CubismClippingManager<T_ClippingContext, T_OffscreenSurface>::InvalidateClippedDrawTotalBounds(const CubismModel& model)
+{
+    const CubismDrawableDirtySet& dirtySet = model.GetDrawableDirtySet();
+    if (_clippedDrawTotalBoundsSerial != 0 && dirtySet.GetUpdateSerial() == _clippedDrawTotalBoundsSerial)
+    {
+        return; // 前回の計算からモデルが更新されていない
+    }
+
+    if (dirtySet.IsConsecutive(_clippedDrawTotalBoundsSerial))
+    {
+        // 頂点位置が変化した描画オブジェクトを使うコンテキストだけ
+        const csmInt32 dirtyCount = dirtySet.CollectDirty(CubismDrawableDirtySet::Kind_VertexPositions, _dirtyDrawableIndices);
+        for (csmInt32 i = 0; i < dirtyCount; i++)
+        {
+            T_ClippingContext* cc = _clippingContextListForDraw[_dirtyDrawableIndices[i]];
+            if (cc != NULL)
+            {
+                cc->_isAllClippedDrawRectValid = false;
+            }
+        }
+    }
+    else
+    {
+        // 間の更新を処理していないので全て
+        for (csmUint32 i = 0; i < _clippingContextListForMask.GetSize(); i++)
+        {
+            _clippingContextListForMask[i]->_isAllClippedDrawRectValid = false;
+        }
+    }
+    _clippedDrawTotalBoundsSerial = dirtySet.GetUpdateSerial();
 }
 
 template <class T_ClippingContext, class T_OffscreenSurface>
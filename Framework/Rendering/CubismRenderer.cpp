@@ -167,6 +167,7 @@ CubismClippingContext::CubismClippingContext(const csmInt32* clippingDrawableInd
     _layoutChannelIndex = 0;
 
     _allClippedDrawRect = CSM_NEW csmRectF();
+    _isAllClippedDrawRectValid = false;
     _layoutBounds = CSM_NEW csmRectF();
 
     _clippedDrawableIndexList = CSM_NEW csmVector<csmInt32>();
@@ -31,6 +31,7 @@ void CubismClippingManager_OpenGLES2::SetupClippingContext(CubismModel& model, C
 {
     // 全てのクリッピングを用意する
     // 同じクリップ（複数の場合はまとめて１つのクリップ）を使う場合は１度だけ設定する
+    InvalidateClippedDrawTotalBounds(model);
     csmInt32 usingClipCount = 0;
     for (csmUint32 clipIndex = 0; clipIndex < _clippingContextListForMask.GetSize(); clipIndex++)
     {
@@ -68,7 +69,7 @@ void CubismClippingManager_OpenGLES2::SetupClippingContext(CubismModel& model, C
     // サイズがレンダーテクスチャの枚数と合わない場合は合わせる
     if (_clearedMaskBufferFlags.GetSize() != _renderTextureCount)
     {
-        _clearedMaskBufferFlags.Clear();
+        _clearedMaskBufferFlags.ClearElements();
 
         for (csmInt32 i = 0; i < _renderTextureCount; ++i)
         {
@@ -429,7 +430,8 @@ void CubismRenderer::StaticRelease()
     CubismRenderer_OpenGLES2::DoStaticRelease();
 }
 
-CubismRenderer_OpenGLES2::CubismRenderer_OpenGLES2() : _clippingManager(NULL)
+CubismRenderer_OpenGLES2::CubismRenderer_OpenGLES2() : _sortedDrawableIndexListSerial(0)
+                                                     , _clippingManager(NULL)
                                                      , _clippingContextBufferForMask(NULL)
                                                      , _clippingContextBufferForDraw(NULL)
 {
@@ -493,6 +495,7 @@ void CubismRenderer_OpenGLES2::Initialize(CubismModel* model, csmInt32 maskBuffe
     }
 
     _sortedDrawableIndexList.Resize(model->GetDrawableCount(), 0);
+    _sortedDrawableIndexListSerial = 0;
 
     CubismRenderer::Initialize(model, maskBufferCount);  //親クラスの処理を呼ぶ
 }
@@ -563,13 +566,21 @@ void CubismRenderer_OpenGLES2::DoDrawModel()
     PreDraw();
 
     const csmInt32 drawableCount = GetModel()->GetDrawableCount();
-    const csmInt32* renderOrder = GetModel()->GetDrawableRenderOrders();
 
-    // インデックスを描画順でソート
-    for (csmInt32 i = 0; i < drawableCount; ++i)
+    // インデックスを描画順でソート（前回から描画順が変化した時だけ）
+    const CubismDrawableDirtySet& dirtySet = GetModel()->GetDrawableDirtySet();
+    if (_sortedDrawableIndexListSerial == 0 || dirtySet.GetUpdateSerial() != _sortedDrawableIndexListSerial)
     {
-        const csmInt32 order = renderOrder[i];
-        _sortedDrawableIndexList[order] = i;
+        if (!dirtySet.IsConsecutive(_sortedDrawableIndexListSerial) || dirtySet.IsAnyDirty(CubismDrawableDirtySet::Kind_RenderOrder))
+        {
+            const csmInt32* renderOrder = GetModel()->GetDrawableRenderOrders();
+            for (csmInt32 i = 0; i < drawableCount; ++i)
+            {
+                const csmInt32 order = renderOrder[i];
+                _sortedDrawableIndexList[order] = i;
+            }
+        }
+        _sortedDrawableIndexListSerial = dirtySet.GetUpdateSerial();
     }
 
     // 描画
@@ -659,7 +670,8 @@ void CubismRenderer_OpenGLES2::DrawMeshOpenGL(const CubismModel& model, const cs
 #endif
 
 #ifndef CSM_DEBUG
-    if (_textures[model.GetDrawableTextureIndex(index)] == 0) return;    // モデルが参照するテクスチャがバインドされていない場合は描画をスキップする
+    const GLuint* texture = _textures.Find(model.GetDrawableTextureIndex(index));
+    if (texture == NULL || *texture == 0) return;    // モデルが参照するテクスチャがバインドされていない場合は描画をスキップする
 #endif
 
     // 裏面描画の有効・無効
@@ -710,7 +722,7 @@ void CubismRenderer_OpenGLES2::BindTexture(csmUint32 modelTextureIndex, GLuint g
     _textures[modelTextureIndex] = glTextureIndex;
 }
 
-const csmMap<csmInt32, GLuint>& CubismRenderer_OpenGLES2::GetBindedTextures() const
+const csmHashMap<csmInt32, GLuint>& CubismRenderer_OpenGLES2::GetBindedTextures() const
 {
     return _textures;
 }
@@ -780,7 +792,8 @@ const csmBool inline CubismRenderer_OpenGLES2::IsGeneratingMask() const
 
 GLuint CubismRenderer_OpenGLES2::GetBindedTextureId(csmInt32 textureId)
 {
-    return (_textures[textureId] != 0) ? _textures[textureId] : -1;
+    const GLuint* texture = _textures.Find(textureId);
+    return (texture != NULL && *texture != 0) ? *texture : -1;
 }
 
 }}}}
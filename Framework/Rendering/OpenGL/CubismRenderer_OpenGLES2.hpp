@@ -15,7 +15,7 @@
 #include "Type/csmVector.hpp"
 #include "Type/csmRectF.hpp"
 #include "Math/CubismVector2.hpp"
-#include "Type/csmMap.hpp"
+#include "Type/csmHashMap.hpp"
 
 
 //------------ LIVE2D NAMESPACE ------------
@@ -176,7 +176,7 @@ public:
      *
      * @return  テクスチャのアドレスのリスト
      */
-    const csmMap<csmInt32, GLuint>& GetBindedTextures() const;
+    const csmHashMap<csmInt32, GLuint>& GetBindedTextures() const;
 
     /**
      * @brief  クリッピングマスクバッファのサイズを設定する<br>
@@ -342,8 +342,9 @@ private:
     void  CheckGlError(const csmChar* message);
 #endif
 
-    csmMap<csmInt32, GLuint> _textures;                      ///< モデルが参照するテクスチャとレンダラでバインドしているテクスチャとのマップ
+    csmHashMap<csmInt32, GLuint> _textures;                   ///< モデルが参照するテクスチャとレンダラでバインドしているテクスチャとのマップ
     csmVector<csmInt32> _sortedDrawableIndexList;       ///< 描画オブジェクトのインデックスを描画順に並べたリスト
+    csmUint32 _sortedDrawableIndexListSerial;           ///< _sortedDrawableIndexListを並べた時のモデルの更新番号（未作成は0）
     CubismRendererProfile_OpenGLES2 _rendererProfile;               ///< OpenGLのステートを保持するオブジェクト
     CubismClippingManager_OpenGLES2* _clippingManager;               ///< クリッピングマスク管理オブジェクト
     CubismClippingContext_OpenGLES2* _clippingContextBufferForMask;  ///< マスクテクスチャに描画するためのクリッピングコンテキスト
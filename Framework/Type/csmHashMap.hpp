@@ -0,0 +1,532 @@
+﻿/**
+ * Copyright(c) Live2D Inc. All rights reserved.
+ *
+ * Use of this source code is governed by the Live2D Open Software license
+ * that can be found at https://www.live2d.com/eula/live2d-open-software-license-agreement_en.html.
+ */
+
+#pragma once
+
+#include "CubismFramework.hpp"
+#include "csmMap.hpp"
+#include "csmString.hpp"
+#include "Utils/CubismDebug.hpp"
+
+#ifndef NULL
+#   define  NULL 0
+#endif
+
+//--------- LIVE2D NAMESPACE ------------
+namespace Live2D { namespace Cubism { namespace Framework {
+
+/**
+ * @brief   csmHashMapのキーのハッシュ関数。<br>
+ *          整数・ポインタ・csmStringに対して特殊化する。
+ */
+template<class _KeyT>
+struct csmHash;
+
+template<>
+struct csmHash<csmInt32>
+{
+    csmUint32 operator()(csmInt32 key) const { return static_cast<csmUint32>(key); }
+};
+
+template<>
+struct csmHash<csmUint32>
+{
+    csmUint32 operator()(csmUint32 key) const { return key; }
+};
+
+template<class _T>
+struct csmHash<_T*>
+{
+    csmUint32 operator()(_T* key) const
+    {
+        // 下位ビットはアラインメントでほぼ一定なので捨てる
+        const csmUint64 address = static_cast<csmUint64>(reinterpret_cast<csmSizeType>(key));
+        return static_cast<csmUint32>((address >> 4) ^ (address >> 32));
+    }
+};
+
+template<>
+struct csmHash<csmString>
+{
+    csmUint32 operator()(const csmString& key) const
+    {
+        // csmStringは生成時にハッシュコードを計算済み（GetHashcodeはキャッシュを返すだけ）
+        return static_cast<csmUint32>(const_cast<csmString&>(key).GetHashcode());
+    }
+};
+
+/**
+ * @brief   ハッシュマップ型<br>
+ *          オープンアドレス法（線形探索）のインデックスと、挿入順に並んだKey-Valueペアの配列を持つ。
+ *          csmMapと同じAPI（Begin/Endのイテレーション、operator[]、IsExist、AppendKey）で、
+ *          検索は要素数によらずO(1)。イテレーションは挿入順。
+ *
+ * @note    Eraseは後続の要素をずらしてインデックスを再構築する（O(n)）。
+ */
+template<class _KeyT, class _ValT, class _HashT = csmHash<_KeyT> >
+class csmHashMap
+{
+public:
+
+    /**
+     * @brief    コンストラクタ
+     */
+    csmHashMap();
+
+    /**
+     * @brief   コピーコンストラクタ
+     *
+     * @param[in]   m   ->  csmHashMapのインスタンス
+     */
+    csmHashMap(const csmHashMap& m);
+
+    /**
+     * @brief   デストラクタ
+     */
+    virtual ~csmHashMap();
+
+    /**
+     * @brief   代入演算子のオーバーロード
+     *
+     * @param[in]   c   ->  csmHashMapのインスタンス
+     */
+    csmHashMap& operator=(const csmHashMap& c)
+    {
+        if (this != &c)
+        {
+            Clear();
+            Copy(c);
+        }
+
+        return *this;
+    }
+
+    /**
+     * @brief   キーを追加する
+     *
+     * @param[in]   key ->  新たに追加するキー
+     */
+    void AppendKey(const _KeyT& key)
+    {
+        const csmUint32 hash = _hasher(key);
+        if (FindIndex(key, hash) >= 0)
+        {
+            CubismLogWarning("The key is already append.");
+            return;
+        }
+        Insert(key, hash);
+    }
+
+    /**
+     * @brief   添字演算子[key]のオーバーロード。キーが無ければ追加する。
+     *
+     * @return  添字から特定されるValue値
+     */
+    _ValT& operator[](const _KeyT& key)
+    {
+        const csmUint32 hash = _hasher(key);
+        const csmInt32 found = FindIndex(key, hash);
+        if (found >= 0)
+        {
+            return _keyValues[found].Second;
+        }
+        // Insertは配列を再確保しうるので、先にインデックスを得る
+        const csmInt32 index = Insert(key, hash);
+        return _keyValues[index].Second;
+    }
+
+    /**
+     * @brief   添字演算子[key]のオーバーロード(const)
+     *
+     * @return  添字から特定されるValue値。キーが無ければデフォルト値
+     */
+    const _ValT& operator[](const _KeyT& key) const
+    {
+        const csmInt32 found = FindIndex(key, _hasher(key));
+        if (found >= 0)
+        {
+            return _keyValues[found].Second;
+        }
+        if (!_dummyValuePtr) _dummyValuePtr = CSM_NEW _ValT();
+        return *_dummyValuePtr;
+    }
+
+    /**
+     * @brief   引数で渡したKeyを持つ要素が存在するか
+     *
+     * @retval  true    ->  引数で渡したKeyを持つ要素が存在する
+     * @retval  false   ->  引数で渡したKeyを持つ要素が存在しない
+     */
+    csmBool IsExist(const _KeyT& key) const
+    {
+        return FindIndex(key, _hasher(key)) >= 0;
+    }
+
+    /**
+     * @brief   引数で渡したKeyの値を返す（IsExistとoperator[]の二度引きを避ける）
+     *
+     * @return  値のポインタ。キーが無ければNULL
+     */
+    _ValT* Find(const _KeyT& key)
+    {
+        const csmInt32 found = FindIndex(key, _hasher(key));
+        return (found >= 0) ? &_keyValues[found].Second : NULL;
+    }
+
+    /**
+     * @brief   引数で渡したKeyの値を返す(const)
+     *
+     * @return  値のポインタ。キーが無ければNULL
+     */
+    const _ValT* Find(const _KeyT& key) const
+    {
+        const csmInt32 found = FindIndex(key, _hasher(key));
+        return (found >= 0) ? &_keyValues[found].Second : NULL;
+    }
+
+    /**
+     * @brief   Key-Valueを全て解放する
+     */
+    void Clear();
+
+    /**
+     * @brief   コンテナのサイズを取得する
+     *
+     * @return  コンテナのサイズ
+     */
+    csmInt32 GetSize() const { return _size; }
+
+    /**
+     * @brief   コンテナのキャパシティを確保する
+     *
+     * @param[in]   newSize     -> 新たなキャパシティ。引数の値が現在のサイズ未満の場合は何もしない。
+     * @param[in]   fitToSize   ->  trueなら指定したサイズに合わせる。falseならサイズを2倍確保しておく。
+     */
+    void PrepareCapacity(csmInt32 newSize, csmBool fitToSize);
+
+    /**
+     * @brief   csmHashMapのイテレータ
+     */
+    class iterator
+    {
+        friend class csmHashMap;
+
+    public:
+        iterator() : _index(0)
+                   , _map(NULL) {}
+
+        iterator(csmHashMap* v, csmInt32 idx = 0) : _index(idx)
+                                                   , _map(v) {}
+
+        iterator& operator++() { ++_index; return *this; }
+
+        iterator& operator--() { --_index; return *this; }
+
+        iterator operator++(csmInt32) { return iterator(_map, _index++); }
+
+        iterator operator--(csmInt32) { return iterator(_map, _index--); }
+
+        csmPair<_KeyT, _ValT>* operator->() const { return &_map->_keyValues[_index]; }
+
+        csmPair<_KeyT, _ValT>& operator*() const { return _map->_keyValues[_index]; }
+
+        csmBool operator!=(const iterator& ite) const
+        {
+            return (_index != ite._index) || (_map != ite._map);
+        }
+
+    private:
+        csmInt32 _index;        ///< コンテナのインデックス値
+        csmHashMap* _map;       ///< コンテナのポインタ
+    };
+
+    /**
+     * @brief   csmHashMapのイテレータ(const)
+     */
+    class const_iterator
+    {
+        friend class csmHashMap;
+
+    public:
+        const_iterator() : _index(0)
+                         , _map(NULL) {}
+
+        const_iterator(const csmHashMap* v, csmInt32 idx = 0) : _index(idx)
+                                                               , _map(v) {}
+
+        const_iterator& operator++() { ++_index; return *this; }
+
+        const_iterator& operator--() { --_index; return *this; }
+
+        const_iterator operator++(csmInt32) { return const_iterator(_map, _index++); }
+
+        const_iterator operator--(csmInt32) { return const_iterator(_map, _index--); }
+
+        const csmPair<_KeyT, _ValT>* operator->() const { return &_map->_keyValues[_index]; }
+
+        const csmPair<_KeyT, _ValT>& operator*() const { return _map->_keyValues[_index]; }
+
+        csmBool operator!=(const const_iterator& ite) const
+        {
+            return (_index != ite._index) || (_map != ite._map);
+        }
+
+    private:
+        csmInt32 _index;            ///< コンテナのインデックス値
+        const csmHashMap* _map;     ///< コンテナのポインタ(const)
+    };
+
+    /**
+     * @brief   コンテナの先頭要素を返す
+     */
+    const const_iterator Begin() const { return const_iterator(this, 0); }
+
+    /**
+     * @brief   コンテナの終端要素を返す
+     */
+    const const_iterator End() const { return const_iterator(this, _size); }
+
+    /**
+     * @brief   コンテナから要素を削除する
+     *
+     * @param[in]   ite ->  削除する要素
+     * @return  削除した要素の次の要素
+     */
+    const iterator Erase(const iterator& ite)
+    {
+        EraseAt(ite._index);
+        return iterator(this, ite._index);
+    }
+
+    /**
+     * @brief   コンテナから要素を削除する
+     *
+     * @param[in]   ite ->  削除する要素
+     * @return  削除した要素の次の要素
+     */
+    const const_iterator Erase(const const_iterator& ite)
+    {
+        EraseAt(ite._index);
+        return const_iterator(this, ite._index);
+    }
+
+private:
+    static const csmInt32 DefaultSize = 8;  ///< コンテナ初期化のデフォルトサイズ
+
+    /**
+     * @brief   インデックスのスロット。indexが負なら空き
+     */
+    struct Slot
+    {
+        csmUint32 Hash;
+        csmInt32 Index;
+    };
+
+    /**
+     * @brief   ハッシュ値から最初に調べるスロット（フィボナッチハッシュ）
+     */
+    csmUint32 SlotOf(csmUint32 hash) const
+    {
+        return (hash * 0x9E3779B9u) >> _shift;
+    }
+
+    /**
+     * @return  Key-Valueペアのインデックス。見つからなければ-1
+     */
+    csmInt32 FindIndex(const _KeyT& key, csmUint32 hash) const
+    {
+        if (_size == 0) return -1;
+
+        const csmUint32 mask = _slotCount - 1;
+        for (csmUint32 i = SlotOf(hash); ; i = (i + 1) & mask)
+        {
+            const Slot& slot = _slots[i];
+            if (slot.Index < 0) return -1;
+            if (slot.Hash == hash && _keyValues[slot.Index].First == key) return slot.Index;
+        }
+    }
+
+    /**
+     * @brief   キーの存在を確認せずに追加する
+     *
+     * @return  追加したKey-Valueペアのインデックス
+     */
+    csmInt32 Insert(const _KeyT& key, csmUint32 hash)
+    {
+        PrepareCapacity(_size + 1, false);
+
+        const csmInt32 index = _size;
+        CSM_PLACEMENT_NEW(&_keyValues[index]) csmPair<_KeyT, _ValT>(key);
+        _size += 1;
+        InsertSlot(hash, index);
+        return index;
+    }
+
+    void InsertSlot(csmUint32 hash, csmInt32 index)
+    {
+        const csmUint32 mask = _slotCount - 1;
+        csmUint32 i = SlotOf(hash);
+        while (_slots[i].Index >= 0) i = (i + 1) & mask;
+        _slots[i].Hash = hash;
+        _slots[i].Index = index;
+    }
+
+    /**
+     * @brief   スロットを作り直す。スロット数はキャパシティの2倍以上の2の冪（負荷率0.5以下）
+     */
+    void Rehash();
+
+    void EraseAt(csmInt32 index);
+
+    void Copy(const csmHashMap& c);
+
+    csmPair<_KeyT, _ValT>* _keyValues;      ///< Key-Valueペアの配列（挿入順）
+    Slot* _slots;                           ///< オープンアドレスのインデックス
+    mutable _ValT* _dummyValuePtr;          ///< 空の値を返すためのダミー
+    csmInt32 _size;                         ///< コンテナの要素数（サイズ）
+    csmInt32 _capacity;                     ///< Key-Valueペアの配列のキャパシティ
+    csmUint32 _slotCount;                   ///< スロット数（2の冪）
+    csmUint32 _shift;                       ///< 32 - log2(_slotCount)
+    _HashT _hasher;                         ///< ハッシュ関数
+};
+
+
+//========================テンプレートの定義==============================
+
+template<class _KeyT, class _ValT, class _HashT>
+csmHashMap<_KeyT, _ValT, _HashT>::csmHashMap()
+    : _keyValues(NULL)
+    , _slots(NULL)
+    , _dummyValuePtr(NULL)
+    , _size(0)
+    , _capacity(0)
+    , _slotCount(0)
+    , _shift(32)
+    , _hasher()
+{ }
+
+template<class _KeyT, class _ValT, class _HashT>
+csmHashMap<_KeyT, _ValT, _HashT>::csmHashMap(const csmHashMap& m)
+    : _keyValues(NULL)
+    , _slots(NULL)
+    , _dummyValuePtr(NULL)
+    , _size(0)
+    , _capacity(0)
+    , _slotCount(0)
+    , _shift(32)
+    , _hasher(m._hasher)
+{
+    Copy(m);
+}
+
+template<class _KeyT, class _ValT, class _HashT>
+csmHashMap<_KeyT, _ValT, _HashT>::~csmHashMap()
+{
+    Clear();
+}
+
+template<class _KeyT, class _ValT, class _HashT>
+void csmHashMap<_KeyT, _ValT, _HashT>::PrepareCapacity(csmInt32 newSize, csmBool fitToSize)
+{
+    if (newSize <= _capacity) return;
+
+    if (!fitToSize)
+    {
+        if (newSize < DefaultSize) newSize = DefaultSize;
+        if (newSize < _capacity * 2) newSize = _capacity * 2;
+    }
+
+    csmPair<_KeyT, _ValT>* tmp = static_cast<csmPair<_KeyT, _ValT>*>(CSM_MALLOC(sizeof(csmPair<_KeyT, _ValT>) * newSize));
+    CSM_ASSERT(tmp != NULL);
+
+    // csmMapと同様、要素はmemcpyで移動する
+    if (_keyValues != NULL)
+    {
+        memcpy(static_cast<void*>(tmp), static_cast<void*>(_keyValues), sizeof(csmPair<_KeyT, _ValT>) * _size);
+        CSM_FREE(_keyValues);
+    }
+    _keyValues = tmp;
+    _capacity = newSize;
+
+    Rehash();
+}
+
+template<class _KeyT, class _ValT, class _HashT>
+void csmHashMap<_KeyT, _ValT, _HashT>::Rehash()
+{
+    csmUint32 slotCount = 1;
+    csmUint32 shift = 32;
+    while (slotCount < static_cast<csmUint32>(_capacity) * 2)
+    {
+        slotCount <<= 1;
+        --shift;
+    }
+
+    if (slotCount != _slotCount)
+    {
+        if (_slots != NULL) CSM_FREE(_slots);
+        _slots = static_cast<Slot*>(CSM_MALLOC(sizeof(Slot) * slotCount));
+        CSM_ASSERT(_slots != NULL);
+        _slotCount = slotCount;
+        _shift = shift;
+    }
+
+    for (csmUint32 i = 0; i < _slotCount; i++) _slots[i].Index = -1;
+    for (csmInt32 i = 0; i < _size; i++) InsertSlot(_hasher(_keyValues[i].First), i);
+}
+
+template<class _KeyT, class _ValT, class _HashT>
+void csmHashMap<_KeyT, _ValT, _HashT>::EraseAt(csmInt32 index)
+{
+    if (index < 0 || _size <= index) return; // 削除範囲外
+
+    _keyValues[index].~csmPair<_KeyT, _ValT>();
+    if (index < _size - 1)
+        memmove(static_cast<void*>(&_keyValues[index]), static_cast<void*>(&_keyValues[index + 1]), sizeof(csmPair<_KeyT, _ValT>) * (_size - index - 1));
+    --_size;
+
+    Rehash();
+}
+
+template<class _KeyT, class _ValT, class _HashT>
+void csmHashMap<_KeyT, _ValT, _HashT>::Copy(const csmHashMap& c)
+{
+    if (c._size == 0) return;
+
+    PrepareCapacity(c._size, true);
+    for (csmInt32 i = 0; i < c._size; ++i)
+    {
+        CSM_PLACEMENT_NEW(&_keyValues[i]) csmPair<_KeyT, _ValT>(c._keyValues[i].First, c._keyValues[i].Second);
+    }
+    _size = c._size;
+    Rehash();
+}
+
+template<class _KeyT, class _ValT, class _HashT>
+void csmHashMap<_KeyT, _ValT, _HashT>::Clear()
+{
+    if (_dummyValuePtr) CSM_DELETE(_dummyValuePtr);
+    _dummyValuePtr = NULL;
+
+    for (csmInt32 i = 0; i < _size; i++)
+    {
+        _keyValues[i].~csmPair<_KeyT, _ValT>();
+    }
+
+    if (_keyValues != NULL) CSM_FREE(_keyValues);
+    if (_slots != NULL) CSM_FREE(_slots);
+
+    _keyValues = NULL;
+    _slots = NULL;
+    _size = 0;
+    _capacity = 0;
+    _slotCount = 0;
+    _shift = 32;
+}
+}}}
+
+//------------------------- LIVE2D NAMESPACE ------------
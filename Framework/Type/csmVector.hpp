@@ -10,6 +10,8 @@
 #include "csmString.hpp"
 #include "CubismFramework.hpp"
 #include "Utils/CubismDebug.hpp"
+#include <type_traits>
+#include <utility>
 
 #ifndef NULL
 #   define  NULL    0
@@ -58,6 +60,15 @@ public:
         return _ptr;
     }
 
+    /**
+     * @brief   コンテナの先頭アドレスを返す(const)
+     *
+     */
+    const T* GetPtr() const
+    {
+        return _ptr;
+    }
+
     /**
      * @brief   []演算子のオーバーロード
      *
@@ -85,6 +96,15 @@ public:
         return _ptr[index];
     }
 
+    /**
+     * @brief   インデックスで指定した要素を返す(const)
+     *
+     */
+    const T& At(int index) const
+    {
+        return _ptr[index];
+    }
+
     /**
      * @brief   PushBack処理.コンテナに新たな要素を追加する。
      *
@@ -94,12 +114,45 @@ public:
      */
     void PushBack(const T& value, csmBool callPlacementNew = true);
 
+    /**
+     * @brief   PushBack処理（ムーブ）.コンテナに新たな要素を追加する。
+     *
+     * @param[in]   value   -> 追加する値。ムーブ構築される
+     */
+    void PushBack(T&& value);
+
+    /**
+     * @brief   コンテナの末尾に、引数から直接要素を構築する
+     *
+     * @param[in]   args    -> Tのコンストラクタの引数
+     * @return      構築した要素
+     */
+    template<class... Args>
+    T& EmplaceBack(Args&&... args)
+    {
+        return ConstructBack(std::forward<Args>(args)...);
+    }
+
     /**
      * @brief   コンテナの全要素を解放する
      *
      */
     void Clear();
 
+    /**
+     * @brief   コンテナの全要素を破棄する。キャパシティ（確保済みの領域）は保持する<br>
+     *           毎フレーム作り直すリストなどで、再確保を避けるために使う。
+     *
+     */
+    void ClearElements();
+
+    /**
+     * @brief   コンテナのキャパシティを返す
+     *
+     * @return  コンテナのキャパシティ
+     */
+    csmInt32 GetCapacity() const { return _capacity; }
+
     /**
      * @brief   コンテナの要素数を返す
      *
@@ -494,12 +547,33 @@ public:
      * @param[in]   c   ->  csmVector<T>のインスタンス
      */
     csmVector(const csmVector& c)
+        : _ptr(NULL)
+        , _size(0)
+        , _capacity(0)
+        , _inlineBuffer(NULL)
+        , _inlineCapacity(0)
     {
         Copy(c);
     }
 
     /**
-     * @brief   コピーコンストラクタ
+     * @brief   ムーブコンストラクタ
+     *
+     * @param[in]   c   ->  csmVector<T>のインスタンス。空になる
+     */
+    csmVector(csmVector&& c)
+        : _ptr(NULL)
+        , _size(0)
+        , _capacity(0)
+        , _inlineBuffer(NULL)
+        , _inlineCapacity(0)
+    {
+        Move(c);
+    }
+
+    /**
+     * @brief   代入演算子のオーバーロード<br>
+     *           要素数がキャパシティに収まる場合は領域を再利用する。
      *
      * @param[in]   c   ->  csmVector<T>のインスタンス
      */
@@ -507,43 +581,266 @@ public:
     {
         if (this != &c)
         {
-            Clear();
+            if (c._size <= _capacity)
+            {
+                ClearElements();
+            }
+            else
+            {
+                Clear();
+            }
             Copy(c);
         }
 
         return *this;
     }
 
+    /**
+     * @brief   ムーブ代入演算子のオーバーロード
+     *
+     * @param[in]   c   ->  csmVector<T>のインスタンス。空になる
+     */
+    csmVector& operator=(csmVector&& c)
+    {
+        if (this != &c)
+        {
+            Clear();
+            Move(c);
+        }
+
+        return *this;
+    }
+
+protected:
+    /**
+     * @brief   内部バッファ付きのコンストラクタ（csmInlineVector用）<br>
+     *           要素数がinlineCapacity以下の間は、確保せずに内部バッファを使う。
+     *
+     * @param[in]   inlineBuffer    ->  内部バッファ
+     * @param[in]   inlineCapacity  ->  内部バッファのキャパシティ
+     */
+    csmVector(T* inlineBuffer, csmInt32 inlineCapacity)
+        : _ptr(inlineBuffer)
+        , _size(0)
+        , _capacity(inlineCapacity)
+        , _inlineBuffer(inlineBuffer)
+        , _inlineCapacity(inlineCapacity)
+    { }
+
 private:
     static const csmInt32 s_defaultSize = 10;   ///< コンテナ初期化のデフォルトサイズ
 
     /**
-     * @brief   csmVector<T>のコピー関数
+     * @brief   csmVector<T>のコピー関数。要素が空の状態で呼ぶ
      *
      * @param[in]   c   ->  csmVector<T>のインスタンス
      */
     void Copy(const csmVector& c)
     {
+        PrepareCapacity(c._size);
+
+        if (std::is_trivially_copyable<T>::value)
+        {
+            if (c._size > 0)
+            {
+                memcpy(static_cast<void*>(_ptr), static_cast<const void*>(c._ptr), sizeof(T) * c._size);
+            }
+        }
+        else
+        {
+            for (csmInt32 i = 0; i < c._size; ++i)
+            {
+                CSM_PLACEMENT_NEW(&_ptr[i]) T(c._ptr[i]);
+            }
+        }
+
         _size = c._size;
-        _capacity = c._capacity;
+    }
+
+    /**
+     * @brief   csmVector<T>のムーブ関数。要素が空の状態で呼ぶ<br>
+     *           確保済みの領域はそのまま引き継ぎ、内部バッファの要素は移動する。
+     *
+     * @param[in]   c   ->  csmVector<T>のインスタンス。空になる
+     */
+    void Move(csmVector& c)
+    {
+        if (c._ptr != c._inlineBuffer)
+        {
+            _ptr = c._ptr;
+            _size = c._size;
+            _capacity = c._capacity;
+
+            c._ptr = c._inlineBuffer;
+            c._size = 0;
+            c._capacity = c._inlineCapacity;
+        }
+        else
+        {
+            PrepareCapacity(c._size);
+            Relocate(_ptr, c._ptr, c._size);
+            _size = c._size;
+            c._size = 0;
+        }
+    }
 
-        if (c._capacity == 0)
+    /**
+     * @brief   要素を別の領域に移動する。移動元の要素は破棄される
+     *
+     * @param[in]   dst     ->  移動先（未構築の領域）
+     * @param[in]   src     ->  移動元
+     * @param[in]   count   ->  要素数
+     */
+    static void Relocate(T* dst, T* src, csmInt32 count)
+    {
+        if (std::is_trivially_copyable<T>::value)
         {
-            _ptr = NULL;
+            if (count > 0)
+            {
+                memcpy(static_cast<void*>(dst), static_cast<const void*>(src), sizeof(T) * count);
+            }
             return;
         }
 
-        _ptr = (T*)CSM_MALLOC(_capacity * sizeof(T));
+        for (csmInt32 i = 0; i < count; ++i)
+        {
+            CSM_PLACEMENT_NEW(&dst[i]) T(std::move(src[i]));
+            src[i].~T();
+        }
+    }
 
-        for (csmInt32 i = 0; i < _size; ++i)
+    /**
+     * @brief   コンテナの領域を差し替える。既存の要素は新しい領域に移動する
+     *
+     * @param[in]   buffer      ->  新しい領域
+     * @param[in]   capacity    ->  新しい領域のキャパシティ
+     */
+    void AdoptBuffer(T* buffer, csmInt32 capacity)
+    {
+        Relocate(buffer, _ptr, _size);
+
+        if (_ptr != NULL && _ptr != _inlineBuffer)
+        {
+            CSM_FREE(_ptr);
+        }
+
+        _ptr = buffer;
+        _capacity = capacity;
+    }
+
+    /**
+     * @brief   コンテナの末尾に要素を構築する。キャパシティが足りなければ倍に拡張する
+     *
+     * @param[in]   args    -> Tのコンストラクタの引数
+     * @return      構築した要素
+     */
+    template<class... Args>
+    T& ConstructBack(Args&&... args)
+    {
+        if (_size < _capacity)
         {
-            CSM_PLACEMENT_NEW(&_ptr[i]) T(c._ptr[i]);
+            CSM_PLACEMENT_NEW(&_ptr[_size]) T(std::forward<Args>(args)...);
+            return _ptr[_size++];
         }
+
+        const csmInt32 capacity = (_capacity == 0) ? s_defaultSize : _capacity * 2;
+        T* buffer = static_cast<T*>(CSM_MALLOC(sizeof(T) * capacity));
+
+        CSM_ASSERT(buffer != NULL);
+
+        // 引数がコンテナ内の要素を参照している場合に備え、既存の要素を移動する前に構築する
+        CSM_PLACEMENT_NEW(&buffer[_size]) T(std::forward<Args>(args)...);
+        AdoptBuffer(buffer, capacity);
+
+        return _ptr[_size++];
+    }
+
+    T* _ptr;                    ///< コンテナの先頭アドレス（ポインタ）
+    csmInt32 _size;             ///< コンテナの要素数（サイズ）
+    csmInt32 _capacity;         ///< コンテナのキャパシティ
+    T* _inlineBuffer;           ///< 内部バッファ（csmInlineVector以外はNULL）
+    csmInt32 _inlineCapacity;   ///< 内部バッファのキャパシティ
+};
+
+/**
+ * @brief   内部バッファ付きのベクター型<br>
+ *           要素数がN以下の間はメモリを確保しない。毎フレーム作り直す短いリスト用。
+ *           Nを超えた場合は csmVector と同様にヒープに確保する。
+ *
+ */
+template<class T, csmInt32 N>
+class csmInlineVector : public csmVector<T>
+{
+public:
+    /**
+     * @brief   コンストラクタ
+     */
+    csmInlineVector()
+        : csmVector<T>(reinterpret_cast<T*>(_storage), N)
+    { }
+
+    /**
+     * @brief   コピーコンストラクタ
+     *
+     * @param[in]   c   ->  コピー元
+     */
+    csmInlineVector(const csmVector<T>& c)
+        : csmVector<T>(reinterpret_cast<T*>(_storage), N)
+    {
+        csmVector<T>::operator=(c);
+    }
+
+    /**
+     * @brief   コピーコンストラクタ
+     *
+     * @param[in]   c   ->  コピー元
+     */
+    csmInlineVector(const csmInlineVector& c)
+        : csmVector<T>(reinterpret_cast<T*>(_storage), N)
+    {
+        csmVector<T>::operator=(c);
+    }
+
+    /**
+     * @brief   ムーブコンストラクタ
+     *
+     * @param[in]   c   ->  ムーブ元。空になる
+     */
+    csmInlineVector(csmInlineVector&& c)
+        : csmVector<T>(reinterpret_cast<T*>(_storage), N)
+    {
+        csmVector<T>::operator=(std::move(c));
+    }
+
+    /**
+     * @brief   デストラクタ
+     */
+    virtual ~csmInlineVector()
+    {
+        // 内部バッファが破棄される前に要素を破棄する
+        this->Clear();
+    }
+
+    /**
+     * @brief   代入演算子のオーバーロード
+     */
+    csmInlineVector& operator=(const csmInlineVector& c)
+    {
+        csmVector<T>::operator=(c);
+        return *this;
+    }
+
+    /**
+     * @brief   ムーブ代入演算子のオーバーロード
+     */
+    csmInlineVector& operator=(csmInlineVector&& c)
+    {
+        csmVector<T>::operator=(std::move(c));
+        return *this;
     }
 
-    T* _ptr;                ///< コンテナの先頭アドレス（ポインタ）
-    csmInt32 _size;         ///< コンテナの要素数（サイズ）
-    csmInt32 _capacity;     ///< コンテナのキャパシティ
+private:
+    alignas(T) csmUint8 _storage[sizeof(T) * N];  ///< 内部バッファ
 };
 
 //========================テンプレートの定義==============================
@@ -553,10 +850,14 @@ csmVector<T>::csmVector()
     : _ptr(NULL)
     , _size(0)
     , _capacity(0)
+    , _inlineBuffer(NULL)
+    , _inlineCapacity(0)
 { }
 
 template<class T>
 csmVector<T>::csmVector(csmInt32 initialCapacity, csmBool zeroClear)
+    : _inlineBuffer(NULL)
+    , _inlineCapacity(0)
 {
     if (initialCapacity < 1)
     {
@@ -589,15 +890,10 @@ csmVector<T>::~csmVector()
 template<class T>
 void csmVector<T>::PushBack(const T& value, csmBool callPlacementNew)
 {
-    if (_size >= _capacity)
-    {
-        PrepareCapacity(_capacity == 0 ? s_defaultSize : _capacity * 2);
-    }
-
-    // placement new 指定のアドレスに、実体を生成する
-    if (callPlacementNew)
+    if (_size >= _capacity || callPlacementNew)
     {
-        CSM_PLACEMENT_NEW(&_ptr[_size++]) T(value);
+        // placement new 指定のアドレスに、実体を生成する
+        ConstructBack(value);
     }
     else
     {
@@ -605,37 +901,22 @@ void csmVector<T>::PushBack(const T& value, csmBool callPlacementNew)
     }
 }
 
+template<class T>
+void csmVector<T>::PushBack(T&& value)
+{
+    ConstructBack(std::move(value));
+}
+
 template<class T>
 void csmVector<T>::PrepareCapacity(csmInt32 newSize)
 {
     if (newSize > _capacity)
     {
-        if (_capacity == 0)
-        {
-            _ptr = static_cast<T *>(CSM_MALLOC(sizeof(T) * newSize));
-
-            CSM_ASSERT(_ptr != NULL);
-
-            _capacity = newSize;
-        }
-        else
-        {
-            csmInt32 tmp_capacity = newSize;
-            T* tmp = static_cast<T *>(CSM_MALLOC(sizeof(T) * tmp_capacity));
-            csmInt32 tmp_size = _size;
-
-            CSM_ASSERT(tmp != NULL);
+        T* tmp = static_cast<T *>(CSM_MALLOC(sizeof(T) * newSize));
 
-            for (csmInt32 i = 0; i < _size; i++)
-            {
-                CSM_PLACEMENT_NEW(&tmp[i]) T(_ptr[i]);
-            }
-            Clear();
+        CSM_ASSERT(tmp != NULL);
 
-            _ptr = tmp;
-            _capacity = newSize;
-            _size = tmp_size;
-        }
+        AdoptBuffer(tmp, newSize);
     }
 }
 
@@ -649,12 +930,26 @@ void csmVector<T>::Clear()
             _ptr[i].~T();
         }
 
-        CSM_FREE(_ptr);
+        if (_ptr != _inlineBuffer)
+        {
+            CSM_FREE(_ptr);
+        }
+    }
+
+    _ptr = _inlineBuffer;
+    _size = 0;
+    _capacity = _inlineCapacity;
+}
+
+template<class T>
+void csmVector<T>::ClearElements()
+{
+    for (csmInt32 i = 0; i < _size; i++)
+    {
+        _ptr[i].~T();
     }
 
-    _ptr = NULL;
     _size = 0;
-    _capacity = 0;
 }
 
 template<class T>
@@ -750,7 +1045,7 @@ void csmVector<T>::Insert(iterator position, iterator begin, iterator end, csmBo
     {
         for (csmInt32 i = src_si; i < src_ei; i++, dst_si++)
         {
-            CSM_PLACEMENT_NEW(&_ptr[i]) T(begin._vector->_ptr[i]);
+            CSM_PLACEMENT_NEW(&_ptr[dst_si]) T(begin._vector->_ptr[i]);
         }
     }
     else
@@ -1,4 +1,4 @@
-﻿/**
+/**
  * Copyright(c) Live2D Inc. All rights reserved.
  *
  * Use of this source code is governed by the Live2D Open Software license
@@ -6,15 +6,760 @@
  */
 
 #include "CubismJson.hpp"
-#include <stdlib.h>
+#include <math.h>
+#include <new>
 #include "Type/csmString.hpp"
 #include "CubismDebug.hpp"
 
-using namespace std; // for strtof
-
 //------------ LIVE2D NAMESPACE ------------
 namespace Live2D { namespace Cubism { namespace Framework { namespace Utils {
 
+/**
+ * @brief   パース結果の要素を確保するアリーナ<br>
+ *           チャンクの先頭から順に切り出し、個別には解放せずにデストラクタで一括解放する。
+ */
+class CubismJsonArena
+{
+public:
+    /**
+     * @brief   引数付きコンストラクタ
+     *
+     * @param[in]   chunkSize   ->  最初のチャンクのサイズ。以降のチャンクは倍々に大きくする。
+     */
+    explicit CubismJsonArena(csmSizeInt chunkSize)
+        : _chunks(NULL)
+        , _cursor(NULL)
+        , _end(NULL)
+        , _chunkSize(chunkSize)
+    { }
+
+    /**
+     * @brief   デストラクタ
+     */
+    ~CubismJsonArena()
+    {
+        while (_chunks)
+        {
+            Chunk* next = _chunks->Next;
+            CSM_FREE(_chunks);
+            _chunks = next;
+        }
+    }
+
+    /**
+     * @brief   メモリを確保する
+     *
+     * @param[in]   size    ->  確保するサイズ
+     * @return  Alignment境界に揃えた領域
+     */
+    void* Allocate(csmSizeInt size)
+    {
+        size = (size + Alignment - 1) & ~(Alignment - 1);
+        if (static_cast<csmSizeInt>(_end - _cursor) < size)
+        {
+            const csmSizeInt chunkSize = (size + HeaderSize > _chunkSize) ? size + HeaderSize : _chunkSize;
+            Chunk* chunk = static_cast<Chunk*>(CSM_MALLOC(chunkSize));
+            chunk->Next = _chunks;
+            _chunks = chunk;
+            _cursor = reinterpret_cast<csmByte*>(chunk) + HeaderSize;
+            _end = reinterpret_cast<csmByte*>(chunk) + chunkSize;
+            _chunkSize *= 2;
+        }
+        void* ret = _cursor;
+        _cursor += size;
+        return ret;
+    }
+
+    /**
+     * @brief   配列を確保する（要素は初期化しない）
+     */
+    template<class T>
+    T* AllocateArray(csmInt32 count)
+    {
+        return count > 0 ? static_cast<T*>(Allocate(sizeof(T) * count)) : NULL;
+    }
+
+private:
+    struct Chunk
+    {
+        Chunk* Next;
+    };
+
+    static const csmSizeInt Alignment = 8;
+    static const csmSizeInt HeaderSize = (sizeof(Chunk) + Alignment - 1) & ~(Alignment - 1);
+
+    Chunk*      _chunks;        ///< 確保したチャンクのリスト（新しい順）
+    csmByte*    _cursor;        ///< 現在のチャンクの未使用領域の先頭
+    csmByte*    _end;           ///< 現在のチャンクの終端
+    csmSizeInt  _chunkSize;     ///< 次に確保するチャンクのサイズ
+};
+
+namespace {
+
+const csmInt32 MaxDepth = 512;     ///< 配列・オブジェクトの入れ子の上限
+
+/// 10^0 ～ 10^22 はdoubleで正確に表現できる
+const double Pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief   再帰下降でJSONを読み、要素をハンドラへ通知する
+ *
+ * 文字列はエスケープがなければバッファ上をそのまま指す。
+ * inSituが有効な場合はバッファ上でエスケープを展開し、終端の " をNULで置き換える（DOM構築用）。
+ * 無効な場合は作業用バッファに展開する。
+ */
+template<class Handler>
+class JsonReader
+{
+public:
+    JsonReader(const csmChar* buffer, csmSizeInt size, csmBool inSitu, Handler& handler)
+        : _begin(buffer)
+        , _p(buffer)
+        , _end(buffer + size)
+        , _inSitu(inSitu)
+        , _handler(handler)
+        , _error(NULL)
+        , _errorPosition(NULL)
+        , _output(NULL)
+    { }
+
+    csmBool Parse()
+    {
+        // UTF-8 BOM
+        if (_end - _p >= 3 && static_cast<csmUint8>(_p[0]) == 0xEF
+            && static_cast<csmUint8>(_p[1]) == 0xBB && static_cast<csmUint8>(_p[2]) == 0xBF)
+        {
+            _p += 3;
+        }
+        SkipWhitespace();
+        return ParseValue(0);
+    }
+
+    const csmChar* GetError() const { return _error; }
+
+    /**
+     * @brief   エラー位置の行番号（0始まり）
+     */
+    csmInt32 GetErrorLine() const
+    {
+        csmInt32 line = 0;
+        for (const csmChar* c = _begin; c < _errorPosition; ++c)
+        {
+            if (*c == '\n') ++line;
+        }
+        return line;
+    }
+
+private:
+    csmBool SetError(const csmChar* error)
+    {
+        if (!_error)
+        {
+            _error = error;
+            _errorPosition = _p < _end ? _p : _end;
+        }
+        return false;
+    }
+
+    void SkipWhitespace()
+    {
+        while (_p < _end && (*_p == ' ' || *_p == '\n' || *_p == '\r' || *_p == '\t'))
+        {
+            ++_p;
+        }
+    }
+
+    csmBool ParseValue(csmInt32 depth)
+    {
+        if (_p >= _end)
+        {
+            return SetError("illegal end of value");
+        }
+
+        switch (*_p)
+        {
+        case '{':
+            return ParseObject(depth);
+        case '[':
+            return ParseArray(depth);
+        case '\"':
+            ++_p;
+            return ParseString(false);
+        case 't':
+            return ParseLiteral("true", 4) && (_handler.Boolean(true) || SetError("cancelled"));
+        case 'f':
+            return ParseLiteral("false", 5) && (_handler.Boolean(false) || SetError("cancelled"));
+        case 'n':
+            return ParseLiteral("null", 4) && (_handler.Null() || SetError("cancelled"));
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return ParseNumber();
+        case ',':
+            return SetError("illegal ',' position");
+        default:
+            return SetError("illegal value");
+        }
+    }
+
+    csmBool ParseObject(csmInt32 depth)
+    {
+        if (depth >= MaxDepth)
+        {
+            return SetError("nesting too deep");
+        }
+        ++_p; // {
+        if (!_handler.StartObject())
+        {
+            return SetError("cancelled");
+        }
+
+        csmInt32 count = 0;
+        SkipWhitespace();
+        while (_p < _end && *_p != '}')
+        {
+            if (*_p != '\"')
+            {
+                return SetError(*_p == ':' ? "illegal ':' position" : "key not found");
+            }
+            ++_p;
+            if (!ParseString(true))
+            {
+                return false;
+            }
+
+            SkipWhitespace();
+            if (_p >= _end || *_p != ':')
+            {
+                return SetError("':' not found");
+            }
+            ++_p;
+            SkipWhitespace();
+            if (!ParseValue(depth + 1))
+            {
+                return false;
+            }
+            ++count;
+
+            SkipWhitespace();
+            if (_p < _end && *_p == ',')
+            {
+                ++_p;
+                SkipWhitespace();
+            }
+            else if (_p < _end && *_p != '}')
+            {
+                return SetError("',' or '}' not found");
+            }
+        }
+        if (_p >= _end)
+        {
+            return SetError("illegal end of parseObject");
+        }
+        ++_p; // }
+        return _handler.EndObject(count) || SetError("cancelled");
+    }
+
+    csmBool ParseArray(csmInt32 depth)
+    {
+        if (depth >= MaxDepth)
+        {
+            return SetError("nesting too deep");
+        }
+        ++_p; // [
+        if (!_handler.StartArray())
+        {
+            return SetError("cancelled");
+        }
+
+        csmInt32 count = 0;
+        SkipWhitespace();
+        while (_p < _end && *_p != ']')
+        {
+            if (!ParseValue(depth + 1))
+            {
+                return false;
+            }
+            ++count;
+
+            SkipWhitespace();
+            if (_p < _end && *_p == ',')
+            {
+                ++_p;
+                SkipWhitespace();
+            }
+            else if (_p < _end && *_p != ']')
+            {
+                return SetError("',' or ']' not found");
+            }
+        }
+        if (_p >= _end)
+        {
+            return SetError("illegal end of parseArray");
+        }
+        ++_p; // ]
+        return _handler.EndArray(count) || SetError("cancelled");
+    }
+
+    csmBool ParseLiteral(const csmChar* literal, csmInt32 length)
+    {
+        if (_end - _p < length || memcmp(_p, literal, length) != 0)
+        {
+            return SetError("illegal literal");
+        }
+        _p += length;
+        return true;
+    }
+
+    /**
+     * @brief   開始の " の次の文字から文字列を読む
+     */
+    csmBool ParseString(csmBool isKey)
+    {
+        const csmChar* start = _p;
+        while (_p < _end && *_p != '\"' && *_p != '\\')
+        {
+            ++_p;
+        }
+        if (_p >= _end)
+        {
+            return SetError("parse string/illegal end");
+        }
+
+        if (*_p == '\"')
+        {
+            // エスケープなし：バッファをそのまま参照する
+            const csmInt32 length = static_cast<csmInt32>(_p - start);
+            if (_inSitu)
+            {
+                *const_cast<csmChar*>(_p) = '\0';
+            }
+            ++_p;
+            return Emit(isKey, start, length);
+        }
+
+        // エスケープあり：展開済みの部分を書き出してから続きを読む
+        if (_inSitu)
+        {
+            _output = const_cast<csmChar*>(_p);
+        }
+        else
+        {
+            _scratch.UpdateSize(0, '\0', false);
+            for (const csmChar* c = start; c < _p; ++c)
+            {
+                _scratch.PushBack(*c, false);
+            }
+        }
+
+        while (_p < _end)
+        {
+            const csmChar c = *_p++;
+            if (c == '\"')
+            {
+                if (_inSitu)
+                {
+                    const csmInt32 length = static_cast<csmInt32>(_output - start);
+                    *_output = '\0';
+                    return Emit(isKey, start, length);
+                }
+                return Emit(isKey, _scratch.GetPtr(), static_cast<csmInt32>(_scratch.GetSize()));
+            }
+            if (c != '\\')
+            {
+                Put(c);
+                continue;
+            }
+
+            if (_p >= _end)
+            {
+                break;
+            }
+            switch (*_p++)
+            {
+            case '\"': Put('\"'); break;
+            case '\\': Put('\\'); break;
+            case '/': Put('/'); break;
+            case 'b': Put('\b'); break;
+            case 'f': Put('\f'); break;
+            case 'n': Put('\n'); break;
+            case 'r': Put('\r'); break;
+            case 't': Put('\t'); break;
+            case 'u':
+                if (!ParseUnicodeEscape())
+                {
+                    return false;
+                }
+                break;
+            default:
+                return SetError("parse string/escape error");
+            }
+        }
+        return SetError("parse string/illegal end");
+    }
+
+    /**
+     * @brief   \\u の後の16進4桁（サロゲートペアは2組）を読み、UTF-8で書き出す
+     */
+    csmBool ParseUnicodeEscape()
+    {
+        csmUint32 code;
+        if (!ParseHex4(&code))
+        {
+            return false;
+        }
+        if (code >= 0xD800 && code <= 0xDBFF)
+        {
+            csmUint32 low;
+            if (_end - _p < 2 || _p[0] != '\\' || _p[1] != 'u')
+            {
+                return SetError("parse string/invalid unicode escape");
+            }
+            _p += 2;
+            if (!ParseHex4(&low) || low < 0xDC00 || low > 0xDFFF)
+            {
+                return SetError("parse string/invalid unicode escape");
+            }
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        else if (code >= 0xDC00 && code <= 0xDFFF)
+        {
+            return SetError("parse string/invalid unicode escape");
+        }
+
+        if (code < 0x80)
+        {
+            Put(static_cast<csmChar>(code));
+        }
+        else if (code < 0x800)
+        {
+            Put(static_cast<csmChar>(0xC0 | (code >> 6)));
+            Put(static_cast<csmChar>(0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            Put(static_cast<csmChar>(0xE0 | (code >> 12)));
+            Put(static_cast<csmChar>(0x80 | ((code >> 6) & 0x3F)));
+            Put(static_cast<csmChar>(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            Put(static_cast<csmChar>(0xF0 | (code >> 18)));
+            Put(static_cast<csmChar>(0x80 | ((code >> 12) & 0x3F)));
+            Put(static_cast<csmChar>(0x80 | ((code >> 6) & 0x3F)));
+            Put(static_cast<csmChar>(0x80 | (code & 0x3F)));
+        }
+        return true;
+    }
+
+    csmBool ParseHex4(csmUint32* outCode)
+    {
+        if (_end - _p < 4)
+        {
+            return SetError("parse string/invalid unicode escape");
+        }
+        csmUint32 code = 0;
+        for (csmInt32 i = 0; i < 4; ++i)
+        {
+            const csmChar c = *_p++;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else return SetError("parse string/invalid unicode escape");
+        }
+        *outCode = code;
+        return true;
+    }
+
+    /**
+     * @brief   数値を読む。ロケール設定にかかわらず、小数点の区切り文字を . としてパースする。
+     *
+     * 有効数字19桁までを整数として集め、10の累乗を掛けて求める。
+     * 仮数が2^53以下かつ指数が±22以内ならdoubleの1回の演算で正しく丸められる。
+     */
+    csmBool ParseNumber()
+    {
+        csmBool isNegative = false;
+        if (*_p == '-')
+        {
+            isNegative = true;
+            ++_p;
+        }
+        if (_p >= _end || *_p < '0' || *_p > '9')
+        {
+            return SetError("non-numeric charactor found");
+        }
+
+        csmUint64 mantissa = 0;
+        csmInt32 digits = 0;        // 仮数に取り込んだ有効数字の桁数
+        csmInt32 exponent = 0;
+        csmBool truncated = false;  // 20桁目以降を切り捨てたか
+
+        for (; _p < _end && *_p >= '0' && *_p <= '9'; ++_p)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*_p - '0');
+                if (mantissa) ++digits;
+            }
+            else
+            {
+                ++exponent;
+                truncated |= (*_p != '0');
+            }
+        }
+
+        if (_p < _end && *_p == '.')
+        {
+            ++_p;
+            for (; _p < _end && *_p >= '0' && *_p <= '9'; ++_p)
+            {
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 + (*_p - '0');
+                    if (mantissa) ++digits;
+                    --exponent;
+                }
+                else
+                {
+                    truncated |= (*_p != '0');
+                }
+            }
+        }
+
+        if (_p < _end && (*_p == 'e' || *_p == 'E'))
+        {
+            ++_p;
+            csmBool isNegativeExponent = false;
+            if (_p < _end && (*_p == '+' || *_p == '-'))
+            {
+                isNegativeExponent = (*_p == '-');
+                ++_p;
+            }
+            if (_p >= _end || *_p < '0' || *_p > '9')
+            {
+                return SetError("non-numeric charactor found");
+            }
+            csmInt32 value = 0;
+            for (; _p < _end && *_p >= '0' && *_p <= '9'; ++_p)
+            {
+                if (value < 100000) value = value * 10 + (*_p - '0');
+            }
+            exponent += isNegativeExponent ? -value : value;
+        }
+
+        if (_p < _end && *_p != ',' && *_p != ']' && *_p != '}'
+            && *_p != ' ' && *_p != '\n' && *_p != '\r' && *_p != '\t')
+        {
+            return SetError("non-numeric charactor found");
+        }
+
+        double value = static_cast<double>(mantissa);
+        if (mantissa == 0)
+        {
+            value = 0.0;
+        }
+        else if (!truncated && mantissa <= (static_cast<csmUint64>(1) << 53) && exponent >= -22 && exponent <= 22)
+        {
+            value = exponent < 0 ? value / Pow10[-exponent] : value * Pow10[exponent];
+        }
+        else
+        {
+            // floatへの変換には十分な精度
+            value *= pow(10.0, exponent);
+        }
+
+        return _handler.Float(static_cast<csmFloat32>(isNegative ? -value : value)) || SetError("cancelled");
+    }
+
+    void Put(csmChar c)
+    {
+        if (_inSitu)
+        {
+            *_output++ = c;
+        }
+        else
+        {
+            _scratch.PushBack(c, false);
+        }
+    }
+
+    csmBool Emit(csmBool isKey, const csmChar* s, csmInt32 length)
+    {
+        return (isKey ? _handler.Key(s, length) : _handler.String(s, length)) || SetError("cancelled");
+    }
+
+    const csmChar*      _begin;
+    const csmChar*      _p;
+    const csmChar*      _end;
+    csmBool             _inSitu;
+    Handler&            _handler;
+    const csmChar*      _error;
+    const csmChar*      _errorPosition;
+    csmChar*            _output;    ///< inSitu時のエスケープ展開先
+    csmVector<csmChar>  _scratch;   ///< inSituでない時のエスケープ展開先
+};
+
+/**
+ * @brief   JsonReaderの通知から要素のツリーをアリーナ上に作る
+ *
+ * 値は親のコンテナが閉じるまでスタックに積み、閉じた時点でアリーナの配列に移す。
+ * 文字列はinSituで読んだバッファ（アリーナ上）をそのまま参照する。
+ * 借用したバッファを読む場合、キーはバッファ上をそのまま参照し、
+ * NUL終端が必要な文字列値とエスケープを展開したキーはアリーナに複製する。
+ */
+class DomBuilder
+{
+public:
+    /**
+     * @param[in]   arena           ->  要素を確保するアリーナ
+     * @param[in]   borrowedBegin   ->  借用したバッファの先頭（inSituで読む場合はNULL）
+     * @param[in]   borrowedEnd     ->  借用したバッファの終端
+     */
+    DomBuilder(CubismJsonArena& arena, const csmChar* borrowedBegin = NULL, const csmChar* borrowedEnd = NULL)
+        : _arena(arena)
+        , _borrowedBegin(borrowedBegin)
+        , _borrowedEnd(borrowedEnd)
+        , _key(NULL)
+        , _keyLength(0)
+    { }
+
+    Value* GetRoot() { return _stack.GetSize() > 0 ? _stack[0].Item : NULL; }
+
+    csmBool StartObject() { return Open(); }
+
+    csmBool EndObject(csmInt32 memberCount)
+    {
+        Map::Entry* entries = _arena.AllocateArray<Map::Entry>(memberCount);
+        const csmInt32 start = static_cast<csmInt32>(_stack.GetSize()) - memberCount;
+        if (memberCount > 0)
+        {
+            memcpy(entries, &_stack[start], sizeof(Map::Entry) * memberCount);
+        }
+        _stack.UpdateSize(start, Map::Entry(), false);
+        return Close(new(_arena.Allocate(sizeof(Map))) Map(entries, memberCount));
+    }
+
+    csmBool StartArray() { return Open(); }
+
+    csmBool EndArray(csmInt32 elementCount)
+    {
+        Value** items = _arena.AllocateArray<Value*>(elementCount);
+        const csmInt32 start = static_cast<csmInt32>(_stack.GetSize()) - elementCount;
+        for (csmInt32 i = 0; i < elementCount; ++i)
+        {
+            items[i] = _stack[start + i].Item;
+        }
+        _stack.UpdateSize(start, Map::Entry(), false);
+        return Close(new(_arena.Allocate(sizeof(Array))) Array(items, elementCount));
+    }
+
+    csmBool Key(const csmChar* s, csmInt32 length)
+    {
+        // 作業用バッファに展開されたキーは次の文字列で上書きされる
+        const csmBool isBorrowed = _borrowedBegin <= s && s < _borrowedEnd;
+        _key = (_borrowedBegin && !isBorrowed) ? Copy(s, length) : s;
+        _keyLength = length;
+        return true;
+    }
+
+    csmBool String(const csmChar* s, csmInt32 length)
+    {
+        const csmChar* view = _borrowedBegin ? Copy(s, length) : s;
+        return Add(new(_arena.Allocate(sizeof(Utils::String))) Utils::String(view, length));
+    }
+
+    csmBool Float(csmFloat32 value)
+    {
+        return Add(new(_arena.Allocate(sizeof(Utils::Float))) Utils::Float(value));
+    }
+
+    csmBool Boolean(csmBool value)
+    {
+        return Add(value ? Utils::Boolean::TrueValue : Utils::Boolean::FalseValue);
+    }
+
+    csmBool Null() { return Add(Value::NullValue); }
+
+private:
+    /**
+     * @brief   文字列をNUL終端してアリーナに複製する
+     */
+    const csmChar* Copy(const csmChar* s, csmInt32 length)
+    {
+        csmChar* copy = _arena.AllocateArray<csmChar>(length + 1);
+        memcpy(copy, s, length);
+        copy[length] = '\0';
+        return copy;
+    }
+
+    csmBool Add(Value* value)
+    {
+        Map::Entry entry = { _key, _keyLength, value };
+        _stack.PushBack(entry, false);
+        _key = NULL;
+        _keyLength = 0;
+        return true;
+    }
+
+    /**
+     * @brief   コンテナの開始。コンテナ自身のキーを閉じるまで退避する。
+     */
+    csmBool Open()
+    {
+        Map::Entry frame = { _key, _keyLength, NULL };
+        _frames.PushBack(frame, false);
+        _key = NULL;
+        _keyLength = 0;
+        return true;
+    }
+
+    csmBool Close(Value* container)
+    {
+        const Map::Entry& frame = _frames[_frames.GetSize() - 1];
+        _key = frame.Key;
+        _keyLength = frame.KeyLength;
+        _frames.UpdateSize(_frames.GetSize() - 1, Map::Entry(), false);
+        return Add(container);
+    }
+
+    CubismJsonArena&        _arena;
+    const csmChar*          _borrowedBegin; ///< 借用したバッファの先頭（inSituの場合はNULL）
+    const csmChar*          _borrowedEnd;   ///< 借用したバッファの終端
+    csmVector<Map::Entry>   _stack;     ///< 親が閉じていない値（配列要素のキーはNULL）
+    csmVector<Map::Entry>   _frames;    ///< 開いているコンテナのキー
+    const csmChar*          _key;       ///< 次の値のキー
+    csmInt32                _keyLength;
+};
+
+/**
+ * @brief   CubismJsonHandlerへそのまま通知する（仮想関数呼び出し）
+ */
+class SaxForwarder
+{
+public:
+    explicit SaxForwarder(CubismJsonHandler& handler) : _handler(handler) { }
+
+    csmBool StartObject() { return _handler.StartObject(); }
+    csmBool Key(const csmChar* s, csmInt32 length) { return _handler.Key(s, length); }
+    csmBool EndObject(csmInt32 memberCount) { return _handler.EndObject(memberCount); }
+    csmBool StartArray() { return _handler.StartArray(); }
+    csmBool EndArray(csmInt32 elementCount) { return _handler.EndArray(elementCount); }
+    csmBool String(const csmChar* s, csmInt32 length) { return _handler.String(s, length); }
+    csmBool Float(csmFloat32 value) { return _handler.Float(value); }
+    csmBool Boolean(csmBool value) { return _handler.Boolean(value); }
+    csmBool Null() { return _handler.Null(); }
+
+private:
+    CubismJsonHandler& _handler;
+};
+
+}
+
 //StaticInitializeNotForClientCall()で初期化する
 Boolean* Boolean::TrueValue = NULL;
 Boolean* Boolean::FalseValue = NULL;
@@ -45,31 +790,60 @@ void Value::StaticInitializeNotForClientCall()
     Value::ErrorValue = CSM_NEW Error("ERROR", true);
     Value::NullValue = CSM_NEW Utils::NullValue();
 
+    // 文字列バッファは先に確保しておく（共有されるため、使用時に確保しない）
+    Boolean::TrueValue->GetStringBuffer();
+    Boolean::FalseValue->GetStringBuffer();
+
     Value::s_dummyKeys = CSM_NEW csmVector<csmString>();
 }
 
+Value::~Value()
+{
+    if (_stringBuffer)
+    {
+        CSM_DELETE(_stringBuffer);
+    }
+}
+
+csmString& Value::GetStringBuffer()
+{
+    if (!_stringBuffer)
+    {
+        _stringBuffer = CSM_NEW csmString();
+    }
+    return *_stringBuffer;
+}
+
 CubismJson::CubismJson()
     : _error(NULL)
     , _lineCount(0)
     , _root(NULL)
+    , _arena(NULL)
 { }
 
 CubismJson::CubismJson(const csmByte* buffer, csmInt32 length)
     : _error(NULL)
     , _lineCount(0)
     , _root(NULL)
+    , _arena(NULL)
 {
     ParseBytes(buffer, length);
 }
 
 CubismJson::~CubismJson()
 {
+    // 要素はアリーナ上にあるため、デストラクタだけ呼んでアリーナごと解放する
     if (_root && !_root->IsStatic())
     {
-        CSM_DELETE(_root);
+        _root->~Value();
     }
-
     _root = NULL;
+
+    if (_arena)
+    {
+        CSM_DELETE(_arena);
+    }
+    _arena = NULL;
 }
 
 void CubismJson::Delete(CubismJson* instance)
@@ -78,10 +852,10 @@ void CubismJson::Delete(CubismJson* instance)
 }
 
 
-CubismJson* CubismJson::Create(const csmByte* buffer, csmSizeInt size)
+CubismJson* CubismJson::Create(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer)
 {
     CubismJson* json = CSM_NEW CubismJson();
-    const csmBool succeeded = json->ParseBytes(buffer, size);
+    const csmBool succeeded = json->ParseBytes(buffer, size, borrowBuffer);
 
     if (!succeeded)
     {
@@ -95,475 +869,189 @@ CubismJson* CubismJson::Create(const csmByte* buffer, csmSizeInt size)
 }
 
 
+csmBool CubismJson::ParseSax(const csmByte* buffer, csmSizeInt size, CubismJsonHandler& handler, const csmChar** outError)
+{
+    SaxForwarder forwarder(handler);
+    JsonReader<SaxForwarder> reader(reinterpret_cast<const csmChar*>(buffer), size, false, forwarder);
+    const csmBool succeeded = reader.Parse();
+
+    if (outError)
+    {
+        *outError = reader.GetError();
+    }
+    return succeeded;
+}
+
+
 Value& CubismJson::GetRoot() const
 {
     return *_root;
 }
 
 
-csmBool CubismJson::ParseBytes(const csmByte* buffer, csmInt32 size)
+csmBool CubismJson::ParseBytes(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer)
 {
-    csmInt32 endPos;
-    _root = ParseValue(reinterpret_cast<const csmChar*>(buffer), size, 0, &endPos);
+    // 要素は数値1つでも数十バイトになるため、最初のチャンクはソースの数倍を確保する
+    _arena = CSM_NEW CubismJsonArena(size * 4 + 1024);
+
+    // 借用したバッファは書き換えられないため、inSituでは読まない
+    const csmChar* source = reinterpret_cast<const csmChar*>(buffer);
+    if (!borrowBuffer)
+    {
+        // 文字列をその場で展開・NUL終端するため、ソースをアリーナへ複製して読む
+        csmChar* copy = static_cast<csmChar*>(_arena->Allocate(size + 1));
+        memcpy(copy, buffer, size);
+        copy[size] = '\0';
+        source = copy;
+    }
+
+    DomBuilder builder(*_arena, borrowBuffer ? source : NULL, borrowBuffer ? source + size : NULL);
+    JsonReader<DomBuilder> reader(source, size, !borrowBuffer, builder);
+    if (reader.Parse())
+    {
+        _root = builder.GetRoot();
+    }
+    else
+    {
+        _error = reader.GetError();
+        _lineCount = reader.GetErrorLine();
+    }
 
     if (_error)
     {
 #if defined(CSM_TARGET_WIN_GL) || defined(_MSC_VER)
         csmChar strbuf[256] = {'\0'};
-        _snprintf_s(strbuf, 256, 256, "Json parse error : @line %d\n", (_lineCount + 1));
-        _root = CSM_NEW String(strbuf);
+        _snprintf_s(strbuf, 256, 256, "Json parse error : %s @line %d\n", _error, (_lineCount + 1));
+        _root = new(_arena->Allocate(sizeof(String))) String(strbuf);
 #else
         csmChar strbuf[256] = { '\0' };
-        snprintf(strbuf, 256, "Json parse error : @line %d\n", (_lineCount + 1));
-        _root = CSM_NEW String(strbuf);
+        snprintf(strbuf, 256, "Json parse error : %s @line %d\n", _error, (_lineCount + 1));
+        _root = new(_arena->Allocate(sizeof(String))) String(strbuf);
 #endif
         CubismLogInfo("%s", _root->GetRawString());
         return false;
     }
     else if (_root == NULL)
     {
-        _root = CSM_NEW Error(_error, false); //rootは開放されるのでエラーオブジェクトを別途作る
+        _root = new(_arena->Allocate(sizeof(Error))) Error("", false); //rootは開放されるのでエラーオブジェクトを別途作る
         return false;
     }
     return true;
 }
 
 
-csmString CubismJson::ParseString(const csmChar* string, csmInt32 length, csmInt32 begin, csmInt32* outEndPos)
+const csmString& Array::GetString(const csmString& /*defaultValue*/, const csmString& indent)
 {
-    if (_error)
-    {
-        return NULL;
-    }
-
-    if (!string)
+    csmString& buffer = GetStringBuffer();
+    buffer = indent + "[\n";
+    for (csmInt32 i = 0; i < _count; ++i)
     {
-        _error = "string is null";
-        return NULL;
+        Value* v = _items[i];
+        buffer += indent + "	" + v->GetString(indent + "	") + "\n";
     }
+    buffer += indent + "]\n";
 
-    csmInt32 i = begin;
-    csmString ret;
-    csmInt32 buf_start = begin; //sbufに登録されていない文字の開始位置
-
-    for (; i < length; i++)
-    {
-        switch (string[i])
-        {
-        case '\"': {//終端の”, エスケープ文字は別に処理されるのでここにはこない
-            *outEndPos = i + 1; // ”の次の文字
-            ret.Append(static_cast<const csmChar*>(string + buf_start), (i - buf_start));
-            return ret;
-        }
-        case '\\': {//エスケープの場合
-            i++; //２文字をセットで扱う
-
-            if (i - 1 > buf_start)
-            {
-                ret.Append(static_cast<const csmChar*>(string + buf_start), (i - buf_start - 1)); //前の文字までを登録する
-            }
-            buf_start = i + 1; //エスケープ（２文字）の次の文字から
-
-            if (i < length)
-            {
-                switch (string[i])
-                {
-                case '\\': ret.Append(1, '\\');
-                    break;
-                case '\"': ret.Append(1, '\"');
-                    break;
-                case '/': ret.Append(1, '/');
-                    break;
-
-                case 'b': ret.Append(1, '\b');
-                    break;
-                case 'f': ret.Append(1, '\f');
-                    break;
-                case 'n': ret.Append(1, '\n');
-                    break;
-                case 'r': ret.Append(1, '\r');
-                    break;
-                case 't': ret.Append(1, '\t');
-                    break;
-                case 'u':
-                    _error = "parse string/unicode escape not supported";
-                default:
-                    break;
-                }
-            }
-            else
-            {
-                _error = "parse string/escape error";
-            }
-            break;
-        }
-        default: {
-            break;
-        }
-        }
-    }
-    _error = "parse string/illegal end";
-    return NULL;
+    return buffer;
 }
 
 
-Value* CubismJson::ParseNumeric(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos)
+csmVector<Value*>* Array::GetVector(csmVector<Value*>* /*defaultValue*/)
 {
-    if (_error)
-    {
-        return NULL;
-    }
-
-    if (!buffer)
-    {
-        _error = "buffer is null";
-        return NULL;
-    }
-
-    csmFloat32 ret = 0.0f;
-    csmInt32 i = begin;
-    csmBool decimalPointSeen = false;
-    csmBool isNegative = false;
-    csmFloat32 decimalMultiplier = 0.1f;
-
-    // 改行もしくは区切り文字に当たるまで読み込む
-    for (; i < length; i++)
+    if (!_array)
     {
-        switch (buffer[i])
+        _array = CSM_NEW csmVector<Value*>(_count > 0 ? _count : 1);
+        for (csmInt32 i = 0; i < _count; ++i)
         {
-        case '-':
-            {
-                isNegative = true;
-                break;
-            }
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            {
-                csmInt32 digit = buffer[i] - '0';
-
-                if (!decimalPointSeen)  // 整数部分構築
-                {
-                    ret = ret * 10 + digit;
-                }
-                else  // 小数部分構築
-                {
-                    ret += digit * decimalMultiplier;
-                    decimalMultiplier *= 0.1f;
-                }
-                break;
-            }
-        case '.':  // . 小数点記号チェック
-            {
-                if (decimalPointSeen)
-                {
-                    _error = "multiple decimal points found";
-                    return NULL;
-                }
-                decimalPointSeen = true;
-                break;
-            }
-        case '\n': case ',':  // 終端には改行文字か、区切り文字の , が来る
-            {
-                *outEndPos = i;
-                if (isNegative)  // 負数処理
-                {
-                    ret *= -1;
-                }
-                return CSM_NEW Float(ret);
-            }
-        case '\r': break;  // CRLF スキップ用
-        default:
-            {
-                _error = "non-numeric charactor found";
-                return NULL;
-            }
+            _array->PushBack(_items[i], false);
         }
     }
-
-    _error = "parse numeric/illegal end";
-    return NULL;
+    return _array;
 }
 
 
-Value* CubismJson::ParseObject(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos)
+Array::~Array()
 {
-    if (_error)
-    {
-        return NULL;
-    }
-
-    if (!buffer)
-    {
-        _error = "buffer is null";
-        return NULL;
-    }
-
-    Map* ret = CSM_NEW Map();
-
-    //key : value ,
-    csmString key;
-    csmInt32 i = begin;
-    csmInt32 local_ret_endpos2[1];
-    csmBool ok = false;
-
-    // , が続く限りループ
-    for (; i < length; i++)
+    for (csmInt32 i = 0; i < _count; ++i)
     {
-        for (; i < length; i++)
-        {
-            switch (buffer[i])
-            {
-            case '\"':
-                key = ParseString(buffer, length, i + 1, local_ret_endpos2);
-                if (_error) return NULL;
-                i = local_ret_endpos2[0];
-                ok = true;
-                goto BREAK_LOOP1; //-- loopから出る
-            case '}': //閉じカッコ
-                *outEndPos = i + 1;
-                return ret; //空
-            case ':':
-                _error = "illegal ':' position";
-                break;
-            case '\n': _lineCount++;
-            default: break; //スキップする文字
-            }
-        }
-    BREAK_LOOP1:
-        if (!ok)
-        {
-            _error = "key not found";
-            return NULL;
-        }
-
-        ok = false;
-
-        // : をチェック
-        for (; i < length; i++)
-        {
-            switch (buffer[i])
-            {
-            case ':': ok = true;
-                i++;
-                goto BREAK_LOOP2; //-- loopから出る
-
-            case '}':
-                _error = "illegal '}' position";
-                break;
-            case '\n': _lineCount++;
-                //case ' ': case '\t': case '\r':
-            default: break; //スキップする文字
-            }
-        }
-    BREAK_LOOP2:
-
-        if (!ok)
-        {
-            _error = "':' not found";
-            return NULL;
-        }
-
-        // 値をチェック
-        Value* value = ParseValue(buffer, length, i, local_ret_endpos2);
-        if (_error)
-        {
-            return NULL;
-        }
-        i = local_ret_endpos2[0];
-        // ret.put( key , value ) ;
-        ret->Put(key, value);
-
-        for (; i < length; i++)
+        Value* v = _items[i];
+        if (v && !v->IsStatic())
         {
-            switch (buffer[i])
-            {
-            case ',':
-                goto BREAK_LOOP3;
-            case '}':
-                *outEndPos = i + 1;
-                return ret; // << [] 正常終了 >>
-            case '\n': _lineCount++;
-                //case ' ': case '\t': case '\r':
-            default: break; //スキップ
-            }
+            v->~Value();
         }
-    BREAK_LOOP3:
-        ; //dummy
     }
 
-    _error = "illegal end of parseObject";
-    return NULL;
+    if (_array)
+    {
+        CSM_DELETE(_array);
+    }
 }
 
 
-Value* CubismJson::ParseArray(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos)
+const csmString& Map::GetString(const csmString& /*defaultValue*/, const csmString& indent)
 {
-    if (_error)
+    csmString& buffer = GetStringBuffer();
+    buffer = indent + "{\n";
+    for (csmInt32 i = 0; i < _count; ++i)
     {
-        return NULL;
+        Value* v = _entries[i].Item;
+        buffer += indent + "	" + csmString(_entries[i].Key, _entries[i].KeyLength) + " : " + v->GetString(indent + "	") + "\n";
     }
+    buffer += indent + "}\n";
+    return buffer;
+}
 
-    if (!buffer)
-    {
-        _error = "buffer is null";
-        return NULL;
-    }
-
-    Array* ret = CSM_NEW Array();
-
-    //key : value ,
-    csmInt32 i = begin;
-    csmInt32 local_ret_endpos2[1];
 
-    // , が続く限りループ
-    for (; i < length; i++)
+csmMap<csmString, Value*>* Map::GetMap(csmMap<csmString, Value*>* /*defaultValue*/)
+{
+    if (!_map)
     {
-        // : をチェック
-        Value* value = ParseValue(buffer, length, i, local_ret_endpos2);
-        if (_error)
+        // 重複したキーは後の値で上書きされ、最初に現れた位置に並ぶ
+        _map = CSM_NEW csmMap<csmString, Value*>();
+        for (csmInt32 i = 0; i < _count; ++i)
         {
-            return NULL;
+            (*_map)[csmString(_entries[i].Key, _entries[i].KeyLength)] = _entries[i].Item;
         }
-        i = local_ret_endpos2[0];
-        if (value)
-        {
-            ret->Add(value);
-        }
-
-        //FOR_LOOP3:
-        //bool breakflag = false;
-        for (; i < length; i++)
-        {
-            switch (buffer[i])
-            {
-            case ',':
-                // breakflag = true;
-                // break;//次のKEY,VALUEへ
-                goto BREAK_LOOP3;
-            case ']':
-                *outEndPos = i + 1;
-                return ret; //終了
-            case '\n': ++_lineCount;
-                //case ' ': case '\t': case '\r':
-            default: break; //スキップ
-            }
-        }
-    BREAK_LOOP3:
-        ; //dummy
     }
-
-    CSM_DELETE(ret);
-    _error = "illegal end of parseObject";
-    return NULL;
+    return _map;
 }
 
 
-Value* CubismJson::ParseValue(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos)
+csmVector<csmString>& Map::GetKeys()
 {
-    if (_error)
+    if (!_keys)
     {
-        return NULL;
-    }
-
-    if (!buffer)
-    {
-        _error = "buffer is null";
-        return NULL;
-    }
-
-    Value* o = NULL;
-    csmInt32 i = begin;
-    csmFloat32 f;
-    csmString s1; //デバッグ用に使っている
-
-    for (; i < length; i++)
-    {
-        switch (buffer[i])
+        _keys = CSM_NEW csmVector<csmString>();
+        csmMap<csmString, Value*>::const_iterator ite = GetMap()->Begin();
+        while (ite != _map->End())
         {
-        case '-':
-        case '0': case '1': case '2': case '3': case '4':
-        case '5': case '6': case '7': case '8': case '9':
-            return ParseNumeric(buffer, length, i, outEndPos);
-        case '\"':
-            return CSM_NEW String(ParseString(buffer, length, i + 1, outEndPos)); //\"の次の文字から
-        case '[':
-            o = ParseArray(buffer, length, i + 1, outEndPos);
-            return o;
-        case '{':
-            o = ParseObject(buffer, length, i + 1, outEndPos);
-            return o;
-        case 'n': //null以外にない
-            if (i + 3 < length)
-            {
-                o = CSM_NEW NullValue(); //開放できるようにする
-                *outEndPos = i + 4;
-            }
-            else _error = "parse null";
-            return o;
-        case 't': //true以外にない
-            if (i + 3 < length)
-            {
-                o = Boolean::TrueValue;
-                *outEndPos = i + 4;
-            }
-            else _error = "parse true";
-            return o;
-        case 'f': //false以外にない
-            if (i + 4 < length)
-            {
-                o = Boolean::FalseValue;
-                *outEndPos = i + 5;
-            }
-            else _error = "parse false";
-            return o;
-        case ',': //Array separator
-            _error = "illegal ',' position";
-            return NULL;
-        case ']': //不正な}だがスキップする。配列の最後に不要な , があると思われる
-            *outEndPos = i; //同じ文字を再処理
-            return NULL;
-        case '\n': _lineCount++;
-        case ' ': case '\t': case '\r':
-        default: //スキップ
-            break;
-        }
-    }
-
-    _error = "illegal end of value";
-    return NULL;
+            const csmString& key = (*ite).First;
+            _keys->PushBack(key, true);
+            ++ite;
+        }
+    }
+    return *_keys;
 }
 
 
 Map::~Map()
 {
-    csmMap<csmString, Value*>::const_iterator ite = _map.Begin();
-    while (ite != _map.End())
+    for (csmInt32 i = 0; i < _count; ++i)
     {
-        Value* v = (*ite).Second;
+        Value* v = _entries[i].Item;
         if (v && !v->IsStatic())
         {
-            CSM_DELETE(v);
+            v->~Value();
         }
-        ++ite;
     }
 
-    if (_keys)
+    if (_map)
     {
-        CSM_DELETE(_keys);
+        CSM_DELETE(_map);
     }
-}
-
 
-Array::~Array()
-{
-    csmVector<Value*>::iterator ite = _array.Begin();
-    for (; ite != _array.End(); ++ite)
+    if (_keys)
     {
-        Value* v = (*ite);
-        if (v && !v->IsStatic())
-        {
-            CSM_DELETE(v);
-        }
+        CSM_DELETE(_keys);
     }
 }
 }}}}
@@ -7,6 +7,7 @@
 
 #pragma once
 #include <stdio.h>
+#include <string.h>
 #include "CubismFramework.hpp"
 #include "Type/csmVector.hpp"
 #include "Type/csmMap.hpp"
@@ -17,6 +18,7 @@ namespace Live2D { namespace Cubism { namespace Framework { namespace Utils {
 class Value;
 class Error;
 class NullValue;
+class CubismJsonArena;
 
 #define CSM_JSON_ERROR_TYPE_MISMATCH            "Error:type mismatch"
 #define CSM_JSON_ERROR_INDEX_OUT_OF_BOUNDS      "Error:index out of bounds"
@@ -39,13 +41,13 @@ public:
      * @brief   コンストラクタ
      *
      */
-    Value() {}
+    Value() : _stringBuffer(NULL) {}
 
     /**
      * @brief   デストラクタ
      *
      */
-    virtual ~Value() {}
+    virtual ~Value();
 
     /**
      * @brief   要素を文字列で返す(csmString型)
@@ -210,14 +212,23 @@ public:
      *@brief Valueにエラー値をセットする
      */
     virtual Value* SetErrorNotForClientCall(const csmChar* errorStr) {
-        this->_stringBuffer = errorStr;
+        GetStringBuffer() = errorStr;
         return NullValue;
     }
 
 protected:
-    csmString _stringBuffer;        ///< 文字列バッファ
+    /**
+     * @brief   GetString()の返り値を保持する文字列バッファ。必要になった時点で確保する。
+     *
+     */
+    csmString& GetStringBuffer();
+
+    csmString* _stringBuffer;       ///< 文字列バッファ（未使用ならNULL）
 
 private:
+    Value(const Value&);
+    Value& operator=(const Value&);
+
     static csmVector<csmString>* s_dummyKeys;    ///< ダミーキー
 
     /**
@@ -234,26 +245,55 @@ private:
 };
 
 /**
- * @brief   Ascii文字のみ対応した最小限の軽量JSONパーサ。<br>
- *           仕様はJSONのサブセットとなる。<br>
+ * @brief   JSONのSAX形式パースで呼び出されるハンドラ<br>
+ *           各関数でfalseを返すとパースを中断する。<br>
+ *           文字列の引数は呼び出し中のみ有効で、NUL終端されているとは限らない。
+ */
+class CubismJsonHandler
+{
+public:
+    /**
+     * @brief   デストラクタ
+     */
+    virtual ~CubismJsonHandler() {}
+
+    virtual csmBool StartObject() { return true; }                                      ///< { の開始
+    virtual csmBool Key(const csmChar* /*s*/, csmInt32 /*length*/) { return true; }     ///< オブジェクトのキー
+    virtual csmBool EndObject(csmInt32 /*memberCount*/) { return true; }                ///< } の終了
+    virtual csmBool StartArray() { return true; }                                       ///< [ の開始
+    virtual csmBool EndArray(csmInt32 /*elementCount*/) { return true; }                ///< ] の終了
+    virtual csmBool String(const csmChar* /*s*/, csmInt32 /*length*/) { return true; }  ///< 文字列値
+    virtual csmBool Float(csmFloat32 /*value*/) { return true; }                        ///< 数値
+    virtual csmBool Boolean(csmBool /*value*/) { return true; }                         ///< 真偽値
+    virtual csmBool Null() { return true; }                                             ///< null
+};
+
+/**
+ * @brief   軽量JSONパーサ。<br>
  *           設定ファイル(model3.json)などのロード用<br>
  *           <br>
- *           [未対応項目]<br>
- *           ・日本語などの非ASCII文字<br>
- *           ・e による指数表現
+ *           パース結果の要素はインスタンスが持つアリーナに確保され、一括で解放される。<br>
+ *           文字列はアリーナに複製したバッファ上でその場で展開して参照するため、要素ごとの確保は行わない。<br>
+ *           バッファを借用する場合は複製せず、キーはバッファ上を参照し、文字列値だけをアリーナに複製する。<br>
+ *           数値は指数表現にも対応し、ロケール設定にかかわらず小数点の区切り文字を . としてパースする。<br>
+ *           配列・オブジェクト末尾の余分な , は許容する。
  */
 class CubismJson
 {
 public:
     /**
      * @brief  バイトデータから直接ロードしてパースする<br>
-     *          引数 buffer は外部で管理（破棄）する必要がある
-     *
-     * @param   buffer  ->  バイトデータのバッファ
-     * @param   size    ->  バッファサイズ
+     *          引数 buffer は外部で管理（破棄）する必要がある。<br>
+     *          borrowBuffer が false の場合はアリーナへ複製して読むため、パース後すぐに破棄してよい。<br>
+     *          true の場合は複製せずに読み、オブジェクトのキーは buffer 上を参照するため、
+     *          インスタンスを破棄するまで buffer を保持する必要がある。文字列値はアリーナに複製する。
+     *
+     * @param   buffer          ->  バイトデータのバッファ
+     * @param   size            ->  バッファサイズ
+     * @param   borrowBuffer    ->  bufferを複製せずに参照するならtrue
      * @return  CubismJsonクラスのインスタンス。失敗したらNULL。
      */
-    static CubismJson* Create(const csmByte* buffer, csmSizeInt size);
+    static CubismJson* Create(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer = false);
 
     /**
     * @brief   パースしたJSONオブジェクトの解放処理
@@ -263,6 +303,19 @@ public:
     */
     static void Delete(CubismJson* instance);
 
+    /**
+     * @brief   バイトデータをSAX形式でパースする<br>
+     *           要素のツリーを作らずにハンドラへ順に通知する。
+     *
+     * @param[in]   buffer      ->  バイトデータのバッファ
+     * @param[in]   size        ->  バッファサイズ
+     * @param[in]   handler     ->  通知先のハンドラ
+     * @param[out]  outError    ->  失敗時のエラー内容（NULL可）
+     * @retval      true    ->  成功
+     * @retval      false   ->  失敗、またはハンドラによる中断
+     */
+    static csmBool ParseSax(const csmByte* buffer, csmSizeInt size, CubismJsonHandler& handler, const csmChar** outError = NULL);
+
     /**
      * @brief   パースしたJSONのルート要素のポインタを返す
      *
@@ -285,68 +338,13 @@ protected:
     /**
      * @brief JSONのパースを実行する
      *
-     * @param[in]   buffer  ->  パース対象のデータバイト
-     * @param[in]   size    ->  データバイトのサイズ
+     * @param[in]   buffer          ->  パース対象のデータバイト
+     * @param[in]   size            ->  データバイトのサイズ
+     * @param[in]   borrowBuffer    ->  bufferを複製せずに参照するならtrue
      * @retval      true    ->  成功
      * @retval      false   ->  失敗
      */
-    csmBool ParseBytes(const csmByte* buffer, csmInt32 size);
-
-    /**
-     * @brief   次の「"」までの文字列をパースする。文字列は外部で解放する必要がある。
-     *
-     * @param[in]   string  ->  パース対象の文字列
-     * @param[in]   length  ->  パースする長さ
-     * @param[in]   begin   ->  パースを開始する位置
-     * @param[out]  outEndPos   ->  パース終了時の位置
-     * @return      パースした文字列要素
-     */
-    csmString ParseString(const csmChar* string, csmInt32 length, csmInt32 begin, csmInt32* outEndPos);
-
-    /**
-     * @brief   数値をパースする。ロケール設定にかかわらず、小数点の区切り文字を . としてパースする。
-     *
-     * @param[in]   buffer  ->  JSONエレメントのバッファ
-     * @param[in]   length  ->  パースする長さ
-     * @param[in]   begin   ->  パースを開始する位置
-     * @param[out]  outEndPos   ->  パース終了時の位置
-     * @return      パースから取得したValueオブジェクト
-     */
-    Value* ParseNumeric(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos);
-
-    /**
-     * @brief   JSONのオブジェクトエレメントをパースしてValueオブジェクトを返す
-     *
-     * @param[in]   buffer  ->  JSONエレメントのバッファ
-     * @param[in]   length  ->  パースする長さ
-     * @param[in]   begin   ->  パースを開始する位置
-     * @param[out]  outEndPos   ->  パース終了時の位置
-     * @return      パースから取得したValueオブジェクト
-     */
-    Value* ParseObject(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos);
-
-    /**
-     * @brief   JSONの配列エレメントをパースしてValueオブジェクトを返す
-     *
-     * @param[in]   buffer  ->  JSONエレメントのバッファ
-     * @param[in]   length  ->  パースする長さ
-     * @param[in]   begin   ->  パースを開始する位置
-     * @param[out]  outEndPos   ->  パース終了時の位置
-     * @return      パースから取得したValueオブジェクト
-     */
-    Value* ParseArray(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos);
-
-    /**
-     * @brief   JSONエレメントからValue(float,String,Value*,Array,null,true,false)をパースする<br>
-     *           エレメントの書式に応じて内部でParseString(), ParseObject(), ParseArray()を呼ぶ<br>
-     *
-     * @param[in]   buffer  ->  JSONエレメントのバッファ
-     * @param[in]   length  ->  パースする長さ
-     * @param[in]   begin   ->  パースを開始する位置
-     * @param[out]  outEndPos   ->  パース終了時の位置
-     * @return      パースから取得したValueオブジェクト
-     */
-    Value* ParseValue(const csmChar* buffer, csmInt32 length, csmInt32 begin, csmInt32* outEndPos);
+    csmBool ParseBytes(const csmByte* buffer, csmSizeInt size, csmBool borrowBuffer = false);
 
 private:
     /**
@@ -368,9 +366,10 @@ private:
     */
     virtual ~CubismJson();
 
-    const csmChar*  _error;         ///< パース時のエラー
-    csmInt32        _lineCount;     ///< エラー報告に用いる行数カウント
-    Value*          _root;          ///< パースされたルート要素
+    const csmChar*      _error;         ///< パース時のエラー
+    csmInt32            _lineCount;     ///< エラー報告に用いる行数カウント
+    Value*              _root;          ///< パースされたルート要素
+    CubismJsonArena*    _arena;         ///< 要素と文字列を確保するアリーナ
 };
 
 
@@ -407,14 +406,14 @@ public:
 #if defined(CSM_TARGET_WIN_GL) || defined(_MSC_VER)
         csmChar strbuf[32] = {'\0'};
         _snprintf_s(strbuf, 32, 32, "%f", this->_value);
-        _stringBuffer = csmString(strbuf);
-        return _stringBuffer;
+        GetStringBuffer() = csmString(strbuf);
+        return *_stringBuffer;
 #else
         // string stream 未対応
         csmChar strbuf[32] = { '\0' };
         snprintf(strbuf, 32, "%f", this->_value);
-        _stringBuffer = csmString(strbuf);
-        return _stringBuffer;
+        GetStringBuffer() = csmString(strbuf);
+        return *_stringBuffer;
 #endif
     }
 
@@ -491,8 +490,8 @@ public:
      */
     virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
     {
-        _stringBuffer = csmString(_boolValue ? "true" : "false");
-        return _stringBuffer;
+        GetStringBuffer() = csmString(_boolValue ? "true" : "false");
+        return *_stringBuffer;
     }
 
     /**
@@ -544,12 +543,26 @@ public:
     /**
      * @brief   引数付きコンストラクタ
      */
-    String(const csmString& s) : Value() { this->_stringBuffer = s; }
+    String(const csmString& s) : Value()
+                               , _view(NULL)
+                               , _viewLength(0) { GetStringBuffer() = s; }
 
     /**
      * @brief   引数付きコンストラクタ
      */
-    String(const csmChar* s) : Value() { this->_stringBuffer = s; }
+    String(const csmChar* s) : Value()
+                             , _view(NULL)
+                             , _viewLength(0) { GetStringBuffer() = s; }
+
+    /**
+     * @brief   文字列を複製せずに参照するコンストラクタ
+     *
+     * @param[in]   s       ->  NUL終端された文字列。要素より長く保持されている必要がある。
+     * @param[in]   length  ->  文字列の長さ
+     */
+    String(const csmChar* s, csmInt32 length) : Value()
+                                              , _view(s)
+                                              , _viewLength(length) {}
 
     /**
      * @brief   デストラクタ
@@ -566,18 +579,37 @@ public:
      */
     virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
     {
-        return _stringBuffer;
+        if (_view && !_stringBuffer)
+        {
+            GetStringBuffer() = csmString(_view, _viewLength);
+        }
+        return GetStringBuffer();
+    }
+
+    /**
+     * @brief   要素を文字列で返す(csmChar*)
+     *
+     */
+    virtual const csmChar* GetRawString(const csmString& /*defaultValue*/ = "", const csmString& /*indent*/ = "")
+    {
+        return _view ? _view : GetStringBuffer().GetRawString();
     }
 
     /**
      *@brief 引数の値と等しければtrue。
      */
-    virtual csmBool Equals(const csmString& v) { return (_stringBuffer == v); }
+    virtual csmBool Equals(const csmString& v)
+    {
+        return _view ? EqualsView(v.GetRawString(), v.GetLength()) : (*_stringBuffer == v);
+    }
 
     /**
      *@brief 引数の値と等しければtrue。
      */
-    virtual csmBool Equals(const csmChar* v) { return (_stringBuffer == v); }
+    virtual csmBool Equals(const csmChar* v)
+    {
+        return _view ? EqualsView(v, static_cast<csmInt32>(strlen(v))) : (*_stringBuffer == v);
+    }
 
     /**
      *@brief 引数の値と等しければtrue。
@@ -593,6 +625,15 @@ public:
      *@brief 引数の値と等しければtrue。
      */
     virtual csmBool Equals(csmBool v) { return false; }
+
+private:
+    csmBool EqualsView(const csmChar* v, csmInt32 length) const
+    {
+        return length == _viewLength && memcmp(_view, v, length) == 0;
+    }
+
+    const csmChar*  _view;          ///< 参照している文字列（複製を持つ場合はNULL）
+    csmInt32        _viewLength;    ///< 参照している文字列の長さ
 };
 
 
@@ -617,7 +658,7 @@ public:
     */
     virtual Value* SetErrorNotForClientCall(const csmChar* s)
     {
-        this->_stringBuffer = s;
+        GetStringBuffer() = s;
         return this;
     }
 
@@ -666,7 +707,7 @@ public:
      */
     virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
     {
-        return _stringBuffer;
+        return GetStringBuffer();
     }
 
     /**
@@ -678,22 +719,28 @@ private:
     /**
      * @brief    コンストラクタ
      */
-    NullValue() : Value() { _stringBuffer = "NullValue"; }
+    NullValue() : Value() { GetStringBuffer() = "NullValue"; }
 };
 
 
 /**
- * @brief   パースしたJSONの要素を配列として持つ
+ * @brief   パースしたJSONの要素を配列として持つ<br>
+ *           要素の配列はCubismJsonのアリーナに確保されたものを参照する。
  *
  */
 class Array : public Value
 {
 public:
     /**
-     * @brief    コンストラクタ
+     * @brief    引数付きコンストラクタ
+     *
+     * @param[in]   items   ->  要素の配列
+     * @param[in]   count   ->  要素の数
      */
-    Array() : Value()
-            , _array() {}
+    Array(Value** items, csmInt32 count) : Value()
+                                         , _items(items)
+                                         , _count(count)
+                                         , _array(NULL) {}
 
     /**
      * @brief   デストラクタ
@@ -711,9 +758,9 @@ public:
      */
     virtual Value& operator[](csmInt32 index)
     {
-        if (index < 0 || (static_cast<csmInt32>(_array.GetSize()) <= index))
+        if (index < 0 || _count <= index)
             return *(ErrorValue->SetErrorNotForClientCall(CSM_JSON_ERROR_INDEX_OUT_OF_BOUNDS));
-        Value* v = _array[index];
+        Value* v = _items[index];
 
         if (v == NULL) return *Value::NullValue;
         return *v;
@@ -741,54 +788,57 @@ public:
      * @brief   要素を文字列で返す(csmString型)
      *
      */
-    virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
-    {
-        _stringBuffer = indent + "[\n";
-        csmVector<Value*>::iterator ite = _array.Begin();
-        for (; ite != _array.End(); ite++)
-        {
-            Value* v = (*ite);
-            _stringBuffer += indent + "	" + v->GetString(indent + "	") + "\n";
-        }
-        _stringBuffer += indent + "]\n";
-
-        return _stringBuffer;
-    }
-
-    /**
-     * @brief   配列要素を追加する
-     */
-    void Add(Value* v) { _array.PushBack(v, false); }
+    virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "");
 
     /**
-     * @brief   要素をコンテナで返す(csmVector<Value*>)
+     * @brief   要素をコンテナで返す(csmVector<Value*>)<br>
+     *           初回の呼び出しでコンテナを作る。要素数だけが必要な場合はGetSize()を使う。
      *
      */
-    virtual csmVector<Value*>* GetVector(csmVector<Value*>* defaultValue = NULL) { return &_array; }
+    virtual csmVector<Value*>* GetVector(csmVector<Value*>* defaultValue = NULL);
 
     /**
      * @brief   要素の数を返す
      *
      */
-    virtual csmInt32 GetSize() { return static_cast<csmInt32>(_array.GetSize()); }
+    virtual csmInt32 GetSize() { return _count; }
 
 private:
-    csmVector<Value*> _array; ///< JSON要素の値
+    Value**             _items;     ///< JSON要素の値
+    csmInt32            _count;     ///< 要素の数
+    csmVector<Value*>*  _array;     ///< GetVector()用のコンテナ（未使用ならNULL）
 };
 
 
 /**
- * @brief   パースしたJSONの要素をマップとして持つ
+ * @brief   パースしたJSONの要素をマップとして持つ<br>
+ *           キーと値の組はCubismJsonのアリーナに確保された配列を出現順に参照する。
  *
  */
 class Map : public Value
 {
 public:
     /**
-     * @brief    コンストラクタ
+     * @brief    キーと値の組
+     */
+    struct Entry
+    {
+        const csmChar*  Key;        ///< キー（借用したバッファを指す場合はNUL終端されない）
+        csmInt32        KeyLength;  ///< キーの長さ
+        Value*          Item;       ///< 値
+    };
+
+    /**
+     * @brief    引数付きコンストラクタ
+     *
+     * @param[in]   entries ->  キーと値の組の配列
+     * @param[in]   count   ->  組の数
      */
-    Map() : Value()
-          , _keys(NULL) {}
+    Map(Entry* entries, csmInt32 count) : Value()
+                                        , _entries(entries)
+                                        , _count(count)
+                                        , _map(NULL)
+                                        , _keys(NULL) {}
 
     /**
      * @brief    デストラクタ
@@ -805,12 +855,7 @@ public:
      */
     virtual Value& operator[](const csmString& s)
     {
-        Value* ret = _map[s];
-        if (ret == NULL)
-        {
-            return *Value::NullValue;
-        }
-        return *ret;
+        return Find(s.GetRawString(), s.GetLength());
     }
 
     /**
@@ -819,19 +864,7 @@ public:
      */
     virtual Value& operator[](const csmChar* s)
     {
-        for (csmMap<csmString, Value*>::const_iterator iter = _map.Begin(); iter != _map.End(); ++iter)
-        {
-            if( strcmp(iter->First.GetRawString(), s) == 0 )
-            {
-                if(iter->Second==NULL)
-                {
-                    return *Value::NullValue;
-                }
-                return *iter->Second;
-            }
-        }
-
-        return *Value::NullValue;
+        return Find(s, static_cast<csmInt32>(strlen(s)));
     }
 
     /**
@@ -842,65 +875,45 @@ public:
         return *(ErrorValue->SetErrorNotForClientCall(CSM_JSON_ERROR_TYPE_MISMATCH));
     }
 
-    virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "")
-    {
-        _stringBuffer = indent + "{\n";
-        csmMap<csmString, Value*>::const_iterator ite = _map.Begin();
-        while (ite != _map.End())
-        {
-            const csmString& key = (*ite).First;
-            Value* v = (*ite).Second;
+    virtual const csmString& GetString(const csmString& defaultValue = "", const csmString& indent = "");
 
-            _stringBuffer += indent + "	" + key + " : " + v->GetString(indent + "	") + "\n";
-            ++ite;
-        }
-        _stringBuffer += indent + "}\n";
-        return _stringBuffer;
-    }
+    /**
+     * @brief    要素をMap型で返す<br>
+     *           初回の呼び出しでマップを作る。
+     */
+    virtual csmMap<csmString, Value*>* GetMap(csmMap<csmString, Value*>* defaultValue = NULL);
 
     /**
-     * @brief    要素をMap型で返す
+     * @brief    Mapからキーのリストを取得する
      */
-    virtual csmMap<csmString, Value*>* GetMap(csmMap<csmString, Value*>* defaultValue = NULL)
-    {
-        return &_map;
-    }
+    virtual csmVector<csmString>& GetKeys();
 
     /**
-     * @brief    Mapに要素を追加する
+     * @brief    Mapの要素数を取得する
      */
-    void Put(csmString& key, Value* v)
-    {
-        _map[key] = v;
-    }
+    virtual csmInt32 GetSize() { return _count; }
 
+private:
     /**
-     * @brief    Mapからキーのリストを取得する
+     * @brief    キーに対応する値を返す。キーが重複している場合は後のものを返す。
      */
-    virtual csmVector<csmString>& GetKeys()
+    Value& Find(const csmChar* key, csmInt32 length)
     {
-        if (!_keys)
+        for (csmInt32 i = _count - 1; i >= 0; --i)
         {
-            _keys = CSM_NEW csmVector<csmString>();
-            csmMap<csmString, Value*>::const_iterator ite = _map.Begin();
-            while (ite != _map.End())
+            const Entry& entry = _entries[i];
+            if (entry.KeyLength == length && memcmp(entry.Key, key, length) == 0)
             {
-                const csmString& key = (*ite).First;
-                _keys->PushBack(key, true);
-                ++ite;
+                return entry.Item ? *entry.Item : *Value::NullValue;
             }
         }
-        return *_keys;
+        return *Value::NullValue;
     }
 
-    /**
-     * @brief    Mapの要素数を取得する
-     */
-    virtual csmInt32 GetSize() { return static_cast<csmInt32>(_keys->GetSize()); }
-
-private:
-    csmMap<csmString, Value*> _map;     ///< JSON要素の値
-    csmVector<csmString>* _keys;        ///< JSON要素の値
+    Entry*                      _entries;   ///< JSON要素の値
+    csmInt32                    _count;     ///< 組の数
+    csmMap<csmString, Value*>*  _map;       ///< GetMap()用のマップ（未使用ならNULL）
+    csmVector<csmString>*       _keys;      ///< JSON要素の値
 };
 }}}}
 
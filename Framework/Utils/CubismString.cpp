@@ -16,30 +16,44 @@ namespace Live2D { namespace Cubism { namespace Framework { namespace Utils {
 //標準出力の戻り値が複製されるのでオーバーヘッドは大きい。
 csmString CubismString::GetFormatedString(const csmChar* format, ...)
 {
-    csmInt32 bufferSize = 256;
-    csmChar* buffer = static_cast<csmChar*>(CSM_MALLOC(sizeof(csmChar)* bufferSize));
+    // 通常の長さならスタック上のバッファで足りるため、メモリを確保しない
+    csmChar stackBuffer[256];
+    csmInt32 bufferSize = sizeof(stackBuffer);
+    csmChar* buffer = stackBuffer;
 
     va_list args;
     va_start(args, format);
 
     for (;;) {
+        // vsnprintf は va_list を消費するため、試行ごとに複製する
+        va_list copy;
+        va_copy(copy, args);
 #ifdef _WINDOWS
-        if (vsnprintf_s(buffer, bufferSize, _TRUNCATE, format, args) < bufferSize) {
+        const csmInt32 length = vsnprintf_s(buffer, bufferSize, _TRUNCATE, format, copy);
 #else
-        if (vsnprintf(buffer, bufferSize, format, args) < bufferSize) {
+        const csmInt32 length = vsnprintf(buffer, bufferSize, format, copy);
 #endif
+        va_end(copy);
+
+        if (length >= 0 && length < bufferSize) {
             break;
         } else {
             // メモリが足りない為、拡張して確保しなおす。
-            CSM_FREE(buffer);
-            bufferSize *= 2;
+            if (buffer != stackBuffer)
+            {
+                CSM_FREE(buffer);
+            }
+            bufferSize = (length >= bufferSize) ? length + 1 : bufferSize * 2;
             buffer = static_cast<csmChar*>(CSM_MALLOC(sizeof(csmChar)* bufferSize));
         }
     }
     va_end(args);
 
     csmString ret = buffer;
-    CSM_FREE(buffer);
+    if (buffer != stackBuffer)
+    {
+        CSM_FREE(buffer);
+    }
 
     return ret; // CubismString型にされて返されるためアドレスを返すので良い。
 }
@@ -8,7 +8,8 @@
 #include "utils/logger.h"
 
 ModuleConfigManager::ModuleConfigManager(const std::string &config_path)
-: config_path_(config_path), mcp_server(nullptr) {}
+: config_path_(config_path), use_mcp(false), mcp_in_process(true),
+  mcp_server(nullptr), mcp_dispatcher(nullptr) {}
 
 ModuleConfigManager *ModuleConfigManager::instance = nullptr;
 bool ModuleConfigManager::isLoaded = false;
@@ -94,6 +95,7 @@ bool ModuleConfigManager::load() {
                 else mcp_addr = MCP_SERVER_LISTEN_DEFAULT;
                 if (mcp.contains("server_port")) mcp_port = mcp["server_port"];
                 else mcp_port = MCP_SERVER_PORT_DEFAULT;
+                mcp_in_process = mcp.value("in_process_dispatch", true);
 
                 
                 // 先构造前端 MCP server
@@ -103,6 +105,7 @@ bool ModuleConfigManager::load() {
                 this->mcp_server->set_capabilities({
                     {"tools", mcp::json::object()}
                 });
+                this->mcp_dispatcher = std::make_shared<MCPToolDispatcher>();
 
                 if (data.contains("mcpServers")) {
                     json mcp_svrs = data["mcpServers"];
@@ -151,6 +154,7 @@ bool ModuleConfigManager::save() const {
         if (this->is_mcp_enabled()) {
             data["mcp"]["listen_addr"] = mcp_addr;
             data["mcp"]["server_port"] = mcp_port;
+            data["mcp"]["in_process_dispatch"] = mcp_in_process;
 
             for (const auto &kv: mcp_backend_servers) {
                 const MCPServerInstance &mcp_srv_instance = kv.second;
@@ -183,6 +187,7 @@ std::vector<mcp::tool> ModuleConfigManager::get_mcp_tools() const {
         stdLogger.Exception("configurations not loaded when get mcp tools");
         return {};
     }
+    if (this->mcp_server == nullptr) return {};
     return this->mcp_server->get_tools();
 }
 
@@ -200,49 +205,80 @@ std::unordered_map<std::string, ServerConfig> ModuleConfigManager::get_enabled_m
     return enabledServers;
 }
 
-bool ModuleConfigManager::start_enabled_mcp_servers() {
+bool ModuleConfigManager::start_enabled_mcp_servers(MCPBackendReadyCallback on_backend_ready) {
     if (!this->is_mcp_enabled()) {
         stdLogger.Warning("mcp not enabled. Skip starting mcp servers");
         return false;
     }
-    // 启动所有 stdio client 以及对应的 MCP 服务进程
-    for (const auto& [name, mcp_svr_instance] : ModuleConfigManager::instance->mcp_backend_servers) {
+    // 先启动前端 MCP server（非阻塞），后端的工具在各自启动完成后再注册进来
+    if (!this->mcp_server->start(false)) {
+        stdLogger.Exception("failed to start mcp frontend server. disabling mcp...");
+        this->stop_and_cleanup_mcp_servers();
+        return false;
+    }
+
+    // 并发启动所有 stdio client 以及对应的 MCP 服务进程，不阻塞调用方（GUI 线程）
+    for (const auto& [name, mcp_svr_instance] : this->mcp_backend_servers) {
         if (!mcp_svr_instance.first.enabled) continue;
         mcp::stdio_client *current_client = mcp_svr_instance.second;
-        if (!current_client->initialize(name, mcp::MCP_VERSION)) {
-            stdLogger.Exception("failed to start mcp backend server: " + name);
-            // continue;
-            // 策略：立即同步停止 mcp servers 并禁用 mcp，防止出现更多问题。
-            stdLogger.Exception("disabling mcp to avoid further problems...");
-            this->stop_and_cleanup_mcp_servers();
-            return false;
-        }
-        stdLogger.Info("mcp server '" + name + "' started");
-
-        // 向前端 MCP server 注册后端用户指定的 MCP server 的服务，完成服务汇总
-        auto stdio_client_tools = current_client->get_tools();
-        for (const auto &tool: stdio_client_tools) {
-            std::string current_tool_name = tool.name;
-            this->mcp_server->register_tool(
-                tool,
-                // current_client 是堆上指针，在 deinit 前会一直存活，因此可以值传递
-                [current_client, current_tool_name, name]
-                (const json &params, const std::string&/* session id */)->json{
-                    stdLogger.Debug(
-                        QString::asprintf("tool '%s' in backend server '%s' is called",
-                            current_tool_name.data(), name.data())
-                        .toStdString());
-                    return current_client->call_tool(current_tool_name, params);
-                }
-            );
-        }
+        mcp::server *frontend_server = this->mcp_server;
+        std::shared_ptr<MCPToolDispatcher> dispatcher = this->mcp_dispatcher;
+        std::string current_name = name;
+        // 注意：启动线程不访问 this，因为异步回收时 this 中的指针会被立即置空
+        this->mcp_startup_workers.emplace_back([current_name, current_client, frontend_server,
+                                                dispatcher, on_backend_ready]() {
+            bool success = ModuleConfigManager::start_mcp_backend_server(
+                current_name, current_client, frontend_server, dispatcher);
+            if (on_backend_ready) {
+                on_backend_ready(current_name, success);
+            }
+        });
     }
+    return true;
+}
 
-    // 启动前端 MCP server
-    this->mcp_server->start(false);
+bool ModuleConfigManager::start_mcp_backend_server(
+    const std::string &name, mcp::stdio_client *client, mcp::server *frontend_server,
+    std::shared_ptr<MCPToolDispatcher> dispatcher) {
+    if (!client->initialize(name, mcp::MCP_VERSION)) {
+        // 策略：单个后端启动失败只跳过该后端，不影响其他并发启动的后端
+        stdLogger.Exception("failed to start mcp backend server: " + name);
+        return false;
+    }
+    stdLogger.Info("mcp server '" + name + "' started");
+
+    // 向前端 MCP server 注册后端用户指定的 MCP server 的服务，完成服务汇总
+    // mcp::server 内部对工具表加锁，多个启动线程可以并发注册
+    auto stdio_client_tools = client->get_tools();
+    for (const auto &tool: stdio_client_tools) {
+        std::string current_tool_name = tool.name;
+        frontend_server->register_tool(
+            tool,
+            // client 是堆上指针，在 deinit 前会一直存活，因此可以值传递
+            [client, current_tool_name, name]
+            (const json &params, const std::string&/* session id */)->json{
+                stdLogger.Debug(
+                    QString::asprintf("tool '%s' in backend server '%s' is called",
+                        current_tool_name.data(), name.data())
+                    .toStdString());
+                return client->call_tool(current_tool_name, params);
+            }
+        );
+        // 同时登记到进程内分发表，供同进程调用方绕过 SSE 回环
+        dispatcher->register_tool(current_tool_name, name, client);
+    }
+    stdLogger.Info("registered " + std::to_string(stdio_client_tools.size())
+        + " tool(s) from mcp server '" + name + "'");
     return true;
 }
 
+void ModuleConfigManager::join_mcp_startup_workers() {
+    for (auto &worker: this->mcp_startup_workers) {
+        if (worker.joinable()) worker.join();
+    }
+    this->mcp_startup_workers.clear();
+}
+
 void ModuleConfigManager::stop_and_cleanup_mcp_servers(bool async) {
     if (async) {
         this->_async_stop_and_cleanup_mcp_servers();
@@ -256,9 +292,12 @@ void ModuleConfigManager::__sync_stop_and_cleanup_mcp_servers() {
         stdLogger.Debug("mcp not enabled. Skipped cleanning mcp servers");
         return;
     }
+    // 后端启动线程仍可能在访问 mcp_server 与 stdio client，先等待它们结束
+    this->join_mcp_startup_workers();
     // 停止前端 MCP server (析构即触发)
     delete this->mcp_server;
     this->mcp_server = nullptr;
+    this->mcp_dispatcher.reset();
     // 需要回收管理的 stdio client 以及对应的 MCP 服务进程
     for (const auto& [name, mcp_svr_instance] : this->mcp_backend_servers) {
         if (mcp_svr_instance.first.enabled) {
@@ -274,30 +313,32 @@ void ModuleConfigManager::_async_stop_and_cleanup_mcp_servers() {
         // stdLogger.Debug("mcp not enabled. Skipped cleanning mcp servers");
         return;
     }
-    // 异步停止前端 mcp server
-    if (this->mcp_server) {
-        auto* server_to_delete = this->mcp_server;
-        this->mcp_server = nullptr;  // 同步操作，确保后续访问安全
-
-        std::thread([server_to_delete]() {
-            delete server_to_delete;  // 后台线程中阻塞删除
-        }).detach();
-    }
+    // 同步取走所有需要回收的对象，确保后续访问安全
+    auto* server_to_delete = this->mcp_server;
+    this->mcp_server = nullptr;
+    this->mcp_dispatcher.reset();
 
-    // 异步删除后端 MCP 服务
     std::vector<mcp::stdio_client*> servers_to_delete;
     for (const auto& [name, mcp_svr_instance] : this->mcp_backend_servers) {
         if (mcp_svr_instance.first.enabled) {
             servers_to_delete.push_back(mcp_svr_instance.second);
         }
     }
-    this->mcp_backend_servers.clear();  // 同步清空容器，确保后续访问安全
+    this->mcp_backend_servers.clear();
 
-    for (auto* server_ptr : servers_to_delete) {
-        std::thread([server_ptr]() {
+    std::vector<std::thread> workers_to_join = std::move(this->mcp_startup_workers);
+    this->mcp_startup_workers.clear();
+
+    // 后台线程中先等待后端启动线程结束（它们会访问前端 server 与 stdio client），再阻塞删除
+    std::thread([server_to_delete, servers_to_delete, workers = std::move(workers_to_join)]() mutable {
+        for (auto &worker: workers) {
+            if (worker.joinable()) worker.join();
+        }
+        delete server_to_delete;
+        for (auto* server_ptr : servers_to_delete) {
             delete server_ptr;
-        }).detach();
-    }
+        }
+    }).detach();
 
     this->use_mcp = false;  // 同步更新状态
 }
@@ -310,6 +351,22 @@ std::pair<std::string, int> ModuleConfigManager::get_mcp_server_info() const {
     return std::make_pair(mcp_addr, mcp_port);
 }
 
+bool ModuleConfigManager::is_mcp_in_process_dispatch() const {
+    return this->is_mcp_enabled() && this->mcp_in_process;
+}
+
+bool ModuleConfigManager::has_mcp_tool(const std::string &tool_name) const {
+    if (!this->is_mcp_enabled() || !this->mcp_dispatcher) return false;
+    return this->mcp_dispatcher->has_tool(tool_name);
+}
+
+json ModuleConfigManager::call_mcp_tool(const std::string &tool_name, const json &params) const {
+    if (!this->is_mcp_enabled() || !this->mcp_dispatcher) {
+        throw std::runtime_error("mcp not enabled");
+    }
+    return this->mcp_dispatcher->call_tool(tool_name, params);
+}
+
 // caller should check command not empty
 mcp::stdio_client *ModuleConfigManager::build_mcp_ioclient_from_server_config(const ServerConfig &config) {
     std::string fullCmd = config.command;
@@ -321,6 +378,36 @@ mcp::stdio_client *ModuleConfigManager::build_mcp_ioclient_from_server_config(co
 }
 
 
+void MCPToolDispatcher::register_tool(const std::string &tool_name, const std::string &server_name,
+                                      mcp::stdio_client *client) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    routes_[tool_name] = std::make_pair(server_name, client);
+}
+
+bool MCPToolDispatcher::has_tool(const std::string &tool_name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return routes_.find(tool_name) != routes_.end();
+}
+
+json MCPToolDispatcher::call_tool(const std::string &tool_name, const json &params) const {
+    ToolRoute route;
+    {
+        // 只在查表时持锁，工具调用本身可能很耗时
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = routes_.find(tool_name);
+        if (it == routes_.end()) {
+            throw std::runtime_error("tool '" + tool_name + "' not found in any mcp backend server");
+        }
+        route = it->second;
+    }
+    stdLogger.Debug(
+        QString::asprintf("tool '%s' in backend server '%s' is called (in-process)",
+            tool_name.data(), route.first.data())
+        .toStdString());
+    return route.second->call_tool(tool_name, params);
+}
+
+
 LLMConfig LLMConfig::fromJson(const json &config) {
     LLMConfig llmConfig;
     llmConfig.model = config.value("model", llmConfig.model);
@@ -335,6 +422,14 @@ LLMConfig LLMConfig::fromJson(const json &config) {
     llmConfig.base_url = config.value("base_url", llmConfig.base_url);
     llmConfig.stream = config.contains("stream") ? std::optional<bool>(config["stream"]).value_or(false) : false;
     llmConfig.enable_thinking = config.contains("enable_thinking") ? std::optional<bool>(config["enable_thinking"]).value_or(false) : false;
+    if (config.contains("speculative") && config["speculative"].is_object()) {
+        const json &spec = config["speculative"];
+        llmConfig.speculative = spec.value("enable", llmConfig.speculative);
+        llmConfig.speculative_stable_partials = spec.value("stable_partials", llmConfig.speculative_stable_partials);
+        llmConfig.speculative_stable_ms = spec.value("stable_ms", llmConfig.speculative_stable_ms);
+        llmConfig.speculative_min_chars = spec.value("min_chars", llmConfig.speculative_min_chars);
+        llmConfig.speculative_partial_interval_ms = spec.value("partial_interval_ms", llmConfig.speculative_partial_interval_ms);
+    }
     return llmConfig;
 }
 
@@ -348,6 +443,13 @@ json LLMConfig::toJson() const {
     j["base_url"] = base_url;
     j["stream"] = stream;
     j["enable_thinking"] = enable_thinking;
+    j["speculative"] = {
+        {"enable", speculative},
+        {"stable_partials", speculative_stable_partials},
+        {"stable_ms", speculative_stable_ms},
+        {"min_chars", speculative_min_chars},
+        {"partial_interval_ms", speculative_partial_interval_ms}
+    };
     return j;
 }
 
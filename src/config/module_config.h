@@ -2,9 +2,13 @@
 
 #include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -33,6 +37,13 @@ public:
     std::string base_url = LLM_BASE_URL_DEFAULT;
     bool stream = false;
     bool enable_thinking = false;
+    // 基于 STT 部分转写结果的推测请求
+    bool speculative = false;
+    int speculative_stable_partials = 2;
+    int speculative_stable_ms = 300;
+    int speculative_min_chars = 4;
+    // 录音过程中对已录音频做部分转写的间隔（ms）
+    int speculative_partial_interval_ms = 800;
 
     LLMConfig() {}
 
@@ -56,6 +67,26 @@ public:
     json toJson() const;
 };
 
+/**
+ * 进程内 MCP 工具分发表：tool name -> 后端 stdio client。
+ * 前端 MCP server 与调用方位于同一进程时，调用方可以经此直接调用后端，
+ * 绕过本地 SSE 回环（HTTP 往返以及 JSON 的重复编解码）。线程安全
+ */
+class MCPToolDispatcher {
+public:
+    void register_tool(const std::string &tool_name, const std::string &server_name,
+                       mcp::stdio_client *client);
+    bool has_tool(const std::string &tool_name) const;
+    // @throw std::runtime_error 工具未注册
+    json call_tool(const std::string &tool_name, const json &params) const;
+
+private:
+    typedef std::pair<std::string /* server name */, mcp::stdio_client*> ToolRoute;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, ToolRoute> routes_;
+};
+
 class ModuleConfigManager {
 public:
     
@@ -83,13 +114,25 @@ public:
 
     // @return {mcp_host, mcp_port}
     std::pair<std::string, int> get_mcp_server_info() const;
+    // 是否在进程内直接分发工具调用（不经过本地 SSE MCP client -> 前端 server 的回环）
+    bool is_mcp_in_process_dispatch() const;
+    // 进程内直接调用后端 MCP server 的工具，调用方需先确认 has_mcp_tool
+    // @throw std::runtime_error 工具不存在或 MCP 未启用
+    json call_mcp_tool(const std::string &tool_name, const json &params) const;
+    bool has_mcp_tool(const std::string &tool_name) const;
 
     // 获取所有前端 MCP server 中注册的 MCP tools。包括用户给定的所有 backend MCP server 提供的服务
     std::vector<mcp::tool> get_mcp_tools() const;
     // Get only enabled server configurations
     std::unordered_map<std::string, ServerConfig> get_enabled_mcp_backend_servers() const;
-    // 同时启动后端 MCP servers 以及注册好的前端 MCP server
-    bool start_enabled_mcp_servers();
+
+    // 单个后端 MCP server 启动结束（成功或失败）时的回调，参数为 {server name, success}
+    // 注意：该回调在后台启动线程中调用，调用方需要自行转发到 GUI 线程
+    typedef std::function<void(const std::string&, bool)> MCPBackendReadyCallback;
+    // 先启动前端 MCP server，再并发启动所有后端 MCP servers。
+    // 每个后端启动完成后立即向前端注册其工具，并调用 on_backend_ready。本函数不会等待后端启动完成
+    // @return 前端 MCP server 是否启动成功
+    bool start_enabled_mcp_servers(MCPBackendReadyCallback on_backend_ready = nullptr);
 
 private:
 
@@ -103,6 +146,13 @@ private:
 
     mcp::stdio_client *build_mcp_ioclient_from_server_config(const ServerConfig &config);
 
+    // 在后台线程中运行：启动单个后端 MCP server，并把它的工具注册到前端 MCP server
+    static bool start_mcp_backend_server(const std::string &name, mcp::stdio_client *client,
+                                         mcp::server *frontend_server,
+                                         std::shared_ptr<MCPToolDispatcher> dispatcher);
+    // 等待所有后端启动线程结束。回收 mcp_server / 后端 client 之前必须调用
+    void join_mcp_startup_workers();
+
     std::string config_path_;
     ASRHandler::asr_params asr_;
     TTS::tts_params_t tts_;
@@ -111,6 +161,7 @@ private:
     std::string mcp_addr;
     int mcp_port;
     bool use_mcp;
+    bool mcp_in_process;
 
     // 注意：这里 stdio_client 的作用是启动 MCP 后端服务进程，与用户指定的 MCP 进程一一对应
     typedef std::pair<ServerConfig, mcp::stdio_client*> MCPServerInstance;
@@ -119,6 +170,10 @@ private:
 
     // 注：这里是前端 MCP server，作用是汇总所有用户指定的、通过 stdio 启动的 MCP 进程提供的服务的接口
     mcp::server *mcp_server;
+    // 与前端 MCP server 同步注册的进程内分发表（启动线程持有共享引用，回收时整体替换）
+    std::shared_ptr<MCPToolDispatcher> mcp_dispatcher;
+    // 后端 MCP servers 的并发启动线程
+    std::vector<std::thread> mcp_startup_workers;
     
     static ModuleConfigManager *instance;
     // 是否已加载配置
@@ -1,44 +1,333 @@
 #include <stdlib.h>
 
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
 #include "drivers/allocator.h"
 
 using namespace Csm;
 
+namespace {
+    enum BlockSource : uint8_t {
+        SourceHeap = 0,
+        SourcePool,
+        SourceArena,
+        SourceAligned,
+    };
+
+    /* Placed right before every block returned to the framework. */
+    struct alignas(16) BlockHeader {
+        void* owner;        /* Pool: size class, arena: chunk, aligned: base address. */
+        uint32_t size;
+        uint8_t source;
+        uint8_t tag;
+    };
+
+    const size_t HeaderSize = sizeof(BlockHeader);
+    const size_t Granularity = 16;
+    const size_t SizeClassCount = 16;
+    const size_t MaxPooledSize = Granularity * SizeClassCount;
+    const size_t PoolPageSize = 64 * 1024;
+
+    struct ThreadContext {
+        Allocator::Tag tag;
+        AllocatorArena* arena;
+    };
+    thread_local ThreadContext t_context = { Allocator::TagGeneral, NULL };
+
+    std::atomic<size_t> g_arenaReservedBytes(0);
+
+    inline size_t RoundUp(size_t size, size_t alignment) {
+        return (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    inline BlockHeader* HeaderOf(void* memory) {
+        return reinterpret_cast<BlockHeader*>(static_cast<char*>(memory) - HeaderSize);
+    }
+
+    void* AlignedAlloc(size_t size, size_t alignment) {
+#ifdef _WIN32
+        return _aligned_malloc(size, alignment);
+#else
+        return aligned_alloc(alignment, size);
+#endif
+    }
+
+    void AlignedFree(void* memory) {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        free(memory);
+#endif
+    }
+}
+
+/* A free list of blocks of the same size, carved from pages. */
+struct Allocator::SizeClass {
+    std::mutex mutex;
+    void* freeList = NULL;
+    std::vector<void*> pages;
+    size_t blockSize = 0;
+};
+
+Allocator::Allocator(Strategy strategy)
+    : _strategy(strategy)
+    , _sizeClasses(new SizeClass[SizeClassCount])
+    , _liveBytes(0)
+    , _peakBytes(0)
+    , _allocations(0)
+    , _deallocations(0)
+    , _poolReservedBytes(0) {
+    for (size_t i = 0; i < SizeClassCount; i++)
+        _sizeClasses[i].blockSize = HeaderSize + (i + 1) * Granularity;
+    for (TagCounters& counters : _tags) {
+        counters.liveBytes = 0;
+        counters.peakBytes = 0;
+        counters.liveCount = 0;
+        counters.allocations = 0;
+    }
+}
+
+Allocator::~Allocator() {
+    for (size_t i = 0; i < SizeClassCount; i++) {
+        for (void* page : _sizeClasses[i].pages)
+            free(page);
+    }
+    delete[] _sizeClasses;
+}
+
 void* Allocator::Allocate(const csmSizeType  size) {
-    return malloc(size);
+    const ThreadContext& context = t_context;
+    const size_t blockSize = HeaderSize + RoundUp(size, Granularity);
+    void* block = NULL;
+    void* owner = NULL;
+    uint8_t source = SourceHeap;
+
+    if (_strategy == Pooled) {
+        if (context.arena != NULL) {
+            block = context.arena->Allocate(blockSize, &owner);
+            source = SourceArena;
+        }
+        if (block == NULL && size <= MaxPooledSize) {
+            SizeClass& sizeClass = _sizeClasses[size > 0 ? (size - 1) / Granularity : 0];
+            std::lock_guard<std::mutex> lock(sizeClass.mutex);
+            if (sizeClass.freeList == NULL) {
+                char* page = static_cast<char*>(malloc(PoolPageSize));
+                if (page != NULL) {
+                    sizeClass.pages.push_back(page);
+                    _poolReservedBytes.fetch_add(PoolPageSize, std::memory_order_relaxed);
+                    for (size_t offset = 0; offset + sizeClass.blockSize <= PoolPageSize; offset += sizeClass.blockSize) {
+                        *reinterpret_cast<void**>(page + offset) = sizeClass.freeList;
+                        sizeClass.freeList = page + offset;
+                    }
+                }
+            }
+            block = sizeClass.freeList;
+            if (block != NULL) {
+                sizeClass.freeList = *static_cast<void**>(block);
+                owner = &sizeClass;
+                source = SourcePool;
+            }
+        }
+    }
+    if (block == NULL) {
+        block = malloc(blockSize);
+        if (block == NULL)
+            return NULL;
+        source = SourceHeap;
+    }
+
+    BlockHeader* header = static_cast<BlockHeader*>(block);
+    header->owner = owner;
+    header->size = static_cast<uint32_t>(size);
+    header->source = source;
+    header->tag = context.tag;
+    OnAllocate(size, context.tag);
+    return static_cast<char*>(block) + HeaderSize;
 }
 
 void Allocator::Deallocate(void* memory) {
-    free(memory);
+    if (memory == NULL)
+        return;
+
+    BlockHeader* header = HeaderOf(memory);
+    OnDeallocate(header->size, static_cast<Tag>(header->tag));
+    switch (header->source) {
+    case SourcePool: {
+        SizeClass* sizeClass = static_cast<SizeClass*>(header->owner);
+        std::lock_guard<std::mutex> lock(sizeClass->mutex);
+        *reinterpret_cast<void**>(header) = sizeClass->freeList;
+        sizeClass->freeList = header;
+        break;
+    }
+    case SourceArena:
+        AllocatorArena::Free(header->owner);
+        break;
+    case SourceAligned:
+        AlignedFree(header->owner);
+        break;
+    default:
+        free(header);
+        break;
+    }
 }
 
 void* Allocator::AllocateAligned(const csmSizeType size, const csmUint32 alignment) {
-    size_t offset, shift, alignedAddress;
-    void* allocation;
-    void** preamble;
+    /* The header takes the first alignment slot. */
+    const size_t align = alignment > HeaderSize ? alignment : HeaderSize;
+    char* base = static_cast<char*>(AlignedAlloc(align + RoundUp(size, align), align));
+    if (base == NULL)
+        return NULL;
+
+    const Tag tag = t_context.tag;
+    char* memory = base + align;
+    BlockHeader* header = HeaderOf(memory);
+    header->owner = base;
+    header->size = static_cast<uint32_t>(size);
+    header->source = SourceAligned;
+    header->tag = tag;
+    OnAllocate(size, tag);
+    return memory;
+}
+
+void Allocator::DeallocateAligned(void* alignedMemory) {
+    Deallocate(alignedMemory);
+}
 
-    offset = alignment - 1 + sizeof(void*);
+void Allocator::OnAllocate(size_t size, Tag tag) {
+    const size_t live = _liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = _peakBytes.load(std::memory_order_relaxed);
+    while (live > peak && !_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    _allocations.fetch_add(1, std::memory_order_relaxed);
 
-    allocation = Allocate(size + static_cast<csmUint32>(offset));
+    TagCounters& counters = _tags[tag];
+    const size_t tagLive = counters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t tagPeak = counters.peakBytes.load(std::memory_order_relaxed);
+    while (tagLive > tagPeak && !counters.peakBytes.compare_exchange_weak(tagPeak, tagLive, std::memory_order_relaxed)) {}
+    counters.liveCount.fetch_add(1, std::memory_order_relaxed);
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+}
 
-    alignedAddress = reinterpret_cast<size_t>(allocation) + sizeof(void*);
+void Allocator::OnDeallocate(size_t size, Tag tag) {
+    _liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    _deallocations.fetch_add(1, std::memory_order_relaxed);
 
-    shift = alignedAddress % alignment;
+    TagCounters& counters = _tags[tag];
+    counters.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+    counters.liveCount.fetch_sub(1, std::memory_order_relaxed);
+}
 
-    if (shift) {
-        alignedAddress += (alignment - shift);
+Allocator::Stats Allocator::GetStats() const {
+    Stats stats;
+    stats.liveBytes = _liveBytes.load(std::memory_order_relaxed);
+    stats.peakBytes = _peakBytes.load(std::memory_order_relaxed);
+    stats.allocations = _allocations.load(std::memory_order_relaxed);
+    stats.deallocations = _deallocations.load(std::memory_order_relaxed);
+    stats.poolReservedBytes = _poolReservedBytes.load(std::memory_order_relaxed);
+    stats.arenaReservedBytes = AllocatorArena::GetReservedBytes();
+    for (int i = 0; i < TagCount; i++) {
+        stats.tags[i].liveBytes = _tags[i].liveBytes.load(std::memory_order_relaxed);
+        stats.tags[i].peakBytes = _tags[i].peakBytes.load(std::memory_order_relaxed);
+        stats.tags[i].liveCount = _tags[i].liveCount.load(std::memory_order_relaxed);
+        stats.tags[i].allocations = _tags[i].allocations.load(std::memory_order_relaxed);
     }
+    return stats;
+}
+
+const char* Allocator::GetTagName(Tag tag) {
+    switch (tag) {
+    case TagGeneral: return "general";
+    case TagModel: return "model";
+    case TagMotion: return "motion";
+    case TagPhysics: return "physics";
+    case TagJson: return "json";
+    case TagRenderer: return "renderer";
+    default: return "unknown";
+    }
+}
 
-    preamble = reinterpret_cast<void**>(alignedAddress);
-    preamble[-1] = allocation;
+/* Freed with its last block; the arena holds one reference while allocating from it. */
+struct alignas(16) AllocatorArena::Chunk {
+    std::atomic<int> refs;
+    size_t size;
+};
 
-    return reinterpret_cast<void*>(alignedAddress);
+AllocatorArena::AllocatorArena(size_t chunkSize)
+    : _chunkSize(chunkSize)
+    , _current(NULL)
+    , _cursor(NULL)
+    , _end(NULL) {
 }
 
-void Allocator::DeallocateAligned(void* alignedMemory) {
-    void** preamble;
+AllocatorArena::~AllocatorArena() {
+    Release();
+}
 
-    preamble = static_cast<void**>(alignedMemory);
+void AllocatorArena::Release() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_current != NULL)
+        Free(_current);
+    _current = NULL;
+    _cursor = NULL;
+    _end = NULL;
+}
+
+size_t AllocatorArena::GetReservedBytes() {
+    return g_arenaReservedBytes.load(std::memory_order_relaxed);
+}
+
+void* AllocatorArena::Allocate(size_t blockSize, void** chunk) {
+    /* Large blocks would waste the end of the chunks. */
+    if (blockSize > _chunkSize / 8)
+        return NULL;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (static_cast<size_t>(_end - _cursor) < blockSize) {
+        Chunk* next = static_cast<Chunk*>(malloc(_chunkSize));
+        if (next == NULL)
+            return NULL;
+        next->refs = 1;
+        next->size = _chunkSize;
+        g_arenaReservedBytes.fetch_add(_chunkSize, std::memory_order_relaxed);
+        if (_current != NULL)
+            Free(_current);
+        _current = next;
+        _cursor = reinterpret_cast<char*>(next) + RoundUp(sizeof(Chunk), Granularity);
+        _end = reinterpret_cast<char*>(next) + _chunkSize;
+    }
+
+    void* block = _cursor;
+    _cursor += blockSize;
+    _current->refs.fetch_add(1, std::memory_order_relaxed);
+    *chunk = _current;
+    return block;
+}
+
+void AllocatorArena::Free(void* chunk) {
+    Chunk* owner = static_cast<Chunk*>(chunk);
+    if (owner->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        g_arenaReservedBytes.fetch_sub(owner->size, std::memory_order_relaxed);
+        free(owner);
+    }
+}
+
+AllocationScope::AllocationScope(Allocator::Tag tag)
+    : _previousTag(t_context.tag)
+    , _previousArena(t_context.arena) {
+    t_context.tag = tag;
+}
+
+AllocationScope::AllocationScope(Allocator::Tag tag, AllocatorArena* arena)
+    : _previousTag(t_context.tag)
+    , _previousArena(t_context.arena) {
+    t_context.tag = tag;
+    t_context.arena = arena;
+}
 
-    Deallocate(preamble[-1]);
+AllocationScope::~AllocationScope() {
+    t_context.tag = _previousTag;
+    t_context.arena = _previousArena;
 }
@@ -1,28 +1,107 @@
 /**
  * @file allocator.h
- * @brief A source file providing a customized malloc-based memory allocator.
- * 
+ * @brief A source file providing the memory allocators of the Cubism framework.
+ *
  * @author SSRVodka
  * @date   Feb 12, 2024
  */
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
 #include <CubismFramework.hpp>
 #include <ICubismAllocator.hpp>
 
+class AllocatorArena;
+
 /**
  * @class Allocator
  * @brief Class that implements memory allocation.
  *
  * Implementation of interface for memory allocation/deallocation process.
  * Called by the framework.
- * 
+ *
+ * Every block starts with a small header (source, size & tag), so that blocks
+ * from any source can be released whatever the current strategy is, and
+ * so that the counters (`GetStats`) are always available, per tag with peak watermarks.
+ *
+ * - `Heap`: `malloc` / `free`.
+ * - `Pooled`: small blocks come from size-class pools, and the allocations
+ *   made in an `AllocationScope` with an arena (e.g. while loading a model)
+ *   come from that arena.
+ *
+ * Aligned blocks are allocated by `aligned_alloc` in both strategies.
+ * Thread-safe.
+ *
  * @see Csm::ICubismAllocator
  *
  */
 class Allocator : public Csm::ICubismAllocator
 {
+public:
+    enum Strategy {
+        Heap,
+        Pooled,
+    };
+
+    /**
+     * @brief Owner of an allocation, set by `AllocationScope`.
+     *
+     * The ids registered in `CubismIdManager` keep the tag of the asset that
+     * registered them first, until the framework is disposed.
+     */
+    enum Tag : uint8_t {
+        TagGeneral = 0, /**< Untagged: frame updates, framework internals... */
+        TagModel,       /**< Model setup: moc, model, expressions, pose, ids... */
+        TagMotion,      /**< Motions loaded by the motion cache. */
+        TagPhysics,     /**< Physics rig (and its json while parsing). */
+        TagJson,        /**< Model setting json kept by the model. */
+        TagRenderer,    /**< Renderer of the models, shaders. */
+        TagCount,
+    };
+
+    struct TagStats {
+        size_t liveBytes;
+        size_t peakBytes;   /**< Highest `liveBytes` since start up. */
+        size_t liveCount;
+        uint64_t allocations;
+    };
+
+    /**
+     * @struct Stats
+     * @brief Snapshot of the counters. Sizes are the requested ones (headers excluded).
+     */
+    struct Stats {
+        size_t liveBytes;
+        size_t peakBytes;
+        uint64_t allocations;
+        uint64_t deallocations;
+        size_t poolReservedBytes;   /**< Pages held by the size-class pools. */
+        size_t arenaReservedBytes;  /**< Chunks held by the arenas (all allocators). */
+        TagStats tags[TagCount];
+    };
+
+    explicit Allocator(Strategy strategy = Heap);
+    ~Allocator();
+
+    Allocator(const Allocator&) = delete;
+    Allocator& operator=(const Allocator&) = delete;
+
+    /**
+     * @brief Select the strategy of the next allocations (blocks already allocated are unaffected).
+     */
+    void SetStrategy(Strategy strategy) { _strategy = strategy; }
+    Strategy GetStrategy() const { return _strategy; }
+
+    Stats GetStats() const;
+
+    static const char* GetTagName(Tag tag);
+
+private:
     /**
     * @brief Allocates memory space.
     *
@@ -53,4 +132,114 @@ class Allocator : public Csm::ICubismAllocator
     * @param[in] alignedMemory  Memory to be released.
     */
     void DeallocateAligned(void* alignedMemory);
+
+    struct SizeClass;
+
+    void OnAllocate(size_t size, Tag tag);
+    void OnDeallocate(size_t size, Tag tag);
+
+    struct TagCounters {
+        std::atomic<size_t> liveBytes;
+        std::atomic<size_t> peakBytes;
+        std::atomic<size_t> liveCount;
+        std::atomic<uint64_t> allocations;
+    };
+
+    Strategy _strategy;
+    SizeClass* _sizeClasses;
+    std::atomic<size_t> _liveBytes;
+    std::atomic<size_t> _peakBytes;
+    std::atomic<uint64_t> _allocations;
+    std::atomic<uint64_t> _deallocations;
+    std::atomic<size_t> _poolReservedBytes;
+    TagCounters _tags[TagCount];
+};
+
+/**
+ * @class AllocatorArena
+ * @brief Chunks of memory bump-allocated for one owner (e.g. a model) and released with it.
+ *
+ * Blocks are not reused once freed: a chunk is given back when the arena moved to
+ * another chunk (or is released) and all its blocks are freed. A block outliving
+ * the arena (e.g. an id registered in `CubismIdManager` while loading) only keeps its chunk.
+ * Used by `Allocator` (`Pooled` strategy) in an `AllocationScope`. Thread-safe.
+ */
+class AllocatorArena {
+public:
+    /**
+     * @param[in] chunkSize  Size of the chunks; larger blocks are not taken from the arena.
+     */
+    explicit AllocatorArena(size_t chunkSize = 256 * 1024);
+
+    /**
+     * @brief Release the arena (see `Release`).
+     */
+    ~AllocatorArena();
+
+    AllocatorArena(const AllocatorArena&) = delete;
+    AllocatorArena& operator=(const AllocatorArena&) = delete;
+
+    /**
+     * @brief Stop allocating from the current chunk, which is freed with its last block.
+     */
+    void Release();
+
+    /**
+     * @brief Bytes of the chunks held by all arenas.
+     */
+    static size_t GetReservedBytes();
+
+private:
+    friend class Allocator;
+
+    struct Chunk;
+
+    /**
+     * @brief Bump-allocate a block (header included).
+     *
+     * @param[out] chunk  Chunk of the block, to be passed to `Free`.
+     * @return  NULL if the block is too large for the arena.
+     */
+    void* Allocate(size_t blockSize, void** chunk);
+
+    /**
+     * @brief Release a block of a chunk.
+     */
+    static void Free(void* chunk);
+
+    std::mutex _mutex;
+    size_t _chunkSize;
+    Chunk* _current;
+    char* _cursor;
+    char* _end;
+};
+
+/**
+ * @class AllocationScope
+ * @brief Sets the tag (and the arena) of the allocations of the current thread until destroyed.
+ *
+ * Scopes nest: the previous tag and arena are restored on destruction.
+ */
+class AllocationScope {
+public:
+    /**
+     * @brief Change the tag only, allocating from the current arena (if any).
+     *
+     * @param[in] tag    Tag of the allocations.
+     */
+    explicit AllocationScope(Allocator::Tag tag);
+
+    /**
+     * @param[in] tag    Tag of the allocations.
+     * @param[in] arena  Arena to allocate from, NULL for the pools / heap.
+     */
+    AllocationScope(Allocator::Tag tag, AllocatorArena* arena);
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+private:
+    Allocator::Tag _previousTag;
+    AllocatorArena* _previousArena;
 };
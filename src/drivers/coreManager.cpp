@@ -1,10 +1,17 @@
 #include <AppOpenGLWrapper.hpp>
 
+#include <QtCore/QString>
+
 #include "drivers/coreManager.h"
 #include "drivers/modelManager.h"
 #include "drivers/renderer.h"
 #include "drivers/textureManager.h"
 #include "drivers/tools.h"
+#include "drivers/workerPool.h"
+
+#include "utils/cJSON.h"
+#include "utils/consts.h"
+#include "utils/logger.h"
 
 using namespace Csm;
 
@@ -52,11 +59,70 @@ bool CoreManager::Initialize(AnimeWidget* window) {
 
 void CoreManager::Release() {
     delete _textureManager;
+    _textureManager = NULL;
     delete _view;
 
     ModelManager::ReleaseInstance();
+    WorkerPool::ReleaseInstance();
 
     CubismFramework::Dispose();
+
+    const Allocator::Stats stats = _cubismAllocator.GetStats();
+    stdLogger.Info(
+        QString::asprintf("Cubism memory: peak %.1f KB, %llu allocations, %.1f KB not released",
+            stats.peakBytes / 1024.0, static_cast<unsigned long long>(stats.allocations), stats.liveBytes / 1024.0)
+        .toStdString()
+    );
+    for (int i = 0; i < Allocator::TagCount; i++) {
+        const Allocator::TagStats& tag = stats.tags[i];
+        if (tag.liveCount == 0)
+            continue;
+        stdLogger.Warning(
+            QString::asprintf("Cubism memory leak (%s): %zu blocks, %.1f KB (peak %.1f KB)",
+                Allocator::GetTagName(static_cast<Allocator::Tag>(i)), tag.liveCount, tag.liveBytes / 1024.0, tag.peakBytes / 1024.0)
+            .toStdString()
+        );
+    }
+}
+
+std::string CoreManager::GetMemoryReport() const {
+    const Allocator::Stats stats = _cubismAllocator.GetStats();
+    cJSON* root = cJSON_CreateObject();
+
+    cJSON* cubism = cJSON_AddObjectToObject(root, "cubism");
+    cJSON_AddStringToObject(cubism, "strategy", _cubismAllocator.GetStrategy() == Allocator::Pooled ? "pooled" : "heap");
+    cJSON_AddNumberToObject(cubism, "liveBytes", static_cast<double>(stats.liveBytes));
+    cJSON_AddNumberToObject(cubism, "peakBytes", static_cast<double>(stats.peakBytes));
+    cJSON_AddNumberToObject(cubism, "allocations", static_cast<double>(stats.allocations));
+    cJSON_AddNumberToObject(cubism, "deallocations", static_cast<double>(stats.deallocations));
+    cJSON_AddNumberToObject(cubism, "poolReservedBytes", static_cast<double>(stats.poolReservedBytes));
+    cJSON_AddNumberToObject(cubism, "arenaReservedBytes", static_cast<double>(stats.arenaReservedBytes));
+    cJSON* tags = cJSON_AddObjectToObject(cubism, "tags");
+    for (int i = 0; i < Allocator::TagCount; i++) {
+        const Allocator::TagStats& tag = stats.tags[i];
+        cJSON* node = cJSON_AddObjectToObject(tags, Allocator::GetTagName(static_cast<Allocator::Tag>(i)));
+        cJSON_AddNumberToObject(node, "liveBytes", static_cast<double>(tag.liveBytes));
+        cJSON_AddNumberToObject(node, "peakBytes", static_cast<double>(tag.peakBytes));
+        cJSON_AddNumberToObject(node, "liveCount", static_cast<double>(tag.liveCount));
+        cJSON_AddNumberToObject(node, "allocations", static_cast<double>(tag.allocations));
+    }
+
+    /* Estimated from the sizes & formats, the driver may use more. */
+    if (_textureManager != NULL) {
+        const TextureManager::MemoryStats textures = _textureManager->GetMemoryStats();
+        cJSON* node = cJSON_AddObjectToObject(root, "textureVram");
+        cJSON_AddNumberToObject(node, "count", static_cast<double>(textures.textureCount));
+        cJSON_AddNumberToObject(node, "residentBytes", static_cast<double>(textures.residentBytes));
+        cJSON_AddNumberToObject(node, "unusedBytes", static_cast<double>(textures.unusedBytes));
+        cJSON_AddNumberToObject(node, "peakBytes", static_cast<double>(textures.peakBytes));
+        cJSON_AddNumberToObject(node, "pending", static_cast<double>(textures.pendingCount));
+    }
+
+    char* text = cJSON_Print(root);
+    std::string report = text != NULL ? text : "";
+    cJSON_free(text);
+    cJSON_Delete(root);
+    return report;
 }
 
 
@@ -80,6 +146,9 @@ void CoreManager::update() {
     APP_CALL_GLFUNC glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     APP_CALL_GLFUNC glClearDepthf(1.0);
 
+    /* Stream pending textures within the per-frame upload budget. */
+    _textureManager->Update();
+
     /* Update render engine. */
     _view->Render();
 }
@@ -104,6 +173,7 @@ CoreManager::~CoreManager() {
 
 void CoreManager::InitializeCubism() {
     /* Setup Cubism SDK. */
+    _cubismAllocator.SetStrategy(CUBISM_POOLED_ALLOCATOR ? Allocator::Pooled : Allocator::Heap);
     Csm::CubismFramework::StartUp(&_cubismAllocator);
 
     /* Initialize Cubism SDK. */
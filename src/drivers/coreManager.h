@@ -7,6 +7,8 @@
  */
 
 #pragma once
+#include <string>
+
 #include "drivers/allocator.h"
 #include "gui/animeWidget.h"
 
@@ -83,6 +85,18 @@ public:
 
     TextureManager* GetTextureManager() { return _textureManager; }
 
+    /**
+     * @brief Counters of the Cubism SDK allocator.
+     */
+    Allocator::Stats GetAllocatorStats() const { return _cubismAllocator.GetStats(); }
+
+    /**
+     * @brief Memory report (JSON): Cubism allocations per tag with peaks, estimated texture VRAM.
+     *
+     * Sizes are in bytes.
+     */
+    std::string GetMemoryReport() const;
+
     /**
      * @brief Self-defined rule: Stop responding to tap when drag finished for one time.
      */
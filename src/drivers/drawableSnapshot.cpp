@@ -0,0 +1,163 @@
+#include <cstring>
+#include <utility>
+
+#include "drivers/drawableSnapshot.h"
+
+using namespace Live2D::Cubism::Framework;
+namespace Core = Live2D::Cubism::Core;
+
+namespace {
+    /* Flags telling what changed during an update (all but csmIsVisible). */
+    const Core::csmFlags DidChangeFlags =
+        Core::csmVisibilityDidChange | Core::csmOpacityDidChange | Core::csmDrawOrderDidChange |
+        Core::csmRenderOrderDidChange | Core::csmVertexPositionsDidChange | Core::csmBlendColorDidChange;
+}
+
+DrawableSnapshotBuffer::DrawableSnapshotBuffer()
+    : _model(NULL)
+    , _back(0)
+    , _ready(1)
+    , _front(2)
+    , _previous(3)
+    , _hasReady(false)
+    , _takenTicks(0) {}
+
+void DrawableSnapshotBuffer::Initialize(const CubismModel* model) {
+    _model = model;
+
+    const csmInt32 drawableCount = model->GetDrawableCount();
+    _vertexOffsets.resize(drawableCount);
+    csmInt32 vertexCount = 0;
+    for (csmInt32 i = 0; i < drawableCount; i++) {
+        _vertexOffsets[i] = vertexCount;
+        vertexCount += model->GetDrawableVertexCount(i);
+    }
+
+    for (int i = 0; i < SlotCount; i++)
+        Resize(&_slots[i]);
+    Resize(&_interpolated);
+
+    _back = 0;
+    _ready = 1;
+    _front = 2;
+    _previous = 3;
+    _hasReady = false;
+    _takenTicks = 0;
+}
+
+void DrawableSnapshotBuffer::Resize(Slot* slot) {
+    const csmInt32 drawableCount = static_cast<csmInt32>(_vertexOffsets.size());
+    const csmInt32 vertexCount = drawableCount > 0 ? _vertexOffsets[drawableCount - 1] + _model->GetDrawableVertexCount(drawableCount - 1) : 0;
+
+    slot->positions.assign(vertexCount, Core::csmVector2());
+    slot->vertexPositions.resize(drawableCount);
+    for (csmInt32 i = 0; i < drawableCount; i++)
+        slot->vertexPositions[i] = slot->positions.data() + _vertexOffsets[i];
+    slot->opacities.assign(drawableCount, 0.0f);
+    slot->renderOrders.assign(drawableCount, 0);
+    slot->dynamicFlags.assign(drawableCount, 0);
+    slot->multiplyColors.assign(drawableCount, Core::csmVector4());
+    slot->screenColors.assign(drawableCount, Core::csmVector4());
+    slot->time = 0.0;
+
+    slot->view.VertexPositions = slot->vertexPositions.data();
+    slot->view.Opacities = slot->opacities.data();
+    slot->view.RenderOrders = slot->renderOrders.data();
+    slot->view.DynamicFlags = slot->dynamicFlags.data();
+    slot->view.MultiplyColors = slot->multiplyColors.data();
+    slot->view.ScreenColors = slot->screenColors.data();
+    slot->view.DirtySet = &slot->dirtySet;
+}
+
+void DrawableSnapshotBuffer::Capture(double time) {
+    if (_model == NULL)
+        return;
+
+    /* Only this thread moves `_back`. Read the live state (the model never has a snapshot set here). */
+    Slot& slot = _slots[_back];
+    Core::csmModel* model = _model->GetModel();
+    const csmInt32 drawableCount = static_cast<csmInt32>(_vertexOffsets.size());
+    const Core::csmVector2** positions = Core::csmGetDrawableVertexPositions(model);
+    const csmInt32* vertexCounts = Core::csmGetDrawableVertexCounts(model);
+    for (csmInt32 i = 0; i < drawableCount; i++)
+        memcpy(slot.positions.data() + _vertexOffsets[i], positions[i], sizeof(Core::csmVector2) * vertexCounts[i]);
+    memcpy(slot.opacities.data(), Core::csmGetDrawableOpacities(model), sizeof(csmFloat32) * drawableCount);
+    memcpy(slot.renderOrders.data(), Core::csmGetDrawableRenderOrders(model), sizeof(csmInt32) * drawableCount);
+    memcpy(slot.dynamicFlags.data(), Core::csmGetDrawableDynamicFlags(model), sizeof(Core::csmFlags) * drawableCount);
+    memcpy(slot.multiplyColors.data(), Core::csmGetDrawableMultiplyColors(model), sizeof(Core::csmVector4) * drawableCount);
+    memcpy(slot.screenColors.data(), Core::csmGetDrawableScreenColors(model), sizeof(Core::csmVector4) * drawableCount);
+    slot.dirtySet.CopyBits(_model->GetUpdatedDrawableDirtySet());
+    slot.time = time;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    /* The published snapshot was not drawn: what changed in it must not be lost. */
+    if (_hasReady) {
+        const Core::csmFlags* dropped = _slots[_ready].dynamicFlags.data();
+        for (csmInt32 i = 0; i < drawableCount; i++)
+            slot.dynamicFlags[i] |= dropped[i] & DidChangeFlags;
+        slot.dirtySet.Merge(_slots[_ready].dirtySet);
+    }
+    std::swap(_back, _ready);
+    _hasReady = true;
+}
+
+const CubismModel::DrawableSnapshot* DrawableSnapshotBuffer::Acquire(double time) {
+    bool taken = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_hasReady) {
+            const int ready = _ready;
+            _ready = _previous;
+            _previous = _front;
+            _front = ready;
+            _hasReady = false;
+            if (_takenTicks < 2)
+                _takenTicks++;
+            taken = true;
+        }
+    }
+    if (_takenTicks == 0)
+        return NULL;
+
+    const Slot& front = _slots[_front];
+    const Slot& previous = _slots[_previous];
+
+    /*
+     * Between two ticks the drawn state moves from `previous` to `front`: what changed in `front`.
+     * Taking a tick also finishes the move from the tick before `previous`: what changed in `previous` too.
+     */
+    _dirty.CopyBits(front.dirtySet);
+    if (taken && _takenTicks >= 2)
+        _dirty.Merge(previous.dirtySet);
+
+    _interpolated.view = front.view;
+    _interpolated.view.DirtySet = &_dirty;
+    if (_takenTicks < 2)
+        return &_interpolated.view;
+
+    /* Drawn one tick behind: `previous` is shown at `front.time`, `front` one period later. */
+    const double period = front.time - previous.time;
+    if (period <= 0.0)
+        return &_interpolated.view;
+    const double alpha = (time - front.time) / period;
+    if (alpha >= 1.0)
+        return &_interpolated.view;
+    const csmFloat32 t = alpha > 0.0 ? static_cast<csmFloat32>(alpha) : 0.0f;
+
+    const size_t vertexCount = front.positions.size();
+    const Core::csmVector2* from = previous.positions.data();
+    const Core::csmVector2* to = front.positions.data();
+    Core::csmVector2* out = _interpolated.positions.data();
+    for (size_t i = 0; i < vertexCount; i++) {
+        out[i].X = from[i].X + (to[i].X - from[i].X) * t;
+        out[i].Y = from[i].Y + (to[i].Y - from[i].Y) * t;
+    }
+    const size_t drawableCount = front.opacities.size();
+    for (size_t i = 0; i < drawableCount; i++)
+        _interpolated.opacities[i] = previous.opacities[i] + (front.opacities[i] - previous.opacities[i]) * t;
+
+    /* Orders, flags & colors are not interpolated. */
+    _interpolated.view.VertexPositions = _interpolated.vertexPositions.data();
+    _interpolated.view.Opacities = _interpolated.opacities.data();
+    return &_interpolated.view;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file drawableSnapshot.h
+ * @brief A source file defining the drawable snapshots handed from the simulation thread to the GL thread.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <Model/CubismModel.hpp>
+
+/**
+ * @class DrawableSnapshotBuffer
+ * @brief Drawable states of a model, captured on the simulation thread and drawn on the GL thread.
+ *
+ * The simulation thread captures the model after each tick (`Capture`) and
+ * publishes it; the GL thread takes the latest one (`Acquire`) and interpolates
+ * the vertex positions & opacities between the last two ticks, i.e. draws one tick behind.
+ *
+ * Triple buffering, plus the previous tick kept for the interpolation: the slot
+ * being written, the published one and the two being drawn. Neither thread waits
+ * for the other (the lock only guards the exchange of the slots). A published
+ * snapshot replaced before being drawn is dropped, its "did change" flags and
+ * dirty set are carried to the next one.
+ */
+class DrawableSnapshotBuffer {
+public:
+    DrawableSnapshotBuffer();
+
+    DrawableSnapshotBuffer(const DrawableSnapshotBuffer&) = delete;
+    DrawableSnapshotBuffer& operator=(const DrawableSnapshotBuffer&) = delete;
+
+    /**
+     * @brief Size the slots for a model, dropping the captured snapshots.
+     *
+     * Neither thread may use the buffer meanwhile.
+     */
+    void Initialize(const Csm::CubismModel* model);
+
+    /**
+     * @brief Capture the drawables of the model (just updated) and publish them. Simulation thread.
+     *
+     * @param[in] time  Simulation time of the tick [s].
+     */
+    void Capture(double time);
+
+    /**
+     * @brief Take the latest snapshot, interpolated at `time`. GL thread.
+     *
+     * @param[in] time  Current time [s], on the clock of `Capture`.
+     * @return  Valid until the next call, NULL until a snapshot is captured.
+     */
+    const Csm::CubismModel::DrawableSnapshot* Acquire(double time);
+
+private:
+    struct Slot {
+        std::vector<Live2D::Cubism::Core::csmVector2> positions;               /**< Vertex positions of all the drawables. */
+        std::vector<const Live2D::Cubism::Core::csmVector2*> vertexPositions;  /**< Per drawable, into `positions`. */
+        std::vector<Csm::csmFloat32> opacities;
+        std::vector<Csm::csmInt32> renderOrders;
+        std::vector<Live2D::Cubism::Core::csmFlags> dynamicFlags;
+        std::vector<Live2D::Cubism::Core::csmVector4> multiplyColors;
+        std::vector<Live2D::Cubism::Core::csmVector4> screenColors;
+        Csm::CubismDrawableDirtySet dirtySet;  /**< Drawables changed by the tick. */
+        double time;
+        Csm::CubismModel::DrawableSnapshot view;
+    };
+
+    void Resize(Slot* slot);
+
+    enum {
+        SlotCount = 4,
+    };
+
+    const Csm::CubismModel* _model;
+    std::vector<Csm::csmInt32> _vertexOffsets;  /**< Offset of each drawable in `Slot::positions`. */
+    Slot _slots[SlotCount];
+    Slot _interpolated;                         /**< Positions & opacities drawn between two ticks (GL thread). */
+    Csm::CubismDrawableDirtySet _dirty;         /**< Drawables changed since the previous `Acquire` (GL thread). */
+
+    std::mutex _mutex;
+    int _back;          /**< Written by the simulation thread. */
+    int _ready;         /**< Published, not drawn yet if `_hasReady`. */
+    int _front;         /**< Latest tick taken by the GL thread. */
+    int _previous;      /**< Tick before `_front`. */
+    bool _hasReady;
+    int _takenTicks;    /**< Ticks taken by the GL thread, up to 2 (interpolation possible). */
+};
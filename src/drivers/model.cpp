@@ -1,6 +1,9 @@
 #include <fstream>
+#include <utility>
 #include <vector>
 
+#include <QtCore/QElapsedTimer>
+
 #include <Id/CubismIdManager.hpp>
 #include <Motion/CubismMotion.hpp>
 #include <Motion/CubismMotionQueueEntry.hpp>
@@ -17,6 +20,7 @@
 #include "drivers/modelParameters.h"
 #include "drivers/textureManager.h"
 #include "drivers/tools.h"
+#include "drivers/workerPool.h"
 
 #include "utils/consts.h"
 #include "utils/logger.h"
@@ -26,30 +30,107 @@ using namespace Live2D::Cubism::Framework::DefaultParameterId;
 using namespace ModelParameters;
 
 namespace {
-    csmByte* CreateBuffer(const csmChar* path, csmSizeInt* size) {
+    /* Resources are only read by the parsers: map them instead of copying. */
+    bool CreateBuffer(const csmChar* path, FileBuffer* buffer) {
         stdLogger.Debug(
             QString("Create resource buffer: %1")
             .arg(path)
             .toStdString().c_str()
         );
         
-        return ToolFunctions::LoadFileAsBytes(path, size);
+        return buffer->Open(path);
     }
 
-    void DeleteBuffer(csmByte* buffer, const csmChar* path = "") {
+    void DeleteBuffer(FileBuffer* buffer, const csmChar* path = "") {
         stdLogger.Debug(
             QString("Release resource buffer: %1")
             .arg(path)
             .toStdString().c_str()
         );
-        ToolFunctions::ReleaseBytes(buffer);
-    }
+        buffer->Close();
+    }
+
+    double ElapsedMs(const QElapsedTimer& timer) {
+        return timer.nsecsElapsed() / 1000000.0;
+    }
+
+    /**
+     * @brief One independent asset of model3.json, read & parsed on the worker pool.
+     *
+     * Textures are not jobs: they are decoded & streamed by the texture manager.
+     * Motions are not jobs either: they are parsed on first use by the motion cache.
+     * With a model bundle, the content is read from the bundle instead of the file.
+     *
+     * `Run` must not touch the model, the model setting or OpenGL.
+     */
+    struct AssetJob {
+        enum Type { Moc, Expression, Physics, Pose, UserData };
+
+        AssetJob(Type type, const csmString& path)
+            : type(type), path(path)
+            , entry(NULL), bytes(NULL), size(0)
+            , motion(NULL)
+            , physics(NULL), pose(NULL), userData(NULL) {}
+
+        void Run() {
+            if (entry != NULL) {
+                bytes = entry->data;
+                size = entry->size;
+            } else {
+                if (!CreateBuffer(path.GetRawString(), &buffer))
+                    return;
+                bytes = buffer.GetData();
+                size = buffer.GetSize();
+            }
+            switch (type) {
+            case Expression: motion = CubismExpressionMotion::Create(bytes, size); break;
+            case Physics:    physics = CubismPhysics::Create(bytes, size); break;
+            case Pose:       pose = CubismPose::Create(bytes, size); break;
+            case UserData:   userData = CubismModelUserData::Create(bytes, size); break;
+            default:
+                /* The moc is created on the GUI thread from the raw bytes. */
+                return;
+            }
+            if (buffer.IsOpen()) DeleteBuffer(&buffer, path.GetRawString());
+            bytes = NULL;
+            size = 0;
+        }
+
+        /* Release everything not taken by the model. */
+        void Release() {
+            if (buffer.IsOpen()) DeleteBuffer(&buffer, path.GetRawString());
+            if (motion) ACubismMotion::Delete(motion);
+            if (physics) CubismPhysics::Delete(physics);
+            if (pose) CubismPose::Delete(pose);
+            if (userData) CubismModelUserData::Delete(userData);
+            motion = NULL;
+            physics = NULL;
+            pose = NULL;
+            userData = NULL;
+        }
+
+        Type type;
+        csmString path;
+        csmString name;             /**< Expression name. */
+
+        const ModelBundle::Entry* entry;    /**< Content in the model bundle, NULL to read the file. */
+        FileBuffer buffer;
+        const csmByte* bytes;       /**< Raw bytes, kept for the moc only. */
+        csmSizeInt size;
+        ACubismMotion* motion;
+        CubismPhysics* physics;
+        CubismPose* pose;
+        CubismModelUserData* userData;
+    };
 }
 
 Model::Model()
     : CubismUserModel()
     , _modelSetting(NULL)
-    , _userTimeSeconds(0.0f) {
+    , _userTimeSeconds(0.0f)
+    , _arena(MODEL_ARENA_CHUNK_BYTES)
+    , _motionCache(MOTION_CACHE_BUDGET_BYTES)
+    , _loadTimings() {
 
     _idParamAngleX = CubismFramework::GetIdManager()->GetId(ParamAngleX);
     _idParamAngleY = CubismFramework::GetIdManager()->GetId(ParamAngleY);
@@ -62,6 +143,8 @@ Model::Model()
 Model::~Model() {
     _renderBuffer.DestroyOffscreenSurface();
 
+    ReleaseTextureReferences();
+
     ReleaseMotions();
     ReleaseExpressions();
     if(_modelSetting) {
@@ -73,8 +156,11 @@ Model::~Model() {
     }
 }
 
-bool Model::LoadAssets(const csmChar* dir, const csmChar* fileName) {
+bool Model::LoadAssets(const csmChar* dir, const csmChar* fileName, std::shared_ptr<const ModelBundle> bundle) {
+    /* Framework objects living as long as the model come from its arena, released with it. */
+    AllocationScope allocationScope(Allocator::TagModel, &_arena);
     _modelHomeDir = dir;
+    _bundle = bundle;
 
     stdLogger.Debug(
         QString("Load model configuration: %1")
@@ -82,21 +168,51 @@ bool Model::LoadAssets(const csmChar* dir, const csmChar* fileName) {
         .toStdString().c_str()
     );
 
-    csmSizeInt size;
+    QElapsedTimer totalTimer, phaseTimer;
+    totalTimer.start();
+    phaseTimer.start();
+
     const csmString path = csmString(dir) + fileName;
 
-    csmByte* buffer = CreateBuffer(path.GetRawString(), &size);
-    if(buffer == NULL)
-        return false;
-    
-    ICubismModelSetting* setting = new CubismModelSettingJson(buffer, size);
-    DeleteBuffer(buffer, path.GetRawString());
+    const ModelBundle::Entry* settingEntry = _bundle ? _bundle->Find(fileName) : NULL;
+    ICubismModelSetting* setting;
+    if (settingEntry != NULL) {
+        AllocationScope jsonScope(Allocator::TagJson);
+        /* The model keeps the bundle mapped as long as the setting refers to it. */
+        setting = new CubismModelSettingJson(settingEntry->data, settingEntry->size, true);
+    } else {
+        FileBuffer buffer;
+        if(!CreateBuffer(path.GetRawString(), &buffer))
+            return false;
+        AllocationScope jsonScope(Allocator::TagJson);
+        setting = new CubismModelSettingJson(buffer.GetData(), buffer.GetSize());
+        DeleteBuffer(&buffer, path.GetRawString());
+    }
+    _loadTimings.settingMs = ElapsedMs(phaseTimer);
 
-    SetupModel(setting);
+    if (!SetupModel(setting))
+        return false;
+    _drawables.Initialize(_model);
 
-    CreateRenderer();
+    phaseTimer.restart();
+    {
+        AllocationScope rendererScope(Allocator::TagRenderer);
+        CreateRenderer();
+    }
+    _loadTimings.rendererMs = ElapsedMs(phaseTimer);
 
+    phaseTimer.restart();
     SetupTextures();
+    _loadTimings.textureMs = ElapsedMs(phaseTimer);
+
+    _loadTimings.totalMs = ElapsedMs(totalTimer);
+    stdLogger.Info(
+        QString::asprintf("Model '%s' loaded from %s in %.1f ms (setting: %.1f, parallel assets: %.1f, moc: %.1f, "
+            "assemble: %.1f, renderer: %.1f, textures: %.1f)",
+            fileName, _bundle ? "bundle" : "json", _loadTimings.totalMs, _loadTimings.settingMs, _loadTimings.parallelMs,
+            _loadTimings.mocMs, _loadTimings.assembleMs, _loadTimings.rendererMs, _loadTimings.textureMs)
+        .toStdString()
+    );
     return true;
 }
 
@@ -108,74 +224,114 @@ bool Model::SetupModel(ICubismModelSetting* setting)
 
     _modelSetting = setting;
 
-    csmByte* buffer;
-    csmSizeInt size;
+    QElapsedTimer phaseTimer;
+    phaseTimer.start();
+
+    /* Collect the asset jobs. The model setting (JSON) is not thread-safe, so read it here. */
+    std::vector<AssetJob> jobs;
+    csmInt32 mocJob = -1;
+    auto addJob = [this, &jobs](AssetJob::Type type, const csmChar* file) -> AssetJob& {
+        jobs.push_back(AssetJob(type, _modelHomeDir + file));
+        if (_bundle)
+            jobs.back().entry = _bundle->Find(file);
+        return jobs.back();
+    };
 
-    /* Cubism Model */
     if (strcmp(_modelSetting->GetModelFileName(), "") != 0) {
-        csmString path = _modelSetting->GetModelFileName();
-        path = _modelHomeDir + path;
+        mocJob = static_cast<csmInt32>(jobs.size());
+        addJob(AssetJob::Moc, _modelSetting->GetModelFileName());
+    }
+    for (csmInt32 i = 0; i < _modelSetting->GetExpressionCount(); i++) {
+        addJob(AssetJob::Expression, _modelSetting->GetExpressionFileName(i)).name = _modelSetting->GetExpressionName(i);
+    }
+    if (strcmp(_modelSetting->GetPhysicsFileName(), "") != 0) {
+        addJob(AssetJob::Physics, _modelSetting->GetPhysicsFileName());
+    }
+    if (strcmp(_modelSetting->GetPoseFileName(), "") != 0) {
+        addJob(AssetJob::Pose, _modelSetting->GetPoseFileName());
+    }
+    if (strcmp(_modelSetting->GetUserDataFile(), "") != 0) {
+        addJob(AssetJob::UserData, _modelSetting->GetUserDataFile());
+    }
+
+    /* Read & parse on the worker pool. */
+    AllocatorArena* arena = &_arena;
+    WorkerPool::GetInstance()->ParallelFor(static_cast<int>(jobs.size()), [&jobs, arena](int i) {
+        AllocationScope allocationScope(jobs[i].type == AssetJob::Physics ? Allocator::TagPhysics : Allocator::TagModel, arena);
+        jobs[i].Run();
+    });
+    _loadTimings.parallelMs = ElapsedMs(phaseTimer);
 
+    /* Cubism Model */
+    phaseTimer.restart();
+    if (mocJob >= 0) {
+        AssetJob& job = jobs[mocJob];
         stdLogger.Debug(
             QString("Create model: %1")
             .arg(setting->GetModelFileName())
             .toStdString().c_str()
         );
-
-        buffer = CreateBuffer(path.GetRawString(), &size);
-        if(buffer==NULL)
+        if (job.bytes == NULL) {
+            for (AssetJob& other : jobs)
+                other.Release();
             return false;
-        
-        LoadModel(buffer, size);
-        DeleteBuffer(buffer, path.GetRawString());
-    }
-
-    /* Expression */
-    if (_modelSetting->GetExpressionCount() > 0) {
-        const csmInt32 count = _modelSetting->GetExpressionCount();
-        for (csmInt32 i = 0; i < count; i++) {
-            csmString name = _modelSetting->GetExpressionName(i);
-            csmString path = _modelSetting->GetExpressionFileName(i);
-            path = _modelHomeDir + path;
-
-            buffer = CreateBuffer(path.GetRawString(), &size);
-            if(buffer == NULL)
-                return false;
-
-            ACubismMotion* motion = LoadExpression(buffer, size, name.GetRawString());
-
-            if (_expressions[name] != NULL) {
-                ACubismMotion::Delete(_expressions[name]);
-                _expressions[name] = NULL;
-            }
-            _expressions[name] = motion;
-
-            DeleteBuffer(buffer, path.GetRawString());
         }
+        /* CubismMoc copies the bytes into its own aligned buffer before reviving them:
+         * reviving rewrites the moc, and the bundle mapping is read-only. */
+        LoadModel(job.bytes, job.size);
     }
+    _loadTimings.mocMs = ElapsedMs(phaseTimer);
 
-    /* Physics */
-    if (strcmp(_modelSetting->GetPhysicsFileName(), "") != 0) {
-        csmString path = _modelSetting->GetPhysicsFileName();
-        path = _modelHomeDir + path;
+    phaseTimer.restart();
 
-        buffer = CreateBuffer(path.GetRawString(), &size);
-        if(buffer) {
-            LoadPhysics(buffer, size);
-            DeleteBuffer(buffer, path.GetRawString());
+    /* EyeBlinkIds & LipSyncIds are needed by motions. */
+    {
+        csmInt32 eyeBlinkIdCount = _modelSetting->GetEyeBlinkParameterCount();
+        for (csmInt32 i = 0; i < eyeBlinkIdCount; ++i) {
+            _eyeBlinkIds.PushBack(_modelSetting->GetEyeBlinkParameterId(i));
+        }
+        csmInt32 lipSyncIdCount = _modelSetting->GetLipSyncParameterCount();
+        for (csmInt32 i = 0; i < lipSyncIdCount; ++i) {
+            _lipSyncIds.PushBack(_modelSetting->GetLipSyncParameterId(i));
         }
     }
 
-    /* Pose */
-    if (strcmp(_modelSetting->GetPoseFileName(), "") != 0) {
-        csmString path = _modelSetting->GetPoseFileName();
-        path = _modelHomeDir + path;
-
-        buffer = CreateBuffer(path.GetRawString(), &size);
-        if(buffer) {
-            LoadPose(buffer, size);
-            DeleteBuffer(buffer, path.GetRawString());
+    /* Attach parsed assets in the order of model3.json. */
+    for (AssetJob& job : jobs) {
+        switch (job.type) {
+        case AssetJob::Expression:
+            if (job.motion == NULL) {
+                stdLogger.Warning(
+                    QString("Failed to load expression: %1")
+                    .arg(job.path.GetRawString())
+                    .toStdString()
+                );
+                break;
+            }
+            {
+                ACubismMotion*& expression = _expressions[job.name];
+                if (expression != NULL)
+                    ACubismMotion::Delete(expression);
+                expression = job.motion;
+            }
+            job.motion = NULL;
+            break;
+        case AssetJob::Physics:
+            _physics = job.physics;
+            job.physics = NULL;
+            break;
+        case AssetJob::Pose:
+            _pose = job.pose;
+            job.pose = NULL;
+            break;
+        case AssetJob::UserData:
+            _modelUserData = job.userData;
+            job.userData = NULL;
+            break;
+        default:
+            break;
         }
+        job.Release();
     }
 
     /* EyeBlink */
@@ -198,33 +354,6 @@ bool Model::SetupModel(ICubismModelSetting* setting)
         _breath->SetParameters(breathParameters);
     }
 
-    /* UserData */
-    if (strcmp(_modelSetting->GetUserDataFile(), "") != 0) {
-        csmString path = _modelSetting->GetUserDataFile();
-        path = _modelHomeDir + path;
-        buffer = CreateBuffer(path.GetRawString(), &size);
-        if(buffer) {
-            LoadUserData(buffer, size);
-            DeleteBuffer(buffer, path.GetRawString());
-        }
-    }
-
-    /* EyeBlinkIds */
-    {
-        csmInt32 eyeBlinkIdCount = _modelSetting->GetEyeBlinkParameterCount();
-        for (csmInt32 i = 0; i < eyeBlinkIdCount; ++i) {
-            _eyeBlinkIds.PushBack(_modelSetting->GetEyeBlinkParameterId(i));
-        }
-    }
-
-    /* LipSyncIds */
-    {
-        csmInt32 lipSyncIdCount = _modelSetting->GetLipSyncParameterCount();
-        for (csmInt32 i = 0; i < lipSyncIdCount; ++i) {
-            _lipSyncIds.PushBack(_modelSetting->GetLipSyncParameterId(i));
-        }
-    }
-
     /* Layout */
     csmMap<csmString, csmFloat32> layout;
     _modelSetting->GetLayoutMap(layout);
@@ -232,18 +361,47 @@ bool Model::SetupModel(ICubismModelSetting* setting)
 
     _model->SaveParameters();
 
-    for (csmInt32 i = 0; i < _modelSetting->GetMotionGroupCount(); i++) {
-        const csmChar* group = _modelSetting->GetMotionGroupName(i);
-        PreloadMotionGroup(group);
+    /* Parameters updated every frame: look them up once. */
+    {
+        const CubismIdHandle dragIds[] = {
+            _idParamAngleX, _idParamAngleY, _idParamAngleZ, _idParamBodyAngleX, _idParamEyeBallX, _idParamEyeBallY,
+        };
+        _dragParameterIndices.Clear();
+        for (csmUint32 i = 0; i < sizeof(dragIds) / sizeof(dragIds[0]); ++i) {
+            _dragParameterIndices.PushBack(_model->GetParameterIndex(dragIds[i]));
+        }
+        _lipSyncParameterIndices.Clear();
+        for (csmUint32 i = 0; i < _lipSyncIds.GetSize(); ++i) {
+            _lipSyncParameterIndices.PushBack(_model->GetParameterIndex(_lipSyncIds[i]));
+        }
     }
 
     _motionManager->StopAllMotions();
+    _loadTimings.assembleMs = ElapsedMs(phaseTimer);
+
+    /* Motions are parsed on first use; the idle ones are needed right away. */
+    PreloadMotionGroup(MotionGroupIdle);
 
     _updating = false;
     _initialized = true;
     return true;
 }
 
+void Model::SetupMotion(const csmString& name, const csmChar* group, csmInt32 no, CubismMotion* motion, size_t bytes) {
+    csmFloat32 fadeTime = _modelSetting->GetMotionFadeInTimeValue(group, no);
+    if (fadeTime >= 0.0f) {
+        motion->SetFadeInTime(fadeTime);
+    }
+
+    fadeTime = _modelSetting->GetMotionFadeOutTimeValue(group, no);
+    if (fadeTime >= 0.0f) {
+        motion->SetFadeOutTime(fadeTime);
+    }
+    motion->SetEffectIds(_eyeBlinkIds, _lipSyncIds);
+
+    _motionCache.Insert(name.GetRawString(), motion, bytes);
+}
+
 void Model::PreloadMotionGroup(const csmChar* group) {
     const csmInt32 count = _modelSetting->GetMotionCount(group);
 
@@ -254,37 +412,72 @@ void Model::PreloadMotionGroup(const csmChar* group) {
         path = _modelHomeDir + path;
 
         stdLogger.Debug(
-            QString("Load motion: %1 => [%2_%3] ")
+            QString("Prefetch motion: %1 => [%2_%3] ")
             .arg(path.GetRawString())
             .arg(group)
             .arg(i)
             .toStdString().c_str()
         );
 
-        csmByte* buffer;
-        csmSizeInt size;
-        buffer = CreateBuffer(path.GetRawString(), &size);
-        if(buffer) {
-            CubismMotion* tmpMotion = static_cast<CubismMotion*>(LoadMotion(buffer, size, name.GetRawString()));
-            csmFloat32 fadeTime = _modelSetting->GetMotionFadeInTimeValue(group, i);
-            if (fadeTime >= 0.0f) {
-                tmpMotion->SetFadeInTime(fadeTime);
-            }
+        _motionCache.Prefetch(name.GetRawString(), group, i, GetMotionLoader(group, i));
+    }
+}
 
-            fadeTime = _modelSetting->GetMotionFadeOutTimeValue(group, i);
-            if (fadeTime >= 0.0f) {
-                tmpMotion->SetFadeOutTime(fadeTime);
-            }
-            tmpMotion->SetEffectIds(_eyeBlinkIds, _lipSyncIds);
+CubismMotion* Model::AcquireMotion(const csmChar* group, csmInt32 no) {
+    //ex) idle_0
+    const csmString name = Utils::CubismString::GetFormatedString("%s_%d", group, no);
+    CubismMotion* motion = _motionCache.Find(name.GetRawString());
+    if (motion != NULL)
+        return motion;
 
-            if (_motions[name] != NULL) {
-                ACubismMotion::Delete(_motions[name]);
-            }
-            _motions[name] = tmpMotion;
+    /* Not used yet (or evicted): parse it now. */
+    stdLogger.Debug(
+        QString("Load motion: %1 => [%2_%3] ")
+        .arg(_modelSetting->GetMotionFileName(group, no))
+        .arg(group)
+        .arg(no)
+        .toStdString().c_str()
+    );
+
+    size_t bytes;
+    motion = GetMotionLoader(group, no)(&bytes);
+    if (motion != NULL)
+        SetupMotion(name, group, no, motion, bytes);
+    return motion;
+}
+
+MotionCache::Loader Model::GetMotionLoader(const csmChar* group, csmInt32 no) const {
+    const csmChar* file = _modelSetting->GetMotionFileName(group, no);
+    const ModelBundle::Entry* entry = _bundle ? _bundle->Find(file) : NULL;
+    if (entry != NULL) {
+        /* The job keeps the bundle mapped, even if the model is released meanwhile. */
+        std::shared_ptr<const ModelBundle> bundle = _bundle;
+        return [bundle, entry](size_t* bytes) {
+            return MotionCache::Load(entry->data, entry->size, bytes);
+        };
+    }
+
+    const std::string path = std::string(_modelHomeDir.GetRawString()) + file;
+    return [path](size_t* bytes) {
+        return MotionCache::Load(path, bytes);
+    };
+}
 
-            DeleteBuffer(buffer, path.GetRawString());
+void Model::UpdateMotionCache() {
+    std::vector<MotionCache::LoadedMotion> prefetched;
+    _motionCache.TakePrefetched(&prefetched);
+    for (MotionCache::LoadedMotion& item : prefetched) {
+        if (item.motion == NULL)
+            continue;
+        /* Already parsed on demand meanwhile. */
+        if (_motionCache.Find(item.name) != NULL) {
+            ACubismMotion::Delete(item.motion);
+            continue;
         }
+        SetupMotion(item.name.c_str(), item.group.c_str(), item.no, item.motion, item.bytes);
     }
+
+    _motionCache.Evict(_motionManager);
 }
 
 void Model::ReleaseMotionGroup(const csmChar* group) const {
@@ -299,23 +492,18 @@ void Model::ReleaseMotionGroup(const csmChar* group) const {
 }
 
 void Model::ReleaseMotions() {
-    for (csmMap<csmString, ACubismMotion*>::const_iterator iter = _motions.Begin(); iter != _motions.End(); ++iter) {
-        ACubismMotion::Delete(iter->Second);
-    }
-
-    _motions.Clear();
+    _motionCache.Clear();
 }
 
 void Model::ReleaseExpressions() {
-    for (csmMap<csmString, ACubismMotion*>::const_iterator iter = _expressions.Begin(); iter != _expressions.End(); ++iter) {
+    for (csmHashMap<csmString, ACubismMotion*>::const_iterator iter = _expressions.Begin(); iter != _expressions.End(); ++iter) {
         ACubismMotion::Delete(iter->Second);
     }
 
     _expressions.Clear();
 }
 
-void Model::Update() {
-    const csmFloat32 deltaTimeSeconds = ToolFunctions::GetDeltaTime();
+void Model::Update(csmFloat32 deltaTimeSeconds) {
     _userTimeSeconds += deltaTimeSeconds;
 
     _dragManager->Update(deltaTimeSeconds);
@@ -325,6 +513,8 @@ void Model::Update() {
     /* Parameter update by motion or not. */
     csmBool motionUpdated = false;
 
+    UpdateMotionCache();
+
     /* --------------- */
     _model->LoadParameters(); /* Load last saved state. */
     if (_motionManager->IsFinished()) {
@@ -349,18 +539,19 @@ void Model::Update() {
         _expressionManager->UpdateMotion(_model, deltaTimeSeconds); /* Parameter update by facial expression (relative change) */
     }
 
-    /* Changes by dragging */
-    /* Adjustment of face direction by dragging */
-    _model->AddParameterValue(_idParamAngleX, _dragX * 30); /* Add a value of -30 to 30. */
-    _model->AddParameterValue(_idParamAngleY, _dragY * 30);
-    _model->AddParameterValue(_idParamAngleZ, _dragX * _dragY * -30);
-
-    /* Adjusting body orientation by dragging. */
-    _model->AddParameterValue(_idParamBodyAngleX, _dragX * 10); /* Add a value of -10 to 10. */
-
-    /* Drag to adjust eye orientation. */
-    _model->AddParameterValue(_idParamEyeBallX, _dragX); /* Add a value of -1 to 1. */
-    _model->AddParameterValue(_idParamEyeBallY, _dragY);
+    /* Changes by dragging, in the order of `_dragParameterIndices` */
+    const csmFloat32 dragValues[] = {
+        /* Adjustment of face direction by dragging */
+        _dragX * 30, /* Add a value of -30 to 30. */
+        _dragY * 30,
+        _dragX * _dragY * -30,
+        /* Adjusting body orientation by dragging. */
+        _dragX * 10, /* Add a value of -10 to 10. */
+        /* Drag to adjust eye orientation. */
+        _dragX, /* Add a value of -1 to 1. */
+        _dragY,
+    };
+    _model->AddParameterValues(_dragParameterIndices.GetPtr(), dragValues, _dragParameterIndices.GetSize());
 
     /* Breath */
     if (_breath != NULL) {
@@ -382,8 +573,9 @@ void Model::Update() {
         _wavFileHandler.Update(deltaTimeSeconds);
         value = _wavFileHandler.GetRms();
 
-        for (csmUint32 i = 0; i < _lipSyncIds.GetSize(); ++i) {
-            _model->AddParameterValue(_lipSyncIds[i], value, LIP_SYNC_RMS_WEIGHT);
+        /* Added with the other deltas right before the model update. */
+        for (csmUint32 i = 0; i < _lipSyncParameterIndices.GetSize(); ++i) {
+            _model->AccumulateParameterValue(_lipSyncParameterIndices[i], value, LIP_SYNC_RMS_WEIGHT);
         }
     }
 
@@ -392,6 +584,7 @@ void Model::Update() {
         _pose->UpdateParameters(_model, deltaTimeSeconds);
     }
 
+    _model->ApplyAccumulatedParameterValues();
     _model->Update();
 
 }
@@ -402,52 +595,27 @@ csmBool Model::StartLipSync(const Csm::csmString& filePath) {
 }
 
 CubismMotionQueueEntryHandle Model::StartMotion(const csmChar* group, csmInt32 no, csmInt32 priority, ACubismMotion::FinishedMotionCallback onFinishedMotionHandler) {
-    if (priority == PriorityForce) {
-        _motionManager->SetReservePriority(priority);
-    } else if (!_motionManager->ReserveMotion(priority)) {
+    /* Rejected while a motion of higher or equal priority plays, e.g. on every tap of a tap spam: format without allocating. */
+    char message[128];
+    if (!_motionManager->ReserveMotion(priority, priority == PriorityForce)) {
+        snprintf(message, sizeof(message), "Failed to start motion: %s (%d)", group, no);
+        stdLogger.Exception(message);
+        return InvalidMotionQueueEntryHandleValue;
+    }
+
+    /* Owned by the motion cache, which never evicts a motion in the queue. */
+    CubismMotion* motion = AcquireMotion(group, no);
+    if (motion == NULL) {
         stdLogger.Exception(
-            QString("Failed to start motion: %1 (%2)")
+            QString("Failed to load motion: %1 (%2)")
             .arg(group)
             .arg(no)
             .toStdString().c_str()
         );
+        _motionManager->CancelReservation(priority);
         return InvalidMotionQueueEntryHandleValue;
     }
-
-    const csmString fileName = _modelSetting->GetMotionFileName(group, no);
-
-    //ex) idle_0
-    csmString name = Utils::CubismString::GetFormatedString("%s_%d", group, no);
-    CubismMotion* motion = static_cast<CubismMotion*>(_motions[name.GetRawString()]);
-    csmBool autoDelete = false;
-
-    if (motion == NULL) {
-        csmString path = fileName;
-        path = _modelHomeDir + path;
-
-        csmByte* buffer;
-        csmSizeInt size;
-        buffer = CreateBuffer(path.GetRawString(), &size);
-        if(buffer) {
-            motion = static_cast<CubismMotion*>(LoadMotion(buffer, size, NULL, onFinishedMotionHandler));
-            csmFloat32 fadeTime = _modelSetting->GetMotionFadeInTimeValue(group, no);
-            if (fadeTime >= 0.0f) {
-                motion->SetFadeInTime(fadeTime);
-            }
-
-            fadeTime = _modelSetting->GetMotionFadeOutTimeValue(group, no);
-            if (fadeTime >= 0.0f) {
-                motion->SetFadeOutTime(fadeTime);
-            }
-            motion->SetEffectIds(_eyeBlinkIds, _lipSyncIds);
-            autoDelete = true; /* Removed from memory on exit. */
-
-            DeleteBuffer(buffer, path.GetRawString());
-        }
-    }
-    else {
-        motion->SetFinishedMotionHandler(onFinishedMotionHandler);
-    }
+    motion->SetFinishedMotionHandler(onFinishedMotionHandler);
 
     /* voice */
     csmString voice = _modelSetting->GetMotionSoundFileName(group, no);
@@ -458,13 +626,10 @@ CubismMotionQueueEntryHandle Model::StartMotion(const csmChar* group, csmInt32 n
         _wavFileHandler.Start(path.GetRawString());
     }
 
-    stdLogger.Debug(
-        QString("Start motion: [%1_%2]")
-        .arg(group)
-        .arg(no)
-        .toStdString().c_str()
-    );
-    return  _motionManager->StartMotionPriority(motion, autoDelete, priority);
+    /* Idle motions restart during steady-state frames: format without allocating. */
+    snprintf(message, sizeof(message), "Start motion: [%s_%d]", group, no);
+    stdLogger.Debug(message);
+    return  _motionManager->StartMotionPriority(motion, false, priority);
 }
 
 CubismMotionQueueEntryHandle Model::StartRandomMotion(const csmChar* group, csmInt32 priority, ACubismMotion::FinishedMotionCallback onFinishedMotionHandler) {
@@ -495,6 +660,27 @@ void Model::Draw(CubismMatrix44& matrix) {
     DoDraw();
 }
 
+void Model::CaptureDrawables(double time) {
+    if (_model == NULL)
+        return;
+
+    _drawables.Capture(time);
+}
+
+bool Model::DrawCaptured(CubismMatrix44& matrix, double time) {
+    if (_model == NULL)
+        return false;
+
+    const CubismModel::DrawableSnapshot* snapshot = _drawables.Acquire(time);
+    if (snapshot == NULL)
+        return false;
+
+    _model->SetDrawableSnapshot(snapshot);
+    Draw(matrix);
+    _model->SetDrawableSnapshot(NULL);
+    return true;
+}
+
 csmBool Model::HitTest(const csmChar* hitAreaName, csmFloat32 x, csmFloat32 y) {
     /* When transparent, there is no hit detection. */
     if (_opacity < 1)
@@ -511,7 +697,8 @@ csmBool Model::HitTest(const csmChar* hitAreaName, csmFloat32 x, csmFloat32 y) {
 }
 
 void Model::SetExpression(const csmChar* expressionID) {
-    ACubismMotion* motion = _expressions[expressionID];
+    ACubismMotion* const* expression = _expressions.Find(expressionID);
+    ACubismMotion* motion = expression != NULL ? *expression : NULL;
     stdLogger.Debug(
         QString("Expression: [%1]")
         .arg(expressionID)
@@ -535,7 +722,7 @@ void Model::SetRandomExpression() {
         return;
 
     csmInt32 no = rand() % _expressions.GetSize();
-    csmMap<csmString, ACubismMotion*>::const_iterator map_ite;
+    csmHashMap<csmString, ACubismMotion*>::const_iterator map_ite;
     csmInt32 i = 0;
     for (map_ite = _expressions.Begin(); map_ite != _expressions.End(); map_ite++) {
         if (i == no) {
@@ -548,6 +735,7 @@ void Model::SetRandomExpression() {
 }
 
 void Model::ReloadRenderer() {
+    AllocationScope allocationScope(Allocator::TagRenderer, &_arena);
     DeleteRenderer();
 
     CreateRenderer();
@@ -556,21 +744,39 @@ void Model::ReloadRenderer() {
 }
 
 void Model::SetupTextures() {
+    /* The renderer is rebuilt: take the references again. */
+    ReleaseTextureReferences();
+
     for (csmInt32 modelTextureNumber = 0; modelTextureNumber < _modelSetting->GetTextureCount(); modelTextureNumber++) {
         /* Skip load-bind process if texture name is an empty string. */
         if (strcmp(_modelSetting->GetTextureFileName(modelTextureNumber), "") == 0)
             continue;
 
         /* Load textures into the OpenGL texture unit. */
+        TextureManager* textureManager = CoreManager::GetInstance()->GetTextureManager();
         csmString texturePath = _modelSetting->GetTextureFileName(modelTextureNumber);
         texturePath = _modelHomeDir + texturePath;
 
-        TextureManager::TextureInfo* texture = CoreManager::GetInstance()->GetTextureManager()->CreateTextureFromPngFile(texturePath.GetRawString());
-        if(texture != NULL) {
-            const csmInt32 glTextueNumber = texture->id;
-            /* OpenGL */
-            GetRenderer<Rendering::CubismRenderer_OpenGLES2>()->BindTexture(modelTextureNumber, glTextueNumber);
+        /* Pre-compressed in the bundle: uploaded at once, no decoding. */
+        const ModelBundle::Entry* entry = _bundle ? _bundle->Find(_modelSetting->GetTextureFileName(modelTextureNumber)) : NULL;
+        if (entry != NULL) {
+            TextureManager::TextureInfo* texture = textureManager->CreateTextureFromKtxData(texturePath.GetRawString(), entry->data, entry->size);
+            if (texture != NULL) {
+                _texturePaths.PushBack(texturePath);
+                GetRenderer<Rendering::CubismRenderer_OpenGLES2>()->BindTexture(modelTextureNumber, texture->id);
+                continue;
+            }
         }
+
+        /* Streamed by the texture manager: bind the placeholder now, rebind when ready. */
+        const GLuint glTextueNumber = textureManager->CreateTextureFromPngFileAsync(
+            texturePath.GetRawString(), this,
+            [this, modelTextureNumber](GLuint textureId) {
+                GetRenderer<Rendering::CubismRenderer_OpenGLES2>()->BindTexture(modelTextureNumber, textureId);
+            });
+        _texturePaths.PushBack(texturePath);
+        /* OpenGL */
+        GetRenderer<Rendering::CubismRenderer_OpenGLES2>()->BindTexture(modelTextureNumber, glTextueNumber);
     }
 
 #ifdef PREMULTIPLIED_ALPHA_ENABLE
@@ -581,6 +787,18 @@ void Model::SetupTextures() {
 
 }
 
+void Model::ReleaseTextureReferences() {
+    /* The texture manager is released first on shutdown. */
+    TextureManager* textureManager = CoreManager::GetInstance()->GetTextureManager();
+    if (textureManager != NULL) {
+        textureManager->CancelPendingTextures(this);
+        for (csmUint32 i = 0; i < _texturePaths.GetSize(); i++) {
+            textureManager->ReleaseTexture(_texturePaths[i].GetRawString());
+        }
+    }
+    _texturePaths.Clear();
+}
+
 void Model::MotionEventFired(const csmString& eventValue) {
     CubismLogInfo("%s is fired on Model!!", eventValue.GetRawString());
 }
@@ -8,13 +8,21 @@
 
 #pragma once
 
+#include <memory>
+
 #include <Model/CubismUserModel.hpp>
+#include <Motion/CubismMotion.hpp>
 #include <Rendering/OpenGL/CubismOffscreenSurface_OpenGLES2.hpp>
+#include <Type/csmHashMap.hpp>
 #include <Type/csmRectF.hpp>
 
 #include <CubismFramework.hpp>
 #include <ICubismModelSetting.hpp>
 
+#include "drivers/allocator.h"
+#include "drivers/drawableSnapshot.h"
+#include "drivers/modelBundle.h"
+#include "drivers/motionCache.h"
 #include "drivers/wavFileHandler.h"
 
 /**
@@ -29,14 +37,32 @@ class Model : public Csm::CubismUserModel {
     friend class ModelManager;
 public:
 
+    /**
+     * @struct LoadTimings
+     * @brief Time [ms] spent in each phase of `LoadAssets`.
+     */
+    struct LoadTimings {
+        double settingMs;   /**< Read & parse model3.json. */
+        double parallelMs;  /**< Read & parse assets on the worker pool. */
+        double mocMs;       /**< Create the moc & model instance. */
+        double assembleMs;  /**< Attach parsed assets to the model. */
+        double rendererMs;  /**< Create the renderer. */
+        double textureMs;   /**< Request textures (streamed over the next frames). */
+        double totalMs;
+    };
+
     Model();
     virtual ~Model();
 
     /**
      * @brief Generates a model from the directory and file path 
      *        where model3.json is located.
+     *
+     * @param[in] bundle  Pre-baked assets of the model (optional): assets found in
+     *                    the bundle are not read from the directory.
      */
-    bool LoadAssets(const Csm::csmChar* dir, const  Csm::csmChar* fileName);
+    bool LoadAssets(const Csm::csmChar* dir, const  Csm::csmChar* fileName,
+                    std::shared_ptr<const ModelBundle> bundle = nullptr);
 
     /**
      * @brief Rebuild the renderer.
@@ -48,8 +74,11 @@ public:
      * @brief Model update process. 
      * 
      * Determines the drawing state from the model parameters.
+     * Does not touch OpenGL: may run on the simulation thread.
+     *
+     * @param[in]  deltaTimeSeconds  Time elapsed since the last update [s]
      */
-    void Update();
+    void Update(Csm::csmFloat32 deltaTimeSeconds);
 
     /**
      * @brief The process of drawing the model.
@@ -60,6 +89,24 @@ public:
      */
     void Draw(Csm::CubismMatrix44& matrix);
 
+    /**
+     * @brief Capture the drawables for `DrawCaptured`, after `Update` (simulation thread).
+     *
+     * @param[in]  time  Simulation time of the update [s]
+     */
+    void CaptureDrawables(double time);
+
+    /**
+     * @brief Draw the captured drawables, interpolated at `time`, instead of the live model state.
+     *
+     * The model may be updated meanwhile on the simulation thread.
+     *
+     * @param[in]  matrix  View-Projection Matrix
+     * @param[in]  time    Current time [s], on the clock of `CaptureDrawables`
+     * @return     false if nothing is captured yet.
+     */
+    bool DrawCaptured(Csm::CubismMatrix44& matrix, double time);
+
     /**
      * @brief Allows models to read arbitrary external audio files directly to initiate lip-synchronization,
      *  without the need for the audio always specified in the model's JSON file.
@@ -137,6 +184,11 @@ public:
      */
     Csm::Rendering::CubismOffscreenSurface_OpenGLES2& GetRenderBuffer();
 
+    /**
+     * @brief Get the time spent in each phase of the last `LoadAssets`.
+     */
+    const LoadTimings& GetLoadTimings() const { return _loadTimings; }
+
 protected:
     /**
      * @brief The process of drawing the model.
@@ -159,11 +211,19 @@ private:
 
     /**
      * @brief Load textures into the OpenGL texture unit.
+     * 
+     * Textures are decoded & uploaded asynchronously by the texture manager:
+     * a placeholder is bound until they are ready.
      */
     void SetupTextures();
 
     /**
-     * @brief Load motion data in batches by group name.
+     * @brief Drop the references of the textures taken by `SetupTextures`.
+     */
+    void ReleaseTextureReferences();
+
+    /**
+     * @brief Parse the motions of a group in background, ahead of their first use.
      * 
      * Motion data names are obtained internally from ModelSetting.
      *
@@ -171,6 +231,34 @@ private:
      */
     void PreloadMotionGroup(const Csm::csmChar* group);
 
+    /**
+     * @brief Apply fade times & effect IDs of model3.json to a loaded motion and register it.
+     *
+     * @param[in] name      Motion name (e.g. idle_0)
+     * @param[in] group     Motion data group name
+     * @param[in] no        The number of the motion in the group
+     * @param[in] motion    The loaded motion, owned by the motion cache afterwards
+     * @param[in] bytes     Estimated memory usage of the motion
+     */
+    void SetupMotion(const Csm::csmString& name, const Csm::csmChar* group, Csm::csmInt32 no, Csm::CubismMotion* motion, size_t bytes);
+
+    /**
+     * @brief Get a motion from the cache, parsing it synchronously on a miss.
+     *
+     * @return  NULL if the motion file cannot be loaded.
+     */
+    Csm::CubismMotion* AcquireMotion(const Csm::csmChar* group, Csm::csmInt32 no);
+
+    /**
+     * @brief Register the prefetched motions and evict the unused ones over the budget.
+     */
+    void UpdateMotionCache();
+
+    /**
+     * @brief Loader of a motion, reading the model bundle if any, the motion file otherwise.
+     */
+    MotionCache::Loader GetMotionLoader(const Csm::csmChar* group, Csm::csmInt32 no) const;
+
     /**
      * @brief Release motion data from the group name at once.
      * 
@@ -195,8 +283,9 @@ private:
     Csm::csmFloat32 _userTimeSeconds;                               /**< Totalized delta time [s]. */
     Csm::csmVector<Csm::CubismIdHandle> _eyeBlinkIds;               /**< Parameter ID for blink function set in the model. */
     Csm::csmVector<Csm::CubismIdHandle> _lipSyncIds;                /**< Parameter ID for lip-sync function set in the model. */
-    Csm::csmMap<Csm::csmString, Csm::ACubismMotion*> _motions;      /**< List of loaded motions. */
-    Csm::csmMap<Csm::csmString, Csm::ACubismMotion*> _expressions;  /**< List of loaded expressions. */
+    AllocatorArena _arena;                                          /**< Framework objects created while loading (pooled allocator). */
+    MotionCache _motionCache;                                       /**< Motions loaded on demand. */
+    Csm::csmHashMap<Csm::csmString, Csm::ACubismMotion*> _expressions;  /**< List of loaded expressions. */
     Csm::csmVector<Csm::csmRectF> _hitArea;
     Csm::csmVector<Csm::csmRectF> _userArea;
     const Csm::CubismId* _idParamAngleX;        /**< Parameter ID: ParamAngleX. */
@@ -205,9 +294,19 @@ private:
     const Csm::CubismId* _idParamBodyAngleX;    /**< Parameter ID: ParamBodyAngleX. */
     const Csm::CubismId* _idParamEyeBallX;      /**< Parameter ID: ParamEyeBallX. */
     const Csm::CubismId* _idParamEyeBallY;      /**< Parameter ID: ParamEyeBallY. */
+    Csm::csmVector<Csm::csmInt32> _dragParameterIndices;    /**< AngleX, AngleY, AngleZ, BodyAngleX, EyeBallX & EyeBallY in the model. */
+    Csm::csmVector<Csm::csmInt32> _lipSyncParameterIndices; /**< `_lipSyncIds` in the model. */
 
     WavFileHandler _wavFileHandler; /**< wav file handler. */
 
+    LoadTimings _loadTimings;       /**< Time spent in each phase of LoadAssets. */
+
+    std::shared_ptr<const ModelBundle> _bundle;     /**< Pre-baked assets, NULL when loaded from model3.json. */
+
+    Csm::csmVector<Csm::csmString> _texturePaths;   /**< Textures referenced in the texture manager. */
+
+    DrawableSnapshotBuffer _drawables;  /**< Drawables captured on the simulation thread. */
+
     Csm::Rendering::CubismOffscreenSurface_OpenGLES2  _renderBuffer;  /**< Drawing destination other than frame buffer. */
 };
 
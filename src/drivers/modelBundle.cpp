@@ -0,0 +1,296 @@
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+#include <sys/stat.h>
+
+#include <QtCore/QSaveFile>
+#include <QtCore/QString>
+
+#include <CubismModelSettingJson.hpp>
+
+#include "drivers/modelBundle.h"
+#include "drivers/textureCache.h"
+#include "drivers/textureManager.h"
+#include "drivers/workerPool.h"
+
+#include "utils/consts.h"
+#include "utils/logger.h"
+
+using namespace Live2D::Cubism::Framework;
+
+namespace {
+    const char BundleMagic[8] = { 'L', '2', 'D', 'B', 'N', 'D', 'L', '\0' };
+    const uint32_t BundleEndianness = 0x04030201;
+    /* Alignment of the moc (csmAlignofMoc), enough for everything else. */
+    const size_t BundleAlignment = 64;
+    const uint32_t FlagPremultiplied = 1;
+
+    /* Written in the native byte order, tagged by `endianness`. */
+    struct BundleHeader {
+        char magic[8];
+        uint32_t endianness;
+        uint32_t version;
+        uint32_t flags;
+        uint32_t textureFormat;
+        uint32_t entryCount;
+        uint32_t reserved;
+    };
+
+    struct BundleEntry {
+        uint32_t kind;
+        uint32_t nameSize;
+        uint64_t nameOffset;
+        uint64_t dataOffset;
+        uint64_t dataSize;
+        uint64_t sourceSize;    /* Source file when baked, to tell whether it was edited since. */
+        int64_t sourceMtime;
+    };
+
+    uint32_t GetBuildFlags() {
+#ifdef PREMULTIPLIED_ALPHA_ENABLE
+        return FlagPremultiplied;
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * @brief An asset to pack, read (and compressed) on the worker pool.
+     */
+    struct BakeItem {
+        ModelBundle::EntryKind kind;
+        std::string name;
+        std::vector<unsigned char> data;
+        uint64_t sourceSize = 0;
+        int64_t sourceMtime = 0;
+        bool success = false;
+    };
+
+    bool StatSource(const std::string& path, uint64_t* size, int64_t* mtime) {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            return false;
+        *size = static_cast<uint64_t>(st.st_size);
+        *mtime = static_cast<int64_t>(st.st_mtime);
+        return true;
+    }
+
+    void BakeItemData(const std::string& dir, GLenum textureFormat, BakeItem* item) {
+        /* Stat before reading: an edit made while baking then shows up as a newer source. */
+        if (!StatSource(dir + item->name, &item->sourceSize, &item->sourceMtime))
+            return;
+        FileBuffer file;
+        if (!file.Open(dir + item->name))
+            return;
+
+        if (item->kind != ModelBundle::Texture) {
+            item->data.assign(file.GetData(), file.GetData() + file.GetSize());
+            item->success = true;
+            return;
+        }
+
+        TextureManager::DecodedImage image;
+        if (!TextureManager::DecodePngData(file.GetData(), file.GetSize(), item->name, &image))
+            return;
+        TextureCache::CompressedImage compressed;
+        item->success = TextureCache::Compress(image.pixels, image.width, image.height, textureFormat, &compressed)
+                        && TextureCache::Serialize(compressed, &item->data);
+        TextureManager::ReleaseDecodedImage(&image);
+    }
+}
+
+ModelBundle::ModelBundle()
+    : _textureFormat(0) {
+}
+
+bool ModelBundle::Open(const std::string& path) {
+    _entries.clear();
+    _textureFormat = 0;
+    if (!_file.Open(path))
+        return false;
+
+    const csmByte* bytes = _file.GetData();
+    const size_t fileSize = _file.GetSize();
+
+    BundleHeader header;
+    if (fileSize < sizeof(header)) {
+        stdLogger.Warning(QString("Invalid model bundle: %1").arg(path.c_str()).toStdString());
+        _file.Close();
+        return false;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, BundleMagic, sizeof(BundleMagic)) != 0 || header.endianness != BundleEndianness) {
+        stdLogger.Warning(QString("Invalid model bundle: %1").arg(path.c_str()).toStdString());
+        _file.Close();
+        return false;
+    }
+    if (header.version != Version || header.flags != GetBuildFlags()) {
+        stdLogger.Warning(
+            QString("Model bundle %1 is baked by another version (%2), bake it again")
+            .arg(path.c_str())
+            .arg(header.version)
+            .toStdString()
+        );
+        _file.Close();
+        return false;
+    }
+
+    const size_t tableEnd = sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(BundleEntry);
+    if (tableEnd > fileSize) {
+        stdLogger.Warning(QString("Truncated model bundle: %1").arg(path.c_str()).toStdString());
+        _file.Close();
+        return false;
+    }
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        BundleEntry entry;
+        memcpy(&entry, bytes + sizeof(header) + i * sizeof(BundleEntry), sizeof(entry));
+        if (entry.nameOffset + entry.nameSize > fileSize || entry.dataOffset + entry.dataSize > fileSize
+            || entry.kind > Texture) {
+            stdLogger.Warning(QString("Truncated model bundle: %1").arg(path.c_str()).toStdString());
+            _entries.clear();
+            _file.Close();
+            return false;
+        }
+        const std::string name(reinterpret_cast<const char*>(bytes + entry.nameOffset), entry.nameSize);
+        _entries[name] = { static_cast<EntryKind>(entry.kind), bytes + entry.dataOffset, static_cast<csmSizeInt>(entry.dataSize),
+                           entry.sourceSize, entry.sourceMtime };
+    }
+    _textureFormat = header.textureFormat;
+    return true;
+}
+
+const ModelBundle::Entry* ModelBundle::Find(const std::string& name) const {
+    auto it = _entries.find(name);
+    return it != _entries.end() ? &it->second : NULL;
+}
+
+bool ModelBundle::IsUpToDate(const std::string& dir) const {
+    for (const auto& it : _entries) {
+        uint64_t size;
+        int64_t mtime;
+        /* A missing source is fine: the bundle can be shipped without the loose files. */
+        if (!StatSource(dir + it.first, &size, &mtime))
+            continue;
+        if (size != it.second.sourceSize || mtime != it.second.sourceMtime) {
+            stdLogger.Warning(
+                QString("Model bundle of %1 is out of date: %2 changed since it was baked, bake it again")
+                .arg(dir.c_str())
+                .arg(it.first.c_str())
+                .toStdString()
+            );
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string ModelBundle::GetBundlePath(const std::string& dir, const std::string& name) {
+    return dir + name + MODEL_BUNDLE_SUFFIX;
+}
+
+bool ModelBundle::Bake(const std::string& dir, const std::string& settingFileName,
+                       const std::string& outPath, GLenum textureFormat) {
+    std::vector<BakeItem> items;
+    std::unordered_set<std::string> names;
+    auto add = [&items, &names](EntryKind kind, const csmChar* name) {
+        /* A file can be referenced twice (e.g. one motion in two groups). */
+        if (strcmp(name, "") == 0 || !names.insert(name).second)
+            return;
+        BakeItem item;
+        item.kind = kind;
+        item.name = name;
+        items.push_back(std::move(item));
+    };
+
+    {
+        FileBuffer settingFile;
+        if (!settingFile.Open(dir + settingFileName))
+            return false;
+        CubismModelSettingJson setting(settingFile.GetData(), settingFile.GetSize());
+
+        add(Setting, settingFileName.c_str());
+        add(Moc, setting.GetModelFileName());
+        for (csmInt32 i = 0; i < setting.GetExpressionCount(); i++)
+            add(Expression, setting.GetExpressionFileName(i));
+        add(Physics, setting.GetPhysicsFileName());
+        add(Pose, setting.GetPoseFileName());
+        add(UserData, setting.GetUserDataFile());
+        for (csmInt32 i = 0; i < setting.GetMotionGroupCount(); i++) {
+            const csmChar* group = setting.GetMotionGroupName(i);
+            for (csmInt32 j = 0; j < setting.GetMotionCount(group); j++)
+                add(Motion, setting.GetMotionFileName(group, j));
+        }
+        for (csmInt32 i = 0; i < setting.GetTextureCount(); i++)
+            add(Texture, setting.GetTextureFileName(i));
+    }
+
+    /* Texture compression dominates: spread it over the worker pool. */
+    WorkerPool::GetInstance()->ParallelFor(static_cast<int>(items.size()), [&dir, &items, textureFormat](int i) {
+        BakeItemData(dir, textureFormat, &items[i]);
+    });
+    for (const BakeItem& item : items) {
+        if (!item.success) {
+            stdLogger.Exception(
+                QString("Failed to bake %1%2")
+                .arg(dir.c_str())
+                .arg(item.name.c_str())
+                .toStdString().c_str()
+            );
+            return false;
+        }
+    }
+
+    /* Layout: header, entry table, names, then the aligned data. */
+    BundleHeader header;
+    memcpy(header.magic, BundleMagic, sizeof(BundleMagic));
+    header.endianness = BundleEndianness;
+    header.version = Version;
+    header.flags = GetBuildFlags();
+    header.textureFormat = textureFormat;
+    header.entryCount = static_cast<uint32_t>(items.size());
+    header.reserved = 0;
+
+    std::vector<BundleEntry> table(items.size());
+    uint64_t offset = sizeof(header) + items.size() * sizeof(BundleEntry);
+    for (size_t i = 0; i < items.size(); i++) {
+        table[i].kind = items[i].kind;
+        table[i].nameSize = static_cast<uint32_t>(items[i].name.size());
+        table[i].nameOffset = offset;
+        table[i].sourceSize = items[i].sourceSize;
+        table[i].sourceMtime = items[i].sourceMtime;
+        offset += items[i].name.size();
+    }
+    for (size_t i = 0; i < items.size(); i++) {
+        offset = (offset + BundleAlignment - 1) / BundleAlignment * BundleAlignment;
+        table[i].dataOffset = offset;
+        table[i].dataSize = items[i].data.size();
+        offset += items[i].data.size();
+    }
+
+    /* QSaveFile writes aside and renames on commit: readers see either the old bundle or the new one. */
+    QSaveFile file(QString::fromStdString(outPath));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(BundleEntry));
+    for (const BakeItem& item : items)
+        file.write(item.name.data(), item.name.size());
+    const char padding[BundleAlignment] = {};
+    for (size_t i = 0; i < items.size(); i++) {
+        file.write(padding, static_cast<qint64>(table[i].dataOffset - static_cast<uint64_t>(file.pos())));
+        file.write(reinterpret_cast<const char*>(items[i].data.data()), items[i].data.size());
+    }
+    if (!file.commit())
+        return false;
+
+    stdLogger.Info(
+        QString("Baked %1 assets of %2%3 into %4 (%5 bytes)")
+        .arg(items.size())
+        .arg(dir.c_str())
+        .arg(settingFileName.c_str())
+        .arg(outPath.c_str())
+        .arg(static_cast<qulonglong>(offset))
+        .toStdString()
+    );
+    return true;
+}
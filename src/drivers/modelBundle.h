@@ -0,0 +1,127 @@
+/**
+ * @file modelBundle.h
+ * @brief A source file defining the pre-baked binary bundle of a model.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <CubismFramework.hpp>
+
+#include <AppOpenGLWrapper.hpp>
+
+#include "drivers/tools.h"
+
+/**
+ * @class ModelBundle
+ * @brief All assets of a model packed into one versioned file, mapped in memory.
+ *
+ * The bundle is made offline by `Bake` (see the `bake_model` tool): it holds the
+ * model3.json, the moc3, the expression / physics / pose / user data / motion
+ * files, and the textures already compressed with their mipmaps (KTX, see `TextureCache`).
+ * Loading a model from a bundle is a single mapping, with no png decoding and
+ * no file lookup per asset.
+ *
+ * Entries are named after the paths in model3.json (relative to the model directory),
+ * and their data are 64-byte aligned (the moc alignment). The mapping is read-only and
+ * shared by the models loaded from it, so the moc is still copied before being revived.
+ *
+ * Read-only once opened: `Find` is thread-safe.
+ */
+class ModelBundle {
+public:
+    /* Bump when the layout (or the content of an entry kind) changes. */
+    static const uint32_t Version = 2;
+
+    enum EntryKind : uint32_t {
+        Setting = 0,    /**< model3.json */
+        Moc,
+        Expression,
+        Physics,
+        Pose,
+        UserData,
+        Motion,
+        Texture,        /**< KTX content, see `TextureCache::Parse`. */
+    };
+
+    /**
+     * @struct Entry
+     * @brief One asset of the bundle, pointing into the mapping.
+     */
+    struct Entry {
+        EntryKind kind;
+        const Csm::csmByte* data;
+        Csm::csmSizeInt size;
+        uint64_t sourceSize;    /**< Size of the source file when baked. */
+        int64_t sourceMtime;    /**< Modification time of the source file when baked [s]. */
+    };
+
+    ModelBundle();
+
+    ModelBundle(const ModelBundle&) = delete;
+    ModelBundle& operator=(const ModelBundle&) = delete;
+
+    /**
+     * @brief Map a bundle file and check its header.
+     *
+     * @param[in] path  Bundle file path.
+     * @return  Whether the bundle is valid for this build.
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Find an entry by its path in model3.json.
+     *
+     * @return  NULL if the bundle does not have it.
+     */
+    const Entry* Find(const std::string& name) const;
+
+    /**
+     * @brief Check that no source file was edited since the bundle was baked.
+     *
+     * Every entry records the size and modification time of its file, so an edited
+     * texture or motion is caught as well as an edited model3.json. Missing files are skipped.
+     *
+     * @param[in] dir  Directory of model3.json (with the trailing slash).
+     * @return  Whether the bundle still matches the files in `dir`.
+     */
+    bool IsUpToDate(const std::string& dir) const;
+
+    /**
+     * @brief Compressed format of the textures (0 if the bundle has no texture).
+     */
+    GLenum GetTextureFormat() const { return _textureFormat; }
+
+    Csm::csmUint32 GetEntryCount() const { return static_cast<Csm::csmUint32>(_entries.size()); }
+
+    /**
+     * @brief Bundle path of a model: `<dir><name>.bundle`.
+     */
+    static std::string GetBundlePath(const std::string& dir, const std::string& name);
+
+    /**
+     * @brief Pack the assets referenced by a model3.json into a bundle file.
+     *
+     * The Cubism framework must be initialized. Textures are compressed on the worker pool.
+     *
+     * @param[in] dir              Directory of model3.json (with the trailing slash).
+     * @param[in] settingFileName  File name of model3.json.
+     * @param[in] outPath          Bundle file path, replaced atomically.
+     * @param[in] textureFormat    Compressed texture format (see `TextureCache::Compress`).
+     * @return  Whether the bundle is written.
+     */
+    static bool Bake(const std::string& dir, const std::string& settingFileName,
+                     const std::string& outPath, GLenum textureFormat);
+
+private:
+    FileBuffer _file;
+    GLenum _textureFormat;
+    std::unordered_map<std::string, Entry> _entries;
+};
@@ -1,16 +1,23 @@
+#include <chrono>
+#include <memory>
 #include <string>
+#include <sys/stat.h>
 
 #include <AppOpenGLWrapper.hpp>
 
 #include <Rendering/CubismRenderer.hpp>
 
 #include "drivers/coreManager.h"
+#include "utils/consts.h"
 #include "utils/logger.h"
 #include "drivers/model.h"
+#include "drivers/modelBundle.h"
 #include "drivers/modelManager.h"
 #include "drivers/modelParameters.h"
 #include "drivers/renderer.h"
 #include "drivers/resourceLoader.h"
+#include "drivers/tools.h"
+#include "drivers/workerPool.h"
 
 
 using namespace Csm;
@@ -20,6 +27,15 @@ using namespace ModelParameters;
 namespace {
     ModelManager* s_instance = NULL;
 
+    double ElapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /* Clock of the snapshots, shared by the simulation & GL threads [s]. */
+    double ToSeconds(std::chrono::steady_clock::time_point time) {
+        return std::chrono::duration<double>(time.time_since_epoch()).count();
+    }
+
     void FinishedMotion(ACubismMotion* self) {
         QString tmp;
         stdLogger.Debug(
@@ -27,6 +43,19 @@ namespace {
             .toStdString().c_str()
         );
     }
+
+    /* The bundle is skipped when any of its source files was edited since it was baked. */
+    std::shared_ptr<const ModelBundle> OpenModelBundle(const std::string& dir, const std::string& name) {
+        const std::string bundlePath = ModelBundle::GetBundlePath(dir, name);
+        struct stat bundleStat;
+        if (stat(bundlePath.c_str(), &bundleStat) != 0)
+            return nullptr;
+
+        std::shared_ptr<ModelBundle> bundle = std::make_shared<ModelBundle>();
+        if (!bundle->Open(bundlePath) || !bundle->IsUpToDate(dir))
+            return nullptr;
+        return bundle;
+    }
 }
 
 ModelManager* ModelManager::GetInstance() {
@@ -44,24 +73,42 @@ void ModelManager::ReleaseInstance() {
 }
 
 ModelManager::ModelManager()
-    : _viewMatrix(NULL) {
+    : _viewMatrix(NULL)
+    , _stopSimulation(false) {
     _viewMatrix = new CubismMatrix44();
 
     auto m = resourceLoader::get_instance().getCurrentModelName();
     if(!ChangeScene((Csm::csmChar*)m.toStdString().c_str())) {
         stdLogger.Exception("Failed to load current model. Please check your configuration file.");
     }
+
+    if (SIMULATION_THREAD)
+        _simulationThread = std::thread(&ModelManager::SimulationLoop, this);
 }
 
 ModelManager::~ModelManager() {
-    ReleaseAllModel();
+    {
+        std::lock_guard<std::mutex> lock(_modelMutex);
+        _stopSimulation = true;
+    }
+    _simulationCond.notify_all();
+    if (_simulationThread.joinable())
+        _simulationThread.join();
+
+    DeleteModels();
 }
 
 void ModelManager::ReleaseAllModel() {
+    std::lock_guard<std::mutex> lock(_modelMutex);
+    DeleteModels();
+}
+
+void ModelManager::DeleteModels() {
     for (csmUint32 i = 0; i < _models.GetSize(); i++)
         delete _models[i];
 
     _models.Clear();
+    _timings.Clear();
 }
 
 Model* ModelManager::GetModel(csmUint32 no) const {
@@ -72,6 +119,7 @@ Model* ModelManager::GetModel(csmUint32 no) const {
 }
 
 bool ModelManager::StartExternalLipSync(csmChar *filePath) const {
+    std::lock_guard<std::mutex> lock(_modelMutex);
     bool res = true;
     for (csmUint32 i = 0; i < _models.GetSize(); i++) {
         Model* model = GetModel(i);
@@ -82,6 +130,7 @@ bool ModelManager::StartExternalLipSync(csmChar *filePath) const {
 }
 
 void ModelManager::OnDrag(csmFloat32 x, csmFloat32 y) const {
+    std::lock_guard<std::mutex> lock(_modelMutex);
     for (csmUint32 i = 0; i < _models.GetSize(); i++) {
         Model* model = GetModel(i);
 
@@ -90,6 +139,7 @@ void ModelManager::OnDrag(csmFloat32 x, csmFloat32 y) const {
 }
 
 void ModelManager::OnTap(csmFloat32 x, csmFloat32 y) {
+    std::lock_guard<std::mutex> lock(_modelMutex);
     for (csmUint32 i = 0; i < _models.GetSize(); i++) {
         /* It was commented because many models do not have "hit area" designed. */
 
@@ -126,11 +176,21 @@ void ModelManager::OnUpdate() const
     int width = CoreManager::GetInstance()->GetWindow()->width();
     int height = CoreManager::GetInstance()->GetWindow()->height();
 
-    CubismMatrix44 projection;
+    /* The models only change on this thread: no lock needed to go through them. */
     csmUint32 modelCount = _models.GetSize();
+    if (!SIMULATION_THREAD) {
+        std::lock_guard<std::mutex> lock(_modelMutex);
+        UpdateModels(ToolFunctions::GetDeltaTime());
+    }
+    const double now = ToSeconds(std::chrono::steady_clock::now());
+
+    /* GL phase: draw serially. */
     for (csmUint32 i = 0; i < modelCount; ++i) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
         Model* model = GetModel(i);
 
+        /* One projection per model: Draw multiplies the model matrix into it. */
+        CubismMatrix44 projection;
         if (model->GetModel()->GetCanvasWidth() > 1.0f && width < height) {
             /* Calculate scale by the horizontal size of the model 
              * when displaying a long model in a portrait window. */
@@ -147,16 +207,61 @@ void ModelManager::OnUpdate() const
         /* Call before drawing a model. */
         CoreManager::GetInstance()->GetView()->PreModelDraw(*model);
 
-        model->Update();
         /* Since the reference is passed by reference, 
          * the PROJECTION is transformed. */
-        model->Draw(projection);
+        if (SIMULATION_THREAD)
+            model->DrawCaptured(projection, now);
+        else
+            model->Draw(projection);
 
         /* Call after drawing a model. */
         CoreManager::GetInstance()->GetView()->PostModelDraw(*model);
+        _timings[i].drawMs = ElapsedMs(start);
+    }
+}
+
+void ModelManager::UpdateModels(csmFloat32 deltaTimeSeconds) const {
+    /* The models are independent, update them in parallel.
+     * Nothing here may touch OpenGL (the context is only current on the GUI thread). */
+    WorkerPool::GetInstance()->ParallelFor(static_cast<int>(_models.GetSize()), [this, deltaTimeSeconds](int i) {
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        _models[i]->Update(deltaTimeSeconds);
+        _timings[i].updateMs = ElapsedMs(start);
+    });
+}
+
+void ModelManager::SimulationLoop() {
+    const std::chrono::steady_clock::duration period =
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / SIMULATION_TICK_HZ));
+    const csmFloat32 tickSeconds = 1.0f / static_cast<csmFloat32>(SIMULATION_TICK_HZ);
+    std::chrono::steady_clock::time_point tick = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(_modelMutex);
+    while (!_stopSimulation) {
+        /* Fixed step: the snapshots are stamped with the scheduled tick time, evenly spaced for the interpolation. */
+        UpdateModels(tickSeconds);
+        for (csmUint32 i = 0; i < _models.GetSize(); i++)
+            _models[i]->CaptureDrawables(ToSeconds(tick));
+
+        tick += period;
+        /* Far behind (a long model load, the machine slept...): skip the missed ticks rather than catching up. */
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now - tick > period * 4)
+            tick = now;
+        /* The models are unlocked while waiting. */
+        _simulationCond.wait_until(lock, tick, [this] { return _stopSimulation; });
     }
 }
 
+ModelManager::ModelTimings ModelManager::GetModelTimings(csmUint32 no) const {
+    std::lock_guard<std::mutex> lock(_modelMutex);
+    if (no < _timings.GetSize())
+        return _timings[no];
+
+    ModelTimings zero = { 0.0, 0.0 };
+    return zero;
+}
+
 bool ModelManager::ChangeScene(Csm::csmChar* name) {
     stdLogger.Debug(
         QString("Current model index: %1")
@@ -171,10 +276,15 @@ bool ModelManager::ChangeScene(Csm::csmChar* name) {
     snprintf(modelPath,128,"%s%s/",ResourcesPath,(char*)name);
     snprintf(modelJsonName,128,"%s.model3.json", (char*)name);
 
-    ReleaseAllModel();
+    /* Pre-baked assets (see the bake_model tool) skip most file reads & png decoding. */
+    std::shared_ptr<const ModelBundle> bundle = OpenModelBundle(modelPath, name);
+
+    /* The simulation thread waits until the new models are loaded. */
+    std::lock_guard<std::mutex> lock(_modelMutex);
+    DeleteModels();
     _models.PushBack(new Model());
-    if(_models[0]->LoadAssets(modelPath, modelJsonName)==false) {
-        ReleaseAllModel();
+    if(_models[0]->LoadAssets(modelPath, modelJsonName, bundle)==false) {
+        DeleteModels();
         return false;
     }
 
@@ -199,7 +309,7 @@ bool ModelManager::ChangeScene(Csm::csmChar* name) {
         /* As a sample of attaching alpha to individual models,
          * create another model and shift the position slightly. */
         _models.PushBack(new Model());
-        _models[1]->LoadAssets(modelPath.c_str(), modelJsonName.c_str());
+        _models[1]->LoadAssets(modelPath, modelJsonName, bundle);
         _models[1]->GetModelMatrix()->TranslateX(0.2f);
 #endif
 
@@ -209,6 +319,9 @@ bool ModelManager::ChangeScene(Csm::csmChar* name) {
         float clearColor[3] = { 0.0f, 0.0f, 0.0f };
         CoreManager::GetInstance()->GetView()->SetRenderTargetClearColor(clearColor[0], clearColor[1], clearColor[2]);
     }
+
+    ModelTimings zero = { 0.0, 0.0 };
+    _timings.UpdateSize(_models.GetSize(), zero, false);
     return true;
 }
 
@@ -8,6 +8,10 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <Math/CubismMatrix44.hpp>
 #include <Type/csmVector.hpp>
 
@@ -22,10 +26,24 @@ class Model;
  * Performs model creation and destruction,
  * tap event handling, and model switching.
  *
+ * With `SIMULATION_THREAD`, the models are updated at a fixed rate on a dedicated
+ * thread and drawn on the GUI thread from captured snapshots (see `DrawableSnapshotBuffer`),
+ * so that a busy GUI thread does not stall the animation. The public methods are
+ * called on the GUI thread; the ones changing the models lock them against the simulation thread.
+ *
  */
 class ModelManager {
 
 public:
+    /**
+     * @struct ModelTimings
+     * @brief Time spent on a model in the last frame, in milliseconds.
+     */
+    struct ModelTimings {
+        double updateMs;    /**< Motions, physics & `csmUpdateModel` (last tick of the simulation thread, if any). */
+        double drawMs;      /**< GL submission, on the GUI thread. */
+    };
+
     /**
      * @brief Return an instance (singleton) of the class.
      * 
@@ -75,10 +93,20 @@ public:
     /**
     * @brief Processing when updating the screen.
     * 
-    * Processes updating and drawing models.
+    * Draws the models one by one on the calling (GL) thread: the latest snapshots
+    * of the simulation thread, interpolated, with `SIMULATION_THREAD`. Otherwise
+    * updates the models first (see `UpdateModels`).
     */
     void OnUpdate() const;
 
+    /**
+     * @brief Timings of a model in the last frame.
+     *
+     * @param[in] no     Index value of model list
+     * @return           Zeros if the index value is out of range or the model was not drawn yet.
+     */
+    ModelTimings GetModelTimings(Csm::csmUint32 no) const;
+
     /**
      * @brief Initiates lip synchronization actively.
      * 
@@ -114,6 +142,30 @@ private:
     ModelManager();
     virtual ~ModelManager();
 
+    /**
+     * @brief Update the models in parallel on the `WorkerPool` (CPU only: motions,
+     *        physics, `csmUpdateModel`). Called with the models locked.
+     *
+     * @param[in] deltaTimeSeconds  Time elapsed since the last update [s]
+     */
+    void UpdateModels(Csm::csmFloat32 deltaTimeSeconds) const;
+
+    /**
+     * @brief Release the models. Called with the models locked.
+     */
+    void DeleteModels();
+
+    /**
+     * @brief Body of the simulation thread: update & capture the models every tick.
+     */
+    void SimulationLoop();
+
     Csm::CubismMatrix44*        _viewMatrix;    /**< View matrix used for model rendering. */
     Csm::csmVector<Model*>  _models;            /**< The container for model instances. */
+    mutable Csm::csmVector<ModelTimings> _timings;  /**< Timings of the last frame, per model. */
+
+    mutable std::mutex _modelMutex;             /**< Locks the models against the simulation thread. */
+    std::condition_variable _simulationCond;    /**< Wakes the simulation thread up to stop. */
+    std::thread _simulationThread;
+    bool _stopSimulation;
 };
@@ -0,0 +1,161 @@
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+#include <Motion/CubismMotionQueueEntry.hpp>
+
+#include "drivers/allocator.h"
+#include "drivers/motionCache.h"
+#include "drivers/tools.h"
+#include "drivers/workerPool.h"
+
+using namespace Live2D::Cubism::Framework;
+
+struct MotionCache::PrefetchQueue {
+    std::mutex mutex;
+    std::vector<LoadedMotion> loaded;
+    std::unordered_set<std::string> pending;    /**< Names submitted and not taken yet. */
+    bool cancelled = false;
+
+    ~PrefetchQueue() {
+        for (LoadedMotion& item : loaded) {
+            if (item.motion) ACubismMotion::Delete(item.motion);
+        }
+    }
+};
+
+MotionCache::MotionCache(size_t budgetBytes)
+    : _budgetBytes(budgetBytes)
+    , _bytes(0)
+    , _prefetchQueue(std::make_shared<PrefetchQueue>()) {
+}
+
+MotionCache::~MotionCache() {
+    Clear();
+}
+
+CubismMotion* MotionCache::Find(const std::string& name) {
+    auto it = _entries.find(name);
+    if (it == _entries.end()) {
+        _stats.misses++;
+        return NULL;
+    }
+    _stats.hits++;
+    _lru.splice(_lru.end(), _lru, it->second.lruPosition);
+    return it->second.motion;
+}
+
+void MotionCache::Insert(const std::string& name, CubismMotion* motion, size_t bytes) {
+    auto it = _entries.find(name);
+    if (it != _entries.end()) {
+        ACubismMotion::Delete(it->second.motion);
+        _bytes -= it->second.bytes;
+        _lru.erase(it->second.lruPosition);
+        _entries.erase(it);
+    }
+
+    Entry entry;
+    entry.motion = motion;
+    entry.bytes = bytes;
+    entry.lruPosition = _lru.insert(_lru.end(), name);
+    _entries[name] = entry;
+    _bytes += bytes;
+}
+
+void MotionCache::Prefetch(const std::string& name, const std::string& group, csmInt32 no, Loader load) {
+    if (_entries.find(name) != _entries.end())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(_prefetchQueue->mutex);
+        if (!_prefetchQueue->pending.insert(name).second)
+            return;
+    }
+
+    std::shared_ptr<PrefetchQueue> queue = _prefetchQueue;
+    WorkerPool::GetInstance()->Submit([queue, name, group, no, load]() {
+        {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            if (queue->cancelled)
+                return;
+        }
+        LoadedMotion item = { name, group, no, NULL, 0 };
+        item.motion = load(&item.bytes);
+
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->cancelled) {
+            if (item.motion) ACubismMotion::Delete(item.motion);
+            return;
+        }
+        queue->loaded.push_back(std::move(item));
+    });
+}
+
+void MotionCache::TakePrefetched(std::vector<LoadedMotion>* out) {
+    std::lock_guard<std::mutex> lock(_prefetchQueue->mutex);
+    for (LoadedMotion& item : _prefetchQueue->loaded) {
+        _prefetchQueue->pending.erase(item.name);
+        if (item.motion) _stats.prefetched++;
+        out->push_back(std::move(item));
+    }
+    _prefetchQueue->loaded.clear();
+}
+
+void MotionCache::Evict(CubismMotionManager* playing) {
+    if (_bytes <= _budgetBytes)
+        return;
+
+    /* Deleting a motion still in the queue would leave a dangling entry. */
+    std::unordered_set<const ACubismMotion*> inUse;
+    csmVector<CubismMotionQueueEntry*>* queue = playing ? playing->GetCubismMotionQueueEntries() : NULL;
+    if (queue != NULL) {
+        for (csmUint32 i = 0; i < queue->GetSize(); i++) {
+            if ((*queue)[i] != NULL) inUse.insert((*queue)[i]->GetCubismMotion());
+        }
+    }
+
+    for (auto it = _lru.begin(); it != _lru.end() && _bytes > _budgetBytes;) {
+        auto entry = _entries.find(*it);
+        if (inUse.count(entry->second.motion)) {
+            ++it;
+            continue;
+        }
+        ACubismMotion::Delete(entry->second.motion);
+        _bytes -= entry->second.bytes;
+        _entries.erase(entry);
+        it = _lru.erase(it);
+        _stats.evicted++;
+    }
+}
+
+void MotionCache::Clear() {
+    for (auto& item : _entries) {
+        ACubismMotion::Delete(item.second.motion);
+    }
+    _entries.clear();
+    _lru.clear();
+    _bytes = 0;
+
+    /* Jobs still running drop their result; start over with a new queue. */
+    {
+        std::lock_guard<std::mutex> lock(_prefetchQueue->mutex);
+        _prefetchQueue->cancelled = true;
+    }
+    _prefetchQueue = std::make_shared<PrefetchQueue>();
+}
+
+CubismMotion* MotionCache::Load(const std::string& path, size_t* bytes) {
+    FileBuffer buffer;
+    *bytes = 0;
+    if (!buffer.Open(path))
+        return NULL;
+    return Load(buffer.GetData(), buffer.GetSize(), bytes);
+}
+
+CubismMotion* MotionCache::Load(const csmByte* data, size_t size, size_t* bytes) {
+    /* Evicted independently of the model: never from the model arena. */
+    AllocationScope allocationScope(Allocator::TagMotion, NULL);
+    CubismMotion* motion = CubismMotion::Create(data, static_cast<csmSizeInt>(size));
+    /* The parsed curves take about as much memory as the json text. */
+    *bytes = motion != NULL ? size : 0;
+    return motion;
+}
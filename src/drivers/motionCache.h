@@ -0,0 +1,145 @@
+/**
+ * @file motionCache.h
+ * @brief A source file defining the motion cache of the models.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <Motion/CubismMotion.hpp>
+#include <Motion/CubismMotionManager.hpp>
+
+/**
+ * @class MotionCache
+ * @brief Parsed motions of a model, loaded on first use and kept within a memory budget.
+ *
+ * Motions can be prefetched (parsed on the worker pool); the least recently
+ * used ones are evicted when the budget is exceeded, unless they are playing.
+ *
+ * Not thread-safe: used on the thread updating the model. Only the parsing of
+ * prefetched motions runs on worker threads.
+ */
+class MotionCache {
+public:
+    /**
+     * @struct LoadedMotion
+     * @brief A motion parsed in background, not in the cache yet.
+     */
+    struct LoadedMotion {
+        std::string name;           /**< Motion name (e.g. idle_0). */
+        std::string group;          /**< Motion group. */
+        Csm::csmInt32 no;           /**< Motion index in group. */
+        Csm::CubismMotion* motion;  /**< NULL if the file cannot be parsed. */
+        size_t bytes;               /**< Estimated memory usage. */
+    };
+
+    /**
+     * @struct Stats
+     * @brief Cache counters, for tuning the budget.
+     */
+    struct Stats {
+        Csm::csmUint32 hits = 0;
+        Csm::csmUint32 misses = 0;          /**< Parsed synchronously on first use. */
+        Csm::csmUint32 prefetched = 0;
+        Csm::csmUint32 evicted = 0;
+    };
+
+    /**
+     * @brief Parse a motion (from a file or a model bundle). Must be thread-safe.
+     *
+     * @param[out] bytes  Estimated memory usage.
+     * @return  NULL if the motion cannot be read or parsed.
+     */
+    typedef std::function<Csm::CubismMotion*(size_t* bytes)> Loader;
+
+    /**
+     * @param[in] budgetBytes  Memory budget of the cached motions.
+     */
+    explicit MotionCache(size_t budgetBytes);
+    ~MotionCache();
+
+    MotionCache(const MotionCache&) = delete;
+    MotionCache& operator=(const MotionCache&) = delete;
+
+    /**
+     * @brief Find a cached motion and mark it as recently used.
+     *
+     * @return  NULL if the motion is not cached.
+     */
+    Csm::CubismMotion* Find(const std::string& name);
+
+    /**
+     * @brief Add a parsed motion to the cache, which owns it afterwards.
+     */
+    void Insert(const std::string& name, Csm::CubismMotion* motion, size_t bytes);
+
+    /**
+     * @brief Parse a motion on the worker pool. Collect it with `TakePrefetched`.
+     *
+     * Ignored if the motion is already cached or being prefetched.
+     */
+    void Prefetch(const std::string& name, const std::string& group, Csm::csmInt32 no, Loader load);
+
+    /**
+     * @brief Take the motions prefetched since the last call.
+     *
+     * The caller sets them up and `Insert`s them (or deletes them).
+     */
+    void TakePrefetched(std::vector<LoadedMotion>* out);
+
+    /**
+     * @brief Delete the least recently used motions while over the budget.
+     *
+     * @param[in] playing  Motions in this queue are never evicted.
+     */
+    void Evict(Csm::CubismMotionManager* playing);
+
+    /**
+     * @brief Delete all cached motions. Pending prefetches are dropped.
+     */
+    void Clear();
+
+    /**
+     * @brief Parse a motion file synchronously.
+     *
+     * @param[in]  path   Motion file path.
+     * @param[out] bytes  Estimated memory usage.
+     * @return  NULL if the file cannot be read or parsed.
+     */
+    static Csm::CubismMotion* Load(const std::string& path, size_t* bytes);
+
+    /**
+     * @brief Parse motion file content already in memory.
+     */
+    static Csm::CubismMotion* Load(const Csm::csmByte* data, size_t size, size_t* bytes);
+
+    size_t GetBytes() const { return _bytes; }
+    const Stats& GetStats() const { return _stats; }
+
+private:
+    struct Entry {
+        Csm::CubismMotion* motion;
+        size_t bytes;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    /* Shared with the worker jobs, which may finish after the cache is cleared. */
+    struct PrefetchQueue;
+
+    size_t _budgetBytes;
+    size_t _bytes;
+    std::unordered_map<std::string, Entry> _entries;
+    std::list<std::string> _lru;                    /**< Least recently used first. */
+    std::shared_ptr<PrefetchQueue> _prefetchQueue;
+    Stats _stats;
+};
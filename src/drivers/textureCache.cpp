@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/stat.h>
+
+#ifndef USE_GLAD_GLLOADER
+#include <QtGui/QOpenGLContext>
+#endif
+#include <QtCore/QDir>
+#include <QtCore/QSaveFile>
+#include <QtCore/QString>
+
+#include "drivers/textureCache.h"
+#include "drivers/tools.h"
+
+#include "utils/consts.h"
+#include "utils/logger.h"
+
+namespace {
+    /* Bump when the encoder output changes, so that stale caches are not loaded. */
+    const uint64_t CacheVersion = 1;
+
+    const unsigned char KtxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const uint32_t KtxEndianness = 0x04030201;
+    const uint32_t KtxHeaderFields = 13;
+
+    /**
+     * @brief FNV-1a 64-bit hash.
+     */
+    uint64_t HashBytes(const unsigned char* bytes, size_t size, uint64_t hash = 14695981039346656037ULL) {
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    size_t GetLevelSize(int width, int height) {
+        /* 16 bytes per 4x4 block. */
+        return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * 16;
+    }
+
+    uint16_t To565(int r, int g, int b) {
+        return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+    }
+
+    void From565(uint16_t c, int rgb[3]) {
+        const int r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    /**
+     * @brief 2x2 box filter to the next mipmap level.
+     */
+    void Downsample(const std::vector<unsigned char>& src, int width, int height,
+                    std::vector<unsigned char>* dst, int dstWidth, int dstHeight) {
+        dst->resize(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        for (int y = 0; y < dstHeight; y++) {
+            const int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+            for (int x = 0; x < dstWidth; x++) {
+                const int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                for (int c = 0; c < 4; c++) {
+                    const int sum = src[(static_cast<size_t>(y0) * width + x0) * 4 + c]
+                                  + src[(static_cast<size_t>(y0) * width + x1) * 4 + c]
+                                  + src[(static_cast<size_t>(y1) * width + x0) * 4 + c]
+                                  + src[(static_cast<size_t>(y1) * width + x1) * 4 + c];
+                    (*dst)[(static_cast<size_t>(y) * dstWidth + x) * 4 + c] = static_cast<unsigned char>((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    void WriteU32(std::vector<unsigned char>* out, uint32_t value) {
+        /* KTX files are written in the native byte order, tagged by `KtxEndianness`. */
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        out->insert(out->end(), bytes, bytes + 4);
+    }
+
+    uint32_t ReadU32(const unsigned char* bytes) {
+        uint32_t value;
+        memcpy(&value, bytes, 4);
+        return value;
+    }
+}
+
+GLenum TextureCache::GetSupportedFormat() {
+#ifdef USE_GLAD_GLLOADER
+    const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+    const bool s3tc = extensions != NULL && strstr(extensions, "GL_EXT_texture_compression_s3tc") != NULL;
+#else
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    const bool s3tc = context != NULL && context->hasExtension("GL_EXT_texture_compression_s3tc");
+#endif
+    return s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+}
+
+std::string TextureCache::GetCachePath(const unsigned char* bytes, size_t size, GLenum format) {
+    uint64_t key[3] = { CacheVersion, format, 0 };
+#ifdef PREMULTIPLIED_ALPHA_ENABLE
+    key[2] = 1;
+#endif
+    const uint64_t hash = HashBytes(bytes, size, HashBytes(reinterpret_cast<const unsigned char*>(key), sizeof(key)));
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.ktx", static_cast<unsigned long long>(hash));
+    return std::string(TEXTURE_CACHE_DIR) + name;
+}
+
+bool TextureCache::Load(const std::string& path, GLenum format, CompressedImage* image) {
+    /* A missing file is the usual cache miss: do not go through the logging loader. */
+    struct stat statBuf;
+    if (stat(path.c_str(), &statBuf) != 0)
+        return false;
+
+    FileBuffer file;
+    if (!file.Open(path))
+        return false;
+    return Parse(file.GetData(), file.GetSize(), format, image);
+}
+
+bool TextureCache::Parse(const unsigned char* bytes, size_t fileSize, GLenum format, CompressedImage* image) {
+    const size_t headerSize = sizeof(KtxIdentifier) + KtxHeaderFields * 4;
+    if (fileSize < headerSize || memcmp(bytes, KtxIdentifier, sizeof(KtxIdentifier)) != 0)
+        return false;
+    const unsigned char* header = bytes + sizeof(KtxIdentifier);
+    /* [endianness, glType, glTypeSize, glFormat, glInternalFormat, glBaseInternalFormat,
+        width, height, depth, arrayElements, faces, mipmapLevels, keyValueBytes] */
+    if (ReadU32(header) != KtxEndianness || ReadU32(header + 16) != format)
+        return false;
+    int width = static_cast<int>(ReadU32(header + 24));
+    int height = static_cast<int>(ReadU32(header + 28));
+    const uint32_t levelCount = ReadU32(header + 44);
+    size_t offset = headerSize + ReadU32(header + 48);
+    if (width <= 0 || height <= 0 || levelCount == 0 || levelCount > 32)
+        return false;
+
+    image->internalFormat = format;
+    image->levels.clear();
+    image->data.clear();
+    for (uint32_t i = 0; i < levelCount; i++) {
+        if (offset + 4 > fileSize)
+            return false;
+        const size_t size = ReadU32(bytes + offset);
+        offset += 4;
+        if (size != GetLevelSize(width, height) || offset + size > fileSize)
+            return false;
+
+        image->levels.push_back({ width, height, image->data.size(), size });
+        image->data.insert(image->data.end(), bytes + offset, bytes + offset + size);
+        offset += size;
+
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return true;
+}
+
+bool TextureCache::Serialize(const CompressedImage& image, std::vector<unsigned char>* out) {
+    if (!image.IsValid())
+        return false;
+
+    out->assign(KtxIdentifier, KtxIdentifier + sizeof(KtxIdentifier));
+    WriteU32(out, KtxEndianness);
+    WriteU32(out, 0);                       /* glType: compressed */
+    WriteU32(out, 1);                       /* glTypeSize */
+    WriteU32(out, 0);                       /* glFormat: compressed */
+    WriteU32(out, image.internalFormat);
+    WriteU32(out, GL_RGBA);                 /* glBaseInternalFormat */
+    WriteU32(out, image.levels[0].width);
+    WriteU32(out, image.levels[0].height);
+    WriteU32(out, 0);                       /* pixelDepth */
+    WriteU32(out, 0);                       /* numberOfArrayElements */
+    WriteU32(out, 1);                       /* numberOfFaces */
+    WriteU32(out, static_cast<uint32_t>(image.levels.size()));
+    WriteU32(out, 0);                       /* bytesOfKeyValueData */
+
+    for (const CompressedImage::Level& level : image.levels) {
+        WriteU32(out, static_cast<uint32_t>(level.size));
+        /* Level sizes are multiples of 16 bytes: no mipPadding needed. */
+        out->insert(out->end(), image.data.begin() + level.offset, image.data.begin() + level.offset + level.size);
+    }
+    return true;
+}
+
+bool TextureCache::Store(const std::string& path, const CompressedImage& image) {
+    std::vector<unsigned char> content;
+    if (!Serialize(image, &content))
+        return false;
+
+    QDir cacheDir(TEXTURE_CACHE_DIR);
+    if (!cacheDir.exists() && !cacheDir.mkpath(".")) {
+        stdLogger.Exception("failed to create directory (" TEXTURE_CACHE_DIR ") for texture cache");
+        return false;
+    }
+
+    /* QSaveFile writes a unique temporary file in TEXTURE_CACHE_DIR and renames it over `path` on commit:
+     * concurrent stores never share it, and readers see either no cache or a complete one. */
+    QSaveFile file(QString::fromStdString(path));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(reinterpret_cast<const char*>(content.data()), static_cast<qint64>(content.size()));
+    return file.commit();
+}
+
+bool TextureCache::Compress(const unsigned char* pixels, int width, int height, GLenum format, CompressedImage* image) {
+    if (format != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT || pixels == NULL || width <= 0 || height <= 0)
+        return false;
+
+    image->internalFormat = format;
+    image->levels.clear();
+    image->data.clear();
+
+    std::vector<unsigned char> level(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    std::vector<unsigned char> next;
+    while (true) {
+        const size_t offset = image->data.size();
+        const size_t size = GetLevelSize(width, height);
+        image->levels.push_back({ width, height, offset, size });
+        image->data.resize(offset + size);
+
+        unsigned char* out = image->data.data() + offset;
+        unsigned char block[64];
+        for (int by = 0; by < height; by += 4) {
+            for (int bx = 0; bx < width; bx += 4) {
+                /* Edge blocks repeat the last row / column. */
+                for (int y = 0; y < 4; y++) {
+                    const int sy = std::min(by + y, height - 1);
+                    for (int x = 0; x < 4; x++) {
+                        const int sx = std::min(bx + x, width - 1);
+                        memcpy(block + (y * 4 + x) * 4, level.data() + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+                    }
+                }
+                CompressBlockBC3(block, out);
+                out += 16;
+            }
+        }
+
+        if (width == 1 && height == 1)
+            break;
+        const int nextWidth = std::max(1, width / 2), nextHeight = std::max(1, height / 2);
+        Downsample(level, width, height, &next, nextWidth, nextHeight);
+        level.swap(next);
+        width = nextWidth;
+        height = nextHeight;
+    }
+    return true;
+}
+
+void TextureCache::CompressBlockBC3(const unsigned char block[64], unsigned char out[16]) {
+    /* Alpha: 8-value interpolated palette between the extremes. */
+    int alphaMin = 255, alphaMax = 0;
+    for (int i = 0; i < 16; i++) {
+        alphaMin = std::min(alphaMin, static_cast<int>(block[i * 4 + 3]));
+        alphaMax = std::max(alphaMax, static_cast<int>(block[i * 4 + 3]));
+    }
+    out[0] = static_cast<unsigned char>(alphaMax);
+    out[1] = static_cast<unsigned char>(alphaMin);
+    uint64_t alphaIndices = 0;
+    if (alphaMax > alphaMin) {
+        int palette[8] = { alphaMax, alphaMin };
+        for (int k = 2; k < 8; k++)
+            palette[k] = ((8 - k) * alphaMax + (k - 1) * alphaMin) / 7;
+        for (int i = 0; i < 16; i++) {
+            const int a = block[i * 4 + 3];
+            int best = 0, bestError = 256;
+            for (int k = 0; k < 8; k++) {
+                const int error = std::abs(palette[k] - a);
+                if (error < bestError) {
+                    bestError = error;
+                    best = k;
+                }
+            }
+            alphaIndices |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = static_cast<unsigned char>(alphaIndices >> (8 * i));
+
+    /* Color: endpoints on the bounding box diagonal that follows the color spread. */
+    int minColor[3] = { 255, 255, 255 }, maxColor[3] = { 0, 0, 0 }, mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            minColor[c] = std::min(minColor[c], static_cast<int>(block[i * 4 + c]));
+            maxColor[c] = std::max(maxColor[c], static_cast<int>(block[i * 4 + c]));
+            mean[c] += block[i * 4 + c];
+        }
+    }
+    int covRG = 0, covBG = 0;
+    for (int i = 0; i < 16; i++) {
+        const int g = block[i * 4 + 1] * 16 - mean[1];
+        covRG += (block[i * 4 + 0] * 16 - mean[0]) * g;
+        covBG += (block[i * 4 + 2] * 16 - mean[2]) * g;
+    }
+    if (covRG < 0) std::swap(minColor[0], maxColor[0]);
+    if (covBG < 0) std::swap(minColor[2], maxColor[2]);
+    /* Inset the box a little: the extremes are rarely the best endpoints. */
+    for (int c = 0; c < 3; c++) {
+        const int inset = (maxColor[c] - minColor[c]) / 16;
+        maxColor[c] = std::min(255, std::max(0, maxColor[c] - inset));
+        minColor[c] = std::min(255, std::max(0, minColor[c] + inset));
+    }
+
+    uint16_t color0 = To565(maxColor[0], maxColor[1], maxColor[2]);
+    uint16_t color1 = To565(minColor[0], minColor[1], minColor[2]);
+    /* color0 > color1 selects the 4-color palette. */
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    uint32_t colorIndices = 0;
+    if (color0 != color1) {
+        int palette[4][3];
+        From565(color0, palette[0]);
+        From565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestError = 0x7FFFFFFF;
+            for (int k = 0; k < 4; k++) {
+                const int dr = palette[k][0] - block[i * 4 + 0];
+                const int dg = palette[k][1] - block[i * 4 + 1];
+                const int db = palette[k][2] - block[i * 4 + 2];
+                const int error = dr * dr + dg * dg + db * db;
+                if (error < bestError) {
+                    bestError = error;
+                    best = k;
+                }
+            }
+            colorIndices |= static_cast<uint32_t>(best) << (2 * i);
+        }
+    }
+    out[8] = static_cast<unsigned char>(color0);
+    out[9] = static_cast<unsigned char>(color0 >> 8);
+    out[10] = static_cast<unsigned char>(color1);
+    out[11] = static_cast<unsigned char>(color1 >> 8);
+    for (int i = 0; i < 4; i++)
+        out[12 + i] = static_cast<unsigned char>(colorIndices >> (8 * i));
+}
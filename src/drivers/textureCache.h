@@ -0,0 +1,117 @@
+/**
+ * @file textureCache.h
+ * @brief A source file defining the on-disk cache of GPU compressed textures.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <AppOpenGLWrapper.hpp>
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+/**
+ * @class TextureCache
+ * @brief Transcodes decoded textures into a GPU compressed format (with the whole
+ *  mipmap chain) and keeps them on disk as KTX files, keyed by the hash of the source file.
+ *
+ * Only BC3 (S3TC DXT5) is produced: it is the format with a cheap enough encoder
+ * to run at load time. Contexts without S3TC fall back to RGBA8 uploads.
+ *
+ * All functions but `GetSupportedFormat` are thread-safe (no OpenGL involved).
+ */
+class TextureCache {
+public:
+    /**
+     * @struct CompressedImage
+     * @brief Compressed mipmap chain, level 0 first.
+     */
+    struct CompressedImage {
+        struct Level {
+            int width;
+            int height;
+            size_t offset;  /**< Offset of the level in `data`. */
+            size_t size;
+        };
+
+        GLenum internalFormat = 0;
+        std::vector<Level> levels;
+        std::vector<unsigned char> data;
+
+        bool IsValid() const { return internalFormat != 0 && !levels.empty(); }
+    };
+
+    /**
+     * @brief Compressed format to use with the current context, 0 if none is supported.
+     *
+     * Must be called on the OpenGL context thread.
+     */
+    static GLenum GetSupportedFormat();
+
+    /**
+     * @brief Path of the cache file of a source file content.
+     *
+     * @param[in] bytes   Content of the source (png) file.
+     * @param[in] size    Size of the content.
+     * @param[in] format  Compressed format of the cache.
+     */
+    static std::string GetCachePath(const unsigned char* bytes, size_t size, GLenum format);
+
+    /**
+     * @brief Load a cache file.
+     *
+     * @param[in]  path    Cache file path.
+     * @param[in]  format  Expected compressed format.
+     * @param[out] image   Compressed mipmap chain.
+     * @return  Whether the cache exists and is valid.
+     */
+    static bool Load(const std::string& path, GLenum format, CompressedImage* image);
+
+    /**
+     * @brief Parse KTX content already in memory (e.g. a model bundle entry).
+     *
+     * @param[in]  bytes   KTX file content.
+     * @param[in]  size    Size of the content.
+     * @param[in]  format  Expected compressed format.
+     * @param[out] image   Compressed mipmap chain.
+     * @return  Whether the content is a valid KTX of `format`.
+     */
+    static bool Parse(const unsigned char* bytes, size_t size, GLenum format, CompressedImage* image);
+
+    /**
+     * @brief Encode a compressed mipmap chain as KTX content.
+     */
+    static bool Serialize(const CompressedImage& image, std::vector<unsigned char>* out);
+
+    /**
+     * @brief Write a cache file (atomically: a partially written file is never loaded).
+     */
+    static bool Store(const std::string& path, const CompressedImage& image);
+
+    /**
+     * @brief Build the mipmap chain of RGBA8 pixels and compress it.
+     *
+     * @param[in]  pixels  RGBA8 pixels (premultiplied if enabled).
+     * @param[in]  width   Width of the image.
+     * @param[in]  height  Height of the image.
+     * @param[in]  format  Compressed format (see `GetSupportedFormat`).
+     * @param[out] image   Compressed mipmap chain.
+     * @return  Whether the format is supported by the encoder.
+     */
+    static bool Compress(const unsigned char* pixels, int width, int height, GLenum format, CompressedImage* image);
+
+private:
+    /**
+     * @brief Compress a 4x4 RGBA8 block into BC3 (16 bytes).
+     */
+    static void CompressBlockBC3(const unsigned char block[64], unsigned char out[16]);
+};
@@ -3,116 +3,634 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <QtCore/QString>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTURE_PREMULTIPLY_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TEXTURE_PREMULTIPLY_NEON
+#endif
+
+#include "drivers/textureCache.h"
 #include "drivers/textureManager.h"
 #include "drivers/tools.h"
+#include "drivers/workerPool.h"
+
+#include "utils/consts.h"
+#include "utils/logger.h"
+
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+
+struct TextureManager::PendingTexture {
+    /* Written by the worker, read by the GL thread once `done` is set. */
+    struct Decoded {
+        std::atomic<bool> done{false};
+        bool success = false;
+        DecodedImage image{NULL, 0, 0, ""};
+        DecodedImage preview{NULL, 0, 0, ""};
+        TextureCache::CompressedImage compressed;   /**< Loaded from the cache: uploaded instead of `image`. */
+
+        ~Decoded() {
+            ReleaseDecodedImage(&image);
+            ReleaseDecodedImage(&preview);
+        }
+    };
+
+    std::string fileName;
+    std::vector<std::pair<const void*, TextureReadyCallback>> listeners;
+    std::shared_ptr<Decoded> decoded;
+    GLuint previewId = 0;
+    GLuint textureId = 0;
+    GLuint pbo = 0;
+    int uploadedRows = 0;
+    size_t uploadedLevels = 0;
+    int refCount = 0;   /**< References taken while streaming, moved to the registry when resident. */
+};
+
+namespace {
+    /**
+     * @brief Box-filter the (premultiplied) image down to at most TEXTURE_PREVIEW_MAX_SIZE.
+     */
+    void CreatePreview(const TextureManager::DecodedImage& image, TextureManager::DecodedImage* preview) {
+        const int factor = std::max(1, (std::max(image.width, image.height) + TEXTURE_PREVIEW_MAX_SIZE - 1) / TEXTURE_PREVIEW_MAX_SIZE);
+        preview->fileName = image.fileName;
+        preview->width = std::max(1, image.width / factor);
+        preview->height = std::max(1, image.height / factor);
+        preview->pixels = static_cast<unsigned char*>(STBI_MALLOC(static_cast<size_t>(preview->width) * preview->height * 4));
+        if (preview->pixels == NULL)
+            return;
+
+        for (int y = 0; y < preview->height; y++) {
+            for (int x = 0; x < preview->width; x++) {
+                unsigned int sum[4] = { 0, 0, 0, 0 };
+                int samples = 0;
+                for (int sy = y * factor; sy < std::min(image.height, (y + 1) * factor); sy++) {
+                    const unsigned char* row = image.pixels + (static_cast<size_t>(sy) * image.width + x * factor) * 4;
+                    for (int sx = 0; sx < factor && x * factor + sx < image.width; sx++) {
+                        sum[0] += row[sx * 4 + 0];
+                        sum[1] += row[sx * 4 + 1];
+                        sum[2] += row[sx * 4 + 2];
+                        sum[3] += row[sx * 4 + 3];
+                        samples++;
+                    }
+                }
+                unsigned char* dst = preview->pixels + (static_cast<size_t>(y) * preview->width + x) * 4;
+                for (int c = 0; c < 4; c++)
+                    dst[c] = static_cast<unsigned char>(sum[c] / std::max(1, samples));
+            }
+        }
+    }
+
+    GLuint UploadTexture(const TextureManager::DecodedImage& image, bool mipmap) {
+        GLuint textureId;
+        APP_CALL_GLFUNC glGenTextures(1, &textureId);
+        APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, textureId);
+        APP_CALL_GLFUNC glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
+        if (mipmap) {
+            APP_CALL_GLFUNC glGenerateMipmap(GL_TEXTURE_2D);
+            APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        } else {
+            APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        }
+        APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, 0);
+        return textureId;
+    }
 
-TextureManager::TextureManager() {
+    /**
+     * @brief Whether pixel unpack buffers are available (not on OpenGL ES 2.0).
+     */
+    bool PixelBufferSupported() {
+        static int supported = -1;
+        if (supported < 0) {
+            const char* version = reinterpret_cast<const char*>(APP_CALL_GLFUNC glGetString(GL_VERSION));
+            supported = (version != NULL && strstr(version, "OpenGL ES 2.") == NULL) ? 1 : 0;
+        }
+        return supported == 1;
+    }
+}
+
+TextureManager::TextureManager() : _unusedBytes(0), _residentBytes(0), _peakBytes(0), _placeholderTextureId(0) {
 }
 
 TextureManager::~TextureManager() {
+    /* Like the loaded textures, GL objects are left to the context destruction. */
+    for (Csm::csmUint32 i = 0; i < _pendingTextures.GetSize(); i++) {
+        delete _pendingTextures[i];
+    }
+    _pendingTextures.Clear();
+    _pendingByPath.clear();
     ReleaseTextures();
 }
 
+void TextureManager::PremultiplyPixels(unsigned char* pixels, size_t count) {
+    size_t i = 0;
+#if defined(TEXTURE_PREMULTIPLY_SSE2)
+    /* 4 pixels per iteration: c = c * (a + 1) >> 8 on 16-bit lanes, alpha kept as is. */
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i * 4));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i plo = _mm_srli_epi16(_mm_mullo_epi16(lo, _mm_add_epi16(alo, one)), 8);
+        __m128i phi = _mm_srli_epi16(_mm_mullo_epi16(hi, _mm_add_epi16(ahi, one)), 8);
+        plo = _mm_or_si128(_mm_andnot_si128(alphaMask, plo), _mm_and_si128(alphaMask, lo));
+        phi = _mm_or_si128(_mm_andnot_si128(alphaMask, phi), _mm_and_si128(alphaMask, hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i * 4), _mm_packus_epi16(plo, phi));
+    }
+#elif defined(TEXTURE_PREMULTIPLY_NEON)
+    /* 8 pixels per iteration, channels deinterleaved. */
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t v = vld4_u8(pixels + i * 4);
+        uint16x8_t a1 = vaddw_u8(vdupq_n_u16(1), v.val[3]);
+        v.val[0] = vshrn_n_u16(vmulq_u16(vmovl_u8(v.val[0]), a1), 8);
+        v.val[1] = vshrn_n_u16(vmulq_u16(vmovl_u8(v.val[1]), a1), 8);
+        v.val[2] = vshrn_n_u16(vmulq_u16(vmovl_u8(v.val[2]), a1), 8);
+        vst4_u8(pixels + i * 4, v);
+    }
+#endif
+    unsigned int* fourBytes = reinterpret_cast<unsigned int*>(pixels);
+    for (; i < count; i++) {
+        unsigned char* p = pixels + i * 4;
+        fourBytes[i] = Premultiply(p[0], p[1], p[2], p[3]);
+    }
+}
+
 TextureManager::TextureInfo* TextureManager::CreateTextureFromPngFile(std::string fileName) {
     /* search loaded texture already. */
-    for (Csm::csmUint32 i = 0; i < _textures.GetSize(); i++) {
-        if (_textures[i]->fileName == fileName) {
-            return _textures[i];
-        }
-    }
+    TextureInfo* loaded = AcquireTexture(fileName);
+    if (loaded != NULL)
+        return loaded;
 
-    GLuint textureId;
-    int width, height, channels;
-    unsigned int size;
-    unsigned char* png;
-    unsigned char* address;
+    DecodedImage image;
+    if (!DecodePngFile(fileName, &image))
+        return NULL;
 
-    address = ToolFunctions::LoadFileAsBytes(fileName, &size);
+    return CreateTextureFromDecodedImage(&image);
+}
+
+bool TextureManager::DecodePngFile(const std::string& fileName, DecodedImage* image) {
+    FileBuffer file;
+
+    image->pixels = NULL;
+    image->width = 0;
+    image->height = 0;
+    image->fileName = fileName;
+
+    if(!file.Open(fileName))
+        return false;
+    return DecodePngData(file.GetData(), file.GetSize(), fileName, image);
+}
+
+bool TextureManager::DecodePngData(const unsigned char* bytes, size_t size, const std::string& fileName, DecodedImage* image) {
+    image->pixels = NULL;
+    image->width = 0;
+    image->height = 0;
+    image->fileName = fileName;
 
-    if(address == NULL)
-        return NULL;
     /* Get png information. */
-    png = stbi_load_from_memory(
-        address,
+    int channels;
+    image->pixels = stbi_load_from_memory(
+        bytes,
         static_cast<int>(size),
-        &width,
-        &height,
+        &image->width,
+        &image->height,
         &channels,
         STBI_rgb_alpha);
-    {
+
+    if (image->pixels == NULL)
+        return false;
 
 #ifdef PREMULTIPLIED_ALPHA_ENABLE
-        unsigned int* fourBytes = reinterpret_cast<unsigned int*>(png);
-        for (int i = 0; i < width * height; i++)
-        {
-            unsigned char* p = png + i * 4;
-            fourBytes[i] = Premultiply(p[0], p[1], p[2], p[3]);
-        }
+    PremultiplyPixels(image->pixels, static_cast<size_t>(image->width) * image->height);
 #endif
+    return true;
+}
+
+void TextureManager::ReleaseDecodedImage(DecodedImage* image) {
+    if (image->pixels != NULL)
+        stbi_image_free(image->pixels);
+    image->pixels = NULL;
+}
+
+TextureManager::TextureInfo* TextureManager::CreateTextureFromDecodedImage(DecodedImage* image) {
+    if (image->pixels == NULL)
+        return NULL;
+
+    /* search loaded texture already. */
+    TextureInfo* loaded = AcquireTexture(image->fileName);
+    if (loaded != NULL) {
+        ReleaseDecodedImage(image);
+        return loaded;
     }
 
     /* Generate textures for OpenGL. */
+    GLuint textureId = UploadTexture(*image, true);
+
+    /* Release current images. */
+    ReleaseDecodedImage(image);
+
+    return RegisterTexture(image->fileName, textureId, image->width, image->height, GetTextureBytes(image->width, image->height), 1);
+}
+
+GLuint TextureManager::CreateTextureFromPngFileAsync(std::string fileName, const void* owner, TextureReadyCallback onReady) {
+    /* search loaded texture already. */
+    TextureInfo* loaded = AcquireTexture(fileName);
+    if (loaded != NULL)
+        return loaded->id;
+    /* search streaming texture already. */
+    auto streaming = _pendingByPath.find(fileName);
+    if (streaming != _pendingByPath.end()) {
+        PendingTexture* pending = streaming->second;
+        pending->refCount++;
+        pending->listeners.emplace_back(owner, onReady);
+        return pending->previewId ? pending->previewId : GetPlaceholderTextureId();
+    }
+
+    PendingTexture* pending = new PendingTexture();
+    pending->fileName = fileName;
+    pending->refCount = 1;
+    pending->listeners.emplace_back(owner, onReady);
+    pending->decoded = std::make_shared<PendingTexture::Decoded>();
+    _pendingTextures.PushBack(pending);
+    _pendingByPath[fileName] = pending;
+
+    std::shared_ptr<PendingTexture::Decoded> decoded = pending->decoded;
+    const GLenum compressedFormat = TextureCache::GetSupportedFormat();
+    WorkerPool::GetInstance()->Submit([decoded, fileName, compressedFormat]() {
+        FileBuffer file;
+        if (!file.Open(fileName)) {
+            decoded->done.store(true, std::memory_order_release);
+            return;
+        }
+
+        /* Compressed cache hit: no png decoding at all. */
+        std::string cachePath;
+        if (compressedFormat != 0) {
+            cachePath = TextureCache::GetCachePath(file.GetData(), file.GetSize(), compressedFormat);
+            if (TextureCache::Load(cachePath, compressedFormat, &decoded->compressed)) {
+                decoded->success = true;
+                decoded->done.store(true, std::memory_order_release);
+                return;
+            }
+        }
+
+        decoded->success = DecodePngData(file.GetData(), file.GetSize(), fileName, &decoded->image);
+        file.Close();
+        if (decoded->success)
+            CreatePreview(decoded->image, &decoded->preview);
+        decoded->done.store(true, std::memory_order_release);
+
+        /* Miss: stream the RGBA8 pixels now, and fill the cache for the next launch. */
+        if (decoded->success && !cachePath.empty()) {
+            TextureCache::CompressedImage compressed;
+            if (TextureCache::Compress(decoded->image.pixels, decoded->image.width, decoded->image.height, compressedFormat, &compressed)
+                && !TextureCache::Store(cachePath, compressed)) {
+                stdLogger.Warning(
+                    QString("Failed to write texture cache: %1")
+                    .arg(cachePath.c_str())
+                    .toStdString()
+                );
+            }
+        }
+    });
+
+    return GetPlaceholderTextureId();
+}
+
+TextureManager::TextureInfo* TextureManager::CreateTextureFromKtxData(const std::string& fileName, const unsigned char* bytes, size_t size) {
+    /* search loaded texture already. */
+    TextureInfo* loaded = AcquireTexture(fileName);
+    if (loaded != NULL)
+        return loaded;
+    if (_pendingByPath.find(fileName) != _pendingByPath.end())
+        return NULL;
+
+    const GLenum format = TextureCache::GetSupportedFormat();
+    TextureCache::CompressedImage image;
+    if (format == 0 || !TextureCache::Parse(bytes, size, format, &image))
+        return NULL;
+
+    GLuint textureId;
     APP_CALL_GLFUNC glGenTextures(1, &textureId);
     APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, textureId);
-    APP_CALL_GLFUNC glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, png);
-    APP_CALL_GLFUNC glGenerateMipmap(GL_TEXTURE_2D);
+    for (size_t i = 0; i < image.levels.size(); i++) {
+        const TextureCache::CompressedImage::Level& level = image.levels[i];
+        APP_CALL_GLFUNC glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), image.internalFormat,
+                                               level.width, level.height, 0, static_cast<GLsizei>(level.size),
+                                               image.data.data() + level.offset);
+    }
     APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, 0);
 
-    /* Release current images. */
-    stbi_image_free(png);
-    ToolFunctions::ReleaseBytes(address);
+    return RegisterTexture(fileName, textureId, image.levels[0].width, image.levels[0].height, image.data.size(), 1);
+}
+
+void TextureManager::CancelPendingTextures(const void* owner) {
+    for (Csm::csmUint32 i = 0; i < _pendingTextures.GetSize(); i++) {
+        auto& listeners = _pendingTextures[i]->listeners;
+        listeners.erase(
+            std::remove_if(listeners.begin(), listeners.end(),
+                [owner](const std::pair<const void*, TextureReadyCallback>& l) { return l.first == owner; }),
+            listeners.end());
+    }
+}
+
+void TextureManager::Update() {
+    size_t budget = TEXTURE_UPLOAD_BYTES_PER_FRAME;
+
+    for (Csm::csmUint32 i = 0; i < _pendingTextures.GetSize() && budget > 0;) {
+        PendingTexture* pending = _pendingTextures[i];
+        if (!pending->decoded->done.load(std::memory_order_acquire)) {
+            i++;
+            continue;
+        }
+        if (!pending->decoded->success) {
+            stdLogger.Exception(
+                QString("Failed to decode texture: %1")
+                .arg(pending->fileName.c_str())
+                .toStdString().c_str()
+            );
+            RemovePending(i);
+            continue;
+        }
+
+        if (pending->textureId == 0)
+            BeginUpload(pending);
+
+        const DecodedImage& image = pending->decoded->image;
+        const TextureCache::CompressedImage& compressed = pending->decoded->compressed;
+        bool resident;
+        if (compressed.IsValid()) {
+            budget -= std::min(UploadLevels(pending, budget), budget);
+            resident = pending->uploadedLevels == compressed.levels.size();
+        } else {
+            budget -= std::min(UploadRows(pending, budget), budget);
+            resident = pending->uploadedRows >= image.height;
+        }
+        if (!resident) {
+            i++;
+            continue;
+        }
+
+        /* Fully resident: build mipmaps (the cache already has them) and switch from the preview. */
+        APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, pending->textureId);
+        if (!compressed.IsValid())
+            APP_CALL_GLFUNC glGenerateMipmap(GL_TEXTURE_2D);
+        APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, 0);
+
+        TextureInfo* textureInfo;
+        if (compressed.IsValid()) {
+            textureInfo = RegisterTexture(pending->fileName, pending->textureId,
+                                          compressed.levels[0].width, compressed.levels[0].height,
+                                          compressed.data.size(), pending->refCount);
+        } else {
+            textureInfo = RegisterTexture(pending->fileName, pending->textureId,
+                                          image.width, image.height,
+                                          GetTextureBytes(image.width, image.height), pending->refCount);
+        }
 
-    TextureManager::TextureInfo* textureInfo = new TextureManager::TextureInfo();
-    if (textureInfo != NULL) {
-        textureInfo->fileName = fileName;
-        textureInfo->width = width;
-        textureInfo->height = height;
-        textureInfo->id = textureId;
+        for (auto& listener : pending->listeners)
+            listener.second(textureInfo->id);
 
-        _textures.PushBack(textureInfo);
+        /* The texture is owned by the registry now. */
+        pending->textureId = 0;
+        RemovePending(i);
     }
 
-    return textureInfo;
+    EvictUnusedTextures();
+}
 
+GLuint TextureManager::GetPlaceholderTextureId() {
+    if (_placeholderTextureId == 0) {
+        unsigned char transparent[4] = { 0, 0, 0, 0 };
+        DecodedImage placeholder = { transparent, 1, 1, "" };
+        _placeholderTextureId = UploadTexture(placeholder, false);
+    }
+    return _placeholderTextureId;
 }
 
-void TextureManager::ReleaseTextures() {
-    for (Csm::csmUint32 i = 0; i < _textures.GetSize(); i++) {
-        delete _textures[i];
+void TextureManager::BeginUpload(PendingTexture* pending) {
+    const DecodedImage& image = pending->decoded->image;
+    const DecodedImage& preview = pending->decoded->preview;
+
+    /* Compressed levels are small enough to be uploaded from client memory, without preview. */
+    if (pending->decoded->compressed.IsValid()) {
+        APP_CALL_GLFUNC glGenTextures(1, &pending->textureId);
+        APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, pending->textureId);
+        APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, 0);
+        return;
     }
 
-    _textures.Clear();
+    /* The preview is small enough to be uploaded at once. */
+    if (preview.pixels != NULL) {
+        pending->previewId = UploadTexture(preview, false);
+        for (auto& listener : pending->listeners)
+            listener.second(pending->previewId);
+    }
+
+    /* Allocate the full texture, filled row by row afterwards. */
+    APP_CALL_GLFUNC glGenTextures(1, &pending->textureId);
+    APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, pending->textureId);
+    APP_CALL_GLFUNC glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    APP_CALL_GLFUNC glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, 0);
+
+    /* Without PBO, rows are uploaded from client memory (still within the budget). */
+    if (PixelBufferSupported())
+        APP_CALL_GLFUNC glGenBuffers(1, &pending->pbo);
 }
 
-void TextureManager::ReleaseTexture(Csm::csmUint32 textureId) {
-    for (Csm::csmUint32 i = 0; i < _textures.GetSize(); i++) {
-        if (_textures[i]->id != textureId) {
-            continue;
-        }
-        delete _textures[i];
-        _textures.Remove(i);
-        break;
+size_t TextureManager::UploadRows(PendingTexture* pending, size_t budget) {
+    const DecodedImage& image = pending->decoded->image;
+    const size_t rowBytes = static_cast<size_t>(image.width) * 4;
+    /* At least one row per frame, or a huge row would never be uploaded. */
+    const int rows = std::min(image.height - pending->uploadedRows,
+                              std::max(1, static_cast<int>(budget / rowBytes)));
+    if (rows <= 0)
+        return 0;
+    const size_t bytes = rowBytes * rows;
+
+    const unsigned char* src = image.pixels + rowBytes * pending->uploadedRows;
+
+    APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, pending->textureId);
+    if (pending->pbo != 0) {
+        /* The driver copies into the PBO and transfers to the texture without blocking the frame. */
+        APP_CALL_GLFUNC glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pending->pbo);
+        APP_CALL_GLFUNC glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, src, GL_STREAM_DRAW);
+        APP_CALL_GLFUNC glTexSubImage2D(GL_TEXTURE_2D, 0, 0, pending->uploadedRows, image.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        APP_CALL_GLFUNC glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        APP_CALL_GLFUNC glTexSubImage2D(GL_TEXTURE_2D, 0, 0, pending->uploadedRows, image.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, src);
     }
+    APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, 0);
+
+    pending->uploadedRows += rows;
+    return bytes;
 }
 
-void TextureManager::ReleaseTexture(std::string fileName) {
-    for (Csm::csmUint32 i = 0; i < _textures.GetSize(); i++) {
-        if (_textures[i]->fileName == fileName) {
-            delete _textures[i];
-            _textures.Remove(i);
+size_t TextureManager::UploadLevels(PendingTexture* pending, size_t budget) {
+    const TextureCache::CompressedImage& compressed = pending->decoded->compressed;
+    size_t uploaded = 0;
+
+    APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, pending->textureId);
+    /* At least one level per frame, or a huge level would never be uploaded. */
+    while (pending->uploadedLevels < compressed.levels.size()) {
+        const TextureCache::CompressedImage::Level& level = compressed.levels[pending->uploadedLevels];
+        if (uploaded > 0 && uploaded + level.size > budget)
             break;
-        }
+        APP_CALL_GLFUNC glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(pending->uploadedLevels), compressed.internalFormat,
+                                               level.width, level.height, 0, static_cast<GLsizei>(level.size),
+                                               compressed.data.data() + level.offset);
+        uploaded += level.size;
+        pending->uploadedLevels++;
     }
+    APP_CALL_GLFUNC glBindTexture(GL_TEXTURE_2D, 0);
+    return uploaded;
 }
 
-TextureManager::TextureInfo* TextureManager::GetTextureInfoById(GLuint textureId) const {
-    for (Csm::csmUint32 i = 0; i < _textures.GetSize(); i++) {
-        if (_textures[i]->id == textureId) {
-            return _textures[i];
-        }
+void TextureManager::ReleasePending(PendingTexture* pending) {
+    if (pending->pbo != 0)
+        APP_CALL_GLFUNC glDeleteBuffers(1, &pending->pbo);
+    if (pending->previewId != 0)
+        APP_CALL_GLFUNC glDeleteTextures(1, &pending->previewId);
+    if (pending->textureId != 0)
+        APP_CALL_GLFUNC glDeleteTextures(1, &pending->textureId);
+    pending->pbo = 0;
+    pending->previewId = 0;
+    pending->textureId = 0;
+    /* The pixels are released with the last reference (the worker may still hold one). */
+    pending->decoded.reset();
+}
+
+void TextureManager::RemovePending(Csm::csmUint32 index) {
+    PendingTexture* pending = _pendingTextures[index];
+    _pendingByPath.erase(pending->fileName);
+    ReleasePending(pending);
+    delete pending;
+    _pendingTextures.Remove(index);
+}
+
+size_t TextureManager::GetTextureBytes(int width, int height) {
+    /* RGBA8 with the mipmap chain (+1/3). */
+    return static_cast<size_t>(width) * height * 4 * 4 / 3;
+}
+
+TextureManager::TextureInfo* TextureManager::AcquireTexture(const std::string& fileName) {
+    auto it = _texturesByPath.find(fileName);
+    if (it == _texturesByPath.end())
+        return NULL;
+
+    TextureEntry& entry = it->second;
+    if (entry.refCount++ == 0) {
+        /* Reused before eviction. */
+        _unusedTextures.erase(entry.unusedPosition);
+        _unusedBytes -= entry.bytes;
     }
+    return &entry.info;
+}
+
+TextureManager::TextureInfo* TextureManager::RegisterTexture(const std::string& fileName, GLuint textureId, int width, int height, size_t bytes, int refCount) {
+    TextureEntry& entry = _texturesByPath[fileName];
+    entry.info.fileName = fileName;
+    entry.info.width = width;
+    entry.info.height = height;
+    entry.info.id = textureId;
+    _residentBytes += bytes - entry.bytes;
+    _peakBytes = std::max(_peakBytes, _residentBytes);
+    entry.bytes = bytes;
+    entry.refCount = refCount;
+    _texturesById[textureId] = &entry;
+
+    /* All the requests were released while streaming. */
+    if (refCount <= 0) {
+        entry.refCount = 0;
+        entry.unusedPosition = _unusedTextures.insert(_unusedTextures.end(), &entry);
+        _unusedBytes += bytes;
+    }
+    return &entry.info;
+}
+
+void TextureManager::ReleaseReference(TextureEntry* entry) {
+    if (entry->refCount <= 0 || --entry->refCount > 0)
+        return;
+
+    /* Kept for reuse (e.g. scene reload) until evicted. */
+    entry->unusedPosition = _unusedTextures.insert(_unusedTextures.end(), entry);
+    _unusedBytes += entry->bytes;
+}
+
+void TextureManager::EvictUnusedTextures() {
+    while (_unusedBytes > TEXTURE_UNUSED_BUDGET_BYTES && !_unusedTextures.empty()) {
+        /* Least recently released first. */
+        TextureEntry* entry = _unusedTextures.front();
+        _unusedTextures.pop_front();
+        _unusedBytes -= entry->bytes;
+        _residentBytes -= entry->bytes;
+
+        GLuint textureId = entry->info.id;
+        APP_CALL_GLFUNC glDeleteTextures(1, &textureId);
+        _texturesById.erase(textureId);
+        _texturesByPath.erase(entry->info.fileName);
+    }
+}
+
+void TextureManager::ReleaseTextures() {
+    _texturesById.clear();
+    _texturesByPath.clear();
+    _unusedTextures.clear();
+    _unusedBytes = 0;
+    _residentBytes = 0;
+}
+
+void TextureManager::ReleaseTexture(Csm::csmUint32 textureId) {
+    auto it = _texturesById.find(textureId);
+    if (it != _texturesById.end())
+        ReleaseReference(it->second);
+}
+
+void TextureManager::ReleaseTexture(std::string fileName) {
+    auto it = _texturesByPath.find(fileName);
+    if (it != _texturesByPath.end()) {
+        ReleaseReference(&it->second);
+        return;
+    }
+    auto streaming = _pendingByPath.find(fileName);
+    if (streaming != _pendingByPath.end() && streaming->second->refCount > 0)
+        streaming->second->refCount--;
+}
+
+TextureManager::TextureInfo* TextureManager::GetTextureInfoById(GLuint textureId) const {
+    auto it = _texturesById.find(textureId);
+    return it != _texturesById.end() ? &it->second->info : NULL;
+}
 
-    return NULL;
+TextureManager::MemoryStats TextureManager::GetMemoryStats() const {
+    MemoryStats stats;
+    stats.textureCount = _texturesByPath.size();
+    stats.residentBytes = _residentBytes;
+    stats.unusedBytes = _unusedBytes;
+    stats.peakBytes = _peakBytes;
+    stats.pendingCount = _pendingTextures.GetSize();
+    return stats;
 }
@@ -8,7 +8,12 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 #include <AppOpenGLWrapper.hpp>
 
@@ -19,6 +24,11 @@
  * @brief Texture Management Class.
  *
  * Class for loading and managing images.
+ *
+ * Loaded textures are reference counted and indexed by both file name and GL id:
+ * every `CreateTexture*` call takes a reference, every `ReleaseTexture` drops one.
+ * Unused textures are kept for reuse (shared by models, scene reloads) until
+ * they exceed `TEXTURE_UNUSED_BUDGET_BYTES`, then evicted least recently released first.
  */
 class TextureManager {
 public:
@@ -34,6 +44,37 @@ public:
         std::string fileName;
     };
 
+    /**
+     * @struct DecodedImage
+     * @brief RGBA pixels decoded from an image file, not uploaded to OpenGL yet.
+     */
+    struct DecodedImage {
+        unsigned char* pixels;  /**< RGBA8 pixels (premultiplied if enabled). NULL on failure */
+        int width;
+        int height;
+        std::string fileName;
+    };
+
+    /**
+     * @struct MemoryStats
+     * @brief Estimated VRAM usage of the loaded textures (mipmaps included).
+     */
+    struct MemoryStats {
+        size_t textureCount;    /**< Loaded textures, referenced or not. */
+        size_t residentBytes;   /**< All loaded textures. */
+        size_t unusedBytes;     /**< Unreferenced textures kept for reuse (see `TEXTURE_UNUSED_BUDGET_BYTES`). */
+        size_t peakBytes;       /**< Highest `residentBytes` since creation. */
+        size_t pendingCount;    /**< Textures still streaming. */
+    };
+
+    /**
+     * @brief Called on the OpenGL context thread when a streamed texture changes:
+     *  first with the low resolution preview, then with the full resident texture.
+     *
+     * @param[in] textureId  The texture to bind from now on.
+     */
+    typedef std::function<void(GLuint textureId)> TextureReadyCallback;
+
     TextureManager();
     ~TextureManager();
 
@@ -47,7 +88,7 @@ public:
      *
      * @return Color values after pre-multiply processing.
      */
-    inline unsigned int Premultiply(unsigned char red, unsigned char green, unsigned char blue, unsigned char alpha) {
+    static inline unsigned int Premultiply(unsigned char red, unsigned char green, unsigned char blue, unsigned char alpha) {
         return static_cast<unsigned>(\
             (red * (alpha + 1) >> 8) | \
             ((green * (alpha + 1) >> 8) << 8) | \
@@ -56,6 +97,14 @@ public:
             );
     }
 
+    /**
+     * @brief Premultiply RGBA8 pixels in place (SIMD when available).
+     *
+     * @param[in,out] pixels  RGBA8 pixels.
+     * @param[in]     count   Number of pixels.
+     */
+    static void PremultiplyPixels(unsigned char* pixels, size_t count);
+
     /**
      * @brief Image loading.
      *
@@ -64,17 +113,99 @@ public:
      */
     TextureInfo* CreateTextureFromPngFile(std::string fileName);
 
+    /**
+     * @brief Image loading without stalling the frame.
+     *
+     * The png is decoded on the worker pool, then `Update` streams it to OpenGL
+     * through a pixel buffer object over several frames.
+     * When the context supports it, the texture is also compressed into the
+     * on-disk `TextureCache`; later loads upload the cached mipmaps directly.
+     * Until the texture is resident, the returned placeholder (and then a low
+     * resolution preview, see `TextureReadyCallback`) should be drawn instead.
+     *
+     * @param[in] fileName  Image file path name to be read.
+     * @param[in] owner     Owner of the request, used by `CancelPendingTextures`.
+     * @param[in] onReady   Called when the texture to bind changes. Not called if
+     *                      the texture is already loaded.
+     * @return   The texture to bind now: the loaded texture, or a placeholder.
+     */
+    GLuint CreateTextureFromPngFileAsync(std::string fileName, const void* owner, TextureReadyCallback onReady);
+
+    /**
+     * @brief Upload a texture pre-compressed as KTX (e.g. by the model bundle baker) at once.
+     *
+     * Must be called on the OpenGL context thread.
+     *
+     * @param[in] fileName  Source image file path name, the key of the texture.
+     * @param[in] bytes     KTX content.
+     * @param[in] size      Size of the content.
+     * @return   Image information. Returns NULL if the format is not supported by
+     *           the context (or the texture is streaming): load the source image instead.
+     */
+    TextureInfo* CreateTextureFromKtxData(const std::string& fileName, const unsigned char* bytes, size_t size);
+
+    /**
+     * @brief Drop the callbacks of the streaming requests made by `owner` (e.g. the model is released).
+     *
+     * The textures are still loaded.
+     */
+    void CancelPendingTextures(const void* owner);
+
+    /**
+     * @brief Advance streaming uploads. Called once per frame on the OpenGL context thread.
+     *
+     * At most `TEXTURE_UPLOAD_BYTES_PER_FRAME` bytes are uploaded per call.
+     */
+    void Update();
+
+    /**
+     * @brief Read and decode a png file without touching OpenGL.
+     *
+     * Thread-safe: can be called from worker threads.
+     *
+     * @param[in]  fileName  Image file path name to be read.
+     * @param[out] image     Decoded image. Release it by `CreateTextureFromDecodedImage` or `ReleaseDecodedImage`.
+     * @return   Whether the image is decoded successfully.
+     */
+    static bool DecodePngFile(const std::string& fileName, DecodedImage* image);
+
+    /**
+     * @brief Decode png file content already in memory. Thread-safe.
+     *
+     * @param[in]  bytes     Content of the png file.
+     * @param[in]  size      Size of the content.
+     * @param[in]  fileName  Image file path name (kept in the decoded image).
+     * @param[out] image     Decoded image.
+     * @return   Whether the image is decoded successfully.
+     */
+    static bool DecodePngData(const unsigned char* bytes, size_t size, const std::string& fileName, DecodedImage* image);
+
+    /**
+     * @brief Release pixels of a decoded image which will not be uploaded.
+     */
+    static void ReleaseDecodedImage(DecodedImage* image);
+
+    /**
+     * @brief Upload a decoded image to OpenGL. Must be called on the OpenGL context thread.
+     *
+     * The pixels of the image are released after uploading.
+     *
+     * @param[in] image  Image decoded by `DecodePngFile`.
+     * @return   Image information. Returns NULL if the image is invalid.
+     */
+    TextureInfo* CreateTextureFromDecodedImage(DecodedImage* image);
+
     /**
      * @brief Release image(s).
      *
-     * Deallocate all images present in the array.
+     * Forget all images in the registry, regardless of their references.
      */
     void ReleaseTextures();
 
     /**
      * @brief Release image.
      *
-     * Releases the image with the specified texture ID.
+     * Drops a reference of the image with the specified texture ID.
      * 
      * @param[in] textureId  The ID of the texture to be released.
      **/
@@ -83,7 +214,8 @@ public:
     /**
      * @brief Release image.
      *
-     * Releases the image with the specified file name.
+     * Drops a reference of the image with the specified file name
+     * (the image may still be streaming).
      * 
      * @param[in] fileName  The file name of the texture to be released.
      **/
@@ -97,6 +229,98 @@ public:
      */
     TextureInfo* GetTextureInfoById(GLuint textureId) const;
 
+    /**
+     * @brief Estimated VRAM usage of the textures.
+     */
+    MemoryStats GetMemoryStats() const;
+
 private:
-    Csm::csmVector<TextureInfo*> _textures;
+    /**
+     * @struct PendingTexture
+     * @brief Streaming state of a texture requested by `CreateTextureFromPngFileAsync`.
+     */
+    struct PendingTexture;
+
+    /**
+     * @struct TextureEntry
+     * @brief Registry entry of a loaded texture.
+     */
+    struct TextureEntry {
+        TextureInfo info;
+        int refCount = 0;
+        size_t bytes = 0;                                       /**< Estimated VRAM usage. */
+        std::list<TextureEntry*>::iterator unusedPosition;      /**< Position in `_unusedTextures` when unreferenced. */
+    };
+
+    /**
+     * @brief Take a reference of a loaded texture.
+     *
+     * @return  NULL if the texture is not loaded.
+     */
+    TextureInfo* AcquireTexture(const std::string& fileName);
+
+    /**
+     * @brief Add a loaded texture to the registry with `refCount` references.
+     */
+    TextureInfo* RegisterTexture(const std::string& fileName, GLuint textureId, int width, int height, size_t bytes, int refCount);
+
+    /**
+     * @brief Drop a reference; unreferenced textures become evictable.
+     */
+    void ReleaseReference(TextureEntry* entry);
+
+    /**
+     * @brief Delete the least recently released textures while over the budget.
+     */
+    void EvictUnusedTextures();
+
+    /**
+     * @brief Estimated VRAM usage of a RGBA8 texture with mipmaps.
+     */
+    static size_t GetTextureBytes(int width, int height);
+
+    /**
+     * @brief Shared 1x1 transparent texture shown before anything is decoded.
+     */
+    GLuint GetPlaceholderTextureId();
+
+    /**
+     * @brief Upload the next rows of a pending texture through its PBO.
+     *
+     * @return Bytes uploaded.
+     */
+    size_t UploadRows(PendingTexture* pending, size_t budget);
+
+    /**
+     * @brief Upload the next mipmap levels of a pending texture loaded from the compressed cache.
+     *
+     * @return Bytes uploaded.
+     */
+    size_t UploadLevels(PendingTexture* pending, size_t budget);
+
+    /**
+     * @brief Upload the preview and allocate the full texture & PBO.
+     */
+    void BeginUpload(PendingTexture* pending);
+
+    /**
+     * @brief Release the GL objects & pixels of a pending texture.
+     */
+    void ReleasePending(PendingTexture* pending);
+
+    /**
+     * @brief Release and remove the pending texture at `index`.
+     */
+    void RemovePending(Csm::csmUint32 index);
+
+    std::unordered_map<std::string, TextureEntry> _texturesByPath;     /**< Loaded textures (node-based: pointers stay valid). */
+    std::unordered_map<GLuint, TextureEntry*> _texturesById;
+    std::list<TextureEntry*> _unusedTextures;                           /**< Unreferenced textures, least recently released first. */
+    size_t _unusedBytes;
+    size_t _residentBytes;                                              /**< Estimated VRAM of `_texturesByPath`. */
+    size_t _peakBytes;
+
+    Csm::csmVector<PendingTexture*> _pendingTextures;   /**< Streaming textures, in request order. */
+    std::unordered_map<std::string, PendingTexture*> _pendingByPath;
+    GLuint _placeholderTextureId;
 };
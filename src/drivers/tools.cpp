@@ -1,4 +1,5 @@
 #include <fstream>
+#include <utility>
 #include <sys/stat.h>
 
 #include <AppOpenGLWrapper.hpp>
@@ -13,7 +14,10 @@
 #include <Windows.h>
 #pragma comment(lib, "winmm.lib")
 #else
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <time.h>
+#include <unistd.h>
 unsigned int timeGetTime() {
     unsigned int uptime = 0;
     struct timespec on;
@@ -26,6 +30,116 @@ unsigned int timeGetTime() {
 using namespace Csm;
 using namespace std;
 
+namespace {
+    /* Smaller files are cheaper to read than to map (syscalls, page faults). */
+    const csmSizeInt MapMinSize = 16 * 1024;
+}
+
+FileBuffer::FileBuffer()
+    : _data(NULL), _size(0), _mapped(false)
+#ifdef _WIN32
+    , _mappingHandle(NULL)
+#endif
+{ }
+
+FileBuffer::~FileBuffer() {
+    Close();
+}
+
+FileBuffer::FileBuffer(FileBuffer&& other) noexcept : FileBuffer() {
+    MoveFrom(other);
+}
+
+FileBuffer& FileBuffer::operator=(FileBuffer&& other) noexcept {
+    if (this != &other) {
+        Close();
+        MoveFrom(other);
+    }
+    return *this;
+}
+
+void FileBuffer::MoveFrom(FileBuffer& other) {
+    _data = other._data;
+    _size = other._size;
+    _mapped = other._mapped;
+    other._data = NULL;
+    other._size = 0;
+    other._mapped = false;
+#ifdef _WIN32
+    _mappingHandle = other._mappingHandle;
+    other._mappingHandle = NULL;
+#endif
+}
+
+bool FileBuffer::Open(const std::string& filePath) {
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= static_cast<LONGLONG>(MapMinSize)) {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+            if (view != NULL) {
+                _data = static_cast<const csmByte*>(view);
+                _size = static_cast<csmSizeInt>(fileSize.QuadPart);
+                _mapped = true;
+                _mappingHandle = mapping;
+            } else if (mapping) {
+                CloseHandle(mapping);
+            }
+        }
+        /* The mapping keeps the file open. */
+        CloseHandle(file);
+    }
+#else
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat statBuf;
+        if (fstat(fd, &statBuf) == 0 && static_cast<csmSizeInt>(statBuf.st_size) >= MapMinSize) {
+            void* view = mmap(NULL, statBuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED) {
+                /* Assets are parsed front to back. */
+                madvise(view, statBuf.st_size, MADV_SEQUENTIAL);
+                _data = static_cast<const csmByte*>(view);
+                _size = static_cast<csmSizeInt>(statBuf.st_size);
+                _mapped = true;
+            }
+        }
+        /* The mapping keeps the file open. */
+        close(fd);
+    }
+#endif
+
+    if (!_mapped) {
+        /* Heap fallback: small files, or files that cannot be mapped. */
+        _data = ToolFunctions::LoadFileAsBytes(filePath, &_size);
+    }
+    return _data != NULL;
+}
+
+void FileBuffer::Close() {
+    if (_data == NULL)
+        return;
+
+    if (_mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(_mappingHandle);
+        _mappingHandle = NULL;
+#else
+        munmap(const_cast<csmByte*>(_data), _size);
+#endif
+    } else {
+        ToolFunctions::ReleaseBytes(const_cast<csmByte*>(_data));
+    }
+    _data = NULL;
+    _size = 0;
+    _mapped = false;
+}
+
 double ToolFunctions::s_currentFrame = 0.0;
 double ToolFunctions::s_lastFrame = 0.0;
 double ToolFunctions::s_deltaTime = 0.0;
@@ -41,8 +155,6 @@ csmByte* ToolFunctions::LoadFileAsBytes(const string filePath, csmSizeInt* outSi
     }
 
     std::fstream file;
-    char* buf = new char[size];
-
     file.open(path, std::ios::in | std::ios::binary);
     if (!file.is_open()) {
         stdLogger.Exception(
@@ -52,6 +164,7 @@ csmByte* ToolFunctions::LoadFileAsBytes(const string filePath, csmSizeInt* outSi
         );
         return NULL;
     }
+    char* buf = new char[size];
     file.read(buf, size);
     file.close();
 
@@ -12,6 +12,56 @@
 
 #include <CubismFramework.hpp>
 
+/**
+ * @class FileBuffer
+ * @brief Read-only content of a file, memory mapped when possible.
+ *
+ * Prefer this to `ToolFunctions::LoadFileAsBytes` when the data is only read:
+ * parsers (json, png, wav) then read straight from the page cache.
+ *
+ * Small files, and files which cannot be mapped, are read into the heap instead.
+ * The data is valid as long as the buffer is open: the buffer can be moved
+ * (e.g. handed over to another thread) but not copied.
+ */
+class FileBuffer {
+public:
+    FileBuffer();
+    ~FileBuffer();
+
+    FileBuffer(FileBuffer&& other) noexcept;
+    FileBuffer& operator=(FileBuffer&& other) noexcept;
+    FileBuffer(const FileBuffer&) = delete;
+    FileBuffer& operator=(const FileBuffer&) = delete;
+
+    /**
+     * @brief Open a file (the previous one is closed).
+     *
+     * @param[in]   filePath    Path of the file to be read
+     * @return      Whether the file is readable
+     */
+    bool Open(const std::string& filePath);
+
+    /**
+     * @brief Unmap / free the content. The data must not be used afterwards.
+     */
+    void Close();
+
+    const Csm::csmByte* GetData() const { return _data; }
+    Csm::csmSizeInt GetSize() const { return _size; }
+    bool IsOpen() const { return _data != NULL; }
+    bool IsMapped() const { return _mapped; }
+
+private:
+    void MoveFrom(FileBuffer& other);
+
+    const Csm::csmByte* _data;
+    Csm::csmSizeInt _size;
+    bool _mapped;       /**< Mapped (otherwise allocated by `ToolFunctions::LoadFileAsBytes`). */
+#ifdef _WIN32
+    void* _mappingHandle;
+#endif
+};
+
 /**
  * @class ToolFunctions
  * @brief Cubism Platform Abstraction Layer, which abstracts platform-dependent functions.
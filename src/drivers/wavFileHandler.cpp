@@ -78,7 +78,10 @@ Csm::csmBool WavFileHandler::LoadWavFile(const Csm::csmString& filePath) {
         ReleasePcmData();
 
     /* File load. */
-    _byteReader._fileByte = ToolFunctions::LoadFileAsBytes(filePath.GetRawString(), &(_byteReader._fileSize));
+    FileBuffer file;
+    file.Open(filePath.GetRawString());
+    _byteReader._fileByte = file.GetData();
+    _byteReader._fileSize = file.GetSize();
     _byteReader._readOffset = 0;
 
     /* Failure if the file load fails
@@ -159,7 +162,7 @@ Csm::csmBool WavFileHandler::LoadWavFile(const Csm::csmString& filePath) {
     }  while (false);
 
     /* File resource release. */
-    ToolFunctions::ReleaseBytes(_byteReader._fileByte);
+    file.Close();
     _byteReader._fileByte = NULL;
     _byteReader._fileSize = 0;
 
@@ -153,7 +153,7 @@ private:
                 && (getSignature[2] == referenceString[2]) && (getSignature[3] == referenceString[3]);
         }
 
-        Csm::csmByte* _fileByte;    /**< Byte sequence of the loaded file */
+        const Csm::csmByte* _fileByte;  /**< Byte sequence of the loaded file (owned by a `FileBuffer`) */
         Csm::csmSizeInt _fileSize;  /**< File size */
         Csm::csmUint32 _readOffset; /**< File reference position */
     } _byteReader;
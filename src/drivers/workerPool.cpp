@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "drivers/workerPool.h"
+
+namespace {
+    WorkerPool* s_instance = NULL;
+
+    const unsigned int MaxWorkerCount = 8;
+}
+
+WorkerPool* WorkerPool::GetInstance() {
+    if (s_instance == NULL)
+        s_instance = new WorkerPool();
+
+    return s_instance;
+}
+
+void WorkerPool::ReleaseInstance() {
+    if (s_instance != NULL)
+        delete s_instance;
+
+    s_instance = NULL;
+}
+
+WorkerPool::WorkerPool() : _stop(false) {
+    /* Keep one core for the GUI thread. */
+    unsigned int hardware = std::thread::hardware_concurrency();
+    unsigned int count = hardware > 1 ? std::min(hardware - 1, MaxWorkerCount) : 1;
+    for (unsigned int i = 0; i < count; i++) {
+        _workers.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _cond.notify_all();
+    for (std::thread& worker : _workers) {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+void WorkerPool::Submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+    }
+    _cond.notify_one();
+}
+
+void WorkerPool::ParallelFor(int count, const std::function<void(int)>& job) {
+    if (count <= 0)
+        return;
+    /* Nothing to share: run inline, without the bookkeeping (and its allocations). */
+    if (count == 1 || GetWorkerCount() == 0) {
+        for (int i = 0; i < count; i++)
+            job(i);
+        return;
+    }
+
+    /* Shared by the helpers: they may outlive this call only until they notice no index is left. */
+    struct State {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::mutex mutex;
+        std::condition_variable cond;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+    const std::function<void(int)>* jobPtr = &job;
+
+    auto drain = [state, jobPtr, count]() {
+        int i;
+        while ((i = state->next.fetch_add(1)) < count) {
+            (*jobPtr)(i);
+            if (state->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->cond.notify_all();
+            }
+        }
+    };
+
+    int helpers = std::min(count - 1, GetWorkerCount());
+    for (int i = 0; i < helpers; i++) {
+        Submit(drain);
+    }
+    /* The calling thread works too instead of only waiting. */
+    drain();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cond.wait(lock, [&state, count]() { return state->done.load() == count; });
+}
+
+void WorkerPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cond.wait(lock, [this]() { return _stop || !_jobs.empty(); });
+            if (_stop && _jobs.empty())
+                return;
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+    }
+}
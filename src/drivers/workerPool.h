@@ -0,0 +1,70 @@
+/**
+ * @file workerPool.h
+ * @brief A source file defining the worker thread pool of the drivers.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkerPool
+ * @brief Fixed-size worker thread pool for CPU / IO bound jobs (file reading, parsing, decoding).
+ *
+ * Jobs must NOT touch OpenGL: the context is only current on the GUI thread.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Return an instance (singleton) of the class.
+     *
+     * If the instance has not been created, it is created internally.
+     *
+     * @return Instances of the class.
+     */
+    static WorkerPool* GetInstance();
+
+    /**
+     * @brief Release an instance (singleton) of the class.
+     *
+     * Waits for the queued jobs to finish.
+     */
+    static void ReleaseInstance();
+
+    /**
+     * @brief Queue a job to be run on a worker thread.
+     */
+    void Submit(std::function<void()> job);
+
+    /**
+     * @brief Run `job(0) ... job(count - 1)` on the worker threads and the calling thread.
+     *
+     * Returns when all of them are finished.
+     */
+    void ParallelFor(int count, const std::function<void(int)>& job);
+
+    /**
+     * @brief Get the number of worker threads.
+     */
+    int GetWorkerCount() const { return static_cast<int>(_workers.size()); }
+
+private:
+    WorkerPool();
+    ~WorkerPool();
+
+    void WorkerLoop();
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _jobs;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    bool _stop;
+};
@@ -1,3 +1,8 @@
+#include <chrono>
+
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QPointer>
 #include <QtCore/QSettings>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
@@ -14,13 +19,16 @@
 #include "gui/animeWidget.h"
 #include "gui/configDialog.h"
 #include "gui/mainWindow.h"
+#include "drivers/coreManager.h"
 #include "drivers/modelManager.h"
 #include "drivers/resourceLoader.h"
 
 #include "gui/chatBox.h"
 
 #include "modules/audio/audio_recorder.h"
+#include "modules/chat/speculative_request.h"
 #include "modules/hotkey/shortcut_handler.h"
+#include "network/network_manager.h"
 
 #include "utils/cleaner.hpp"
 #include "utils/logger.h"
@@ -31,7 +39,9 @@
 
 mainWindow::mainWindow(QApplication* mapp)
     : QMainWindow(nullptr), app(mapp),
-      systemTray(new QSystemTrayIcon(this)) {
+      systemTray(new QSystemTrayIcon(this)),
+      chat_client(nullptr), speculative_request(nullptr), mcp_client(nullptr),
+      mcp_client_ready(false), mcp_client_init_abort(false) {
     
     setupUi(this);
 
@@ -63,6 +73,17 @@ mainWindow::~mainWindow() {
     writeSettings();
     stdLogger.Debug("Geometry configurations saved.");
 
+    // 停止并等待后台 MCP client 连接线程（它引用了 this），唤醒正在等待重试的线程
+    {
+        std::lock_guard<std::mutex> lock(this->mcp_client_init_mutex);
+        this->mcp_client_init_abort = true;
+    }
+    this->mcp_client_init_cv.notify_all();
+    if (this->mcp_client_init_thread.joinable()) {
+        this->mcp_client_init_thread.join();
+    }
+
+    delete this->speculative_request;
     delete this->chat_client;
     delete this->audio_handler;
 
@@ -114,6 +135,10 @@ void mainWindow::setupTray() {
     chatAction->setText(tr("Chat"));
     connect(chatAction, &QAction::triggered, this, &mainWindow::chatBegin);
 
+    memoryReportAction = new QAction(mainMenu);
+    memoryReportAction->setText(tr("Memory Report"));
+    connect(memoryReportAction, &QAction::triggered, this, &mainWindow::dumpMemoryReport);
+
     aboutAction = new QAction(mainMenu);
     aboutAction->setText(tr("About..."));
     connect(aboutAction, &QAction::triggered, this, &mainWindow::aboutAuthor);
@@ -123,6 +148,7 @@ void mainWindow::setupTray() {
     mainMenu->addAction(chatAction);
     mainMenu->addMenu(switchMenu);
     mainMenu->addSeparator();
+    mainMenu->addAction(memoryReportAction);
     mainMenu->addAction(aboutAction);
     mainMenu->addAction(exitAction);
 
@@ -329,7 +355,16 @@ void mainWindow::initMCPServers() {
         stdLogger.Debug("mcp disabled. Skipped initializing mcp servers");
         return;
     }
-    if (!this->module_config_manager->start_enabled_mcp_servers()) {
+    // 后端 MCP servers 在后台并发启动，每个启动完成后回到 GUI 线程刷新工具列表
+    QPointer<mainWindow> self(this);
+    auto on_backend_ready = [self](const std::string &name, bool success) {
+        if (self.isNull()) return;
+        QString server_name = QString::fromStdString(name);
+        QMetaObject::invokeMethod(self.data(), [self, server_name, success]() {
+            if (!self.isNull()) self->recv_mcp_backend_ready(server_name, success);
+        }, Qt::QueuedConnection);
+    };
+    if (!this->module_config_manager->start_enabled_mcp_servers(on_backend_ready)) {
         stdLogger.Exception("failed to start mcp servers. mcp will be disabled");
         // 有必要提示用户
         QMessageBox::warning(this, "ModuleConfigManager",
@@ -376,6 +411,8 @@ void mainWindow::initClients() {
     // preparing for client parameters
     this->audio_handler->set_stt_params(this->stt_params);
     this->audio_handler->set_tts_params(this->tts_params);
+    // 启动时预连接 TTS 服务（LLM 服务在 setChatParams 时预连接）
+    NetworkManager::instance()->preconnect(QUrl(QString::fromStdString(this->tts_params.server_url)));
 
     stdLogger.Debug("initializing chat client...");
     Chat::Client::chat_params_t cp;
@@ -390,53 +427,31 @@ void mainWindow::initClients() {
     this->chat_client->setTimeout(120000);
     this->chat_client->setUseStream(llm_config.stream);
 
-    // MCP config (tools calling config)
-    while (this->module_config_manager->is_mcp_enabled()) {
-        stdLogger.Debug("initializing mcp client...");
-        std::string mcp_host;
-        int mcp_port;
-        std::tie<std::string, int>(mcp_host, mcp_port) = this->module_config_manager->get_mcp_server_info();
-        this->mcp_client = new mcp::sse_client(mcp_host, mcp_port);
-
-        bool mcp_client_init_succ = false;
-        int mcp_client_retry_cnt = 0;
-
-        while (++mcp_client_retry_cnt <= MCP_SSE_CLIENT_MAX_RETRY_TIMES) {
-            mcp_client_init_succ = this->mcp_client->initialize(appName "SSE MCP Client", mcp::MCP_VERSION);
-            if (!mcp_client_init_succ) continue;
-            // ping server
-            if (!this->mcp_client->ping()) {
-                stdLogger.Warning("failed to ping mcp frontend server: retry");
-            }
-            if (mcp_client_init_succ) break;
-        }
-
-        if (!mcp_client_init_succ) {
-            stdLogger.Exception("failed to initialize mcp sse client / ping mcp server. Will not use tools");
-            break;
-        }
+    this->speculative_request = new Chat::SpeculativeRequest(this->chat_client);
+    Chat::SpeculativeRequest::speculative_params_t sp;
+    sp.enable = llm_config.speculative;
+    sp.stable_partials = llm_config.speculative_stable_partials;
+    sp.stable_ms = llm_config.speculative_stable_ms;
+    sp.min_chars = llm_config.speculative_min_chars;
+    this->speculative_request->setParams(sp);
+    // 推测请求依赖录音过程中的部分转写结果
+    this->audio_handler->get_recorder_unsafe_ptr()->setPartialInterval(
+        llm_config.speculative ? llm_config.speculative_partial_interval_ms : 0);
 
-        // 委托回收 MCP client、断开连接（不放在析构函数中，一是耗时，而是退出时一定要执行的安全性）
-        auto temp_mcp_client = this->mcp_client;
-        // 注意 ModuleConfigManager 是单例模式
-        auto mcm_instance = this->module_config_manager;
-        Cleaner::instance().register_cleanup([temp_mcp_client, mcm_instance]() {
-            if (mcm_instance->is_mcp_enabled() && temp_mcp_client) {
-                // 析构以断开连接
-                delete temp_mcp_client;
-            }
-        });
-        
-        auto vtools = this->mcp_client->get_tools();
-        QJsonArray qtools = this->mcpTools2OAIFormatQJsonArray(vtools);
-        this->chat_client->setTools(qtools);
-        
-        // do while(0)
-        break;
+    // MCP config (tools calling config)
+    // 前端 MCP server 就在本进程内时，工具调用直接分发到后端，不需要本地 SSE client
+    if (this->module_config_manager->is_mcp_in_process_dispatch()) {
+        stdLogger.Debug("mcp tool calls are dispatched in-process. Skipped initializing mcp sse client");
+    } else if (this->module_config_manager->is_mcp_enabled()) {
+        this->initMCPClientAsync();
     }
 
     connect(this->audio_handler, SIGNAL(stt_reply(bool,QString)),
         this, SLOT(recv_stt_reply(bool, QString)));
+    connect(this->audio_handler, SIGNAL(stt_partial_reply(QString)),
+        this, SLOT(recv_stt_partial_reply(QString)));
+    connect(this->audio_handler, SIGNAL(stt_partial_discarded()),
+        this, SLOT(recv_stt_partial_discarded()));
     connect(this->audio_handler, SIGNAL(tts_reply(bool,QString)),
         this, SLOT(recv_tts_reply(bool, QString)));
     connect(this->chat_client, SIGNAL(asyncResponseReceived(const QString&)),
@@ -449,6 +464,83 @@ void mainWindow::initClients() {
         this, SLOT(recv_chat_error(QString)));
     connect(this->chat_client, SIGNAL(toolCallsReceived(const QJsonArray&)),
         this, SLOT(recv_tool_calls(QJsonArray)));
+    connect(this->speculative_request, SIGNAL(fired(const QString&)),
+        this, SLOT(recv_speculative_fired(QString)));
+    connect(this->speculative_request, SIGNAL(confirmed()),
+        this, SLOT(recv_speculative_confirmed()));
+    connect(this->speculative_request, SIGNAL(cancelled()),
+        this, SLOT(recv_speculative_cancelled()));
+}
+
+void mainWindow::initMCPClientAsync() {
+    stdLogger.Debug("initializing mcp client...");
+    std::string mcp_host;
+    int mcp_port;
+    std::tie<std::string, int>(mcp_host, mcp_port) = this->module_config_manager->get_mcp_server_info();
+    this->mcp_client = new mcp::sse_client(mcp_host, mcp_port);
+
+    // 委托回收 MCP client、断开连接（不放在析构函数中，一是耗时，而是退出时一定要执行的安全性）
+    auto temp_mcp_client = this->mcp_client;
+    // 注意 ModuleConfigManager 是单例模式
+    auto mcm_instance = this->module_config_manager;
+    // 注意：后台连接线程在 mainWindow 析构时已经结束，这里可以安全地析构 client
+    Cleaner::instance().register_cleanup([temp_mcp_client, mcm_instance]() {
+        if (mcm_instance->is_mcp_enabled() && temp_mcp_client) {
+            // 析构以断开连接
+            delete temp_mcp_client;
+        }
+    });
+
+    // 工具列表由 recv_mcp_backend_ready 直接从前端 server 获取，这里只负责建立工具调用通道
+    this->mcp_client_init_thread = std::thread([this, temp_mcp_client]() {
+        bool mcp_client_init_succ = false;
+        int mcp_client_retry_cnt = 0;
+
+        while (++mcp_client_retry_cnt <= MCP_SSE_CLIENT_MAX_RETRY_TIMES) {
+            {
+                std::lock_guard<std::mutex> lock(this->mcp_client_init_mutex);
+                if (this->mcp_client_init_abort) return;
+            }
+            mcp_client_init_succ = temp_mcp_client->initialize(appName "SSE MCP Client", mcp::MCP_VERSION);
+            if (mcp_client_init_succ) {
+                // ping server
+                if (!temp_mcp_client->ping()) {
+                    stdLogger.Warning("failed to ping mcp frontend server: retry");
+                }
+                break;
+            }
+            // 等待重试间隔，mainWindow 析构时立即返回
+            std::unique_lock<std::mutex> lock(this->mcp_client_init_mutex);
+            if (this->mcp_client_init_cv.wait_for(lock, std::chrono::seconds(MCP_SSE_CLIENT_RETRY_INTERVAL),
+                    [this]() { return this->mcp_client_init_abort; })) {
+                return;
+            }
+        }
+
+        if (!mcp_client_init_succ) {
+            stdLogger.Exception("failed to initialize mcp sse client / ping mcp server. Will not use tools");
+            return;
+        }
+        stdLogger.Info("mcp sse client connected to frontend server");
+        this->mcp_client_ready.store(true);
+    });
+}
+
+void mainWindow::recv_mcp_backend_ready(QString server_name, bool success) {
+    if (!success) {
+        QSystemTrayIcon::MessageIcon msgIcon = QSystemTrayIcon::MessageIcon::Warning;
+        this->systemTray->showMessage(
+            appName,
+            tr("failed to start mcp server '%1'. Its tools will be unavailable").arg(server_name),
+            msgIcon, 5000
+        );
+        return;
+    }
+    if (this->chat_client == nullptr) return;
+    // 前端 server 中的工具是逐个后端累加注册的，每次都取全量列表
+    QJsonArray qtools = this->mcpTools2OAIFormatQJsonArray(this->module_config_manager->get_mcp_tools());
+    this->chat_client->setTools(qtools);
+    stdLogger.Info("tools from mcp server '" + server_name.toStdString() + "' are attached to chat client");
 }
 
 void mainWindow::initGlobalHotKey() {
@@ -490,11 +582,40 @@ void mainWindow::recv_stt_reply(bool valid, QString transcribed_text) {
     // whatever it comes from (keyboard or chatbox), just send it!
     if ((valid && transcribed_text.isEmpty()) || !valid) {
         stdLogger.Warning("empty speech text from STT client");
+        this->speculative_request->abandon();
+        return;
+    }
+    // 推测请求命中时，请求已经发出，不需要重复发送
+    if (this->speculative_request->onFinalTranscript(transcribed_text)) {
         return;
     }
     this->is_receiving = true;
     this->chat_client->sendMessageAsync(transcribed_text);
 }
+void mainWindow::recv_stt_partial_reply(QString partial_text) {
+    this->speculative_request->onPartialTranscript(partial_text, this->is_receiving);
+}
+void mainWindow::recv_stt_partial_discarded() {
+    // 录音被丢弃，不会再有最终转写结果
+    this->speculative_request->abandon();
+}
+void mainWindow::recv_speculative_fired(QString text) {
+    Q_UNUSED(text);
+    this->is_receiving = true;
+}
+void mainWindow::recv_speculative_confirmed() {
+    if (this->speculative_pending_reply) {
+        auto pending = std::move(this->speculative_pending_reply);
+        this->speculative_pending_reply = nullptr;
+        pending();
+    }
+}
+void mainWindow::recv_speculative_cancelled() {
+    // 推测请求的回复（包括流式输出的部分内容）全部丢弃，历史记录已由 Client 回滚
+    this->speculative_pending_reply = nullptr;
+    this->current_stream_reply_buf = "";
+    this->is_receiving = false;
+}
 void mainWindow::recv_tts_reply(bool success, QString msg) {
     if (success) {
         // play sound from file
@@ -509,6 +630,11 @@ void mainWindow::recv_tts_reply(bool success, QString msg) {
     }
 }
 void mainWindow::recv_chat_async_reply(QString text) {
+    // 推测请求尚未确认时不能播放回复
+    if (this->speculative_request->isAwaitingConfirmation()) {
+        this->speculative_pending_reply = [this, text]() { this->recv_chat_async_reply(text); };
+        return;
+    }
     this->is_receiving = false;
     // Note: you won't speak out code blocks or your thinkings XP
     text = Chat::Client::removeCodeBlocks(text);
@@ -518,6 +644,11 @@ void mainWindow::recv_chat_async_reply(QString text) {
     this->last_tts_pending_audio_file = gen_audio_file;
 }
 void mainWindow::recv_tool_calls(QJsonArray tool_calls) {
+    // 推测请求尚未确认时不能调用工具（可能有副作用）
+    if (this->speculative_request->isAwaitingConfirmation()) {
+        this->speculative_pending_reply = [this, tool_calls]() { this->recv_tool_calls(tool_calls); };
+        return;
+    }
     // this->is_receiving = false;
     this->callingTools(tool_calls);
     // this->is_receiving = true;
@@ -536,6 +667,12 @@ void mainWindow::recv_chat_stream_fin() {
 }
 void mainWindow::recv_chat_error(QString msg) {
     this->is_receiving = false;
+    // 推测请求失败时放弃推测，最终转写结果会按正常流程重新发送
+    if (this->speculative_request->isAwaitingConfirmation()) {
+        stdLogger.Warning("speculative request failed: " + msg.toStdString());
+        this->speculative_request->abandon();
+        return;
+    }
     stdLogger.Exception("failed to retrieve response message due to client error: "
         + msg.toStdString());
 }
@@ -584,7 +721,19 @@ void mainWindow::callingTools(const QJsonArray &tool_calls) {
             }
             // re-decoded to mcp::json
             json tool_args_fin = json::parse(args_encoded.toStdString());
-            json result = this->mcp_client->call_tool(tool_name.toStdString(), tool_args_fin);
+            json result;
+            if (this->module_config_manager->is_mcp_in_process_dispatch()) {
+                // 工具所在的后端可能尚未就绪（还未注册到进程内分发表）
+                if (!this->module_config_manager->has_mcp_tool(tool_name.toStdString())) {
+                    throw std::runtime_error("no ready mcp server provides this tool");
+                }
+                result = this->module_config_manager->call_mcp_tool(tool_name.toStdString(), tool_args_fin);
+            } else {
+                if (this->mcp_client == nullptr || !this->mcp_client_ready.load()) {
+                    throw std::runtime_error("mcp client is not connected yet");
+                }
+                result = this->mcp_client->call_tool(tool_name.toStdString(), tool_args_fin);
+            }
             auto content = result.value("content", mcp::json::array());
             std::string content_str = content.dump();
             // write to history
@@ -599,6 +748,25 @@ void mainWindow::callingTools(const QJsonArray &tool_calls) {
     }
 }
 
+void mainWindow::dumpMemoryReport() {
+    // 按需导出 Cubism 内存（按标签统计、峰值）与纹理显存估计
+    const std::string report = CoreManager::GetInstance()->GetMemoryReport();
+    stdLogger.Info("Memory report: " + report);
+
+    QFile file(MEMORY_REPORT_FILE_PATH);
+    QSystemTrayIcon::MessageIcon msgIcon = QSystemTrayIcon::MessageIcon::Information;
+    QString msg = tr("Memory report saved to %1").arg(QFileInfo(file).absoluteFilePath());
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        file.write(report.c_str(), static_cast<qint64>(report.size()));
+        file.close();
+    } else {
+        stdLogger.Warning("Failed to write memory report: " + file.errorString().toStdString());
+        msgIcon = QSystemTrayIcon::MessageIcon::Warning;
+        msg = tr("Failed to save memory report: %1").arg(file.errorString());
+    }
+    this->systemTray->showMessage(appName, msg, msgIcon, 5000);
+}
+
 void mainWindow::aboutAuthor() {
     PREPARE_FOR_POPUP;
     QMessageBox::about(0, tr("About me & my program"),
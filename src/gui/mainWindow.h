@@ -8,6 +8,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
 #include <QtCore/QJsonArray>
 #include <QtWidgets/QAction>
 #include <QtWidgets/QApplication>
@@ -25,6 +31,7 @@ class GlobalHotKeyHandler;
 
 namespace Chat {
 class Client;
+class SpeculativeRequest;
 };
 
 namespace mcp {
@@ -53,10 +60,13 @@ private slots:
     void geoEditMode(bool enter);
     void config();
     void chatBegin();
+    void dumpMemoryReport();
 
     void aboutAuthor();
 
     void recv_stt_reply(bool valid, QString transcribed_text);
+    void recv_stt_partial_reply(QString partial_text);
+    void recv_stt_partial_discarded();
     void recv_tts_reply(bool success, QString msg);
     void recv_chat_async_reply(QString text);
     void recv_chat_stream_ready(QString chunk);
@@ -64,7 +74,14 @@ private slots:
     void recv_chat_error(QString msg);
     void recv_tool_calls(QJsonArray tool_calls);
 
+    void recv_speculative_fired(QString text);
+    void recv_speculative_confirmed();
+    void recv_speculative_cancelled();
+
     void toggle_keyboard_record();
+
+    // 单个后端 MCP server 启动结束后（GUI 线程）刷新 Chat Client 的工具列表
+    void recv_mcp_backend_ready(QString server_name, bool success);
 private:
     void writeSettings();
     void loadSettings();
@@ -75,6 +92,8 @@ private:
 
     void initMCPServers();
     void initClients();
+    // 后台线程中连接前端 MCP server（initialize + ping 重试），不阻塞启动流程
+    void initMCPClientAsync();
     void initGlobalHotKey();
 
     // 按照模型指令调用指定工具（可能有多个），这会更改 Chat Client 的历史记录
@@ -93,6 +112,7 @@ private:
     QAction *geoEditAction;
     QAction *settingsAction;
     QAction *chatAction;
+    QAction *memoryReportAction;
     QAction *aboutAction;
     
     QApplication* app;
@@ -110,9 +130,18 @@ private:
     // chat utilities
     Chat::Client *chat_client;
     bool is_receiving;
+    Chat::SpeculativeRequest *speculative_request;
+    // 推测请求未确认前收到的回复（文本回复或工具调用），确认后再执行
+    std::function<void()> speculative_pending_reply;
 
     // tool calling & MCP utilities
     mcp::client *mcp_client;
+    std::thread mcp_client_init_thread;
+    std::atomic<bool> mcp_client_ready;
+    // 通知连接线程停止重试（由 mcp_client_init_mutex 保护）
+    bool mcp_client_init_abort;
+    std::mutex mcp_client_init_mutex;
+    std::condition_variable mcp_client_init_cv;
 
     // global hotkey
     GlobalHotKeyHandler *hotkey_handler;
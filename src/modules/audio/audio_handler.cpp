@@ -21,6 +21,8 @@ AudioHandler::AudioHandler(QObject *parent)
     
     connect(this->stt_client, SIGNAL(replyArrived(bool,const QString&)),
             this, SIGNAL(stt_reply(bool,QString)));
+    connect(this->stt_client, SIGNAL(partialArrived(const QString&)),
+            this, SIGNAL(stt_partial_reply(QString)));
     connect(this->tts_client, SIGNAL(finished(bool,const QString&)),
             this, SIGNAL(tts_reply(bool,QString)));
 }
@@ -40,6 +42,19 @@ void AudioHandler::stt_request(const QString &audio_file) {
     this->stt_client->sendWav(this->stt_params);
 }
 
+void AudioHandler::stt_partial_request(const QString &audio_file) {
+    stt_params_t params = this->stt_params;
+    params.fname_inp.clear();
+    params.fname_inp.emplace_back(audio_file.toStdString());
+
+    this->stt_client->sendPartialWav(params);
+}
+
+void AudioHandler::stt_discard_partials() {
+    this->stt_client->discardPartials();
+    emit stt_partial_discarded();
+}
+
 QString AudioHandler::tts_request(const QString &text) {
     // generate audio filename
     QString gen_audio_fn = AudioHandler::get_new_audio_filename(false);
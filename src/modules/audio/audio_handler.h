@@ -57,6 +57,17 @@ public:
      * @see AudioHandler::stt_reply
      */
     void stt_request(const QString &audio_file);
+    /**
+     * @brief convert a snapshot of the ongoing recording to text asynchronously.
+     *  Listen to signal `stt_partial_reply` to get result. The file is removed afterwards.
+     *  Called by the recorder (see `AudioRecorder::setPartialInterval`).
+     */
+    void stt_partial_request(const QString &audio_file);
+    /**
+     * @brief drop the pending partial transcripts of a discarded recording.
+     *  Emits `stt_partial_discarded`.
+     */
+    void stt_discard_partials();
     /**
      * @brief convert text to audio source (TTS) asynchronously.
      *  Listen to signal `tts_reply` to get result.
@@ -96,6 +107,10 @@ public:
     }
 signals:
     void stt_reply(bool valid, QString transcribed_text);
+    // partial transcript of the ongoing recording, before `stt_reply`. Used for speculative requests
+    void stt_partial_reply(QString partial_text);
+    // the recording is discarded: no `stt_reply` follows its partial transcripts
+    void stt_partial_discarded();
     void tts_reply(bool success, QString msg);
 
 private:
@@ -1,3 +1,7 @@
+#include <cmath>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
 #include <QtCore/QFileInfo>
 #include <QtCore/QUrl>
 
@@ -7,8 +11,51 @@
 #include "utils/consts.h"
 #include "utils/logger.h"
 
+namespace {
+
+// 部分转写至少需要的录音时长（ms），过短的快照没有意义
+const int PARTIAL_MIN_DURATION_MS = 1000;
+
+/**
+ * @brief write mono 16-bit samples as a model compatible wav file,
+ *  resampled (linear interpolation) to MODEL_CAP_SAMPLE_RATE
+ */
+bool write_model_wav(const QString &path, const QVector<qint16> &samples, int sample_rate) {
+    const qint64 out_count = static_cast<qint64>(samples.size()) * MODEL_CAP_SAMPLE_RATE / sample_rate;
+    QFile file(path);
+    if (out_count <= 0 || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    const quint32 data_size = static_cast<quint32>(out_count * sizeof(qint16));
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData("RIFF", 4);
+    out << quint32(36 + data_size);
+    out.writeRawData("WAVE", 4);
+    out.writeRawData("fmt ", 4);
+    out << quint32(16) << quint16(1 /* PCM */) << quint16(1 /* mono */)
+        << quint32(MODEL_CAP_SAMPLE_RATE) << quint32(MODEL_CAP_SAMPLE_RATE * sizeof(qint16))
+        << quint16(sizeof(qint16)) << quint16(16);
+    out.writeRawData("data", 4);
+    out << data_size;
+
+    const double step = static_cast<double>(sample_rate) / MODEL_CAP_SAMPLE_RATE;
+    for (qint64 i = 0; i < out_count; ++i) {
+        const double pos = i * step;
+        const int idx = static_cast<int>(pos);
+        const int next = qMin(idx + 1, samples.size() - 1);
+        const double frac = pos - idx;
+        out << static_cast<qint16>(std::lround(samples[idx] * (1.0 - frac) + samples[next] * frac));
+    }
+    return out.status() == QDataStream::Ok;
+}
 
-AudioRecorder::AudioRecorder(AudioHandler *p_handler): QObject(nullptr), handler(p_handler), recording(false) {
+}
+
+
+AudioRecorder::AudioRecorder(AudioHandler *p_handler): QObject(nullptr), handler(p_handler), recording(false),
+    probe_available(false), partial_interval(0), partial_sample_rate(0),
+    partial_snapshot_samples(0), partial_snapshot_cnt(0) {
     // default: little-endian
     // recorder.setContainerFormat(QString::fromStdString(MODEL_CAP_CONTAINER_FORMAT));
     // settings.setCodec(QString::fromStdString(MODEL_CAP_CODEC_QT));
@@ -24,6 +71,11 @@ AudioRecorder::AudioRecorder(AudioHandler *p_handler): QObject(nullptr), handler
         QOverload<QMediaPlayer::Error>::of(&QMediaPlayer::error),
         this,
         &AudioRecorder::handleMediaError);
+
+    // 部分转写：通过探针获取录音数据，定时写快照
+    this->probe_available = probe.setSource(&recorder);
+    connect(&probe, &QAudioProbe::audioBufferProbed, this, &AudioRecorder::handleAudioBuffer);
+    connect(&partial_timer, &QTimer::timeout, this, &AudioRecorder::snapshotPartial);
 }
 
 AudioRecorder::~AudioRecorder() {
@@ -40,6 +92,13 @@ void AudioRecorder::record() {
     stdLogger.Info("Start recording audio...");
     this->recording = true;
     this->last_record_timestamp = time(NULL);
+    this->partial_samples.clear();
+    this->partial_sample_rate = 0;
+    this->partial_snapshot_samples = 0;
+    this->partial_snapshot_cnt = 0;
+    if (this->partial_interval > 0 && this->probe_available) {
+        this->partial_timer.start(this->partial_interval);
+    }
     recorder.record();
 }
 
@@ -50,9 +109,12 @@ QString AudioRecorder::record_stop() {
     }
     this->recording = false;
     recorder.stop();
+    this->partial_timer.stop();
+    this->partial_samples.clear();
     if (time(NULL) - this->last_record_timestamp < this->record_threshold) {
         // record time is less than threshold: ignored
         stdLogger.Warning("record duration is shorter than threshold: ignored");
+        this->handler->stt_discard_partials();
         return QString();
     }
     QString msg = QString("Stop recording audio. Data written to %1")
@@ -68,6 +130,7 @@ QString AudioRecorder::record_stop() {
         return QString::fromStdString(converted_file);
     }
     stdLogger.Exception("failed to convert audio file to model compatible format");
+    this->handler->stt_discard_partials();
     return QString();
 }
 
@@ -75,6 +138,69 @@ void AudioRecorder::setRecordThreshold(unsigned int threshold) {
     this->record_threshold = threshold;
 }
 
+void AudioRecorder::setPartialInterval(int ms) {
+    this->partial_interval = ms > 0 ? ms : 0;
+    if (this->partial_interval > 0 && !this->probe_available) {
+        stdLogger.Warning("audio probe not supported by the media backend: partial transcripts disabled");
+    }
+}
+
+void AudioRecorder::handleAudioBuffer(const QAudioBuffer &buffer) {
+    if (!this->recording || this->partial_interval <= 0 || this->partial_sample_rate < 0) return;
+
+    const QAudioFormat format = buffer.format();
+    const int channels = format.channelCount();
+    if (channels <= 0 || format.sampleRate() <= 0) return;
+    if (this->partial_sample_rate != format.sampleRate()) {
+        // 采样率在录音过程中变化（不应发生）：丢弃之前的数据
+        this->partial_samples.clear();
+        this->partial_snapshot_samples = 0;
+        this->partial_sample_rate = format.sampleRate();
+    }
+
+    const int frames = buffer.frameCount();
+    if (format.sampleType() == QAudioFormat::SignedInt && format.sampleSize() == 16
+        && format.byteOrder() == QAudioFormat::LittleEndian) {
+        const qint16 *data = buffer.constData<qint16>();
+        for (int i = 0; i < frames; ++i) {
+            int sum = 0;
+            for (int c = 0; c < channels; ++c) sum += data[i * channels + c];
+            this->partial_samples.append(static_cast<qint16>(sum / channels));
+        }
+    } else if (format.sampleType() == QAudioFormat::Float && format.sampleSize() == 32) {
+        const float *data = buffer.constData<float>();
+        for (int i = 0; i < frames; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) sum += data[i * channels + c];
+            const float v = qBound(-1.0f, sum / channels, 1.0f);
+            this->partial_samples.append(static_cast<qint16>(v * 32767.0f));
+        }
+    } else {
+        stdLogger.Warning("unsupported probed audio format: partial transcripts disabled for this recording");
+        this->partial_timer.stop();
+        this->partial_samples.clear();
+        this->partial_sample_rate = -1;
+    }
+}
+
+void AudioRecorder::snapshotPartial() {
+    if (!this->recording || this->partial_sample_rate <= 0) return;
+    // 距离上一个快照没有新的录音数据，或者录音还太短
+    if (this->partial_samples.size() == this->partial_snapshot_samples) return;
+    if (this->partial_samples.size() < static_cast<qint64>(this->partial_sample_rate) * PARTIAL_MIN_DURATION_MS / 1000) return;
+
+    // 每个快照使用不同的文件：上一个快照可能还在转写
+    const QString snapshot = QString("%1.partial%2%3")
+        .arg(this->current_file).arg(++this->partial_snapshot_cnt).arg(MODEL_CAP_SUFFIX);
+    if (!write_model_wav(snapshot, this->partial_samples, this->partial_sample_rate)) {
+        stdLogger.Warning("failed to write partial audio snapshot: " + snapshot.toStdString());
+        QFile::remove(snapshot);
+        return;
+    }
+    this->partial_snapshot_samples = this->partial_samples.size();
+    this->handler->stt_partial_request(snapshot);
+}
+
 void AudioRecorder::play(const QString &audio_file) {
     player.setMedia(QUrl::fromLocalFile(QFileInfo(audio_file).absoluteFilePath()));
     player.play();
@@ -12,6 +12,10 @@
 #include <cstring>
 #include <string>
 
+#include <QtCore/QTimer>
+#include <QtCore/QVector>
+#include <QtMultimedia/QAudioBuffer>
+#include <QtMultimedia/QAudioProbe>
 #include <QtMultimedia/QAudioRecorder>
 #include <QtMultimedia/QMediaPlayer>
 
@@ -25,6 +29,12 @@ public:
     ~AudioRecorder();
 
     void setRecordThreshold(unsigned int threshold = 3 /* second(s) */);
+    /**
+     * @brief transcribe the audio recorded so far every `ms` milliseconds while
+     *  recording (see `AudioHandler::stt_partial_request`). 0 disables it.
+     * @note needs a media backend supporting `QAudioProbe` on the recorder
+     */
+    void setPartialInterval(int ms);
 
     void record();
     /**
@@ -34,6 +44,10 @@ public:
     void play(const QString &audio_file);
 protected slots:
     void handleMediaError(QMediaPlayer::Error error);
+    // 累积录音数据（单声道 16 位），用于部分转写
+    void handleAudioBuffer(const QAudioBuffer &buffer);
+    // 将目前为止的录音写为快照文件并请求部分转写
+    void snapshotPartial();
 private:
     AudioHandler *handler;
 
@@ -45,4 +59,16 @@ private:
     long last_record_timestamp;
     QString current_file;
     bool recording;
+
+    // 部分转写
+    QAudioProbe probe;
+    bool probe_available;
+    QTimer partial_timer;
+    int partial_interval;
+    QVector<qint16> partial_samples;
+    // < 0：本次录音的数据格式不支持部分转写
+    int partial_sample_rate;
+    // 上一个快照包含的采样数
+    int partial_snapshot_samples;
+    int partial_snapshot_cnt;
 };
@@ -8,56 +8,60 @@
 
 #pragma once
 
+#include <memory>
+
+#include <QtCore/QHash>
 #include <QtCore/QJsonArray>
 #include <QtCore/QMutex>
-#include <QtNetwork/QNetworkAccessManager>
-#include <QtNetwork/QNetworkReply>
-#include <QtCore/QTimer>
+#include <QtCore/QStringList>
+
+#include "modules/chat/session.h"
+
+class NetworkManager;
 
 namespace Chat {
 
 /**
- * @brief HTTP client class supports OpenAI API
- * @warning This class is not thread-safe for now
- * @todo TODO: 1. ensure thread-safety; 2. persist message data
+ * @brief HTTP client class supports OpenAI API.
+ *
+ * The client owns a set of named sessions (e.g. the voice assistant persona and a
+ * background summarizer) that run concurrently over the shared network layer.
+ * The conversation API of the client itself is forwarded to the default session,
+ * and the signals of the default session are re-emitted by the client.
+ *
+ * Sessions are shared: a removed session stays valid for the callers (e.g. worker
+ * threads) still holding it, and is destroyed on its thread once the last one drops it.
+ *
+ * @see Chat::Session for the thread-safety of each operation
+ * @todo TODO: persist message data
  */
 class Client : public QObject {
     Q_OBJECT
 public:
-    struct Message {
-        quint32 id;
-        QString role;           // 可能的角色："assistant", "user", "tool"
-        QString content;
-        QJsonArray tool_calls;  // 当 role="assistant" 时使用
-        QString tool_call_id;   // 当 role="tool" 时使用
-
-        bool operator==(const Message &other) {
-            return this->id == other.id;
-        }
-    };
-
-    struct chat_params_t {
-        QString server_url;
-        QString api_key;
-        QString model;
-        QString system_prompt;
-        // only valid for reasoning model
-        bool enable_thinking;
-    };
+    typedef Session::Message Message;
+    typedef Session::chat_params_t chat_params_t;
+
+    static constexpr const char *DEFAULT_SESSION = "default";
 
     explicit Client(int timeoutMs = 30000, 
                     QObject* parent = nullptr);
     ~Client();
 
     std::pair<QString, bool> sendMessageSync(const QString& message);
-    void sendMessageAsync(const QString& message);
+    // @return 加入历史记录的用户消息 ID（可用于 cancelConversation 回滚）
+    quint32 sendMessageAsync(const QString& message);
 
     // 该方法不会更改历史记录，只会将当前历史记录发给模型继续生成。
     // 注意：外部调用方只能在工具调用返回结果补充到历史记录后，转移控制流时调用
     void continueConversation();
     Message addToolMessage(const QString& tool_call_id, const QString& content);
 
+    // 中止当前进行中的对话（包括流式传输），不会再发出任何回复 / 错误信号。
+    // 同时回滚 ID 为 fromMsgId 的消息及其之后的所有历史记录
+    //（Chat::SpeculativeRequest 用它撤回被最终转写结果否定的推测请求）
+    void cancelConversation(quint32 fromMsgId);
 
+    // 以下参数对所有会话生效（会话自己的人格提示词除外）
     void setChatParams(const chat_params_t &params);
     void setTimeout(int ms);
     void setUseStream(bool stream);
@@ -65,6 +69,23 @@ public:
     QVector<Message> getHistory();
     void clearHistory();
 
+    /**
+     * @brief create a new session (thread-safe). The session shares the server
+     *  parameters of the client and lives on the client thread.
+     * @param name unique session name
+     * @param system_prompt persona of the session. Empty to use the client's one
+     * @return the session shared with the client, or the existing one if the name is used
+     */
+    std::shared_ptr<Session> createSession(const QString &name, const QString &system_prompt = QString());
+    // @return nullptr if not found (thread-safe)
+    std::shared_ptr<Session> session(const QString &name) const;
+    // 默认会话与客户端同生命周期
+    Session *defaultSession() const { return m_defaultSession; }
+    // 从客户端移除会话（默认会话不可删除）。
+    // 其他持有者释放会话后，会话在其线程中析构，并中止未完成的请求
+    void removeSession(const QString &name);
+    QStringList sessionNames() const;
+
     // 处理回复字符串的工具函数
     static QString removeTags(const char *tagName, const QString &text);
     static QString removeCodeBlocks(const QString &text);
@@ -77,64 +98,22 @@ signals:
     void errorOccurred(const QString& error);
 
 private:
-    inline QNetworkRequest createRequest(bool stream) const;
-    inline QByteArray createRequestBody(bool stream) const;
-
-    inline Message addUserMessage(const QString& message);
-    // @param tool_calls nullptr represents no tool calls
-    inline Message createAssistantMessage(const QString& message, QJsonArray *tool_calls = nullptr);
-    inline void addAssistantMessage(Message &msg);
-
-    // 处理一般回复（同步 / 一般异步）
-    // 注：不会将 Message 加入 history
-    std::pair<Message, bool> processReply(QNetworkReply* reply);
-    // 处理流式回复
-    void processStreamBuffer(QNetworkReply* reply);
-    // 处理单个SSE事件的工具函数
-    void processStreamEvent(QNetworkReply* reply, const QByteArray& eventData);
-
-    void handleAsyncResponse(QNetworkReply* reply);
-    void handleAsyncTimeout(QNetworkReply* reply, Message relatedMsg);
-    void handleStreamFinished(QNetworkReply *reply);
-    void handleStreamTimeout(QNetworkReply *reply);
-
-    // 流式传输时，工具调用也可能是 partial 的（尤其是 arguments 比较长的时候），需要工具函数拼接
-    void mergeToolCallsStreamDeltaTo(QJsonArray partialToolCalls, QJsonArray *dst);
-    // 作用：为某些不符合 OpenAI Format 的接口提供兼容性
-    // 目前仅支持工具调用类型为 function
-    QJsonArray formatToolCalls2OAIFormat(QJsonArray tool_calls);
-
-    void abortAllRequests();
-
-    quint32 generateMsgId();
-
-    QNetworkAccessManager* m_manager;
-    QString m_serverUrl;
-    QString m_model;
-    QString m_apiKey;
-    QString m_sysprompt;
-    QVector<Message> m_history;
-    QSet<QNetworkReply*> m_pendingReplies;
-
-    // 流式传输上下文
-    struct StreamContext {
-        QByteArray buffer;          // 原始数据缓冲区
-        QString accumulatedResponse; // 累积的完整响应
-        QTimer* timeoutTimer;        // 关联的超时定时器
-        Message lastMessage;         // 关联的用户消息或者工具消息（上一条）
-        bool hasToolCalls;          // 当前流式事件是否为工具调用请求，而非一般的流式信息
-        QJsonArray tool_calls;      // 当前流式事件中的工具调用请求
-    };
-    
-    QHash<QNetworkReply*, StreamContext> m_streamContexts;
-
-    QAtomicInteger<quint32> m_nextMsgId;
-    // (仅对异步操作) 当前请求是否已经确认结果（不再 pending），可以是超时或者回应
-    QAtomicInteger<qint8> m_currentFin;
-    
+    // 调用方需持有 m_sessionsMutex
+    void applyParamsTo(Session *session) const;
+
+    // 共享网络层（连接池 / 预连接 / 请求计时），不归本对象所有
+    NetworkManager* m_network;
+
+    // 保护会话表与新会话的参数模板
+    mutable QMutex m_sessionsMutex;
+    QHash<QString, std::shared_ptr<Session>> m_sessions;
+    // 会话名 -> 人格提示词（为空则使用 m_params 中的系统提示词）
+    QHash<QString, QString> m_personas;
+    Session *m_defaultSession;
+
+    chat_params_t m_params;
     QJsonArray m_tools;
     int m_timeout;
-    bool m_thinking;
     bool m_stream;
 };
 
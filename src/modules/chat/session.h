@@ -0,0 +1,177 @@
+/**
+ * @file session.h
+ * @brief A single conversation with an OpenAI compatible server.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QAtomicInteger>
+#include <QtCore/QHash>
+#include <QtCore/QJsonArray>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+class NetworkManager;
+
+namespace Chat {
+
+/**
+ * @brief One conversation (history, pending requests, stream contexts) with an
+ *  OpenAI compatible server. Different sessions run concurrently over the
+ *  shared network layer; each session still has at most one in-flight request.
+ *
+ * Thread-safety:
+ *  - the session lives on the thread of the network layer (GUI thread) and
+ *    emits its signals there;
+ *  - history / parameter accessors and `sendMessageAsync`, `continueConversation`,
+ *    `cancelConversation` can be called from any thread. Cross-thread calls to the
+ *    latter are queued to the session thread;
+ *  - `sendMessageSync` must be called on the session thread.
+ */
+class Session : public QObject {
+    Q_OBJECT
+public:
+    struct Message {
+        quint32 id;
+        QString role;           // 可能的角色："assistant", "user", "tool"
+        QString content;
+        QJsonArray tool_calls;  // 当 role="assistant" 时使用
+        QString tool_call_id;   // 当 role="tool" 时使用
+
+        bool operator==(const Message &other) {
+            return this->id == other.id;
+        }
+    };
+
+    struct chat_params_t {
+        QString server_url;
+        QString api_key;
+        QString model;
+        QString system_prompt;
+        // only valid for reasoning model
+        bool enable_thinking;
+    };
+
+    explicit Session(const QString &name,
+                     int timeoutMs = 30000,
+                     QObject* parent = nullptr);
+    ~Session();
+
+    const QString &name() const { return m_name; }
+
+    std::pair<QString, bool> sendMessageSync(const QString& message);
+    // @return 加入历史记录的用户消息 ID（可用于 cancelConversation 回滚）
+    quint32 sendMessageAsync(const QString& message);
+
+    // 该方法不会更改历史记录，只会将当前历史记录发给模型继续生成。
+    // 注意：外部调用方只能在工具调用返回结果补充到历史记录后，转移控制流时调用
+    void continueConversation();
+    Message addToolMessage(const QString& tool_call_id, const QString& content);
+
+    // 中止当前进行中的对话（包括流式传输），不会再发出任何回复 / 错误信号。
+    // 同时回滚 ID 为 fromMsgId 的消息及其之后的所有历史记录
+    //（Chat::SpeculativeRequest 用它撤回被最终转写结果否定的推测请求）
+    void cancelConversation(quint32 fromMsgId);
+
+    void setChatParams(const chat_params_t &params);
+    void setSystemPrompt(const QString &prompt);
+    void setTimeout(int ms);
+    void setUseStream(bool stream);
+    void setTools(const QJsonArray& tools);
+    QVector<Message> getHistory();
+    void clearHistory();
+
+    // 所有会话共享的消息 ID 生成器（无锁）
+    static quint32 generateMsgId();
+
+signals:
+    void asyncResponseReceived(const QString& response);
+    void streamResponseReceived(const QString& chunk);
+    void streamFinished();
+    void toolCallsReceived(const QJsonArray& tool_calls);
+    void errorOccurred(const QString& error);
+
+private:
+    // 当前线程不是会话所在线程时，将 fn 投递到会话线程执行并返回 true
+    template <typename Func>
+    bool postToSessionThread(Func fn);
+
+    inline QNetworkRequest createRequest(bool stream) const;
+    inline QByteArray createRequestBody(bool stream) const;
+
+    inline Message addUserMessage(const QString& message);
+    // @param tool_calls nullptr represents no tool calls
+    inline Message createAssistantMessage(const QString& message, QJsonArray *tool_calls = nullptr);
+    inline void addAssistantMessage(Message &msg);
+    void removeHistoryMessage(const Message &msg);
+
+    // 处理一般回复（同步 / 一般异步）
+    // 注：不会将 Message 加入 history
+    std::pair<Message, bool> processReply(QNetworkReply* reply);
+    // 处理流式回复
+    void processStreamBuffer(QNetworkReply* reply);
+    // 处理单个SSE事件的工具函数
+    void processStreamEvent(QNetworkReply* reply, const QByteArray& eventData);
+
+    void handleAsyncResponse(QNetworkReply* reply);
+    void handleAsyncTimeout(QNetworkReply* reply, Message relatedMsg);
+    void handleStreamFinished(QNetworkReply *reply);
+    void handleStreamTimeout(QNetworkReply *reply);
+
+    // 流式传输时，工具调用也可能是 partial 的（尤其是 arguments 比较长的时候），需要工具函数拼接
+    void mergeToolCallsStreamDeltaTo(QJsonArray partialToolCalls, QJsonArray *dst);
+    // 作用：为某些不符合 OpenAI Format 的接口提供兼容性
+    // 目前仅支持工具调用类型为 function
+    QJsonArray formatToolCalls2OAIFormat(QJsonArray tool_calls);
+
+    // 中止所有未完成的请求并清理超时定时器、流式上下文，之后可以开始新的对话
+    void abortAllRequests();
+    // 删除 ID 为 fromMsgId 的消息及其之后的所有历史记录
+    void rollbackHistory(quint32 fromMsgId);
+
+    QString m_name;
+    // 共享网络层（连接池 / 预连接 / 请求计时），不归本对象所有
+    NetworkManager* m_network;
+
+    // 保护以下参数与历史记录（可能被工作线程访问）
+    mutable QMutex m_mutex;
+    QString m_serverUrl;
+    QString m_model;
+    QString m_apiKey;
+    QString m_sysprompt;
+    QJsonArray m_tools;
+    int m_timeout;
+    bool m_thinking;
+    bool m_stream;
+    QVector<Message> m_history;
+
+    // 以下请求状态只在会话线程中访问
+    QSet<QNetworkReply*> m_pendingReplies;
+    // 未完成请求关联的超时定时器
+    QHash<QNetworkReply*, QTimer*> m_replyTimers;
+
+    // 流式传输上下文
+    struct StreamContext {
+        QByteArray buffer;          // 原始数据缓冲区
+        QString accumulatedResponse; // 累积的完整响应
+        QTimer* timeoutTimer;        // 关联的超时定时器
+        Message lastMessage;         // 关联的用户消息或者工具消息（上一条）
+        bool hasToolCalls;          // 当前流式事件是否为工具调用请求，而非一般的流式信息
+        QJsonArray tool_calls;      // 当前流式事件中的工具调用请求
+    };
+
+    QHash<QNetworkReply*, StreamContext> m_streamContexts;
+
+    // (仅对异步操作) 当前请求是否已经确认结果（不再 pending），可以是超时或者回应
+    QAtomicInteger<qint8> m_currentFin;
+
+    static QAtomicInteger<quint32> s_nextMsgId;
+};
+
+};
@@ -0,0 +1,144 @@
+
+#include <QtCore/QChar>
+
+#include "modules/chat/openai_client.h"
+#include "modules/chat/speculative_request.h"
+#include "utils/logger.h"
+
+using namespace Chat;
+
+#define SPECULATIVE_TYPE "Speculative Request"
+
+
+// 推测请求流程：
+
+// - STT 持续给出部分转写结果（onPartialTranscript）；
+// - 同一结果连续出现 stable_partials 次且保持 stable_ms 以上，发出推测请求；
+// - 推测期间部分转写结果发生变化：立即取消（计为未命中），重新检测稳定性；
+// - 最终转写结果（onFinalTranscript）与推测文本一致：命中，保留已发出的请求；
+// - 不一致：取消请求并回滚历史记录（计为未命中），由调用方按原流程发送最终结果。
+
+SpeculativeRequest::SpeculativeRequest(Client *client, QObject *parent)
+    : QObject(parent), m_client(client),
+    m_stableCount(0), m_busy(false),
+    m_inFlight(false), m_speculativeMsgId(0) {
+
+    m_stableTimer.setSingleShot(true);
+    connect(&m_stableTimer, &QTimer::timeout, this, &SpeculativeRequest::tryFire);
+}
+
+void SpeculativeRequest::setParams(const speculative_params_t &params) {
+    m_params = params;
+    if (!m_params.enable) {
+        m_stableTimer.stop();
+        resetPartialState();
+    }
+}
+
+void SpeculativeRequest::onPartialTranscript(const QString &text, bool busy) {
+    if (!m_params.enable) return;
+
+    QString norm = normalize(text);
+    m_busy = busy;
+
+    if (m_inFlight) {
+        if (norm == m_speculativeText) return;
+        // 用户说的话和推测的不一样了，尽早取消以节省 token
+        stdLogger.Debug(SPECULATIVE_TYPE ": partial transcript diverged from speculation");
+        cancelSpeculation(true);
+    }
+
+    if (norm != m_lastPartial) {
+        m_lastPartial = norm;
+        m_lastPartialRaw = text;
+        m_stableCount = 1;
+        m_stableClock.restart();
+        m_stableTimer.start(m_params.stable_ms);
+        return;
+    }
+    ++m_stableCount;
+    tryFire();
+}
+
+bool SpeculativeRequest::onFinalTranscript(const QString &text) {
+    m_stableTimer.stop();
+    if (!m_inFlight) {
+        resetPartialState();
+        return false;
+    }
+
+    if (normalize(text) == m_speculativeText) {
+        m_inFlight = false;
+        ++m_stats.hits;
+        m_stats.saved_ms += m_firedClock.elapsed();
+        resetPartialState();
+        logStats("hit");
+        emit confirmed();
+        return true;
+    }
+
+    cancelSpeculation(true);
+    resetPartialState();
+    return false;
+}
+
+void SpeculativeRequest::abandon() {
+    m_stableTimer.stop();
+    if (m_inFlight) {
+        stdLogger.Debug(SPECULATIVE_TYPE ": speculation abandoned");
+        cancelSpeculation(false);
+    }
+    resetPartialState();
+}
+
+void SpeculativeRequest::tryFire() {
+    if (!m_params.enable || m_inFlight || m_busy) return;
+    if (m_lastPartial.size() < m_params.min_chars) return;
+    if (m_stableCount < m_params.stable_partials) return;
+    if (!m_stableClock.isValid() || m_stableClock.elapsed() < m_params.stable_ms) return;
+
+    // 注意：历史记录中保存的是原始文本，规范化文本仅用于比较
+    m_speculativeText = m_lastPartial;
+    m_inFlight = true;
+    m_firedClock.restart();
+    ++m_stats.fired;
+    stdLogger.Debug(SPECULATIVE_TYPE ": firing speculative request on stable partial transcript");
+    m_speculativeMsgId = m_client->sendMessageAsync(m_lastPartialRaw);
+    emit fired(m_lastPartialRaw);
+}
+
+void SpeculativeRequest::cancelSpeculation(bool countMiss) {
+    m_client->cancelConversation(m_speculativeMsgId);
+    m_inFlight = false;
+    m_speculativeText.clear();
+    if (countMiss) {
+        ++m_stats.misses;
+        logStats("miss");
+    }
+    emit cancelled();
+}
+
+void SpeculativeRequest::resetPartialState() {
+    m_lastPartial.clear();
+    m_lastPartialRaw.clear();
+    m_stableCount = 0;
+    m_stableClock.invalidate();
+}
+
+void SpeculativeRequest::logStats(const char *event) const {
+    QString msg = QString::asprintf(
+        SPECULATIVE_TYPE ": %s (fired: %u, hits: %u, misses: %u, hit rate: %.1f%%, avg saved: %lld ms)",
+        event, m_stats.fired, m_stats.hits, m_stats.misses, m_stats.hitRate() * 100.0,
+        m_stats.hits ? static_cast<long long>(m_stats.saved_ms / m_stats.hits) : 0LL);
+    stdLogger.Info(msg.toStdString());
+}
+
+QString SpeculativeRequest::normalize(const QString &text) {
+    QString res;
+    res.reserve(text.size());
+    for (const QChar &c : text) {
+        if (c.isSpace() || c.isPunct() || c.isSymbol()) continue;
+        res.append(c.toLower());
+    }
+    return res;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file speculative_request.h
+ * @brief Speculative LLM request fired on a stable partial STT transcript.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QTimer>
+
+namespace Chat {
+
+class Client;
+
+/**
+ * @brief Send the user's utterance to the LLM before STT finishes.
+ *
+ * When the partial transcript stays unchanged for a while, a speculative request
+ * is sent with it. The final transcript then either confirms the speculation
+ * (the reply already in flight is kept) or rejects it (the request is aborted,
+ * the history is rolled back and the caller sends the final text as usual).
+ *
+ * Replies received before confirmation must be held back by the caller
+ * (see `isAwaitingConfirmation`) and released on `confirmed`, dropped on `cancelled`.
+ *
+ * @warning This class is not thread-safe; use it on the thread owning the client
+ */
+class SpeculativeRequest : public QObject {
+    Q_OBJECT
+public:
+    struct speculative_params_t {
+        bool enable = false;
+        // 连续收到相同部分转写结果的次数达到该值才认为稳定
+        int stable_partials = 2;
+        // 部分转写结果保持不变的最短时长（ms）
+        int stable_ms = 300;
+        // 过短的转写结果不值得推测
+        int min_chars = 4;
+    };
+
+    struct stats_t {
+        quint32 fired = 0;
+        quint32 hits = 0;
+        quint32 misses = 0;
+        // 推测命中时相对最终转写结果提前发出请求的时间总和（ms）
+        qint64 saved_ms = 0;
+
+        double hitRate() const {
+            quint32 judged = hits + misses;
+            return judged ? static_cast<double>(hits) / judged : 0.0;
+        }
+    };
+
+    explicit SpeculativeRequest(Client *client, QObject *parent = nullptr);
+
+    void setParams(const speculative_params_t &params);
+    const speculative_params_t &params() const { return m_params; }
+    const stats_t &stats() const { return m_stats; }
+
+    /**
+     * @brief feed a partial (incremental) transcript from STT.
+     *  May fire a speculative request when the text becomes stable.
+     * @param busy whether the caller is still waiting for a previous reply
+     *  (never speculate on top of an ongoing conversation)
+     */
+    void onPartialTranscript(const QString &text, bool busy);
+    /**
+     * @brief feed the final transcript from STT.
+     * @return true if the speculative request matches the final text and is kept,
+     *  so the caller must NOT send it again; false if the caller should send it normally
+     */
+    bool onFinalTranscript(const QString &text);
+    /**
+     * @brief give up the speculation, e.g. the speculative request failed
+     *  or the final transcript is empty. Not counted as hit or miss.
+     */
+    void abandon();
+
+    // 已发出推测请求、但尚未被最终转写结果确认
+    bool isAwaitingConfirmation() const { return m_inFlight; }
+
+    // 忽略标点、空白和大小写后的文本，用于比较部分 / 最终转写结果
+    static QString normalize(const QString &text);
+
+signals:
+    // 推测请求已通过 Client 发出
+    void fired(const QString &text);
+    // 推测命中：调用方可以释放暂存的回复
+    void confirmed();
+    // 推测失败：调用方应丢弃暂存的回复
+    void cancelled();
+
+private slots:
+    void tryFire();
+
+private:
+    void cancelSpeculation(bool countMiss);
+    void resetPartialState();
+    void logStats(const char *event) const;
+
+    Client *m_client;
+    speculative_params_t m_params;
+    stats_t m_stats;
+
+    // 部分转写结果稳定性检测
+    QString m_lastPartial;
+    QString m_lastPartialRaw;
+    int m_stableCount;
+    QElapsedTimer m_stableClock;
+    QTimer m_stableTimer;
+    bool m_busy;
+
+    // 进行中的推测请求
+    bool m_inFlight;
+    QString m_speculativeText;
+    quint32 m_speculativeMsgId;
+    QElapsedTimer m_firedClock;
+};
+
+}
@@ -1,13 +1,16 @@
 
 #include "modules/stt/client.h"
 
+#include <QtCore/QFile>
+
 #include "utils/logger.h"
 
 namespace STT {
 
 #define CLIENT_TYPE "STT Client"
 
-Client::Client(QObject *parent): QObject(parent), taskID(-1) {
+Client::Client(QObject *parent): QObject(parent), taskID(-1),
+    nextTaskID(0), partialTaskID(-1), partialValidFrom(0) {
     server = new ASRServer;
     workerThread = std::make_unique<QThread>();
     worker = new Worker(server);
@@ -31,16 +34,44 @@ Client::~Client() {
 }
 
 void Client::sendWav(const ASRHandler::asr_params &params) {
-    ++this->taskID;
+    this->taskID = this->nextTaskID++;
+    // 最终结果之前的部分转写结果都已过时
+    this->partialValidFrom = this->nextTaskID;
     std::string msg = CLIENT_TYPE ": worker started with task ID: "
         + std::to_string(taskID);
     stdLogger.Info(msg.c_str());
     emit startProcessing(taskID, params);
 }
 
-void Client::handleResult(ASRHandler::asr_result result) {
+void Client::sendPartialWav(const ASRHandler::asr_params &params) {
+    const std::string file = params.fname_inp.empty() ? std::string() : params.fname_inp.front();
+    if (this->partialTaskID >= 0) {
+        // 上一个快照还在转写：跳过，避免最终请求排在多个部分转写请求之后
+        QFile::remove(QString::fromStdString(file));
+        return;
+    }
+    this->partialTaskID = this->nextTaskID++;
+    this->partialFile = file;
+    stdLogger.Debug(CLIENT_TYPE ": partial transcription with task ID: " + std::to_string(this->partialTaskID));
+    emit startProcessing(this->partialTaskID, params);
+}
+
+void Client::discardPartials() {
+    this->partialValidFrom = this->nextTaskID;
+}
+
+void Client::handleResult(ASRHandler::task_id_t taskId, ASRHandler::asr_result result) {
     std::string msg;
-    if (result.request_id == this->taskID) {
+    if (taskId == this->partialTaskID) {
+        this->partialTaskID = -1;
+        QFile::remove(QString::fromStdString(this->partialFile));
+        this->partialFile.clear();
+        if (result.request_id == taskId && taskId >= this->partialValidFrom && !result.text.empty()) {
+            emit partialArrived(QString::fromStdString(result.text));
+        }
+        return;
+    }
+    if (taskId == this->taskID && result.request_id == this->taskID) {
         msg = CLIENT_TYPE ": [task ID " + std::to_string(result.request_id)
             + "] receive result from server '" + result.text + "'";
         stdLogger.Info(msg.c_str());
@@ -59,7 +90,7 @@ void Client::handleResult(ASRHandler::asr_result result) {
 
 void Worker::process(ASRHandler::task_id_t taskId, ASRHandler::asr_params params) {
     ASRHandler::asr_result result = server->handle(taskId, params);
-    emit resultReady(result);
+    emit resultReady(taskId, result);
 }
 
 };
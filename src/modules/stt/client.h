@@ -27,7 +27,7 @@ public slots:
     void process(ASRHandler::task_id_t taskId, ASRHandler::asr_params params);
 
 signals:
-    void resultReady(ASRHandler::asr_result result);
+    void resultReady(ASRHandler::task_id_t taskId, ASRHandler::asr_result result);
 
 private:
     ASRHandler* server;
@@ -48,12 +48,28 @@ public:
 	~Client();
 
     void sendWav(const ASRHandler::asr_params &params);
+    /**
+     * @brief transcribe a snapshot of an ongoing recording (partial transcript).
+     *  Skipped while the previous snapshot is still being transcribed, so a final
+     *  request never waits behind more than one partial one.
+     *  The snapshot file (`params.fname_inp[0]`) is removed once handled.
+     */
+    void sendPartialWav(const ASRHandler::asr_params &params);
+    /**
+     * @brief drop the partial transcripts not delivered yet (e.g. the recording is discarded)
+     */
+    void discardPartials();
 
 signals:
     /** 
      * Triggered when receive the text response from the STT server
      */
     void replyArrived(bool valid, const QString &transcribed_text);
+    /**
+     * Triggered when a snapshot of the ongoing recording is transcribed (see `sendPartialWav`).
+     * Never emitted after the final request of the recording or `discardPartials`.
+     */
+    void partialArrived(const QString &partial_text);
 
     /**
      * [Used Internally] Triggered when we start the ASRServer asynchronously (using worker)
@@ -61,7 +77,7 @@ signals:
      void startProcessing(ASRHandler::task_id_t taskId, ASRHandler::asr_params params);
 
 protected slots:
-    void handleResult(ASRHandler::asr_result result);
+    void handleResult(ASRHandler::task_id_t taskId, ASRHandler::asr_result result);
 
 private:
     std::unique_ptr<QThread> workerThread;
@@ -69,6 +85,13 @@ private:
     ASRServer *server;
     // < 0 for invalid/failure
     ASRHandler::task_id_t taskID;
+    // 任务 ID 生成器（最终 / 部分转写共用）
+    ASRHandler::task_id_t nextTaskID;
+    // 进行中的部分转写任务（< 0 表示没有）及其快照文件
+    ASRHandler::task_id_t partialTaskID;
+    std::string partialFile;
+    // ID 小于该值的部分转写结果已经过时，不再发出
+    ASRHandler::task_id_t partialValidFrom;
 };
 
 };
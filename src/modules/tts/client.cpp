@@ -5,6 +5,7 @@
 
 #include "modules/audio/audio_handler.h"
 #include "modules/tts/client.h"
+#include "network/network_manager.h"
 
 #include "utils/consts.h"
 #include "utils/logger.h"
@@ -44,7 +45,7 @@ void Client::generateSpeech(const tts_params_t &params, const QString& input, co
     json["input"] = input;
     json["response_format"] = MODEL_CAP_CONTAINER_FORMAT;
 
-    m_currentReply = m_manager.post(request, QJsonDocument(json).toJson());
+    m_currentReply = NetworkManager::instance()->post(request, QJsonDocument(json).toJson());
 
     QObject::connect(m_currentReply, &QNetworkReply::readyRead, [this]() {
         stdLogger.Debug(CLIENT_TYPE "stream read from TTS server");
@@ -1,7 +1,6 @@
 #pragma once
 
 #include <QtCore/QFile>
-#include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
 
 #include "utils/consts.h"
@@ -22,7 +21,6 @@ signals:
     void finished(bool success, const QString& error);
 
 private:
-    QNetworkAccessManager m_manager;
     QNetworkReply* m_currentReply = nullptr;
     QScopedPointer<QFile> m_outputFile;
 
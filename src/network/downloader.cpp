@@ -3,6 +3,7 @@
 #include <QtCore/QEventLoop>
 #include <QtCore/QThread>
 #include "network/downloader.h"
+#include "network/network_manager.h"
 #include "utils/logger.h"
 
 
@@ -10,7 +11,7 @@ FileDownloader::FileDownloader(QObject *parent) : QObject(parent) {}
 
 void FileDownloader::downloadAsync(const QUrl &url, const QString &savePath) {
     QNetworkRequest request(url);
-    reply = manager.get(request);
+    reply = NetworkManager::instance()->get(request);
 
     file.setFileName(savePath);
     if (!file.open(QIODevice::WriteOnly)) {
@@ -10,7 +10,6 @@
 
 #include <QtCore/QFile>
 #include <QtWidgets/QProgressDialog>
-#include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkRequest>
 #include <QtNetwork/QNetworkReply>
 
@@ -43,7 +42,6 @@ private:
         return QString::number(bytes/(1024.0*1024.0), 'f', 1) + " MB";
     }
 
-    QNetworkAccessManager manager;
     QNetworkReply *reply = nullptr;
     QFile file;
     QProgressDialog *progressDialog = nullptr;
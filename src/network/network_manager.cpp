@@ -0,0 +1,138 @@
+
+#include <memory>
+
+#include <QtNetwork/QHostInfo>
+
+#include "network/network_manager.h"
+#include "utils/consts.h"
+#include "utils/logger.h"
+
+#define CLIENT_TYPE "Network Manager"
+
+NetworkManager *NetworkManager::instance() {
+    static NetworkManager *s_instance = nullptr;
+    if (s_instance == nullptr) {
+        qRegisterMetaType<NetworkManager::RequestTiming>();
+        s_instance = new NetworkManager;
+    }
+    return s_instance;
+}
+
+NetworkManager::NetworkManager(QObject *parent)
+: QObject(parent), m_manager(this) {
+    connect(&m_keepWarmTimer, &QTimer::timeout, this, &NetworkManager::keepWarm);
+    setKeepWarmInterval(NETWORK_KEEP_WARM_INTERVAL);
+}
+
+void NetworkManager::prepareRequest(QNetworkRequest &request) {
+    // 对 https 通过 ALPN 协商 HTTP/2，多个流复用同一条连接；不支持的服务端自动回退到 HTTP/1.1
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    // 对 HTTP/1.1 的幂等请求（GET）允许 pipelining
+    request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    request.setRawHeader("Connection", "keep-alive");
+}
+
+QNetworkReply *NetworkManager::post(QNetworkRequest request, const QByteArray &body) {
+    prepareRequest(request);
+    return track(m_manager.post(request, body));
+}
+
+QNetworkReply *NetworkManager::get(QNetworkRequest request) {
+    prepareRequest(request);
+    return track(m_manager.get(request));
+}
+
+QNetworkReply *NetworkManager::track(QNetworkReply *reply) {
+    struct TimingState {
+        QElapsedTimer clock;
+        RequestTiming timing;
+    };
+    auto state = std::make_shared<TimingState>();
+    state->clock.start();
+    state->timing.url = reply->url().toString(QUrl::RemoveUserInfo | QUrl::RemoveQuery);
+    state->timing.dnsMs = m_dnsMs.value(reply->url().host(), -1);
+    state->timing.tlsMs = -1;
+    state->timing.ttfbMs = -1;
+    state->timing.totalMs = -1;
+    state->timing.http2 = false;
+    state->timing.success = false;
+
+#ifndef QT_NO_SSL
+    // 只有新建 TLS 连接时才会触发；复用的连接不会
+    connect(reply, &QNetworkReply::encrypted, this, [state]() {
+        state->timing.tlsMs = state->clock.elapsed();
+    });
+#endif
+    connect(reply, &QNetworkReply::metaDataChanged, this, [state]() {
+        if (state->timing.ttfbMs < 0) state->timing.ttfbMs = state->clock.elapsed();
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, state, reply]() {
+        state->timing.totalMs = state->clock.elapsed();
+        state->timing.http2 = reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+        state->timing.success = reply->error() == QNetworkReply::NoError;
+        const RequestTiming &t = state->timing;
+        stdLogger.Debug(QString::asprintf(CLIENT_TYPE ": %s dns=%lldms tls=%lldms ttfb=%lldms total=%lldms %s",
+            t.url.toStdString().data(), t.dnsMs, t.tlsMs, t.ttfbMs, t.totalMs,
+            t.http2 ? "h2" : "http/1.1").toStdString());
+        emit requestTimed(t);
+    });
+    return reply;
+}
+
+QString NetworkManager::originOf(const QUrl &url) {
+    return url.adjusted(QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment
+        | QUrl::RemoveUserInfo).toString();
+}
+
+void NetworkManager::preconnect(const QUrl &url) {
+    if (!url.isValid() || url.host().isEmpty()) {
+        stdLogger.Warning(CLIENT_TYPE ": skipped preconnecting invalid url '"
+            + url.toString().toStdString() + "'");
+        return;
+    }
+    QString origin = originOf(url);
+    if (m_warmOrigins.contains(origin)) return;
+    m_warmOrigins.insert(origin, url);
+
+    // DNS 预解析（同时让 Qt 的主机名缓存命中），并记录解析耗时
+    QString host = url.host();
+    auto clock = std::make_shared<QElapsedTimer>();
+    clock->start();
+    QHostInfo::lookupHost(host, this, [this, host, clock](const QHostInfo &info) {
+        if (info.error() != QHostInfo::NoError) {
+            stdLogger.Warning(CLIENT_TYPE ": failed to resolve '" + host.toStdString()
+                + "': " + info.errorString().toStdString());
+            return;
+        }
+        m_dnsMs.insert(host, clock->elapsed());
+    });
+
+    connectOrigin(url);
+    stdLogger.Info(CLIENT_TYPE ": preconnecting to " + origin.toStdString());
+}
+
+void NetworkManager::connectOrigin(const QUrl &origin) {
+    // 连接池中已有可用连接时，这两个调用不会新建连接
+    int port = origin.port(origin.scheme() == "https" ? 443 : 80);
+#ifndef QT_NO_SSL
+    if (origin.scheme() == "https") {
+        m_manager.connectToHostEncrypted(origin.host(), port);
+        return;
+    }
+#endif
+    m_manager.connectToHost(origin.host(), port);
+}
+
+void NetworkManager::keepWarm() {
+    for (const QUrl &origin: m_warmOrigins) {
+        connectOrigin(origin);
+    }
+}
+
+void NetworkManager::setKeepWarmInterval(int ms) {
+    if (ms <= 0) {
+        m_keepWarmTimer.stop();
+        return;
+    }
+    m_keepWarmTimer.start(ms);
+}
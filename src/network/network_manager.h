@@ -0,0 +1,91 @@
+/**
+ * @file network_manager.h
+ * @brief Shared network layer (connection pool, warmup & request timing)
+ * 
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QHash>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+/**
+ * @brief Process-wide network layer shared by all HTTP clients (LLM, TTS, downloader).
+ * 
+ * - One `QNetworkAccessManager`, so keep-alive connections are reused across clients;
+ * - DNS / TCP / TLS warmup for configured origins, with periodic keep-warm;
+ * - HTTP/2 (ALPN over TLS) & HTTP/1.1 pipelining enabled on every request;
+ * - per-request timing, reported through `requestTimed`.
+ * 
+ * @warning Must be used from the thread that first calls `instance()` (the GUI thread).
+ */
+class NetworkManager : public QObject {
+    Q_OBJECT
+public:
+    /**
+     * @brief Timing of a single request (unit: ms, -1 means not measured).
+     * @note Qt 5 does not report DNS/TCP phases per request: `dnsMs` comes from the
+     *  warmup lookup of the origin, `tlsMs` is only set when a new TLS handshake happens
+     *  for this request (i.e. the connection was not reused).
+     */
+    struct RequestTiming {
+        QString url;
+        qint64 dnsMs;
+        qint64 tlsMs;
+        qint64 ttfbMs;      // time to response headers
+        qint64 totalMs;
+        bool http2;
+        bool success;
+    };
+
+    static NetworkManager *instance();
+
+    QNetworkAccessManager *manager() { return &m_manager; }
+
+    /**
+     * @brief Apply the shared connection policy (HTTP/2, pipelining, keep-alive) to a request.
+     */
+    static void prepareRequest(QNetworkRequest &request);
+
+    // send through the shared manager with timing. The caller owns the reply
+    QNetworkReply *post(QNetworkRequest request, const QByteArray &body);
+    QNetworkReply *get(QNetworkRequest request);
+
+    /**
+     * @brief Resolve & connect (and handshake for https) to the origin of `url` ahead of
+     *  the first request. The origin is kept warm afterwards.
+     */
+    void preconnect(const QUrl &url);
+
+    /**
+     * @param ms keep-warm interval for preconnected origins. 0 disables keep-warm
+     */
+    void setKeepWarmInterval(int ms);
+
+signals:
+    void requestTimed(const NetworkManager::RequestTiming &timing);
+
+private:
+    explicit NetworkManager(QObject *parent = nullptr);
+
+    static QString originOf(const QUrl &url);
+    void connectOrigin(const QUrl &origin);
+    void keepWarm();
+    QNetworkReply *track(QNetworkReply *reply);
+
+    QNetworkAccessManager m_manager;
+    QTimer m_keepWarmTimer;
+    // origin -> origin url (scheme, host, port)
+    QHash<QString, QUrl> m_warmOrigins;
+    // host -> DNS lookup time measured on warmup
+    QHash<QString, qint64> m_dnsMs;
+};
+
+Q_DECLARE_METATYPE(NetworkManager::RequestTiming)
@@ -0,0 +1,199 @@
+/**
+ * @file bakeModel.cpp
+ * @brief Offline tool packing a model into a pre-baked bundle (see `ModelBundle`).
+ *
+ * Usage: bake_model <model directory> [model name]
+ *
+ * The bundle is written next to model3.json as `<model name>.bundle`
+ * (the model name defaults to the directory name, as in `ModelManager::ChangeScene`).
+ * The time spent to read & parse the assets from the json files and from the
+ * bundle are reported afterwards (OpenGL uploads excluded).
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#include <cstring>
+#include <functional>
+#include <string>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+
+#include <Effect/CubismPose.hpp>
+#include <Model/CubismMoc.hpp>
+#include <Model/CubismModelUserData.hpp>
+#include <Motion/CubismExpressionMotion.hpp>
+#include <Motion/CubismMotion.hpp>
+#include <Physics/CubismPhysics.hpp>
+
+#include <CubismFramework.hpp>
+#include <CubismModelSettingJson.hpp>
+
+#include "drivers/allocator.h"
+#include "drivers/modelBundle.h"
+#include "drivers/textureCache.h"
+#include "drivers/textureManager.h"
+#include "drivers/tools.h"
+#include "drivers/workerPool.h"
+
+#include "utils/logger.h"
+
+using namespace Live2D::Cubism::Framework;
+
+namespace {
+    /**
+     * @brief Content of an asset, from a file or from the bundle.
+     *
+     * @param[in]  file    Path in model3.json.
+     * @param[out] buffer  Holds the content when read from a file.
+     */
+    typedef std::function<bool(const csmChar* file, FileBuffer* buffer, const csmByte** data, csmSizeInt* size)> AssetReader;
+
+    /**
+     * @brief Read & parse every asset of a model (all motions included), single threaded.
+     *
+     * @param[in] textureFormat  Compressed format of the textures, 0 to decode png files.
+     * @return  Time spent [ms], negative if an asset cannot be read.
+     */
+    double MeasureLoad(const std::string& settingFileName, const AssetReader& read, GLenum textureFormat) {
+        QElapsedTimer timer;
+        timer.start();
+
+        FileBuffer buffer;
+        const csmByte* data;
+        csmSizeInt size;
+        if (!read(settingFileName.c_str(), &buffer, &data, &size))
+            return -1.0;
+        CubismModelSettingJson setting(data, size);
+
+        auto parse = [&read](const csmChar* file, const std::function<void(const csmByte*, csmSizeInt)>& create) {
+            if (strcmp(file, "") == 0)
+                return true;
+            FileBuffer content;
+            const csmByte* bytes;
+            csmSizeInt length;
+            if (!read(file, &content, &bytes, &length))
+                return false;
+            create(bytes, length);
+            return true;
+        };
+
+        bool success = parse(setting.GetModelFileName(), [](const csmByte* bytes, csmSizeInt length) {
+            CubismMoc::Delete(CubismMoc::Create(bytes, length));
+        });
+        for (csmInt32 i = 0; i < setting.GetExpressionCount(); i++) {
+            success &= parse(setting.GetExpressionFileName(i), [](const csmByte* bytes, csmSizeInt length) {
+                ACubismMotion::Delete(CubismExpressionMotion::Create(bytes, length));
+            });
+        }
+        success &= parse(setting.GetPhysicsFileName(), [](const csmByte* bytes, csmSizeInt length) {
+            CubismPhysics::Delete(CubismPhysics::Create(bytes, length));
+        });
+        success &= parse(setting.GetPoseFileName(), [](const csmByte* bytes, csmSizeInt length) {
+            CubismPose::Delete(CubismPose::Create(bytes, length));
+        });
+        success &= parse(setting.GetUserDataFile(), [](const csmByte* bytes, csmSizeInt length) {
+            CubismModelUserData::Delete(CubismModelUserData::Create(bytes, length));
+        });
+        for (csmInt32 i = 0; i < setting.GetMotionGroupCount(); i++) {
+            const csmChar* group = setting.GetMotionGroupName(i);
+            for (csmInt32 j = 0; j < setting.GetMotionCount(group); j++) {
+                success &= parse(setting.GetMotionFileName(group, j), [](const csmByte* bytes, csmSizeInt length) {
+                    ACubismMotion::Delete(CubismMotion::Create(bytes, length));
+                });
+            }
+        }
+        for (csmInt32 i = 0; i < setting.GetTextureCount(); i++) {
+            success &= parse(setting.GetTextureFileName(i), [textureFormat](const csmByte* bytes, csmSizeInt length) {
+                if (textureFormat != 0) {
+                    TextureCache::CompressedImage image;
+                    TextureCache::Parse(bytes, length, textureFormat, &image);
+                } else {
+                    TextureManager::DecodedImage image;
+                    if (TextureManager::DecodePngData(bytes, length, "", &image))
+                        TextureManager::ReleaseDecodedImage(&image);
+                }
+            });
+        }
+
+        return success ? timer.nsecsElapsed() / 1000000.0 : -1.0;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <model directory> [model name]\n", argv[0]);
+        return 1;
+    }
+
+    std::string dir = argv[1];
+    if (dir.back() != '/' && dir.back() != '\\')
+        dir += '/';
+    std::string name;
+    if (argc > 2) {
+        name = argv[2];
+    } else {
+        const size_t begin = dir.find_last_of("/\\", dir.size() - 2);
+        name = dir.substr(begin == std::string::npos ? 0 : begin + 1);
+        name.pop_back();
+    }
+    const std::string settingFileName = name + ".model3.json";
+    const std::string bundlePath = ModelBundle::GetBundlePath(dir, name);
+
+    Allocator allocator;
+    CubismFramework::StartUp(&allocator);
+    CubismFramework::Initialize();
+
+    /* BC3 is the only format produced by the texture cache: no OpenGL context needed. */
+    const GLenum textureFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    int ret = 0;
+    if (!ModelBundle::Bake(dir, settingFileName, bundlePath, textureFormat)) {
+        stdLogger.Exception(QString("Failed to bake %1").arg(bundlePath.c_str()).toStdString().c_str());
+        ret = 1;
+    } else {
+        const double jsonMs = MeasureLoad(settingFileName,
+            [&dir](const csmChar* file, FileBuffer* buffer, const csmByte** data, csmSizeInt* size) {
+                if (!buffer->Open(dir + file))
+                    return false;
+                *data = buffer->GetData();
+                *size = buffer->GetSize();
+                return true;
+            }, 0);
+
+        QElapsedTimer timer;
+        timer.start();
+        ModelBundle bundle;
+        double bundleMs = -1.0;
+        if (bundle.Open(bundlePath)) {
+            const double openMs = timer.nsecsElapsed() / 1000000.0;
+            bundleMs = MeasureLoad(settingFileName,
+                [&bundle](const csmChar* file, FileBuffer*, const csmByte** data, csmSizeInt* size) {
+                    const ModelBundle::Entry* entry = bundle.Find(file);
+                    if (entry == NULL)
+                        return false;
+                    *data = entry->data;
+                    *size = entry->size;
+                    return true;
+                }, bundle.GetTextureFormat());
+            if (bundleMs >= 0.0)
+                bundleMs += openMs;
+        }
+
+        if (jsonMs < 0.0 || bundleMs < 0.0) {
+            stdLogger.Exception("Failed to read the assets back");
+            ret = 1;
+        } else {
+            stdLogger.Info(
+                QString::asprintf("Read & parse all assets: json %.1f ms, bundle %.1f ms (%.1fx)",
+                    jsonMs, bundleMs, bundleMs > 0.0 ? jsonMs / bundleMs : 0.0)
+                .toStdString()
+            );
+        }
+    }
+
+    WorkerPool::ReleaseInstance();
+    CubismFramework::Dispose();
+    CubismFramework::CleanUp();
+    return ret;
+}
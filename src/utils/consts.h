@@ -62,8 +62,41 @@ const uint32_t     MODEL_CAP_BITRATE = 16;
 #define            MODEL_CAP_CONTAINER_FORMAT "wav"
 #define            MODEL_CAP_SUFFIX ".wav"
 
+/* --- Texture Streaming Parameters --- */
+
+/* Bytes uploaded to OpenGL per frame while streaming textures */
+const uint32_t     TEXTURE_UPLOAD_BYTES_PER_FRAME = 4 * 1024 * 1024;
+/* Max width / height of the low resolution preview shown until the texture is resident */
+const int          TEXTURE_PREVIEW_MAX_SIZE = 256;
+/* Unreferenced textures kept in VRAM for reuse before being evicted */
+const size_t       TEXTURE_UNUSED_BUDGET_BYTES = 64 * 1024 * 1024;
+
+/* --- Motion Cache Parameters --- */
+
+/* Parsed motions kept in memory per model, least recently used ones are evicted */
+const size_t       MOTION_CACHE_BUDGET_BYTES = 16 * 1024 * 1024;
+
+/* --- Simulation Parameters --- */
+
+/* Update the models on a dedicated thread (drawn interpolated on the GUI thread), inline in paintGL otherwise */
+const bool         SIMULATION_THREAD = true;
+/* Fixed rate of the simulation thread */
+const int          SIMULATION_TICK_HZ = 60;
+
+/* --- Cubism Allocator Parameters --- */
+
+/* Size-class pools & per-model arenas for the Cubism framework, plain malloc otherwise */
+const bool         CUBISM_POOLED_ALLOCATOR = true;
+/* Chunk size of the per-model arenas */
+const size_t       MODEL_ARENA_CHUNK_BYTES = 256 * 1024;
+
 #define AUDIO_FILE_DIR "user_audio/"
 #define AUDIO_GEN_DIR "gen_audio/"
+#define TEXTURE_CACHE_DIR "texture_cache/"
+/* Written on demand from the tray menu (Cubism allocations & texture VRAM) */
+#define MEMORY_REPORT_FILE_PATH "memory_report.json"
+/* Pre-baked model assets, next to model3.json (see the bake_model tool) */
+#define MODEL_BUNDLE_SUFFIX ".bundle"
 // without suffix
 #define AUDIO_FILENAME_LEN 16
 
@@ -88,4 +121,8 @@ struct tts_params_t {
 
 #define MCP_SSE_CLIENT_MAX_RETRY_TIMES 5
 // unit: second
-#define MCP_SSE_CLIENT_RETRY_INTERVAL 2
\ No newline at end of file
+#define MCP_SSE_CLIENT_RETRY_INTERVAL 2
+/* --------- Network related ---------- */
+
+// 预连接的 origin 保活间隔（unit: millisecond），0 表示不保活
+#define NETWORK_KEEP_WARM_INTERVAL 60000
@@ -41,10 +41,9 @@
 
 #define LOG_BODY(format) \
     time_t now; tm *localP; \
-    std::string full = fn; \
-    std::string tmp; \
-    size_t pos = full.find_last_of("/\\"); \
-    tmp = full.substr(pos + 1); \
+    const char* base = fn; \
+    for (const char* p = fn; *p != '\0'; p++) \
+        if (*p == '/' || *p == '\\') base = p + 1; \
     time(&now); \
     localP = localtime(&now); \
     fprintf( \
@@ -54,7 +53,7 @@
         localP->tm_mon + 1, \
         localP->tm_mday, localP->tm_hour, \
         localP->tm_min, localP->tm_sec, \
-        tmp.c_str(), lineno, msg \
+        base, lineno, msg \
     ); \
     fflush(dest);
 
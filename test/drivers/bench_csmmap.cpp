@@ -0,0 +1,145 @@
+/**
+ * @file bench_csmmap.cpp
+ * @brief Checks of `csmHashMap` and lookup benchmark against `csmMap` (10, 100 and 10k entries).
+ *
+ * Usage: bench_csmmap [lookups]
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+
+#include <CubismFramework.hpp>
+#include <Id/CubismId.hpp>
+#include <Id/CubismIdManager.hpp>
+#include <Type/csmHashMap.hpp>
+#include <Type/csmMap.hpp>
+#include <Utils/CubismString.hpp>
+
+#include "utils/logger.h"
+
+#include "drivers/allocator.h"
+
+/* Log and fail instead of `assert`, which NDEBUG removes from the Release test build. */
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            stdLogger.Exception("Check failed: " #condition); \
+            return false; \
+        } \
+    } while (0)
+
+using namespace Live2D::Cubism::Framework;
+
+namespace {
+    bool TestHashMap() {
+        csmHashMap<csmString, csmInt32> map;
+        CHECK(map.GetSize() == 0 && !map.IsExist("a") && map.Find("a") == NULL);
+
+        /* Insertion order is kept, as in csmMap. */
+        for (csmInt32 i = 0; i < 1000; i++)
+            map[Utils::CubismString::GetFormatedString("key%d", i)] = i;
+        CHECK(map.GetSize() == 1000);
+        csmInt32 expected = 0;
+        for (csmHashMap<csmString, csmInt32>::const_iterator it = map.Begin(); it != map.End(); ++it)
+            CHECK(it->Second == expected++);
+        CHECK(map["key500"] == 500 && map.Find("key999") != NULL && *map.Find("key999") == 999 && map.IsExist("key0"));
+
+        /* The const operator[] does not insert. */
+        const csmHashMap<csmString, csmInt32>& constMap = map;
+        CHECK(constMap["missing"] == 0 && map.GetSize() == 1000);
+
+        map.AppendKey("key1");
+        CHECK(map.GetSize() == 1000);
+
+        /* Erase keeps the order of the next entries. */
+        csmHashMap<csmString, csmInt32>::const_iterator it = map.Begin();
+        ++it;
+        it = map.Erase(it);
+        CHECK(it != map.End() && it->Second == 2 && map.GetSize() == 999 && !map.IsExist("key1") && map["key2"] == 2);
+
+        csmHashMap<csmString, csmInt32> copy(map);
+        map.Clear();
+        CHECK(map.GetSize() == 0 && copy.GetSize() == 999 && copy["key998"] == 998);
+        map = copy;
+        CHECK(map.GetSize() == 999 && map.Find("key3") != NULL && *map.Find("key3") == 3);
+
+        csmHashMap<csmInt32, csmFloat32> numbers;
+        for (csmInt32 i = -100; i < 100; i++)
+            numbers[i * 16] = static_cast<csmFloat32>(i);
+        CHECK(numbers.GetSize() == 200 && numbers[-1600] == -100.0f && !numbers.IsExist(8));
+        return true;
+    }
+
+    /**
+     * @brief Lookup time of every key in turn, [ns] per lookup.
+     */
+    template<class Map, class Key>
+    double MeasureLookups(Map& map, const std::vector<Key>& keys, int lookups, csmInt64* sum) {
+        QElapsedTimer timer;
+        timer.start();
+        csmInt64 total = 0;
+        const size_t count = keys.size();
+        for (int i = 0; i < lookups; i++)
+            total += map[keys[i % count]];
+        *sum += total;
+        return static_cast<double>(timer.nsecsElapsed()) / lookups;
+    }
+
+    template<class Key>
+    bool Benchmark(const char* name, const std::vector<Key>& keys, int lookups) {
+        csmMap<Key, csmInt32> linear;
+        csmHashMap<Key, csmInt32> hashed;
+        for (size_t i = 0; i < keys.size(); i++) {
+            linear[keys[i]] = static_cast<csmInt32>(i);
+            hashed[keys[i]] = static_cast<csmInt32>(i);
+        }
+
+        /* The linear map is O(n): fewer lookups for the large maps. */
+        const int linearLookups = keys.size() > 1000 ? lookups / 100 : lookups;
+        csmInt64 linearSum = 0, hashedSum = 0;
+        const double linearNs = MeasureLookups(linear, keys, linearLookups, &linearSum);
+        MeasureLookups(hashed, keys, linearLookups, &hashedSum);
+        CHECK(linearSum == hashedSum);
+        const double hashedNs = MeasureLookups(hashed, keys, lookups, &hashedSum);
+
+        stdLogger.Test(
+            QString::asprintf("%-8s %6d entries: csmMap %9.1f ns, csmHashMap %6.1f ns per lookup (%.1fx)",
+                name, static_cast<int>(keys.size()), linearNs, hashedNs, linearNs / hashedNs)
+            .toStdString()
+        );
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const int lookups = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    Allocator allocator;
+    CubismFramework::StartUp(&allocator);
+    CubismFramework::Initialize();
+
+    if (!TestHashMap())
+        return 1;
+
+    const int sizes[] = { 10, 100, 10000 };
+    for (int size : sizes) {
+        /* Parameter-like names and ids, as in the model & expression lookups. */
+        std::vector<csmString> names;
+        std::vector<CubismIdHandle> ids;
+        for (int i = 0; i < size; i++) {
+            names.push_back(Utils::CubismString::GetFormatedString("ParamBench%d", i));
+            ids.push_back(CubismFramework::GetIdManager()->GetId(names.back()));
+        }
+        if (!Benchmark("csmString", names, lookups) || !Benchmark("id", ids, lookups))
+            return 1;
+    }
+
+    CubismFramework::Dispose();
+    return 0;
+}
@@ -0,0 +1,200 @@
+/**
+ * @file bench_cubismjson.cpp
+ * @brief Checks and parse benchmark of the Cubism json parser (DOM & SAX) over the bundled model files.
+ *
+ * Usage: bench_cubismjson [model directory] [iterations]
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QString>
+
+#include <CubismFramework.hpp>
+#include <CubismModelSettingJson.hpp>
+#include <Utils/CubismJson.hpp>
+
+#include "utils/logger.h"
+
+#include "drivers/allocator.h"
+#include "drivers/tools.h"
+
+#ifndef TEST_MODEL_DIR
+#define TEST_MODEL_DIR "Resources/Hiyori/"
+#endif
+#define TEST_MODEL_SETTING "Hiyori.model3.json"
+
+/* Explicit checks: the tests are built in Release (NDEBUG), where `assert` is compiled out. */
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            stdLogger.Exception("Check failed: " #condition); \
+            return false; \
+        } \
+    } while (0)
+
+using namespace Live2D::Cubism::Framework;
+
+namespace {
+    /* Counts the values, as `CountDom` does on the parsed tree. */
+    class CountingHandler : public Utils::CubismJsonHandler {
+    public:
+        int values = 0;
+        int keys = 0;
+        float sum = 0.0f;
+
+        csmBool EndObject(csmInt32) override { values++; return true; }
+        csmBool EndArray(csmInt32) override { values++; return true; }
+        csmBool Key(const csmChar*, csmInt32) override { keys++; return true; }
+        csmBool String(const csmChar*, csmInt32) override { values++; return true; }
+        csmBool Float(csmFloat32 value) override { values++; sum += value; return true; }
+        csmBool Boolean(csmBool) override { values++; return true; }
+        csmBool Null() override { values++; return true; }
+    };
+
+    void CountDom(Utils::Value& value, CountingHandler* counts) {
+        counts->values++;
+        if (value.IsMap()) {
+            csmVector<csmString>& keys = value.GetKeys();
+            for (csmUint32 i = 0; i < keys.GetSize(); i++) {
+                counts->keys++;
+                CountDom(value[keys[i]], counts);
+            }
+        } else if (value.IsArray()) {
+            for (csmInt32 i = 0; i < value.GetSize(); i++)
+                CountDom(value[i], counts);
+        } else if (value.IsFloat()) {
+            counts->sum += value.ToFloat();
+        }
+    }
+
+    Utils::CubismJson* Parse(const char* text) {
+        return Utils::CubismJson::Create(reinterpret_cast<const csmByte*>(text), static_cast<csmSizeInt>(strlen(text)));
+    }
+
+    bool TestSyntax() {
+        Utils::CubismJson* json = Parse(
+            "\xEF\xBB\xBF{\"a\": [1, -2.5, 1e3, 2.5E-2, 0.1, ], \"s\": \"x\\\"\\u00e9\\n\", \"t\": true,"
+            " \"n\": null, \"a\": {\"nested\": [[]]}, }"
+        );
+        CHECK(json != NULL);
+        Utils::Value& root = json->GetRoot();
+        /* A duplicated key resolves to the last value. */
+        CHECK(root["a"].IsMap() && root["a"]["nested"][0].GetSize() == 0);
+        CHECK(root["s"].Equals("x\"\xC3\xA9\n"));
+        CHECK(root["t"].ToBoolean() && root["n"].IsNull() && root["missing"].IsNull());
+        Utils::CubismJson::Delete(json);
+
+        json = Parse("[1, -2.5, 1e3, 2.5E-2, 0.1, 12345678901234567890123]");
+        CHECK(json != NULL);
+        Utils::Value& numbers = json->GetRoot();
+        CHECK(numbers.GetSize() == 6 && numbers.GetVector()->GetSize() == 6);
+        CHECK(numbers[0].ToFloat() == 1.0f && numbers[1].ToFloat() == -2.5f && numbers[2].ToFloat() == 1000.0f);
+        CHECK(numbers[3].ToFloat() == 0.025f && numbers[4].ToFloat() == 0.1f);
+        CHECK(std::fabs(numbers[5].ToFloat() / 1.2345678901234567e22f - 1.0f) < 1e-6f);
+        CHECK(numbers[6].IsError());
+        Utils::CubismJson::Delete(json);
+
+        CHECK(Parse("{\"a\": 1.2.3}") == NULL);
+        CHECK(Parse("{\"a\": tru}") == NULL);
+        CHECK(Parse("{\"a\": [1, 2}") == NULL);
+        CHECK(Parse("{\"a\" 1}") == NULL);
+        CHECK(Parse("") == NULL);
+        return true;
+    }
+
+    /**
+     * @brief Open every json file referenced by the model (model3.json first).
+     */
+    bool OpenModelJsons(const std::string& dir, std::vector<FileBuffer>* files) {
+        files->resize(1);
+        if (!(*files)[0].Open(dir + TEST_MODEL_SETTING)) {
+            stdLogger.Exception(QString("Failed to open %1%2").arg(dir.c_str()).arg(TEST_MODEL_SETTING).toStdString());
+            return false;
+        }
+        CubismModelSettingJson setting((*files)[0].GetData(), (*files)[0].GetSize());
+        std::vector<std::string> names = {
+            setting.GetPhysicsFileName(), setting.GetPoseFileName(), setting.GetUserDataFile()
+        };
+        for (csmInt32 i = 0; i < setting.GetExpressionCount(); i++)
+            names.push_back(setting.GetExpressionFileName(i));
+        for (csmInt32 i = 0; i < setting.GetMotionGroupCount(); i++) {
+            const csmChar* group = setting.GetMotionGroupName(i);
+            for (csmInt32 j = 0; j < setting.GetMotionCount(group); j++)
+                names.push_back(setting.GetMotionFileName(group, j));
+        }
+        for (const std::string& name : names) {
+            if (name.empty()) continue;
+            files->emplace_back();
+            if (!files->back().Open(dir + name)) {
+                stdLogger.Exception(QString("Failed to open %1%2").arg(dir.c_str()).arg(name.c_str()).toStdString());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* DOM and SAX see the same document. */
+    bool TestSaxMatchesDom(const std::vector<FileBuffer>& files) {
+        for (const FileBuffer& file : files) {
+            Utils::CubismJson* json = Utils::CubismJson::Create(file.GetData(), file.GetSize());
+            CHECK(json != NULL);
+            CountingHandler dom, sax;
+            CountDom(json->GetRoot(), &dom);
+            Utils::CubismJson::Delete(json);
+            CHECK(Utils::CubismJson::ParseSax(file.GetData(), file.GetSize(), sax));
+            CHECK(dom.values == sax.values && dom.keys == sax.keys && dom.sum == sax.sum);
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::string dir = argc > 1 ? argv[1] : TEST_MODEL_DIR;
+    const int iterations = argc > 2 ? atoi(argv[2]) : 200;
+
+    Allocator allocator;
+    CubismFramework::StartUp(&allocator);
+    CubismFramework::Initialize();
+
+    std::vector<FileBuffer> files;
+    if (!TestSyntax() || !OpenModelJsons(dir, &files) || !TestSaxMatchesDom(files))
+        return 1;
+    size_t totalBytes = 0;
+    for (const FileBuffer& file : files)
+        totalBytes += file.GetSize();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int k = 0; k < iterations; k++) {
+        for (FileBuffer& file : files)
+            Utils::CubismJson::Delete(Utils::CubismJson::Create(file.GetData(), file.GetSize()));
+    }
+    const double domMs = timer.nsecsElapsed() / 1000000.0 / iterations;
+
+    timer.restart();
+    for (int k = 0; k < iterations; k++) {
+        for (FileBuffer& file : files) {
+            CountingHandler handler;
+            Utils::CubismJson::ParseSax(file.GetData(), file.GetSize(), handler);
+        }
+    }
+    const double saxMs = timer.nsecsElapsed() / 1000000.0 / iterations;
+
+    stdLogger.Test(
+        QString::asprintf("%d files, %.1f KB: DOM %.3f ms (%.1f MB/s), SAX %.3f ms (%.1f MB/s) per pass",
+            static_cast<int>(files.size()), totalBytes / 1024.0,
+            domMs, totalBytes / domMs / 1000.0, saxMs, totalBytes / saxMs / 1000.0)
+        .toStdString()
+    );
+
+    CubismFramework::Dispose();
+    return 0;
+}
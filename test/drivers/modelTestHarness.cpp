@@ -0,0 +1,45 @@
+#include <thread>
+
+#include <QtWidgets/QApplication>
+
+#include "utils/consts.h"
+#include "utils/logger.h"
+
+#include "drivers/coreManager.h"
+#include "drivers/resourceLoader.h"
+
+#include "modelTestHarness.h"
+
+#ifndef TEST_RESOURCE_ROOT
+#define TEST_RESOURCE_ROOT "."
+#endif
+
+namespace ModelTestHarness {
+    bool Initialize() {
+        if (chdir(TEST_RESOURCE_ROOT) != 0 || !resourceLoader::get_instance().initialize()) {
+            stdLogger.Exception("Failed to initialize resource loader");
+            return false;
+        }
+        return true;
+    }
+
+    void ShowWidget(AnimeWidget* widget) {
+        widget->resize(400, 600);
+        widget->show();
+    }
+
+    void RunFrames(AnimeWidget* widget, int frames, std::chrono::microseconds period) {
+        for (int i = 0; i < frames; i++) {
+            widget->repaint();
+            QApplication::processEvents();
+            if (period.count() > 0)
+                std::this_thread::sleep_for(period);
+        }
+    }
+
+    void Release(AnimeWidget* widget) {
+        widget->makeCurrent();
+        CoreManager::ReleaseInstance();
+        resourceLoader::get_instance().release();
+    }
+}
@@ -0,0 +1,40 @@
+/**
+ * @file modelTestHarness.h
+ * @brief Setup shared by the driver tests rendering the current model in an `AnimeWidget`.
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#pragma once
+
+#include <chrono>
+
+#include "gui/animeWidget.h"
+
+namespace ModelTestHarness {
+    /**
+     * @brief Enter the resource root (the configuration & the models are read
+     *        relative to the working directory) and initialize the resource loader.
+     *
+     * @return false (logged) on failure.
+     */
+    bool Initialize();
+
+    /**
+     * @brief Show the widget at the size used by the tests.
+     */
+    void ShowWidget(AnimeWidget* widget);
+
+    /**
+     * @brief Render frames through Qt: the first ones initialize the context, Cubism and the model.
+     *
+     * @param[in] period  Sleep after each frame (none by default: as fast as possible).
+     */
+    void RunFrames(AnimeWidget* widget, int frames, std::chrono::microseconds period = std::chrono::microseconds(0));
+
+    /**
+     * @brief Release Cubism (in the context of the widget) and the resource loader.
+     */
+    void Release(AnimeWidget* widget);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_frameallocs.cpp
+ * @brief Fails (exit code 1) when a steady-state frame allocates on the heap.
+ *
+ * The model of `Resources/config.json` is loaded in an `AnimeWidget` (an OpenGL
+ * context is required) and warmed up (textures streamed, motions parsed, motion
+ * queue entries recycled). Then `CoreManager::update` (the body of `paintGL`) is
+ * called at 60 Hz for the measured frames, counting:
+ * - the Cubism allocations (`Allocator` stats, the simulation thread included),
+ * - the C++ heap allocations of the GUI thread (`operator new` replaced below).
+ * The warm-up covers an idle motion restart, so do the measured frames.
+ * Frame times are reported (mean / max) to spot the jitter.
+ *
+ * Usage: test_frameallocs [measured frames] [warm-up frames]
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include <QtCore/QString>
+#include <QtWidgets/QApplication>
+
+#include "utils/logger.h"
+
+#include "drivers/allocator.h"
+#include "drivers/coreManager.h"
+#include "drivers/modelManager.h"
+#include "gui/animeWidget.h"
+
+#include "modelTestHarness.h"
+
+namespace {
+    /* Only the allocations of the measured frames on this thread are counted
+     * (the texture decoders & motion prefetchers run on the worker pool). */
+    thread_local bool t_counting = false;
+    thread_local size_t t_allocations = 0;
+
+    const std::chrono::microseconds FramePeriod(16667);
+
+    struct FrameStats {
+        size_t cubismAllocations = 0;
+        size_t heapAllocations = 0;
+        size_t allocatingFrames = 0;
+        double totalUs = 0.0;
+        double maxUs = 0.0;
+    };
+
+    FrameStats MeasureFrames(AnimeWidget* widget, int frames) {
+        CoreManager* core = CoreManager::GetInstance();
+        FrameStats stats;
+
+        widget->makeCurrent();
+        for (int i = 0; i < frames; i++) {
+            const uint64_t cubismBefore = core->GetAllocatorStats().allocations;
+            const auto start = std::chrono::steady_clock::now();
+
+            t_allocations = 0;
+            t_counting = true;
+            core->update();
+            t_counting = false;
+
+            const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            const size_t cubism = static_cast<size_t>(core->GetAllocatorStats().allocations - cubismBefore);
+            stats.cubismAllocations += cubism;
+            stats.heapAllocations += t_allocations;
+            if (cubism > 0 || t_allocations > 0)
+                stats.allocatingFrames++;
+            stats.totalUs += us;
+            if (us > stats.maxUs)
+                stats.maxUs = us;
+
+            std::this_thread::sleep_for(FramePeriod);
+        }
+        widget->doneCurrent();
+        return stats;
+    }
+}
+
+void* operator new(size_t size) {
+    if (t_counting)
+        t_allocations++;
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == NULL)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+int main(int argc, char* argv[]) {
+    QApplication app(argc, argv);
+    const int frames = argc > 1 ? atoi(argv[1]) : 600;
+    const int warmup = argc > 2 ? atoi(argv[2]) : 420;
+
+    if (!ModelTestHarness::Initialize())
+        return 1;
+
+    AnimeWidget widget;
+    ModelTestHarness::ShowWidget(&widget);
+    ModelTestHarness::RunFrames(&widget, warmup, FramePeriod);
+
+    if (ModelManager::GetInstance()->GetModelNum() == 0) {
+        stdLogger.Exception("Failed to load the current model");
+        return 1;
+    }
+
+    const FrameStats stats = MeasureFrames(&widget, frames);
+    stdLogger.Test(
+        QString::asprintf("%d frames: %zu Cubism allocations, %zu heap allocations in %zu frames; frame time mean %.1f us, max %.1f us",
+            frames, stats.cubismAllocations, stats.heapAllocations, stats.allocatingFrames,
+            stats.totalUs / frames, stats.maxUs)
+        .toStdString()
+    );
+
+    ModelTestHarness::Release(&widget);
+
+    if (stats.allocatingFrames > 0) {
+        stdLogger.Exception("Steady-state frames allocate");
+        return 1;
+    }
+    return 0;
+}
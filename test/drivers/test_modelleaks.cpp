@@ -0,0 +1,110 @@
+/**
+ * @file test_modelleaks.cpp
+ * @brief Fails (exit code 1) when loading & releasing the current model leaks memory.
+ *
+ * The model of `Resources/config.json` is loaded in an `AnimeWidget` (an OpenGL
+ * context is required), rendered for a few frames and released by
+ * `ModelManager::ReleaseAllModel` several times. After each release:
+ * - no allocation tag grows compared to the first release (which keeps what lives
+ *   until the framework is disposed: the ids registered while loading, the shaders),
+ * - no texture is referenced anymore (unused ones are kept for reuse).
+ *
+ * Usage: test_modelleaks [rounds]
+ *
+ * @author SSRVodka
+ * @date   Oct 19, 2026
+ */
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+
+#include <QtCore/QString>
+#include <QtWidgets/QApplication>
+
+#include "utils/logger.h"
+
+#include "drivers/allocator.h"
+#include "drivers/coreManager.h"
+#include "drivers/modelManager.h"
+#include "drivers/resourceLoader.h"
+#include "drivers/textureManager.h"
+#include "gui/animeWidget.h"
+
+#include "modelTestHarness.h"
+
+namespace {
+    bool CheckLeaks(int round, const Allocator::Stats& baseline, const Allocator::Stats& stats, const TextureManager::MemoryStats& textures) {
+        bool success = true;
+        for (int i = 0; i < Allocator::TagCount; i++) {
+            const Allocator::Tag tag = static_cast<Allocator::Tag>(i);
+            const Allocator::TagStats& current = stats.tags[i];
+            const Allocator::TagStats& expected = baseline.tags[i];
+            if (current.liveBytes > expected.liveBytes || current.liveCount > expected.liveCount) {
+                stdLogger.Exception(
+                    QString::asprintf("Round %d: %s leaks %zd bytes, %zd blocks",
+                        round, Allocator::GetTagName(tag),
+                        static_cast<ptrdiff_t>(current.liveBytes - expected.liveBytes),
+                        static_cast<ptrdiff_t>(current.liveCount - expected.liveCount))
+                    .toStdString().c_str()
+                );
+                success = false;
+            }
+        }
+        if (textures.residentBytes > textures.unusedBytes) {
+            stdLogger.Exception(
+                QString::asprintf("Round %d: %zu bytes of textures still referenced",
+                    round, textures.residentBytes - textures.unusedBytes)
+                .toStdString().c_str()
+            );
+            success = false;
+        }
+        return success;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    QApplication app(argc, argv);
+    const int rounds = argc > 1 ? atoi(argv[1]) : 3;
+
+    if (!ModelTestHarness::Initialize())
+        return 1;
+    const std::string name = resourceLoader::get_instance().getCurrentModelName().toStdString();
+
+    AnimeWidget widget;
+    ModelTestHarness::ShowWidget(&widget);
+    /* Initializes the context, Cubism and loads the model. */
+    ModelTestHarness::RunFrames(&widget, 30);
+
+    CoreManager* core = CoreManager::GetInstance();
+    ModelManager* manager = ModelManager::GetInstance();
+    if (manager->GetModelNum() == 0) {
+        stdLogger.Exception(QString("Failed to load model %1").arg(name.c_str()).toStdString().c_str());
+        return 1;
+    }
+
+    widget.makeCurrent();
+    manager->ReleaseAllModel();
+    const Allocator::Stats baseline = core->GetAllocatorStats();
+
+    bool success = true;
+    for (int round = 1; round <= rounds; round++) {
+        widget.makeCurrent();
+        if (!manager->ChangeScene(const_cast<Csm::csmChar*>(name.c_str()))) {
+            stdLogger.Exception(QString("Failed to reload model %1").arg(name.c_str()).toStdString().c_str());
+            return 1;
+        }
+        ModelTestHarness::RunFrames(&widget, 30);
+
+        widget.makeCurrent();
+        manager->ReleaseAllModel();
+        success &= CheckLeaks(round, baseline, core->GetAllocatorStats(), core->GetTextureManager()->GetMemoryStats());
+    }
+
+    stdLogger.Test("Memory report after release: " + core->GetMemoryReport());
+    if (success)
+        stdLogger.Test(QString("No leak over %1 load/release rounds of %2").arg(rounds).arg(name.c_str()).toStdString());
+
+    ModelTestHarness::Release(&widget);
+    return success ? 0 : 1;
+}
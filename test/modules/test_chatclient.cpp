@@ -1,11 +1,15 @@
 
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QPointer>
 #include <QtCore/QUrlQuery>
 #include <QtTest/QSignalSpy>
 
+#include <thread>
+
 #include <nlohmann/json.hpp>
 
+#include "modules/chat/speculative_request.h"
 #include "utils/consts.h"
 #include "utils/logger.h"
 #include "test_chatclient.h"
@@ -164,6 +168,130 @@ void TestChatClient::testTimeout() {
     QCOMPARE(this->client->getHistory().size(), 0);
 }
 
+void TestChatClient::testCancel() {
+    this->params.server_url = this->endpoint + "/v1/timeout";
+    this->client->setChatParams(this->params);
+    this->client->setTimeout(TEST_UNIT_TIMEOUT << 1);
+    this->client->clearHistory();
+
+    // cancel a pending request
+    quint32 msgId = this->client->sendMessageAsync("cancelled message");
+    QCOMPARE(this->client->getHistory().size(), 1);
+    QTest::qWait(200);
+    this->client->cancelConversation(msgId);
+    QCOMPARE(this->client->getHistory().size(), 0);
+
+    // no response or error should be delivered for the cancelled request
+    QTest::qWait(500);
+    {
+        std::lock_guard<std::mutex> lock(this->msg_mutex);
+        QVERIFY(this->msg_queue.empty());
+    }
+
+    // the client must be able to start a new conversation right away
+    this->params.server_url = this->endpoint + "/v1/nokey";
+    this->client->setChatParams(this->params);
+    this->submit_and_check(false);
+    QCOMPARE(this->client->getHistory().size(), 2);
+}
+
+void TestChatClient::testSpeculative() {
+    // the speculative request stays pending, so that only the speculation decides its fate
+    this->params.server_url = this->endpoint + "/v1/timeout";
+    this->client->setChatParams(this->params);
+    this->client->setTimeout(TEST_UNIT_TIMEOUT << 1);
+    this->client->clearHistory();
+
+    SpeculativeRequest speculative(this->client);
+    SpeculativeRequest::speculative_params_t sp;
+    sp.enable = true;
+    sp.stable_partials = 2;
+    sp.stable_ms = 0;
+    sp.min_chars = 4;
+    speculative.setParams(sp);
+    QSignalSpy firedSpy(&speculative, &SpeculativeRequest::fired);
+    QSignalSpy cancelledSpy(&speculative, &SpeculativeRequest::cancelled);
+
+    // fired once the partial transcript is stable (punctuation and case ignored)
+    speculative.onPartialTranscript("what time", false);
+    QCOMPARE(firedSpy.count(), 0);
+    speculative.onPartialTranscript("What time?", false);
+    QCOMPARE(firedSpy.count(), 1);
+    QVERIFY(speculative.isAwaitingConfirmation());
+    QCOMPARE(this->client->getHistory().size(), 1);
+
+    // a different final transcript rejects it and rolls the history back
+    QVERIFY(!speculative.onFinalTranscript("what time is it"));
+    QCOMPARE(cancelledSpy.count(), 1);
+    QCOMPARE(this->client->getHistory().size(), 0);
+    QCOMPARE(speculative.stats().misses, 1u);
+
+    // never fired on top of an ongoing conversation
+    speculative.onPartialTranscript("what time is it", true);
+    speculative.onPartialTranscript("what time is it", true);
+    QCOMPARE(firedSpy.count(), 1);
+    speculative.abandon();
+
+    // a matching final transcript keeps the request in flight
+    speculative.onPartialTranscript("what time is it", false);
+    speculative.onPartialTranscript("what time is it", false);
+    QCOMPARE(firedSpy.count(), 2);
+    QVERIFY(speculative.onFinalTranscript("What time is it?"));
+    QCOMPARE(speculative.stats().hits, 1u);
+    QCOMPARE(speculative.stats().hitRate(), 0.5);
+    QCOMPARE(this->client->getHistory().size(), 1);
+
+    this->client->cancelConversation(this->client->getHistory()[0].id);
+}
+
+void TestChatClient::testSessions() {
+    this->params.server_url = this->endpoint + "/v1/nokey";
+    this->params.api_key = "";
+    this->client->setChatParams(this->params);
+    this->client->setTimeout(TEST_UNIT_TIMEOUT << 1);
+    this->client->clearHistory();
+
+    Session *assistant = this->client->defaultSession();
+    std::shared_ptr<Session> summarizer = this->client->createSession("summarizer", "you summarize conversations");
+    QVERIFY(summarizer != nullptr);
+    QCOMPARE(this->client->createSession("summarizer"), summarizer);
+    QCOMPARE(this->client->session("summarizer"), summarizer);
+    QCOMPARE(this->client->sessionNames().size(), 2);
+
+    // concurrent conversations, the second one is sent from a worker thread
+    QSignalSpy assistantSpy(assistant, &Session::asyncResponseReceived);
+    QSignalSpy summarizerSpy(summarizer.get(), &Session::asyncResponseReceived);
+    quint32 assistantMsgId = assistant->sendMessageAsync("hello");
+    quint32 summarizerMsgId = 0;
+    std::thread worker([summarizer, &summarizerMsgId]() {
+        summarizerMsgId = summarizer->sendMessageAsync("summarize");
+    });
+    worker.join();
+    QVERIFY(assistantMsgId != summarizerMsgId);
+
+    QVERIFY(assistantSpy.count() > 0 || assistantSpy.wait(TEST_UNIT_TIMEOUT));
+    QVERIFY(summarizerSpy.count() > 0 || summarizerSpy.wait(TEST_UNIT_TIMEOUT));
+
+    // the histories are independent
+    QCOMPARE(assistant->getHistory().size(), 2);
+    QCOMPARE(summarizer->getHistory().size(), 2);
+    QCOMPARE(summarizer->getHistory()[0].content, QString("summarize"));
+
+    // a removed session stays valid for its holders, and is destroyed once released
+    QPointer<Session> removed(summarizer.get());
+    this->client->removeSession("summarizer");
+    QVERIFY(this->client->session("summarizer") == nullptr);
+    QCOMPARE(summarizer->getHistory().size(), 2);
+    summarizer.reset();
+    QTRY_VERIFY(removed.isNull());
+    this->client->removeSession(Client::DEFAULT_SESSION);
+    QCOMPARE(this->client->defaultSession(), assistant);
+
+    // drain the default session reply delivered through the client
+    std::lock_guard<std::mutex> lock(this->msg_mutex);
+    while (!this->msg_queue.empty()) this->msg_queue.pop();
+}
+
 void TestChatClient::testTagsAndBlocks() {
     QString testStr = "Hello! this is a text.<think> I'm <think>ing now... 12345678 </think>\n\n"
         "Here is my code:\n"
@@ -33,6 +33,9 @@ private slots:
     void testInvalidResponse();
     void testHistory();
     void testTimeout();
+    void testCancel();
+    void testSpeculative();
+    void testSessions();
 
     void testTagsAndBlocks();
 